@@ -71,15 +71,8 @@ void mexFunction( int /*nlhs*/, mxArray* plhs[], int nrhs, const mxArray* prhs[]
       if( mxIsNumeric( mxFilter ) || mxIsClass( mxFilter, "dip_image" )) {
 
          dip::Image const filter = dml::GetImage( mxFilter );
-         filterArray = dip::SeparateFilter( filter );
-         if( filterArray.empty() ) {
-            if( filter.NumberOfPixels() > 7 * 7 ) {
-               dip::ConvolveFT( in, filter, out );
-            } else {
-               dip::GeneralConvolution( in, filter, out, bc );
-            }
-            goto fin;
-         }
+         dip::Convolution( in, filter, out, "best", bc );
+         goto fin;
 
       } else {
 
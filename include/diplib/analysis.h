@@ -235,6 +235,50 @@ DIP_EXPORT FloatArray FindShift(
       UnsignedArray maxShift = {}
 );
 
+/// \brief Estimates the (sub-pixel) global shift between `in1` and `in2`, using a coarse-to-fine strategy.
+///
+/// This function approximates `dip::FindShift` at a much lower cost for large images. Both images are reduced
+/// with `dip::GaussianPyramid` until they are no larger than `windowSize` along any dimension. The integer
+/// shift is estimated at the coarsest level using the full (small) images. At each finer level,
+/// the shift is refined using cross-correlation on a window of at most `windowSize` pixels along each
+/// dimension, taken from the middle of the common part of the two images. The residual shift at each level
+/// is restricted to 2 pixels. Finally, `method` is applied to the full-resolution windows, aligned to the
+/// integer shift, to estimate the sub-pixel shift. Thus, no Fourier transform is ever computed on an image
+/// larger than `windowSize` along any dimension.
+///
+/// `method`, `parameter` and `maxShift` are as in `dip::FindShift`. `windowSize` must be at least 16. The
+/// window must be large enough to contain sufficient image detail to determine the shift. If it does, the integer
+/// shift is the same as that found by `dip::FindShift`, and the sub-pixel shift agrees to within about 0.01 pixels
+/// for the `"MTS"` and `"ITER"` methods. The less precise `"CC"`, `"NCC"` and `"CPF"` methods are more affected
+/// by the smaller window, their results can differ by a few tenths of a pixel. If the images are no larger than
+/// `windowSize`, `dip::FindShift` is called directly.
+DIP_EXPORT FloatArray FindShiftCoarseToFine(
+      Image const& in1,
+      Image const& in2,
+      String const& method = "MTS",
+      dfloat parameter = 0,
+      UnsignedArray maxShift = {},
+      dip::uint windowSize = 256
+);
+
+/// \brief Estimates the (sub-pixel) global shift between each of the pairs of images `in1[ ii ]` and `in2[ ii ]`.
+///
+/// The output array contains, for each pair, the result of `dip::FindShift` with the same `method`, `parameter`
+/// and `maxShift` parameters.
+///
+/// All images must have the same sizes. The cross-correlations for all pairs, used to determine either the
+/// integer shift or the sub-pixel shift (depending on `method`), are computed together through Fourier transforms
+/// of the images stacked along a new dimension. This shares the setup cost of the transforms among all
+/// pairs, and parallelizes over all pairs. This is useful for registering many tiles of the same size, for example
+/// when stitching. Note that the temporary data is as large as all images together.
+DIP_EXPORT FloatCoordinateArray FindShift(
+      ImageConstRefArray const& in1,
+      ImageConstRefArray const& in2,
+      String const& method = "MTS",
+      dfloat parameter = 0,
+      UnsignedArray maxShift = {}
+);
+
 
 /// \brief Computes the structure tensor.
 ///
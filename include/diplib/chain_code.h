@@ -460,6 +460,22 @@ class DIP_NO_EXPORT CovarianceMatrix {
 };
 
 
+/// \brief Describes a rectangle with arbitrary orientation, as returned by `dip::ConvexHull::MinimumAreaRectangle`
+/// and `dip::ConvexHull::MinimumPerimeterRectangle`.
+struct DIP_NO_EXPORT RectangleValues {
+   VertexFloat center;  ///< The center of the rectangle
+   dfloat length = 0.0; ///< The length of the longest side
+   dfloat width = 0.0;  ///< The length of the shortest side
+   dfloat angle = 0.0;  ///< The angle of the longest side, in the range (-&pi;/2,&pi;/2]
+};
+
+/// \brief Describes a circle, as returned by `dip::ConvexHull::MinimumEnclosingCircle`.
+struct DIP_NO_EXPORT CircleValues {
+   VertexFloat center;    ///< The center of the circle
+   dfloat diameter = 0.0; ///< The diameter of the circle
+};
+
+
 //
 // Polygon, convex hull
 //
@@ -653,9 +669,31 @@ class DIP_NO_EXPORT ConvexHull {
          return vertices_.Length();
       }
 
-      /// Returns the %Feret diameters of the convex hull
+      /// \brief Returns the %Feret diameters of the convex hull
+      ///
+      /// The diameters are computed exactly with the rotating calipers algorithm, in time linear in the number
+      /// of vertices: the maximum diameter is the largest distance between antipodal vertex pairs, and the minimum
+      /// diameter is the smallest distance between an edge and the vertex farthest from it.
       DIP_EXPORT FeretValues Feret() const;
 
+      /// \brief Returns the bounding rectangle with the smallest area
+      ///
+      /// One of the sides of this rectangle is collinear with an edge of the convex hull, so it is found exactly
+      /// with the rotating calipers algorithm, in time linear in the number of vertices.
+      DIP_EXPORT RectangleValues MinimumAreaRectangle() const;
+
+      /// \brief Returns the bounding rectangle with the smallest perimeter
+      ///
+      /// As with `MinimumAreaRectangle`, one of the sides of this rectangle is collinear with an edge of the
+      /// convex hull.
+      DIP_EXPORT RectangleValues MinimumPerimeterRectangle() const;
+
+      /// \brief Returns the smallest circle that encloses the convex hull
+      ///
+      /// Uses Welzl's randomized incremental algorithm, which takes expected time linear in the number of
+      /// vertices. The vertices are shuffled with a fixed seed, so that the result is reproducible.
+      DIP_EXPORT CircleValues MinimumEnclosingCircle() const;
+
       /// Returns the centroid of the convex hull
       VertexFloat Centroid() const {
          return vertices_.Centroid();
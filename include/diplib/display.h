@@ -21,6 +21,8 @@
 #ifndef DIP_DISPLAY_H
 #define DIP_DISPLAY_H
 
+#include <map>
+
 #include "diplib.h"
 #include "diplib/color.h"
 
@@ -544,6 +546,12 @@ class DIP_NO_EXPORT ImageDisplay {
       std::array< LimitsLists, 4 > sliceLimits_;  // Limits to use when !globalStretch_
       std::array< LimitsLists, 4 > globalLimits_; // Limits to use when globalStretch_
 
+      // Slice limits computed earlier, so that going back to a previously seen slice or projection does not
+      // require scanning the data again. The key identifies the slice, see `SliceKey()`.
+      std::map< std::vector< dip::uint >, std::array< LimitsLists, 4 >> sliceLimitsCache_;
+      std::vector< dip::uint > sliceLimitsKey_; // The key for the values currently in `sliceLimits_`
+      static constexpr dip::uint maxSliceLimitsCacheSize_ = 4096;
+
       bool IsComplex() { return image_.DataType().IsComplex(); }
       bool IsBinary() { return image_.DataType().IsBinary(); }
       bool IsInteger() { return image_.DataType().IsInteger(); }
@@ -554,6 +562,9 @@ class DIP_NO_EXPORT ImageDisplay {
 
       DIP_NO_EXPORT void InvalidateSliceLimits();
 
+      // Returns a key that uniquely identifies the current `rgbSlice_`.
+      DIP_NO_EXPORT std::vector< dip::uint > SliceKey() const;
+
       DIP_EXPORT void UpdateSlice();
       DIP_NO_EXPORT void UpdateRgbSlice();
       DIP_EXPORT void UpdateOutput();
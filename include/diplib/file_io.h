@@ -301,6 +301,22 @@ DIP_EXPORT void ImageWriteTIFF(
       dip::uint jpegLevel = 80
 );
 
+/// \brief Writes the levels of an image pyramid as a multi-page TIFF file.
+///
+/// Each element of `pyramid` must be a 2D image, and is written as a separate page (image file directory) in
+/// the file, in the order given. All pages except the first one are marked as reduced-resolution versions of
+/// the first one, as is usual for pyramidal TIFF files. The levels need not have the same sizes or data types.
+/// `pyramid` would typically be obtained from `dip::GaussianPyramid`; each level is written with its own pixel
+/// size. Level `n` can be read back with `dip::ImageReadTIFF( filename, dip::Range{ n } )`.
+///
+/// See `dip::ImageWriteTIFF` for the meaning of the other parameters, and the limitations of the file format.
+DIP_EXPORT void ImageWriteTIFFPyramid(
+      ImageArray const& pyramid,
+      String const& filename,
+      String const& compression = "",
+      dip::uint jpegLevel = 80
+);
+
 
 /// \brief Returns the location of the dot that separates the extension, or `dip::String::npos` if there is no dot.
 inline String::size_type FileGetExtensionPosition(
@@ -243,6 +243,113 @@ DIP_EXPORT Image::Pixel ResampleAt(
 );
 
 
+/// \brief Smooths and subsamples the image by a factor 2, yielding the next level of a Gaussian pyramid.
+///
+/// Along each dimension with a size larger than 1, the image is convolved with the 5-tap binomial kernel
+/// `[1 4 6 4 1]/16` and every other sample is kept. The two steps are fused: only the samples that are
+/// kept are computed, and no full-size intermediate image is created. The output has size
+/// `(in.Size( ii ) + 1) / 2` along the processed dimensions. Singleton dimensions are not modified.
+///
+/// `boundaryCondition` determines how the image is extended for the filter, see `dip::BoundaryCondition`.
+///
+/// The output image has the same data type as the input image, except for binary images, which yield a
+/// floating-point output. The pixel size is scaled by 2 along the processed dimensions.
+///
+/// \see dip::PyramidExpand, dip::GaussianPyramid
+DIP_EXPORT void PyramidReduce(
+      Image const& in,
+      Image& out,
+      StringArray const& boundaryCondition = {}
+);
+inline Image PyramidReduce(
+      Image const& in,
+      StringArray const& boundaryCondition = {}
+) {
+   Image out;
+   PyramidReduce( in, out, boundaryCondition );
+   return out;
+}
+
+/// \brief Upsamples the image by a factor 2, interpolating with the kernel used by `dip::PyramidReduce`.
+///
+/// This is the inverse operation (but not an exact inverse) of `dip::PyramidReduce`: the image is
+/// upsampled by inserting zeros, and convolved with `2 * [1 4 6 4 1]/16`. The zeros are never stored
+/// nor multiplied: even output samples are computed as `(in[i-1] + 6 in[i] + in[i+1]) / 8`, odd
+/// output samples as `(in[i] + in[i+1]) / 2`.
+///
+/// `sizes` is the size of the output image, and must satisfy `(sizes[ ii ] + 1) / 2 == in.Size( ii )`.
+/// That is, pass the sizes of the image that was given to `dip::PyramidReduce` to obtain an image of the
+/// same sizes as that image. If `sizes` is empty, the sizes are doubled, except for singleton dimensions,
+/// which are not modified (as in `dip::PyramidReduce`).
+///
+/// The output image has the same data type as the input image, except for binary images, which yield a
+/// floating-point output. The pixel size is halved along the processed dimensions.
+///
+/// \see dip::PyramidReduce, dip::LaplacianPyramid
+DIP_EXPORT void PyramidExpand(
+      Image const& in,
+      Image& out,
+      UnsignedArray const& sizes = {},
+      StringArray const& boundaryCondition = {}
+);
+inline Image PyramidExpand(
+      Image const& in,
+      UnsignedArray const& sizes = {},
+      StringArray const& boundaryCondition = {}
+) {
+   Image out;
+   PyramidExpand( in, out, sizes, boundaryCondition );
+   return out;
+}
+
+/// \brief Computes a Gaussian pyramid with `nLevels` levels.
+///
+/// The first element of the output array is a copy of `in`, each subsequent element is obtained by applying
+/// `dip::PyramidReduce` to the previous one. Each level is computed directly from the previous level,
+/// no full-size temporary images are created. Each level has its pixel size adjusted accordingly.
+///
+/// If `nLevels` is 0, levels are added until all image dimensions are smaller than 8 pixels.
+///
+/// A 2D pyramid can be written to a pyramidal TIFF file with `dip::ImageWriteTIFFPyramid`.
+DIP_EXPORT ImageArray GaussianPyramid(
+      Image const& in,
+      dip::uint nLevels = 0,
+      StringArray const& boundaryCondition = {}
+);
+
+/// \brief Computes a Laplacian pyramid with `nLevels` levels.
+///
+/// Each element of the output array except the last one is the difference between a level of the Gaussian pyramid
+/// and the `dip::PyramidExpand` of the next (coarser) level. The last element is the coarsest level of the Gaussian
+/// pyramid. All levels have a floating-point or complex type. The input can be recovered with
+/// `dip::LaplacianPyramidReconstruction`.
+///
+/// If `nLevels` is 0, levels are added until all image dimensions are smaller than 8 pixels.
+DIP_EXPORT ImageArray LaplacianPyramid(
+      Image const& in,
+      dip::uint nLevels = 0,
+      StringArray const& boundaryCondition = {}
+);
+
+/// \brief Reconstructs an image from its Laplacian pyramid, see `dip::LaplacianPyramid`.
+///
+/// The `boundaryCondition` must match the one used to compute the pyramid for the reconstruction to be exact
+/// (up to rounding errors).
+DIP_EXPORT void LaplacianPyramidReconstruction(
+      ImageArray const& pyramid,
+      Image& out,
+      StringArray const& boundaryCondition = {}
+);
+inline Image LaplacianPyramidReconstruction(
+      ImageArray const& pyramid,
+      StringArray const& boundaryCondition = {}
+) {
+   Image out;
+   LaplacianPyramidReconstruction( pyramid, out, boundaryCondition );
+   return out;
+}
+
+
 // Undocumented internal function called by the other forms of Skew.
 // Each sub-volume perpendicular to axis is shifted with sub-pixel precision, according to `shearArray`.
 // That is, if `axis` is 1, then the sub-volume `in[:,ii,:,:,...]`, with all possible `ii`, is shifted
@@ -527,7 +634,64 @@ inline Image Rotation3D(
 }
 
 
-// TODO: port rot_euler_low.c and affine_trans_low.c from DIPimage
+/// \brief Applies an arbitrary affine transformation to the image.
+///
+/// `matrix` is a `nDims`x`nDims` or a `nDims`x`(nDims+1)` matrix, stored in column-major order, with `nDims`
+/// the image dimensionality. It maps input coordinates to output coordinates. The optional last column is
+/// the translation. The origin of the coordinate system is the origin pixel (as defined in
+/// `dip::FourierTransform` and other places), so that for example a rotation matrix rotates the image around
+/// its center. **Note** the y-axis is positive downwards!
+///
+/// The output image has the same sizes, data type and tensor shape as the input image. Each output pixel is
+/// mapped back to the input image with the inverse transformation, and interpolated there. Output pixels
+/// that map outside of the input image domain are set to zero.
+///
+/// `interpolationMethod` has a restricted set of options: `"linear"`, `"3-cubic"`, or `"nearest"`.
+/// See \ref interpolation_methods for their definition. 2D and 3D images use dedicated interpolation code,
+/// other dimensionalities are supported but slower.
+///
+/// If `matrix` is not invertible, an exception is thrown.
+///
+/// \see dip::ProjectiveTransform, dip::Rotation, dip::ResampleAt
+DIP_EXPORT void AffineTransform(
+      Image const& in,
+      Image& out,
+      FloatArray const& matrix,
+      String const& interpolationMethod = S::LINEAR
+);
+inline Image AffineTransform(
+      Image const& in,
+      FloatArray const& matrix,
+      String const& interpolationMethod = S::LINEAR
+) {
+   Image out;
+   AffineTransform( in, out, matrix, interpolationMethod );
+   return out;
+}
+
+/// \brief Applies an arbitrary projective transformation (homography) to the image.
+///
+/// `matrix` is a `(nDims+1)`x`(nDims+1)` matrix, stored in column-major order, with `nDims` the image
+/// dimensionality. It maps homogeneous input coordinates to homogeneous output coordinates. As in
+/// `dip::AffineTransform`, the origin of the coordinate system is the origin pixel.
+///
+/// Output pixels that map outside of the input image domain, or to points at or behind the projection
+/// center, are set to zero. See `dip::AffineTransform` for the other details.
+DIP_EXPORT void ProjectiveTransform(
+      Image const& in,
+      Image& out,
+      FloatArray const& matrix,
+      String const& interpolationMethod = S::LINEAR
+);
+inline Image ProjectiveTransform(
+      Image const& in,
+      FloatArray const& matrix,
+      String const& interpolationMethod = S::LINEAR
+) {
+   Image out;
+   ProjectiveTransform( in, out, matrix, interpolationMethod );
+   return out;
+}
 
 
 /// \brief Tiles a set of images to form a single image.
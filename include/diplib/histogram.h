@@ -21,6 +21,9 @@
 #ifndef DIP_HISTOGRAM_H
 #define DIP_HISTOGRAM_H
 
+#include <memory>
+#include <unordered_map>
+
 #include "diplib.h"
 #include "diplib/iterators.h"
 #include "diplib/measurement.h"
@@ -57,6 +60,14 @@ inline dip::sint FindBin( dfloat value, dfloat lowerBound, dfloat binSize, dip::
 ///
 /// To facilitate usage for one-dimensional histograms, all getter functions that return a value
 /// for a given dimension, default to dimension 0, so can be called without arguments.
+///
+/// The bins are normally stored in a dense image, which for a multi-dimensional histogram can be huge (a
+/// 5-channel image with 256 bins per channel would need 4 TB). If `dip::Histogram::Configuration::sparse`
+/// is set, only non-empty bins are stored, in a hash map (see `dip::Histogram::IsSparse`). Sparse histograms
+/// do not have an image with bins, so `GetImage`, `begin` and `Origin` cannot be used, nor can `Cumulative`
+/// and `Smooth`. Bin values can be read with `At`, and `Mean`, `Covariance`, `MarginalMedian`, `Mode`,
+/// `MutualInformation` and `Entropy` work as for dense histograms. The threshold algorithms require
+/// a dense histogram.
 class DIP_NO_EXPORT Histogram {
    public:
       using CountType = uint32;
@@ -104,6 +115,7 @@ class DIP_NO_EXPORT Histogram {
          bool lowerIsPercentile = false; ///< If set, `lowerBound` is replaced by the given percentile pixel value.
          bool upperIsPercentile = false; ///< If set, `upperBound` is replaced by the given percentile pixel value.
          bool excludeOutOfBoundValues = false; ///< If set, pixels outside of the histogram bounds are not counted.
+         bool sparse = false;          ///< If set for any dimension, only non-empty bins are stored. Ignored for measurement features.
 
          /// \brief Default-constructed configuration defines 256 bins in the range [0,256].
          Configuration() = default;
@@ -253,7 +265,11 @@ class DIP_NO_EXPORT Histogram {
       /// ```
       Histogram Copy() const {
          Histogram out( *this );
-         out.data_ = data_.Copy();
+         if( IsSparse() ) {
+            out.sparse_ = std::make_shared< SparseBins >( *sparse_ );
+         } else {
+            out.data_ = data_.Copy();
+         }
          return out;
       }
 
@@ -264,11 +280,64 @@ class DIP_NO_EXPORT Histogram {
       Histogram& operator+=( Histogram const& other ) {
          DIP_THROW_IF(( data_.Sizes() != other.data_.Sizes() ||
                       ( lowerBounds_ != other.lowerBounds_ ) ||
-                      ( binSizes_ != other.binSizes_ )), "Histograms don't match" );
-         data_ += other.data_;
+                      ( binSizes_ != other.binSizes_ ) ||
+                      ( IsSparse() != other.IsSparse() )), "Histograms don't match" );
+         if( IsSparse() ) {
+            if( sparse_ == other.sparse_ ) {
+               for( auto& bin : *sparse_ ) {
+                  bin.second *= 2;
+               }
+            } else {
+               for( auto const& bin : *other.sparse_ ) {
+                  ( *sparse_ )[ bin.first ] += bin.second;
+               }
+            }
+         } else {
+            data_ += other.data_;
+         }
          return *this;
       }
 
+      /// \brief Adds the pixels of `input` to the histogram.
+      ///
+      /// The bin configuration is not recomputed, the existing bins are used as they are. This allows a histogram
+      /// to be accumulated over a stream of images without reconfiguring it. `input` must be real-valued and have
+      /// as many tensor elements as the histogram has dimensions. Pixels are excluded or clamped to the end bins
+      /// as specified by the configuration used when the histogram was created. `mask` optionally selects the
+      /// pixels that are counted.
+      DIP_EXPORT Histogram& Add( Image const& input, Image const& mask = {} );
+
+      /// \brief Adds the pixels of `input1` and `input2` to the joint histogram.
+      ///
+      /// Identical to `dip::Histogram::Add`, but for a 2D histogram of two scalar images.
+      DIP_EXPORT Histogram& Add( Image const& input1, Image const& input2, Image const& mask );
+
+      /// \brief Storage for the non-empty bins of a sparse histogram, maps the linear index of a bin to its count.
+      ///
+      /// The linear index of a bin is its offset in an image of sizes `{ Bins( 0 ), Bins( 1 ), ... }` with normal
+      /// strides. Use `dip::Histogram::BinCoordinates` to convert it to bin coordinates.
+      using SparseBins = std::unordered_map< dip::uint, CountType >;
+
+      /// \brief Returns true if the histogram uses sparse storage, see `dip::Histogram::Configuration::sparse`.
+      bool IsSparse() const { return sparse_ != nullptr; }
+
+      /// \brief Returns the non-empty bins of a sparse histogram.
+      SparseBins const& GetSparseBins() const {
+         DIP_THROW_IF( !IsSparse(), "Histogram is not sparse" );
+         return *sparse_;
+      }
+
+      /// \brief Converts a linear bin index, as used in `dip::Histogram::SparseBins`, to bin coordinates.
+      UnsignedArray BinCoordinates( dip::uint index ) const {
+         dip::uint nDims = Dimensionality();
+         UnsignedArray coords( nDims );
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            coords[ ii ] = index % data_.Size( ii );
+            index /= data_.Size( ii );
+         }
+         return coords;
+      }
+
       /// \brief Returns the histogram dimensionality.
       dip::uint Dimensionality() const { return data_.Dimensionality(); }
 
@@ -362,6 +431,9 @@ class DIP_NO_EXPORT Histogram {
       CountType At( dip::uint x ) const {
          DIP_THROW_IF( Dimensionality() != 1, E::ILLEGAL_DIMENSIONALITY );
          DIP_THROW_IF( x >= data_.Size( 0 ), E::INDEX_OUT_OF_RANGE );
+         if( IsSparse() ) {
+            return SparseAt( x );
+         }
          return *static_cast< CountType* >( data_.Pointer( static_cast< dip::sint >( x ) * data_.Stride( 0 ) ));
       }
       /// \brief Get the value at the given bin in a 2D histogram
@@ -369,6 +441,9 @@ class DIP_NO_EXPORT Histogram {
          DIP_THROW_IF( Dimensionality() != 2, E::ILLEGAL_DIMENSIONALITY );
          DIP_THROW_IF( x >= data_.Size( 0 ), E::INDEX_OUT_OF_RANGE );
          DIP_THROW_IF( y >= data_.Size( 1 ), E::INDEX_OUT_OF_RANGE );
+         if( IsSparse() ) {
+            return SparseAt( x + y * data_.Size( 0 ));
+         }
          return *static_cast< CountType* >( data_.Pointer( static_cast< dip::sint >( x ) * data_.Stride( 0 ) +
                                                            static_cast< dip::sint >( y ) * data_.Stride( 1 )));
       }
@@ -379,6 +454,9 @@ class DIP_NO_EXPORT Histogram {
          DIP_THROW_IF( x >= data_.Size( 0 ), E::INDEX_OUT_OF_RANGE );
          DIP_THROW_IF( y >= data_.Size( 1 ), E::INDEX_OUT_OF_RANGE );
          DIP_THROW_IF( z >= data_.Size( 2 ), E::INDEX_OUT_OF_RANGE );
+         if( IsSparse() ) {
+            return SparseAt( x + ( y + z * data_.Size( 1 )) * data_.Size( 0 ));
+         }
          return *static_cast< CountType* >( data_.Pointer( static_cast< dip::sint >( x ) * data_.Stride( 0 ) +
                                                            static_cast< dip::sint >( y ) * data_.Stride( 1 ) +
                                                            static_cast< dip::sint >( z ) * data_.Stride( 2 )));
@@ -386,16 +464,30 @@ class DIP_NO_EXPORT Histogram {
 
       /// \brief Get the value at the given bin
       CountType At( UnsignedArray const& bin ) const {
+         if( IsSparse() ) {
+            DIP_THROW_IF( bin.size() != Dimensionality(), E::ARRAY_PARAMETER_WRONG_LENGTH );
+            dip::uint index = 0;
+            for( dip::uint ii = Dimensionality(); ii > 0; ) {
+               --ii;
+               DIP_THROW_IF( bin[ ii ] >= data_.Size( ii ), E::INDEX_OUT_OF_RANGE );
+               index = index * data_.Size( ii ) + bin[ ii ];
+            }
+            return SparseAt( index );
+         }
          return *static_cast< CountType* >( data_.Pointer( bin )); // Does all the checking
       }
 
       /// \brief Get the image that holds the bin counts. The image is always scalar and of type `dip::DT_UINT32`.
+      ///
+      /// Sparse histograms do not have such an image.
       Image const& GetImage() const {
+         DIP_THROW_IF( IsSparse(), "Not available for sparse histograms" );
          return data_;
       }
 
       /// \brief Returns an iterator to the first bin
       ConstImageIterator< CountType > begin() const {
+         DIP_THROW_IF( IsSparse(), "Not available for sparse histograms" );
          return ConstImageIterator< CountType >( data_ );
       }
 
@@ -405,7 +497,10 @@ class DIP_NO_EXPORT Histogram {
       }
 
       /// \brief Returns a pointer to the first bin
-      CountType const* Origin() const { return static_cast< CountType const* >( data_.Origin() ); }
+      CountType const* Origin() const {
+         DIP_THROW_IF( IsSparse(), "Not available for sparse histograms" );
+         return static_cast< CountType const* >( data_.Origin() );
+      }
 
       /// \brief Returns the total number of elements in the histogram (sum of bins)
       DIP_EXPORT dip::uint Count() const;
@@ -426,6 +521,8 @@ class DIP_NO_EXPORT Histogram {
       /// The marginal histogram represents the marginal intensity distribution. It is a 1D histogram determined
       /// by summing over all dimensions except `dim`, and is equivalent to the histogram for tensor element
       /// `dim`.
+      ///
+      /// The marginal histogram of a sparse histogram is dense.
       DIP_EXPORT Histogram GetMarginal( dip::uint dim ) const;
 
       /// \brief Smooths the histogram, using Gaussian smoothing with parameters `sigma`.
@@ -441,13 +538,22 @@ class DIP_NO_EXPORT Histogram {
       }
 
    private:
-      Image data_;             // This is where the bins are stored. Always scalar and DT_UINT32.
+      Image data_;             // This is where the bins are stored. Always scalar and DT_UINT32. Not forged if sparse.
+      std::shared_ptr< SparseBins > sparse_; // Non-empty bins if the histogram is sparse, nullptr otherwise.
       FloatArray lowerBounds_; // These are the lower bounds of the histogram along each dimension.
       FloatArray binSizes_;    // These are the sizes of the bins along each dimension.
+      BooleanArray excludeOutOfBoundValues_; // Whether out-of-bounds values are excluded along each dimension.
       // Compute the upper bound by : lowerBounds_[ii] + binSizes_[ii]*data_.Sizes(ii).
       // data_.Dimensionality() == lowerBounds_.size() == binSizes_.size()
       // Lower and upper bounds are not bin centers!
 
+      CountType SparseAt( dip::uint index ) const {
+         auto it = sparse_->find( index );
+         return it == sparse_->end() ? 0 : it->second;
+      }
+
+      void SetBins( UnsignedArray const& sizes, bool sparse );
+
       dip::uint FindClampedBin( dfloat value, dip::uint dim ) const {
          return static_cast< dip::uint >( detail::FindBin( value, lowerBounds_[ dim ], binSizes_[ dim ], data_.Size( dim )));
       }
@@ -457,6 +563,9 @@ class DIP_NO_EXPORT Histogram {
       DIP_EXPORT void JointImageHistogram( Image const& input1, Image const& input2, Image const& mask, ConfigurationArray& configuration );
       DIP_EXPORT void MeasurementFeatureHistogram( Measurement::IteratorFeature const& featureValues, ConfigurationArray& configuration );
       DIP_EXPORT void EmptyHistogram( ConfigurationArray configuration );
+      DIP_EXPORT ConfigurationArray GetConfiguration() const;
+      DIP_EXPORT void ImageHistogram( Image const& input, Image const& mask, ConfigurationArray const& configuration );
+      DIP_EXPORT void ImageHistogram( Image const& input1, Image const& input2, Image const& mask, ConfigurationArray const& configuration );
 };
 
 //
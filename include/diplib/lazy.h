@@ -0,0 +1,392 @@
+/*
+ * DIPlib 3.0
+ * This file contains the lazy evaluation of image arithmetic expressions.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_LAZY_H
+#define DIP_LAZY_H
+
+#include <array>
+#include <cmath>
+
+#include "diplib.h"
+#include "diplib/framework.h"
+
+
+/// \file
+/// \brief Declares an opt-in layer for lazy evaluation of image arithmetic.
+/// \see math_arithmetic
+
+
+namespace dip {
+
+
+/// \addtogroup math_arithmetic
+/// \{
+
+/// \brief Lazily evaluated image arithmetic.
+///
+/// The arithmetic operators in `diplib/library/operators.h` are eager: `a * b + c * d - e` creates three temporary
+/// images and makes five passes over the image data. Wrapping an image in `dip::Lazy` turns the
+/// operators into constructors of an expression tree, which is encoded in the type of the expression object.
+/// The expression is evaluated when it is converted to a `dip::Image`, in a single pass over the image data,
+/// without creating any temporary images:
+///
+/// ```cpp
+///     dip::Image out = dip::Lazy( a ) * b + c * d - e;
+/// ```
+///
+/// In the example above, the expression is built because the first operand is a lazy expression. `c * d` is
+/// evaluated eagerly, as the usual operator is called for two images. To make the whole expression lazy, write
+/// `dip::Lazy( a ) * b + dip::Lazy( c ) * d - e`.
+///
+/// Supported are the arithmetic operators `+`, `-`, `*` and `/`, the comparison operators `==`, `!=`, `<`, `>`,
+/// `<=` and `>=`, and the functions `dip::lazy::Abs`, `dip::lazy::Square`, `dip::lazy::Sqrt`, `dip::lazy::Exp`,
+/// `dip::lazy::Ln`, `dip::lazy::Sin` and `dip::lazy::Cos`. These functions are found through argument-dependent
+/// lookup when called unqualified with an expression as argument; calling `dip::Abs` instead evaluates the
+/// expression and applies the eager function to the result. An operand can be an expression, an image
+/// or a scalar value, as long as one of the two operands is an expression. Any other use of the expression,
+/// such as passing it to a function that takes a `dip::Image`, causes it to be evaluated.
+///
+/// The output data type is the same as the eager operators would produce. However, all computations are done
+/// in double precision and the result is only converted to the output data type at the end. Thus, the result can
+/// differ from that of the eager operators in rounding. Binary images are combined with logical operations, as in
+/// the eager operators. Multiplication is always sample-wise (see `dip::MultiplySampleWise`), the matrix
+/// multiplication is not supported. Complex images are not supported.
+///
+/// Singleton expansion is applied as usual. Tensor images are supported if all of them have the same number
+/// of tensor elements; scalar images are expanded to match the tensor images.
+///
+/// The expression stores a copy of each image operand that shares the image data, so it can be stored in
+/// a variable and evaluated later. To write the result into an existing image (for example one that is protected,
+/// see \ref protect), use `dip::lazy::Expression::Evaluate`.
+namespace lazy {
+
+namespace detail {
+
+struct ExpressionBase {};
+
+template< typename T >
+using IsExpression = std::is_base_of< ExpressionBase, std::remove_cv_t< std::remove_reference_t< T >>>;
+
+template< typename T >
+using IsScalar = std::is_arithmetic< std::remove_cv_t< std::remove_reference_t< T >>>;
+
+} // namespace detail
+
+/// \brief Base class for all lazy expression nodes, using the curiously recurring template pattern.
+///
+/// A derived class must have a `static constexpr dip::uint nImages`, the number of image operands
+/// in the expression, and `static constexpr dip::uint nOperations`, the number of operations applied per sample;
+/// and the following member functions:
+///
+/// ```cpp
+///     template< dip::uint I, std::size_t N >
+///     dfloat Compute( std::array< dfloat const*, N > const& in ) const; // computes the value for one sample
+///     void CollectImages( ImageConstRefArray& images ) const;           // appends the image operands to `images`
+///     dip::DataType DataType() const;                                   // the data type of the result
+/// ```
+///
+/// `I` is the index into `in` of the first image operand of the expression.
+template< typename Derived >
+class Expression : public detail::ExpressionBase {
+   public:
+      /// \brief Evaluates the expression, writing the result to `out`.
+      void Evaluate( Image& out ) const {
+         Derived const& expression = static_cast< Derived const& >( *this );
+         ImageConstRefArray in;
+         in.reserve( Derived::nImages );
+         expression.CollectImages( in );
+         DIP_ASSERT( in.size() == Derived::nImages );
+         Tensor outTensor;
+         for( auto const& img : in ) {
+            if( !img.get().IsScalar() ) {
+               if( outTensor.IsScalar() ) {
+                  outTensor = img.get().Tensor();
+               } else if( outTensor.Elements() != img.get().TensorElements() ) {
+                  DIP_THROW( E::NTENSORELEM_DONT_MATCH );
+               }
+            }
+         }
+         auto func = [ &expression ]( std::array< dfloat const*, Derived::nImages > const& its ) {
+            return expression.template Compute< 0 >( its );
+         };
+         Framework::VariadicScanLineFilter< Derived::nImages, dfloat, decltype( func ) > lineFilter( func, Derived::nOperations );
+         ImageRefArray outar{ out };
+         DataTypeArray inBufT( Derived::nImages, DT_DFLOAT );
+         DataTypeArray outBufT{ DT_DFLOAT };
+         DataTypeArray outImT{ expression.DataType() };
+         UnsignedArray nElem{ outTensor.Elements() };
+         DIP_STACK_TRACE_THIS( Framework::Scan( in, outar, inBufT, outBufT, outImT, nElem, lineFilter,
+                                                Framework::ScanOption::TensorAsSpatialDim ));
+         out.ReshapeTensor( outTensor );
+      }
+
+      /// \brief Evaluates the expression.
+      operator Image() const {
+         Image out;
+         Evaluate( out );
+         return out;
+      }
+};
+
+/// \brief An image operand in a lazy expression. Create it with `dip::Lazy`.
+class ImageOperand : public Expression< ImageOperand > {
+   public:
+      static constexpr dip::uint nImages = 1;
+      static constexpr dip::uint nOperations = 0;
+
+      explicit ImageOperand( Image const& image ) : image_( image.QuickCopy() ) {
+         DIP_THROW_IF( !image_.IsForged(), E::IMAGE_NOT_FORGED );
+         DIP_THROW_IF( image_.DataType().IsComplex(), E::DATA_TYPE_NOT_SUPPORTED );
+      }
+
+      template< dip::uint I, std::size_t N >
+      dfloat Compute( std::array< dfloat const*, N > const& in ) const {
+         return *in[ I ];
+      }
+      void CollectImages( ImageConstRefArray& images ) const {
+         images.emplace_back( image_ );
+      }
+      dip::DataType DataType() const {
+         return image_.DataType();
+      }
+
+   private:
+      Image image_;
+};
+
+/// \brief A scalar operand in a lazy expression.
+class ScalarOperand : public Expression< ScalarOperand > {
+   public:
+      static constexpr dip::uint nImages = 0;
+      static constexpr dip::uint nOperations = 0;
+
+      template< typename T, typename = std::enable_if_t< detail::IsScalar< T >::value >>
+      explicit ScalarOperand( T value ) : value_( static_cast< dfloat >( value )), dataType_( Image::Sample( value ).DataType() ) {}
+
+      template< dip::uint I, std::size_t N >
+      dfloat Compute( std::array< dfloat const*, N > const& ) const {
+         return value_;
+      }
+      void CollectImages( ImageConstRefArray& ) const {}
+      dip::DataType DataType() const {
+         return dataType_;
+      }
+
+   private:
+      dfloat value_;
+      dip::DataType dataType_;
+};
+
+/// \brief A node in a lazy expression that applies a dyadic operator `Op` to two sub-expressions.
+template< typename Op, typename L, typename R >
+class DyadicExpression : public Expression< DyadicExpression< Op, L, R >> {
+   public:
+      static constexpr dip::uint nImages = L::nImages + R::nImages;
+      static constexpr dip::uint nOperations = L::nOperations + R::nOperations + Op::cost;
+
+      DyadicExpression( L lhs, R rhs ) : lhs_( std::move( lhs )), rhs_( std::move( rhs )) {
+         dataType_ = Op::DataType( lhs_.DataType(), rhs_.DataType() );
+         binary_ = dataType_.IsBinary();
+      }
+
+      template< dip::uint I, std::size_t N >
+      dfloat Compute( std::array< dfloat const*, N > const& in ) const {
+         return Op::Compute( lhs_.template Compute< I >( in ), rhs_.template Compute< I + L::nImages >( in ), binary_ );
+      }
+      void CollectImages( ImageConstRefArray& images ) const {
+         lhs_.CollectImages( images );
+         rhs_.CollectImages( images );
+      }
+      dip::DataType DataType() const {
+         return dataType_;
+      }
+
+   private:
+      L lhs_;
+      R rhs_;
+      dip::DataType dataType_;
+      bool binary_;
+};
+
+/// \brief A node in a lazy expression that applies a monadic operator `Op` to a sub-expression.
+template< typename Op, typename A >
+class MonadicExpression : public Expression< MonadicExpression< Op, A >> {
+   public:
+      static constexpr dip::uint nImages = A::nImages;
+      static constexpr dip::uint nOperations = A::nOperations + Op::cost;
+
+      explicit MonadicExpression( A arg ) : arg_( std::move( arg )) {
+         DIP_THROW_IF( arg_.DataType().IsBinary(), E::DATA_TYPE_NOT_SUPPORTED );
+         dataType_ = Op::DataType( arg_.DataType() );
+      }
+
+      template< dip::uint I, std::size_t N >
+      dfloat Compute( std::array< dfloat const*, N > const& in ) const {
+         return Op::Compute( arg_.template Compute< I >( in ));
+      }
+      void CollectImages( ImageConstRefArray& images ) const {
+         arg_.CollectImages( images );
+      }
+      dip::DataType DataType() const {
+         return dataType_;
+      }
+
+   private:
+      A arg_;
+      dip::DataType dataType_;
+};
+
+namespace detail {
+
+// Turns an operand into an expression node
+template< typename T, typename = std::enable_if_t< IsExpression< T >::value >>
+T const& MakeOperand( T const& expression ) { return expression; }
+inline ImageOperand MakeOperand( Image const& image ) { return ImageOperand( image ); }
+template< typename T, typename = std::enable_if_t< IsScalar< T >::value >, typename = void >
+ScalarOperand MakeOperand( T value ) { return ScalarOperand( value ); }
+
+template< typename T >
+using OperandType = std::decay_t< decltype( MakeOperand( std::declval< T const& >() )) >;
+
+// Enabled if one operand is an expression and the other one is an expression, an image or a scalar
+template< typename T1, typename T2 >
+using EnableIfLazyOperands = std::enable_if_t<
+      ( IsExpression< T1 >::value && ( IsExpression< T2 >::value || dip::detail::isImage< T2 >::value || IsScalar< T2 >::value )) ||
+      ( IsExpression< T2 >::value && ( dip::detail::isImage< T1 >::value || IsScalar< T1 >::value )) >;
+
+template< typename Op, typename T1, typename T2 >
+using DyadicResult = DyadicExpression< Op, OperandType< T1 >, OperandType< T2 >>;
+
+template< typename Op, typename T1, typename T2 >
+DyadicResult< Op, T1, T2 > MakeDyadic( T1 const& lhs, T2 const& rhs ) {
+   return DyadicResult< Op, T1, T2 >( MakeOperand( lhs ), MakeOperand( rhs ));
+}
+
+// Operators. Binary samples are 0 or 1, and are combined with logical operations, like the eager operators do.
+
+struct AddOp {
+   static constexpr dip::uint cost = 1;
+   static dip::DataType DataType( dip::DataType lhs, dip::DataType rhs ) { return dip::DataType::SuggestArithmetic( lhs, rhs ); }
+   static dfloat Compute( dfloat lhs, dfloat rhs, bool binary ) {
+      return binary ? static_cast< dfloat >(( lhs != 0 ) || ( rhs != 0 )) : lhs + rhs;
+   }
+};
+struct SubtractOp {
+   static constexpr dip::uint cost = 1;
+   static dip::DataType DataType( dip::DataType lhs, dip::DataType rhs ) { return dip::DataType::SuggestArithmetic( lhs, rhs ); }
+   static dfloat Compute( dfloat lhs, dfloat rhs, bool binary ) {
+      return binary ? static_cast< dfloat >(( lhs != 0 ) && ( rhs == 0 )) : lhs - rhs;
+   }
+};
+struct MultiplyOp {
+   static constexpr dip::uint cost = 1;
+   static dip::DataType DataType( dip::DataType lhs, dip::DataType rhs ) { return dip::DataType::SuggestArithmetic( lhs, rhs ); }
+   static dfloat Compute( dfloat lhs, dfloat rhs, bool binary ) {
+      return binary ? static_cast< dfloat >(( lhs != 0 ) && ( rhs != 0 )) : lhs * rhs;
+   }
+};
+struct DivideOp {
+   static constexpr dip::uint cost = 4;
+   static dip::DataType DataType( dip::DataType lhs, dip::DataType rhs ) { return dip::DataType::SuggestArithmetic( lhs, rhs ); }
+   static dfloat Compute( dfloat lhs, dfloat rhs, bool binary ) {
+      return binary ? static_cast< dfloat >(( lhs != 0 ) || ( rhs == 0 )) : lhs / rhs;
+   }
+};
+
+#define DIP__DEFINE_LAZY_COMPARISON( name_, op_ ) \
+struct name_ { \
+   static constexpr dip::uint cost = 1; \
+   static dip::DataType DataType( dip::DataType, dip::DataType ) { return DT_BIN; } \
+   static dfloat Compute( dfloat lhs, dfloat rhs, bool ) { return static_cast< dfloat >( lhs op_ rhs ); } \
+};
+DIP__DEFINE_LAZY_COMPARISON( EqualOp, == )
+DIP__DEFINE_LAZY_COMPARISON( NotEqualOp, != )
+DIP__DEFINE_LAZY_COMPARISON( LesserOp, < )
+DIP__DEFINE_LAZY_COMPARISON( GreaterOp, > )
+DIP__DEFINE_LAZY_COMPARISON( NotGreaterOp, <= )
+DIP__DEFINE_LAZY_COMPARISON( NotLesserOp, >= )
+#undef DIP__DEFINE_LAZY_COMPARISON
+
+#define DIP__DEFINE_LAZY_MONADIC( name_, dataType_, expression_, cost_ ) \
+struct name_ { \
+   static constexpr dip::uint cost = cost_; \
+   static dip::DataType DataType( dip::DataType type ) { return dataType_; } \
+   static dfloat Compute( dfloat value ) { return expression_; } \
+};
+DIP__DEFINE_LAZY_MONADIC( AbsOp, dip::DataType::SuggestAbs( type ), std::abs( value ), 1 )
+DIP__DEFINE_LAZY_MONADIC( SquareOp, dip::DataType::SuggestFlex( type ), value * value, 1 )
+DIP__DEFINE_LAZY_MONADIC( SqrtOp, dip::DataType::SuggestFlex( type ), std::sqrt( value ), 20 )
+DIP__DEFINE_LAZY_MONADIC( ExpOp, dip::DataType::SuggestFlex( type ), std::exp( value ), 20 )
+DIP__DEFINE_LAZY_MONADIC( LnOp, dip::DataType::SuggestFlex( type ), std::log( value ), 20 )
+DIP__DEFINE_LAZY_MONADIC( SinOp, dip::DataType::SuggestFlex( type ), std::sin( value ), 20 )
+DIP__DEFINE_LAZY_MONADIC( CosOp, dip::DataType::SuggestFlex( type ), std::cos( value ), 20 )
+#undef DIP__DEFINE_LAZY_MONADIC
+
+} // namespace detail
+
+#define DIP__DEFINE_LAZY_OPERATOR( operator_, op_ ) \
+template< typename T1, typename T2, typename = detail::EnableIfLazyOperands< T1, T2 >> \
+detail::DyadicResult< detail::op_, T1, T2 > operator_( T1 const& lhs, T2 const& rhs ) { \
+   return detail::MakeDyadic< detail::op_ >( lhs, rhs ); \
+}
+DIP__DEFINE_LAZY_OPERATOR( operator+, AddOp )
+DIP__DEFINE_LAZY_OPERATOR( operator-, SubtractOp )
+DIP__DEFINE_LAZY_OPERATOR( operator*, MultiplyOp )
+DIP__DEFINE_LAZY_OPERATOR( operator/, DivideOp )
+DIP__DEFINE_LAZY_OPERATOR( operator==, EqualOp )
+DIP__DEFINE_LAZY_OPERATOR( operator!=, NotEqualOp )
+DIP__DEFINE_LAZY_OPERATOR( operator<, LesserOp )
+DIP__DEFINE_LAZY_OPERATOR( operator>, GreaterOp )
+DIP__DEFINE_LAZY_OPERATOR( operator<=, NotGreaterOp )
+DIP__DEFINE_LAZY_OPERATOR( operator>=, NotLesserOp )
+#undef DIP__DEFINE_LAZY_OPERATOR
+
+#define DIP__DEFINE_LAZY_FUNCTION( name_, op_ ) \
+template< typename T, typename = std::enable_if_t< detail::IsExpression< T >::value >> \
+MonadicExpression< detail::op_, T > name_( T const& arg ) { \
+   return MonadicExpression< detail::op_, T >( arg ); \
+}
+/// \brief Lazy version of `dip::Abs`.
+DIP__DEFINE_LAZY_FUNCTION( Abs, AbsOp )
+/// \brief Lazy version of `dip::Square`.
+DIP__DEFINE_LAZY_FUNCTION( Square, SquareOp )
+/// \brief Lazy version of `dip::Sqrt`.
+DIP__DEFINE_LAZY_FUNCTION( Sqrt, SqrtOp )
+/// \brief Lazy version of `dip::Exp`.
+DIP__DEFINE_LAZY_FUNCTION( Exp, ExpOp )
+/// \brief Lazy version of `dip::Ln`.
+DIP__DEFINE_LAZY_FUNCTION( Ln, LnOp )
+/// \brief Lazy version of `dip::Sin`.
+DIP__DEFINE_LAZY_FUNCTION( Sin, SinOp )
+/// \brief Lazy version of `dip::Cos`.
+DIP__DEFINE_LAZY_FUNCTION( Cos, CosOp )
+#undef DIP__DEFINE_LAZY_FUNCTION
+
+} // namespace lazy
+
+/// \brief Wraps `image` into a lazy expression, see `dip::lazy`.
+inline lazy::ImageOperand Lazy( Image const& image ) {
+   return lazy::ImageOperand( image );
+}
+
+/// \}
+
+} // namespace dip
+
+#endif // DIP_LAZY_H
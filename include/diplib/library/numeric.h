@@ -313,6 +313,57 @@ inline void SymmetricEigenDecompositionPacked(
    SymmetricEigenDecomposition( n, matrix.data(), lambdas, vectors );
 }
 
+/// \brief Finds the eigenvalues and eigenvectors of a symmetric real 2x2 matrix, using a closed-form solution.
+///
+/// `input` is a pointer to the 3 unique values of the matrix, stored in the same order as symmetric tensors are
+/// stored in an image (xx, yy, xy), as in `dip::SymmetricEigenDecompositionPacked`.
+///
+/// `lambdas` and `vectors` are as in `dip::SymmetricEigenDecomposition`. Eigenvalues are sorted largest to
+/// smallest; the second eigenvector is the first one rotated by 90 degrees.
+///
+/// This function is much faster than `dip::SymmetricEigenDecompositionPacked`. The computation is always done
+/// in double precision, there is an overload for single-precision input and output.
+DIP_EXPORT void SymmetricEigenDecomposition2(
+      ConstSampleIterator< dfloat > input,
+      SampleIterator< dfloat > lambdas,
+      SampleIterator< dfloat > vectors = nullptr
+);
+DIP_EXPORT void SymmetricEigenDecomposition2(
+      ConstSampleIterator< sfloat > input,
+      SampleIterator< sfloat > lambdas,
+      SampleIterator< sfloat > vectors = nullptr
+);
+
+/// \brief Finds the eigenvalues and eigenvectors of a symmetric real 3x3 matrix, using a closed-form solution.
+///
+/// `input` is a pointer to the 6 unique values of the matrix, stored in the same order as symmetric tensors are
+/// stored in an image (xx, yy, zz, xy, xz, yz), as in `dip::SymmetricEigenDecompositionPacked`.
+///
+/// `lambdas` and `vectors` are as in `dip::SymmetricEigenDecomposition`. Eigenvalues are sorted largest to
+/// smallest, and the eigenvectors form a right-handed coordinate system.
+///
+/// The eigenvalues are the roots of the characteristic polynomial, computed with the trigonometric method.
+/// The eigenvector for the eigenvalue that is best separated from the others is computed first, the other two
+/// eigenvectors are then computed in the plane orthogonal to it. This guarantees orthogonal eigenvectors also when
+/// two eigenvalues are (nearly) equal.
+///
+/// This function is much faster than `dip::SymmetricEigenDecompositionPacked`. The computation is always done
+/// in double precision, there is an overload for single-precision input and output.
+///
+/// **Literature**
+/// - O.K. Smith, "Eigenvalues of a symmetric 3x3 matrix", Communications of the ACM 4(4):168, 1961.
+/// - D. Eberly, "A robust eigensolver for 3x3 symmetric matrices", Geometric Tools, 2014.
+DIP_EXPORT void SymmetricEigenDecomposition3(
+      ConstSampleIterator< dfloat > input,
+      SampleIterator< dfloat > lambdas,
+      SampleIterator< dfloat > vectors = nullptr
+);
+DIP_EXPORT void SymmetricEigenDecomposition3(
+      ConstSampleIterator< sfloat > input,
+      SampleIterator< sfloat > lambdas,
+      SampleIterator< sfloat > vectors = nullptr
+);
+
 /// \brief Finds the eigenvalues and eigenvectors of a square real matrix.
 ///
 /// `input` is a pointer to `n*n` values, in column-major order.
@@ -38,6 +38,12 @@
 
 namespace dip {
 
+namespace lazy {
+namespace detail {
+struct ExpressionBase; // Defined in diplib/lazy.h
+}
+}
+
 namespace detail {
 
 template< typename T, typename U >
@@ -49,14 +55,22 @@ using isImage = isa< T, Image >;
 template< typename T >
 using isView = isa< T, Image::View >;
 
+template< typename T >
+using isLazy = std::is_base_of< lazy::detail::ExpressionBase, std::remove_cv_t< std::remove_reference_t< T >>>;
+
 }
 
 template< typename T >
 using EnableIfNotImageOrView = std::enable_if_t< !detail::isImage< T >::value && !detail::isView< T >::value >;
 
 template< typename T1, typename T2 >
-using EnableIfOneIsImageOrView = std::enable_if_t< ( detail::isImage< T1 >::value || detail::isView< T1 >::value ) ||
-                                                   ( detail::isImage< T2 >::value || detail::isView< T2 >::value ) >;
+using EnableIfOneIsImageOrView = std::enable_if_t<(( detail::isImage< T1 >::value || detail::isView< T1 >::value ) ||
+                                                   ( detail::isImage< T2 >::value || detail::isView< T2 >::value )) &&
+                                                  !detail::isLazy< T1 >::value && !detail::isLazy< T2 >::value >;
+
+// Lazy expressions (see diplib/lazy.h) define their own operators
+template< typename T >
+using EnableIfNotLazy = std::enable_if_t< !detail::isLazy< T >::value >;
 
 #define DIP__DEFINE_ARITHMETIC_OVERLOADS( name ) \
 DIP_EXPORT void  name( Image const& lhs, Image const& rhs, Image& out, DataType dt ); \
@@ -603,37 +617,37 @@ DIP__DEFINE_TRIADIC_OVERLOADS( OutOfRange )
 //
 
 /// \brief Comparison operator, calls `dip::Equal`.
-template< typename T >
+template< typename T, typename = EnableIfNotLazy< T >>
 inline Image operator==( Image const& lhs, T const& rhs ) {
    return Equal( lhs, rhs );
 }
 
 /// \brief Comparison operator, calls `dip::NotEqual`.
-template< typename T >
+template< typename T, typename = EnableIfNotLazy< T >>
 inline Image operator!=( Image const& lhs, T const& rhs ) {
    return NotEqual( lhs, rhs );
 }
 
 /// \brief Comparison operator, calls `dip::Lesser`.
-template< typename T >
+template< typename T, typename = EnableIfNotLazy< T >>
 inline Image operator<( Image const& lhs, T const& rhs ) {
    return Lesser( lhs, rhs );
 }
 
 /// \brief Comparison operator, calls `dip::Greater`.
-template< typename T >
+template< typename T, typename = EnableIfNotLazy< T >>
 inline Image operator>( Image const& lhs, T const& rhs ) {
    return Greater( lhs, rhs );
 }
 
 /// \brief Comparison operator, calls `dip::NotGreater`.
-template< typename T >
+template< typename T, typename = EnableIfNotLazy< T >>
 inline Image operator<=( Image const& lhs, T const& rhs ) {
    return NotGreater( lhs, rhs );
 }
 
 /// \brief Comparison operator, calls `dip::NotLesser`.
-template< typename T >
+template< typename T, typename = EnableIfNotLazy< T >>
 inline Image operator>=( Image const& lhs, T const& rhs ) {
    return NotLesser( lhs, rhs );
 }
@@ -133,6 +133,8 @@ constexpr char const* FOURIER = "fourier";
 constexpr char const* SPATIAL = "spatial";
 constexpr char const* FREQUENCY = "frequency";
 constexpr char const* BEST = "best";
+constexpr char const* DIRECT = "direct";
+constexpr char const* SEPARABLE = "separable";
 constexpr char const* EVEN = "even";
 constexpr char const* ODD = "odd";
 constexpr char const* NORMALIZE = "normalize";
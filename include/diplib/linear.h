@@ -89,6 +89,26 @@ using OneDimensionalFilterArray = std::vector< OneDimensionalFilter >;
 /// empty (it's `empty` method returns true, and it's `size` method return 0).
 DIP_EXPORT OneDimensionalFilterArray SeparateFilter( Image const& filter );
 
+/// \brief Approximates a linear filter (convolution kernel) by a sum of separable filters.
+///
+/// The kernel is decomposed using the singular value decomposition, and only the terms with the largest singular
+/// values are kept. The number of terms is the smallest one for which the Frobenius norm of the error, relative to
+/// that of `filter`, is not larger than `tolerance`. Each element of the output array is a set of 1D filters that
+/// can be applied using `dip::SeparableConvolution`; the sum of their results approximates the convolution with
+/// `filter`.
+///
+/// If `filter` is separable, the output has a single element, equal to the output of `dip::SeparateFilter`.
+/// Otherwise, a decomposition is only possible if `filter` has at most two dimensions with a size larger than 1.
+/// The output is empty if the decomposition is not possible, or if more than `maxTerms` terms would be needed
+/// (when `maxTerms` is larger than 0).
+///
+/// \see dip::SeparateFilter, dip::Convolution
+DIP_EXPORT std::vector< OneDimensionalFilterArray > SeparateFilterLowRank(
+      Image const& filter,
+      dfloat tolerance = 1e-7,
+      dip::uint maxTerms = 0
+);
+
 /// \brief Applies a convolution with a filter kernel (PSF) that is separable.
 ///
 /// `filter` is an array with exactly one element for each dimension of `in`. Alternatively, it can have a single
@@ -163,7 +183,8 @@ inline Image ConvolveFT(
 /// `dip::ConvolveFT` with larger filters to compute the convolution in the Fourier domain.
 ///
 /// Also, if all non-zero filter weights have the same value, `dip::Uniform` implements a more efficient
-/// algorithm. If `filter` is a binary image, `dip::Uniform` is called.
+/// algorithm. If `filter` is a binary image, `dip::Uniform` is called. `dip::Convolution` selects between
+/// these algorithms automatically.
 ///
 /// `boundaryCondition` indicates how the boundary should be expanded in each dimension. See `dip::BoundaryCondition`.
 ///
@@ -184,6 +205,48 @@ inline Image GeneralConvolution(
    return out;
 }
 
+/// \brief Applies a convolution with a filter kernel (PSF), selecting the most efficient algorithm.
+///
+/// `filter` is an image, and must be equal in size or smaller than `in`. `filter` must be real-valued.
+///
+/// `method` selects the algorithm:
+///
+/// - `"separable"`: the kernel is decomposed into a sum of separable terms with `dip::SeparateFilterLowRank`,
+///   using `tolerance`, and each term is applied with `dip::SeparableConvolution`. Throws if `filter` cannot be
+///   decomposed.
+/// - `"direct"`: `dip::GeneralConvolution` is called.
+/// - `"fourier"`: `dip::ConvolveFT` is called. `boundaryCondition` is ignored, the image is considered periodic.
+/// - `"best"`: the method with the lowest estimated cost is chosen. The cost of the separable method is
+///   proportional to the number of terms times the sum of the 1D filter sizes, that of the direct method to
+///   the number of non-zero filter weights, and that of the Fourier method to the logarithm of the number of
+///   pixels in `in`. Note that the Fourier method uses periodic boundary conditions, it is only picked for large
+///   kernels that cannot be approximated by few separable terms.
+///
+/// If `filter` is a binary image, `dip::Uniform` is called.
+///
+/// `boundaryCondition` indicates how the boundary should be expanded in each dimension. See `dip::BoundaryCondition`.
+///
+/// \see dip::GeneralConvolution, dip::ConvolveFT, dip::SeparableConvolution, dip::SeparateFilterLowRank
+DIP_EXPORT void Convolution(
+      Image const& in,
+      Image const& filter,
+      Image& out,
+      String const& method = S::BEST,
+      StringArray const& boundaryCondition = {},
+      dfloat tolerance = 1e-7
+);
+inline Image Convolution(
+      Image const& in,
+      Image const& filter,
+      String const& method = S::BEST,
+      StringArray const& boundaryCondition = {},
+      dfloat tolerance = 1e-7
+) {
+   Image out;
+   Convolution( in, filter, out, method, boundaryCondition, tolerance );
+   return out;
+}
+
 /// \brief Applies a convolution with a kernel with uniform weights, leading to an average (mean) filter.
 ///
 /// The size and shape of the kernel is given by `kernel`, which you can define through a default
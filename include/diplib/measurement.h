@@ -39,6 +39,7 @@ template< typename T > class DIP_NO_EXPORT LineIterator;
 struct DIP_NO_EXPORT ChainCode;
 struct DIP_NO_EXPORT Polygon;
 class DIP_NO_EXPORT ConvexHull;
+struct DIP_NO_EXPORT SurfaceMesh;
 
 /// \defgroup measurement Measurement
 /// \brief The measurement infrastructure and functionality. It all revolves around the `dip::MeasurementTool` class.
@@ -56,6 +57,7 @@ enum class DIP_NO_EXPORT Type {
       CHAINCODE_BASED, ///< The feature is derived from `dip::Feature::ChainCodeBased`
       POLYGON_BASED, ///< The feature is derived from `dip::Feature::PolygonBased`
       CONVEXHULL_BASED, ///< The feature is derived from `dip::Feature::ConvexHullBased`
+      MESH_BASED, ///< The feature is derived from `dip::Feature::MeshBased`
       COMPOSITE ///< The feature is derived from `dip::Feature::Composite`
 };
 
@@ -716,6 +718,8 @@ class DIP_CLASS_EXPORT ChainCodeBased : public Base {
       explicit ChainCodeBased( Information const& information ) : Base( information, Type::CHAINCODE_BASED ) {};
 
       /// \brief Called once for each object
+      ///
+      /// This function is called in parallel for different objects, and hence must be thread-safe.
       virtual void Measure( ChainCode const& chainCode, Measurement::ValueIterator output ) = 0;
 };
 
@@ -725,6 +729,8 @@ class DIP_CLASS_EXPORT PolygonBased : public Base {
       explicit PolygonBased( Information const& information ) : Base( information, Type::POLYGON_BASED ) {};
 
       /// \brief Called once for each object
+      ///
+      /// This function is called in parallel for different objects, and hence must be thread-safe.
       virtual void Measure( Polygon const& polygon, Measurement::ValueIterator output ) = 0;
 };
 
@@ -734,9 +740,22 @@ class DIP_CLASS_EXPORT ConvexHullBased : public Base {
       explicit ConvexHullBased( Information const& information ) : Base( information, Type::CONVEXHULL_BASED ) {};
 
       /// \brief Called once for each object
+      ///
+      /// This function is called in parallel for different objects, and hence must be thread-safe.
       virtual void Measure( ConvexHull const& convexHull, Measurement::ValueIterator output ) = 0;
 };
 
+/// \brief The pure virtual base class for all surface-mesh--based measurement features.
+class DIP_CLASS_EXPORT MeshBased : public Base {
+   public:
+      explicit MeshBased( Information const& information ) : Base( information, Type::MESH_BASED ) {};
+
+      /// \brief Called once for each object, with the mesh produced by `dip::GetImageSurfaceMeshes`
+      ///
+      /// This function is called in parallel for different objects, and hence must be thread-safe.
+      virtual void Measure( SurfaceMesh const& mesh, Measurement::ValueIterator output ) = 0;
+};
+
 /// \brief The pure virtual base class for all composite measurement features.
 class DIP_CLASS_EXPORT Composite : public Base {
    public:
@@ -794,6 +813,12 @@ class DIP_CLASS_EXPORT Composite : public Base {
 /// <tr><td> "SolidArea"               <td> Area of object with any holes filled <td> 2D (CC)
 /// <tr><td> "ConvexArea"              <td> Area of the convex hull <td> 2D (CC)
 /// <tr><td> "ConvexPerimeter"         <td> Perimeter of the convex hull <td> 2D (CC)
+/// <tr><td> "MinAreaRectangle"        <td> Minimum area bounding rectangle <td> 2D (CC)
+/// <tr><td> "MinPerimeterRectangle"   <td> Minimum perimeter bounding rectangle <td> 2D (CC)
+/// <tr><td> "EnclosingCircle"         <td> Diameter of the minimum enclosing circle <td> 2D (CC)
+/// <tr><td> "MeshSurfaceArea"         <td> Area of the surface mesh of the object <td> 3D (SM)
+/// <tr><td> "ConvexVolume"            <td> Volume of the convex hull <td> 3D (SM)
+/// <tr><td> "Feret3D"                 <td> Maximum and minimum object diameters <td> 3D (SM)
 /// <tr><td colspan="3"> **Shape features**
 /// <tr><td> "AspectRatioFeret"        <td> Feret-based aspect ratio <td> 2D (CC)
 /// <tr><td> "Radius"                  <td> Statistics on radius of object <td> 2D (CC)
@@ -806,6 +831,7 @@ class DIP_CLASS_EXPORT Composite : public Base {
 /// <tr><td> "EllipseVariance"         <td> Distance to best fit ellipse <td> 2D (CC)
 /// <tr><td> "Eccentricity"            <td> Aspect ratio of best fit ellipse <td> 2D (CC)
 /// <tr><td> "BendingEnergy"           <td> Bending energy of object perimeter <td> 2D (CC)
+/// <tr><td> "Sphericity"              <td> Sphericity of the object <td> 3D (SM)
 /// <tr><td colspan="3"> **Intensity features**
 /// <tr><td> "Mass"                    <td> Mass of object (sum of object intensity) <td> Tensor grey
 /// <tr><td> "Mean"                    <td> Mean object intensity <td> Tensor grey
@@ -838,6 +864,11 @@ class DIP_CLASS_EXPORT Composite : public Base {
 /// That is, the object must be a single connected component. In case of the perimeter, only the external perimeter
 /// is measured, the boundaries of holes in the object are ignored.
 ///
+/// Similarly, some features are specific for 3D, and include "(SM)" in the limitations column above. "SM" stands for
+/// surface mesh. These features are computed based on the triangulated surface of the object, as extracted by
+/// `dip::GetImageSurfaceMeshes`. All components of the object, and the surfaces of cavities within it, are included
+/// in the mesh.
+///
 /// Features that include "Scalar grey" in the limitations column require a scalar grey-value image to be passed
 /// into the `dip::MeasurementTool::Measure` method together with the label image. "Tensor grey" indicates that
 /// this grey-value image can be multi-valued (i.e. a tensor image); each tensor element will be reported as a
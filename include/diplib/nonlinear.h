@@ -427,8 +427,6 @@ inline Image RobustAnisotropicDiffusion(
 ///   this flag returns the larger image instead of the subsampled one.
 ///
 /// This function can be applied to images with two or more dimensions. `in` must be scalar and real-valued.
-/// The `"first"` flag is only supported for 2D images, if `in` has more dimensions, the `"first"` flag is
-/// isnored and `"all"` is assumed.
 ///
 /// In `"all"` mode, \f$D\f$ is composed from the eigen decoposition of the structure tensor \f$S\f$:
 ///
@@ -438,20 +436,27 @@ inline Image RobustAnisotropicDiffusion(
 ///
 /// \f[ E' = \frac{1}{\mathrm{trace}\,E^{-1}} \, E^{-1} \f]
 ///
-/// In `"first"` mode, \f$D\f$ is composed similarly, but the two eigenvalues of \f$D\f$, \f$d_i\f$, are determined
-/// from the eigenvalues \f$\mu_i\f$ of \f$S\f$ (with \f$\mu_1 \ge \mu_2\f$) as follows:
+/// Where some of the eigenvalues of \f$S\f$ are zero, \f$E'\f$ is taken as the limit: the corresponding
+/// eigenvalues of \f$D\f$ share a value of 1, and the others are 0.
+///
+/// In `"first"` mode, \f$D\f$ is composed similarly, but the eigenvalues of \f$D\f$, \f$d_i\f$, are determined
+/// from the eigenvalues \f$\mu_i\f$ of \f$S\f$ (with \f$\mu_1 \ge \mu_2 \ge \ldots \ge \mu_n\f$) as follows:
 ///
 /// \f{eqnarray*}{
 ///       d_1 &=& \alpha
-///    \\ d_2 &=& \begin{cases}
-///                    \alpha + ( 1.0 - \alpha ) \exp\left(\frac{-c}{(\mu_1 - \mu_2)^2}\right) \, ,
-///                                & \text{if}\ \frac{\mu_1 - \mu_2}{\mu_1 + \mu_2} \gt \alpha \; \text{(high anisotropy)}
+///    \\ d_i &=& \begin{cases}
+///                    \alpha + ( 1.0 - \alpha ) \exp\left(\frac{-c}{(\mu_1 - \mu_i)^2}\right) \, ,
+///                                & \text{if}\ \frac{\mu_1 - \mu_i}{\mu_1 + \mu_i} \gt \alpha \; \text{(high anisotropy)}
 ///                 \\ \alpha \, , & \text{otherwise}
-///               \end{cases}
+///               \end{cases} \quad , \; i = 2, \ldots, n
 /// \f}
 ///
-/// \f$\alpha\f$ is a magic number set to 0.01, and \f$c\f$ is set to the median of all \f$\mu_2^2\f$
-/// values across the image (as proposed by Lucas van Vliet).
+/// \f$\alpha\f$ is a magic number set to 0.01, and \f$c\f$ is set to the median of all \f$\mu_n^2\f$
+/// values across the image (as proposed by Lucas van Vliet). For 2D images this is the method as described by
+/// Weickert; for higher-dimensional images it is a straight-forward generalization.
+///
+/// The diffusion tensor is computed on the fly for each pixel and combined immediately with the image
+/// derivatives, it is never stored in full.
 ///
 /// **Literature**
 /// - J. Weickert, "Anisotropic diffusion in image processing," Teubner (Stuttgart), pages 95 and 127, 1998.
@@ -517,7 +522,17 @@ inline Image CoherenceEnhancingDiffusion(
 ///
 /// Together with `sigmas`, the `orders`, `truncation` and `exponents` parameters define the gaussian kernel.
 /// `interpolationMethod` can be `"linear"` (default) or `"zero order"` (faster).
-/// As of yet, `boundaryCondition` can only be "mirror" or "add zeros".
+///
+/// For 2D images, if `nBins` is larger than zero, the orientation is quantized into `nBins` bins, and
+/// the kernel scale into `nBins` levels (but at most 16) between its minimum and maximum value. The transformed
+/// kernels are computed once for each combination of quantized parameters that occurs in the image, and each pixel
+/// is convolved with the precomputed kernel nearest to its parameters. With `"linear"` interpolation, the
+/// results for the two nearest orientations are blended. This is much faster for large kernels, at the cost
+/// of a small quantization error. `nBins` is ignored for 3D images.
+///
+/// If `nBins` is zero, or the image is 3D, `boundaryCondition` can only be "mirror" or "add zeros". If `nBins` is
+/// larger than zero and the image is 2D, any boundary condition can be used, but pixels near the image edge will
+/// differ slightly from the result with `nBins` equal to zero.
 /// 
 /// **Literature**
 /// - T.Q. Pham, L.J. van Vliet, and K. Schutte. Robust fusion of irregularly sampled data using adaptive normalized convolution.
@@ -533,7 +548,8 @@ DIP_EXPORT void AdaptiveGauss(
       dfloat truncation = 2.0,
       UnsignedArray const& exponents = { 0 },
       String const& interpolationMethod = S::LINEAR,
-      String const& boundaryCondition = S::SYMMETRIC_MIRROR
+      String const& boundaryCondition = S::SYMMETRIC_MIRROR,
+      dip::uint nBins = 0
 );
 inline Image AdaptiveGauss(
       Image const& in,
@@ -543,10 +559,11 @@ inline Image AdaptiveGauss(
       dfloat truncation = 2.0,
       UnsignedArray const& exponents = { 0 },
       String const& interpolationMethod = S::LINEAR,
-      String const& boundaryCondition = S::SYMMETRIC_MIRROR
+      String const& boundaryCondition = S::SYMMETRIC_MIRROR,
+      dip::uint nBins = 0
 ) {
    Image out;
-   AdaptiveGauss( in, params, out, sigmas, orders, truncation, exponents, interpolationMethod, boundaryCondition );
+   AdaptiveGauss( in, params, out, sigmas, orders, truncation, exponents, interpolationMethod, boundaryCondition, nBins );
    return out;
 }
 
@@ -579,7 +596,17 @@ inline Image AdaptiveGauss(
 ///
 /// Together with `sigmas`, the `orders`, `truncation` and `exponents` parameters define the gaussian kernel.
 /// `interpolationMethod` can be `"linear"` (default) or `"zero order"` (faster).
-/// As of yet, `boundaryCondition` can only be "mirror" or "add zeros".
+///
+/// If `nBins` is larger than zero, the orientation is quantized into `nBins` bins, and the curvature and kernel
+/// scale into `nBins` levels (but at most 16) between their minimum and maximum values. The transformed kernels
+/// are computed once for each combination of quantized parameters that occurs in the image, and each pixel
+/// is convolved with the precomputed kernel nearest to its parameters. With `"linear"` interpolation, the
+/// results for the two nearest orientations are blended. This is much faster for large kernels, at the cost
+/// of a small quantization error.
+///
+/// If `nBins` is zero, `boundaryCondition` can only be "mirror" or "add zeros". If `nBins` is larger than zero,
+/// any boundary condition can be used, but pixels near the image edge will differ slightly from the result with
+/// `nBins` equal to zero.
 /// 
 /// **Literature**
 /// - T.Q. Pham, L.J. van Vliet, and K. Schutte. Robust fusion of irregularly sampled data using adaptive normalized convolution.
@@ -595,7 +622,8 @@ DIP_EXPORT void AdaptiveBanana(
    dfloat truncation = 2.0,
    UnsignedArray const& exponents = { 0 },
    String const& interpolationMethod = S::LINEAR,
-   String const& boundaryCondition = S::SYMMETRIC_MIRROR
+   String const& boundaryCondition = S::SYMMETRIC_MIRROR,
+   dip::uint nBins = 0
 );
 inline Image AdaptiveBanana(
       Image const& in,
@@ -605,10 +633,11 @@ inline Image AdaptiveBanana(
       dfloat truncation = 2.0,
       UnsignedArray const& exponents = { 0 },
       String const& interpolationMethod = S::LINEAR,
-      String const& boundaryCondition = S::SYMMETRIC_MIRROR
+      String const& boundaryCondition = S::SYMMETRIC_MIRROR,
+      dip::uint nBins = 0
 ) {
    Image out;
-   AdaptiveBanana( in, params, out, sigmas, orders, truncation, exponents, interpolationMethod, boundaryCondition );
+   AdaptiveBanana( in, params, out, sigmas, orders, truncation, exponents, interpolationMethod, boundaryCondition, nBins );
    return out;
 }
 
@@ -300,6 +300,14 @@ class DIP_NO_EXPORT PixelTable {
             }
          }
          origin_ = origin;
+         if( !weights_.empty() ) {
+            // The pixels within each run are now in reverse order, so their weights must be reversed too
+            auto wit = weights_.begin();
+            for( auto& run : runs_ ) {
+               std::reverse( wit, wit + static_cast< dip::sint >( run.length ));
+               wit += static_cast< dip::sint >( run.length );
+            }
+         }
       }
 
       /// Returns the number of pixels in the neighborhood
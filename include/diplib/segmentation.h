@@ -46,18 +46,30 @@ namespace dip {
 /// region is identified by a different label. Boundaries between regions are the Voronoi tessellation
 /// given the identified cluster centers.
 ///
+/// The cluster centers are initialized with the k-means++ algorithm, using a random subset of the pixels.
+/// If `batchSize` is 0, the cluster centers are then refined iteratively using all pixels, until convergence.
+/// Otherwise, mini-batch k-means is used: each iteration uses only `batchSize` randomly selected pixels.
+/// This is much faster for large images, but the result is an approximation. In either case, the final
+/// assignment of pixels to clusters uses all pixels.
+///
 /// The return `dip::CoordinateArray` contains the cluster centers.
+///
+/// **Literature**
+/// - D. Arthur and S. Vassilvitskii, "k-means++: the advantages of careful seeding", Proceedings of the 18th annual ACM-SIAM symposium on Discrete algorithms, pp. 1027-1035, 2007.
+/// - D. Sculley, "Web-scale k-means clustering", Proceedings of the 19th international conference on World Wide Web, pp. 1177-1178, 2010.
 DIP_EXPORT CoordinateArray KMeansClustering(
       Image const& in,
       Image& out,
-      dip::uint nClusters = 2
+      dip::uint nClusters = 2,
+      dip::uint batchSize = 0
 );
 inline Image KMeansClustering(
       Image const& in,
-      dip::uint nClusters = 2
+      dip::uint nClusters = 2,
+      dip::uint batchSize = 0
 ) {
    Image out;
-   KMeansClustering( in, out, nClusters );
+   KMeansClustering( in, out, nClusters, batchSize );
    return out;
 }
 
@@ -80,6 +80,48 @@ inline Image CumulativeSum( Image const& in, Image const& mask = {}, BooleanArra
    return out;
 }
 
+/// \brief Computes the integral image (summed-area table) of `in`.
+///
+/// Each output pixel is the sum of all input pixels whose coordinates are smaller or equal to its own, along the
+/// dimensions specified by `process` (if `process` is an empty array, all dimensions are processed). This is the
+/// same computation as `dip::CumulativeSum`, but the output is always double precision (`dip::DT_DFLOAT`, or
+/// `dip::DT_DCOMPLEX` for complex input) to avoid overflow and loss of precision: sums of integer-valued images
+/// are exact as long as they do not exceed 2^53^. For tensor images, the output has the same tensor size and shape
+/// as the input.
+///
+/// The sum of the input over any rectangular box can then be obtained by looking up 2^n^ values in the integral
+/// image, where n is the image dimensionality, see `dip::BoxSum`.
+///
+/// \see dip::IntegralSquareImage, dip::BoxSum, dip::CumulativeSum
+DIP_EXPORT void IntegralImage( Image const& in, Image& out, BooleanArray const& process = {} );
+inline Image IntegralImage( Image const& in, BooleanArray const& process = {} ) {
+   Image out;
+   IntegralImage( in, out, process );
+   return out;
+}
+
+/// \brief Computes the integral image (summed-area table) of the square of `in`.
+///
+/// Identical to `dip::IntegralImage`, but sums the squared input values. Together with the integral image
+/// this allows computing the variance within any rectangular box in constant time. `in` must be real-valued.
+/// The output is of type `dip::DT_DFLOAT`.
+///
+/// \see dip::IntegralImage, dip::BoxSum
+DIP_EXPORT void IntegralSquareImage( Image const& in, Image& out, BooleanArray const& process = {} );
+inline Image IntegralSquareImage( Image const& in, BooleanArray const& process = {} ) {
+   Image out;
+   IntegralSquareImage( in, out, process );
+   return out;
+}
+
+/// \brief Computes the sum over a box using an integral image.
+///
+/// `integral` is the output of `dip::IntegralImage` or `dip::IntegralSquareImage` over all dimensions. It must
+/// be scalar and real-valued. The box has its top-left corner at `origin` and has size `sizes`; it must fit
+/// within the image. The result is the sum of the values of the original image within the box, computed from
+/// 2^n^ values of `integral`, independently of the size of the box.
+DIP_EXPORT dfloat BoxSum( Image const& integral, UnsignedArray const& origin, UnsignedArray const& sizes );
+
 /// \brief Finds the largest and smallest value in the image, within an optional mask.
 ///
 /// If `mask` is not forged, all input pixels are considered. In case of a tensor
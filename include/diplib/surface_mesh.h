@@ -0,0 +1,210 @@
+/*
+ * DIPlib 3.0
+ * This file contains declarations and definitions for surface-mesh--based 3D measurements
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_SURFACE_MESH_H
+#define DIP_SURFACE_MESH_H
+
+#include <array>
+
+#include "diplib.h"
+
+/// \file
+/// \brief Support for triangulated surface object representation and quantification. Everything declared in
+/// this file is explicitly 3D.
+/// \see measurement
+
+
+namespace dip {
+
+
+/// \addtogroup measurement
+/// \{
+
+
+/// \brief Encodes a location in a 3D image
+struct DIP_NO_EXPORT Vertex3D {
+   dfloat x = 0.0;   ///< The x-coordinate
+   dfloat y = 0.0;   ///< The y-coordinate
+   dfloat z = 0.0;   ///< The z-coordinate
+
+   /// Default constructor
+   constexpr Vertex3D() = default;
+   /// Constructor
+   constexpr Vertex3D( dfloat x, dfloat y, dfloat z ) : x( x ), y( y ), z( z ) {}
+
+   /// Add a vertex
+   Vertex3D& operator+=( Vertex3D v ) {
+      x += v.x;
+      y += v.y;
+      z += v.z;
+      return *this;
+   }
+   /// Subtract a vertex
+   Vertex3D& operator-=( Vertex3D v ) {
+      x -= v.x;
+      y -= v.y;
+      z -= v.z;
+      return *this;
+   }
+   /// Scale by a constant, isotropically
+   Vertex3D& operator*=( dfloat n ) {
+      x *= n;
+      y *= n;
+      z *= n;
+      return *this;
+   }
+};
+
+/// \brief Compare two vertices
+inline bool operator==( Vertex3D v1, Vertex3D v2 ) {
+   return ( v1.x == v2.x ) && ( v1.y == v2.y ) && ( v1.z == v2.z );
+}
+
+/// \brief Add two vertices together
+inline Vertex3D operator+( Vertex3D lhs, Vertex3D rhs ) {
+   lhs += rhs;
+   return lhs;
+}
+
+/// \brief Subtract two vertices from each other
+inline Vertex3D operator-( Vertex3D lhs, Vertex3D rhs ) {
+   lhs -= rhs;
+   return lhs;
+}
+
+/// \brief Multiply a vertex and a constant
+inline Vertex3D operator*( Vertex3D v, dfloat n ) {
+   v *= n;
+   return v;
+}
+
+/// \brief The dot product of vectors `v1` and `v2`.
+inline dfloat Dot( Vertex3D v1, Vertex3D v2 ) {
+   return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
+
+/// \brief The cross product of vectors `v1` and `v2`.
+inline Vertex3D Cross( Vertex3D v1, Vertex3D v2 ) {
+   return { v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x };
+}
+
+/// \brief The norm of the vector `v`.
+inline dfloat Norm( Vertex3D v ) {
+   return std::sqrt( Dot( v, v ));
+}
+
+/// \brief Contains the %Feret diameters as returned by `dip::SurfaceMesh::Feret`.
+struct DIP_NO_EXPORT Feret3DValues {
+   dfloat maxDiameter = 0.0;        ///< The maximum %Feret diameter
+   dfloat minDiameter = 0.0;        ///< The minimum %Feret diameter (object width)
+};
+
+/// \brief A closed surface composed of triangles, with vertices shared between triangles.
+///
+/// Each triangle is given by the indices of its three vertices, in counter-clockwise order when seen from
+/// the outside of the object (i.e. the right-hand rule yields the outward normal).
+///
+/// Use `dip::GetImageSurfaceMeshes` to extract the surfaces of objects in a 3D labeled image.
+struct DIP_NO_EXPORT SurfaceMesh {
+   using Triangle = std::array< dip::uint, 3 >; ///< Indices of the three vertices of a triangle
+
+   std::vector< Vertex3D > vertices;   ///< The vertices
+   std::vector< Triangle > triangles;  ///< The triangles
+   dip::uint objectID = 0;             ///< The label of the object the mesh was extracted from
+
+   /// Returns true if the mesh has no triangles.
+   bool IsEmpty() const {
+      return triangles.empty();
+   }
+
+   /// Returns the area of the surface
+   DIP_EXPORT dfloat Area() const;
+
+   /// \brief Returns the volume enclosed by the surface
+   ///
+   /// Computed with the divergence theorem, which requires the surface to be closed and the triangles to
+   /// be consistently oriented (as produced by `dip::GetImageSurfaceMeshes` and `ConvexHull`).
+   DIP_EXPORT dfloat Volume() const;
+
+   /// \brief Returns the sphericity of the object, the ratio of the surface area of a sphere with the same
+   /// volume to the surface area of the object.
+   ///
+   /// The sphericity is 1 for a sphere, and smaller for any other shape.
+   dfloat Sphericity() const {
+      dfloat area = Area();
+      if( area == 0.0 ) {
+         return nan;
+      }
+      return std::cbrt( pi * 36.0 * Volume() * Volume() ) / area;
+   }
+
+   /// \brief Returns the convex hull of the vertices, as a new mesh
+   ///
+   /// Uses the Quickhull algorithm. Only vertices that are on the hull are copied to the output mesh.
+   /// Points within a distance of 10<sup>-10</sup> times the object size of a hull face are considered to be
+   /// on that face. If all vertices are coplanar, the output is empty.
+   DIP_EXPORT SurfaceMesh ConvexHull() const;
+
+   /// \brief Returns the %Feret diameters of the mesh
+   ///
+   /// The diameters are computed on the convex hull. The maximum diameter is the largest distance between
+   /// two hull vertices. The minimum diameter is the smallest distance between a hull face and the vertex
+   /// farthest from it. Because the directions perpendicular to two hull edges are not examined, the minimum
+   /// diameter can be slightly overestimated.
+   ///
+   /// To find the maximum diameter, the hull vertices are binned in a coarse grid, and only pairs of cells that
+   /// can be farther apart than the largest distance found so far are compared vertex by vertex. This is exact,
+   /// and for a ball with a radius of 100 pixels (about 18,000 hull vertices) takes a fraction of the time needed
+   /// to compute the convex hull. The worst case is still quadratic in the number of hull vertices. The minimum
+   /// diameter is linear in the number of hull faces.
+   DIP_EXPORT Feret3DValues Feret() const;
+};
+
+/// \brief A collection of object surfaces
+using SurfaceMeshArray = std::vector< SurfaceMesh >;
+
+/// \brief Returns the surfaces of the given objects in a 3D labeled image, as triangle meshes.
+///
+/// The surface of each object is extracted with the marching tetrahedra algorithm, where each cube
+/// formed by 8 neighboring pixels is split into 6 tetrahedra that share the cube's main diagonal. A vertex
+/// is placed on each edge between an object pixel and a background pixel (pixels outside the image are
+/// background). The resulting meshes are closed, consistently oriented, and free of the ambiguities of the
+/// marching cubes algorithm. A cavity inside an object yields an additional surface, oriented such that its
+/// volume is subtracted.
+///
+/// To reduce the staircase effect of the binary surface, which causes the area to be overestimated by
+/// about 25%, the vertices are not placed halfway along the edges, but where a slightly smoothed version
+/// of the object crosses 0.5. The smoothing uses a [1,2,1]/4 kernel along each dimension. Vertices of
+/// planar, axis-aligned surfaces remain halfway between pixels. Coordinates are in pixels, the pixel size
+/// is ignored.
+///
+/// Objects are processed in parallel.
+///
+/// `objectIDs` is a list with object IDs present in the labeled image. If an empty array is given, all objects in
+/// the image are used. The output array has the meshes in the same order as the object IDs.
+SurfaceMeshArray DIP_EXPORT GetImageSurfaceMeshes(
+      Image const& labels,                   ///< Labeled image, unsigned integer type
+      UnsignedArray const& objectIDs = {}    ///< A list of object IDs to get surface meshes for
+);
+
+/// \}
+
+} // namespace dip
+
+#endif // DIP_SURFACE_MESH_H
@@ -86,8 +86,8 @@ void init_analysis( py::module& m ) {
           "label"_a, "grey"_a, "mask"_a = dip::Image{}, "metric"_a = dip::Metric{ dip::S::CHAMFER, 2 } );
 
    // diplib/segmentation.h
-   m.def( "KMeansClustering", py::overload_cast< dip::Image const&, dip::uint >( &dip::KMeansClustering ),
-          "in"_a, "nClusters"_a = 2 );
+   m.def( "KMeansClustering", py::overload_cast< dip::Image const&, dip::uint, dip::uint >( &dip::KMeansClustering ),
+          "in"_a, "nClusters"_a = 2, "batchSize"_a = 0 );
    m.def( "IsodataThreshold", py::overload_cast< dip::Image const&, dip::Image const&, dip::uint >( &dip::IsodataThreshold ),
           "in"_a, "mask"_a = dip::Image{}, "nThresholds"_a = 1 );
    m.def( "OtsuThreshold", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::OtsuThreshold ),
@@ -103,6 +103,7 @@ void init_assorted( py::module& m ) {
    // diplib/color.h
    auto mcol = m.def_submodule("ColorSpaceManager", "A Tool to convert images from one color space to another.");
    mcol.def( "Convert", []( dip::Image const& in, dip::String const& colorSpaceName ){ return colorSpaceManager.Convert( in, colorSpaceName ); }, "in"_a, "colorSpaceName"_a = "RGB" );
+   mcol.def( "ConvertApproximate", []( dip::Image const& in, dip::String const& colorSpaceName ){ return colorSpaceManager.ConvertApproximate( in, colorSpaceName ); }, "in"_a, "colorSpaceName"_a = "Lab" );
    mcol.def( "IsDefined", []( dip::String const& colorSpaceName ){ return colorSpaceManager.IsDefined( colorSpaceName ); }, "colorSpaceName"_a = "RGB" );
    mcol.def( "NumberOfChannels", []( dip::String const& colorSpaceName ){ return colorSpaceManager.NumberOfChannels( colorSpaceName ); }, "colorSpaceName"_a = "RGB" );
    mcol.def( "CanonicalName", []( dip::String const& colorSpaceName ){ return colorSpaceManager.CanonicalName( colorSpaceName ); }, "colorSpaceName"_a = "RGB" );
@@ -129,6 +130,8 @@ void init_assorted( py::module& m ) {
    m.def( "ImageIsTIFF", &dip::ImageIsTIFF, "filename"_a );
    m.def( "ImageWriteTIFF", py::overload_cast< dip::Image const&, dip::String const&, dip::String const&, dip::uint >( &dip::ImageWriteTIFF ),
           "image"_a, "filename"_a, "compression"_a = "", "jpegLevel"_a = 80 );
+   m.def( "ImageWriteTIFFPyramid", &dip::ImageWriteTIFFPyramid,
+          "pyramid"_a, "filename"_a, "compression"_a = "", "jpegLevel"_a = 80 );
 
    // diplib/generation.h
    m.def( "FillDelta", &dip::FillDelta, "out"_a, "origin"_a = "" );
@@ -207,6 +210,10 @@ void init_assorted( py::module& m ) {
           "in"_a, "angle"_a, "axis"_a = 2, "interpolationMethod"_a = "", "boundaryCondition"_a = "" );
    m.def( "Rotation3D", py::overload_cast< dip::Image const&, dip::dfloat, dip::dfloat, dip::dfloat, dip::String const&, dip::String const& >( &dip::Rotation3D ),
           "in"_a, "alpha"_a, "beta"_a, "gamma"_a, "interpolationMethod"_a = "", "boundaryCondition"_a = "" );
+   m.def( "AffineTransform", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::String const& >( &dip::AffineTransform ),
+          "in"_a, "matrix"_a, "interpolationMethod"_a = dip::S::LINEAR );
+   m.def( "ProjectiveTransform", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::String const& >( &dip::ProjectiveTransform ),
+          "in"_a, "matrix"_a, "interpolationMethod"_a = dip::S::LINEAR );
 
    m.def( "Tile", py::overload_cast< dip::ImageConstRefArray const&, dip::UnsignedArray const& >( &dip::Tile ),
           "in"_a, "tiling"_a = dip::UnsignedArray{} );
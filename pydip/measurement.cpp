@@ -20,6 +20,7 @@
 #include "pydip.h"
 #include "diplib/measurement.h"
 #include "diplib/chain_code.h"
+#include "diplib/surface_mesh.h"
 
 dip::MeasurementTool measurementTool;
 
@@ -239,6 +240,18 @@ void init_measurement( py::module& m ) {
                 auto feretValues = self.ConvexHull().Feret();
                 return py::make_tuple( feretValues.maxDiameter, feretValues.minDiameter, feretValues.maxPerpendicular, feretValues.maxAngle, feretValues.minAngle ).release();
              } );
+   poly.def( "MinimumAreaRectangle", []( dip::Polygon const& self ) {
+                auto rect = self.ConvexHull().MinimumAreaRectangle();
+                return py::make_tuple( py::make_tuple( rect.center.x, rect.center.y ), rect.length, rect.width, rect.angle ).release();
+             } );
+   poly.def( "MinimumPerimeterRectangle", []( dip::Polygon const& self ) {
+                auto rect = self.ConvexHull().MinimumPerimeterRectangle();
+                return py::make_tuple( py::make_tuple( rect.center.x, rect.center.y ), rect.length, rect.width, rect.angle ).release();
+             } );
+   poly.def( "MinimumEnclosingCircle", []( dip::Polygon const& self ) {
+                auto circle = self.ConvexHull().MinimumEnclosingCircle();
+                return py::make_tuple( py::make_tuple( circle.center.x, circle.center.y ), circle.diameter ).release();
+             } );
 
    // dip::ChainCode
    auto chain = py::class_< dip::ChainCode >( m, "ChainCode", "" );
@@ -271,4 +284,34 @@ void init_measurement( py::module& m ) {
    // Chain code functions
    m.def( "GetImageChainCodes", &dip::GetImageChainCodes, "labels"_a, "objectIDs"_a = dip::UnsignedArray{}, "connectivity"_a = 2 );
    m.def( "GetSingleChainCode", &dip::GetSingleChainCode, "labels"_a, "startCoord"_a, "connectivity"_a = 2 );
+
+   // dip::SurfaceMesh
+   auto mesh = py::class_< dip::SurfaceMesh >( m, "SurfaceMesh", "A triangulated surface representing a 3D object." );
+   mesh.def( "__repr__", []( dip::SurfaceMesh const& self ) {
+                std::ostringstream os;
+                os << "<SurfaceMesh for object #" << self.objectID << " with " << self.vertices.size() << " vertices and "
+                   << self.triangles.size() << " triangles>";
+                return os.str();
+             } );
+   mesh.def_readonly( "objectID", &dip::SurfaceMesh::objectID );
+   mesh.def_property_readonly( "vertices", []( dip::SurfaceMesh const& self ) {
+                py::list list( self.vertices.size() );
+                py::ssize_t index = 0;
+                for( auto const& v : self.vertices ) {
+                   PyList_SET_ITEM( list.ptr(), index++, py::make_tuple( v.x, v.y, v.z ).release().ptr() );
+                }
+                return list;
+             } );
+   mesh.def_readonly( "triangles", &dip::SurfaceMesh::triangles );
+   mesh.def( "Area", &dip::SurfaceMesh::Area );
+   mesh.def( "Volume", &dip::SurfaceMesh::Volume );
+   mesh.def( "Sphericity", &dip::SurfaceMesh::Sphericity );
+   mesh.def( "ConvexHull", &dip::SurfaceMesh::ConvexHull );
+   mesh.def( "Feret", []( dip::SurfaceMesh const& self ) {
+                auto feretValues = self.Feret();
+                return py::make_tuple( feretValues.maxDiameter, feretValues.minDiameter ).release();
+             } );
+
+   // Surface mesh functions
+   m.def( "GetImageSurfaceMeshes", &dip::GetImageSurfaceMeshes, "labels"_a, "objectIDs"_a = dip::UnsignedArray{} );
 }
@@ -21,6 +21,7 @@ set(DIPlib_sources_bogus
 ../include/diplib/histogram.h
 ../include/diplib/iterators.h
 ../include/diplib/kernel.h
+../include/diplib/lazy.h
 ../include/diplib/library/clamp_cast.h
 ../include/diplib/library/copy_buffer.h
 ../include/diplib/library/datatype.h
@@ -55,6 +56,7 @@ set(DIPlib_sources_bogus
 ../include/diplib/saturated_arithmetic.h
 ../include/diplib/segmentation.h
 ../include/diplib/statistics.h
+../include/diplib/surface_mesh.h
 ../include/diplib/testing.h
 ../include/diplib/transform.h
 ../include/diplib/union_find.h
@@ -95,6 +97,7 @@ generation/draw_discrete.cpp
 generation/draw_support.h
 generation/noise.cpp
 geometry/interpolation.h
+geometry/pyramid.cpp
 geometry/resampleat.cpp
 geometry/resampling.cpp
 geometry/tile.cpp
@@ -133,6 +136,7 @@ linear/uniform.cpp
 mapping/equalization.cpp
 mapping/lookup_table.cpp
 mapping/mapping.cpp
+mapping/mapping_support.h
 math/arithmetic.cpp
 math/bitwise.cpp
 math/comparison.cpp
@@ -153,13 +157,16 @@ measurement/feature_center.h
 measurement/feature_circularity.h
 measurement/feature_convex_area.h
 measurement/feature_convex_perimeter.h
+measurement/feature_convex_volume.h
 measurement/feature_convexity.h
 measurement/feature_dimensions_cube.h
 measurement/feature_dimensions_ellipsoid.h
 measurement/feature_directional_statistics.h
 measurement/feature_eccentricity.h
 measurement/feature_ellipse_variance.h
+measurement/feature_enclosing_circle.h
 measurement/feature_feret.h
+measurement/feature_feret_3d.h
 measurement/feature_gravity.h
 measurement/feature_grey_dimensions_cube.h
 measurement/feature_grey_dimensions_ellipsoid.h
@@ -172,6 +179,9 @@ measurement/feature_mass.h
 measurement/feature_max_val.h
 measurement/feature_maximum.h
 measurement/feature_mean.h
+measurement/feature_mesh_surface_area.h
+measurement/feature_min_area_rectangle.h
+measurement/feature_min_perimeter_rectangle.h
 measurement/feature_min_val.h
 measurement/feature_minimum.h
 measurement/feature_mu.h
@@ -183,6 +193,7 @@ measurement/feature_roundness.h
 measurement/feature_size.h
 measurement/feature_solid_area.h
 measurement/feature_solidity.h
+measurement/feature_sphericity.h
 measurement/feature_statistics.h
 measurement/feature_stdandard_deviation.h
 measurement/feature_surface_area.cpp
@@ -193,6 +204,8 @@ measurement/measure_convex_hull.cpp
 measurement/measurement.cpp
 measurement/measurement_tool.cpp
 measurement/object_to_measurement.cpp
+measurement/parallel_for.h
+measurement/surface_mesh.cpp
 microscopy/unmix_stains.cpp
 morphology/areaopening.cpp
 morphology/basic.cpp
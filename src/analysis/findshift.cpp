@@ -238,16 +238,13 @@ FloatArray FindShift_PROJ( Image const& in1, Image const& in2, dip::uint iterati
    return shift;
 }
 
-FloatArray FindShift_CC(
-      Image const& in1,
-      Image const& in2,
+// Finds the location of the peak in the cross-correlation image `cross`, and converts it to a shift.
+FloatArray FindCrossCorrelationPeak(
+      Image cross, // modified, make sure it's a copy
       UnsignedArray const& maxShift,
-      String const& normalize = S::DONT_NORMALIZE,
-      bool subpixelPrecision = false
+      bool subpixelPrecision
 ) {
-   dip::uint nDims = in1.Dimensionality();
-   Image cross;
-   DIP_STACK_TRACE_THIS( CrossCorrelationFT( in1, in2, cross, S::SPATIAL, S::SPATIAL, S::SPATIAL, normalize ));
+   dip::uint nDims = cross.Dimensionality();
    DIP_ASSERT( cross.DataType().IsReal() );
    UnsignedArray sizes = cross.Sizes();
    bool crop = false;
@@ -285,17 +282,28 @@ FloatArray FindShift_CC(
    return shift;
 }
 
-FloatArray CorrectIntegerShift(
+FloatArray FindShift_CC(
+      Image const& in1,
+      Image const& in2,
+      UnsignedArray const& maxShift,
+      String const& normalize = S::DONT_NORMALIZE,
+      bool subpixelPrecision = false
+) {
+   Image cross;
+   DIP_STACK_TRACE_THIS( CrossCorrelationFT( in1, in2, cross, S::SPATIAL, S::SPATIAL, S::SPATIAL, normalize ));
+   return FindCrossCorrelationPeak( std::move( cross ), maxShift, subpixelPrecision );
+}
+
+// Crops `in1` and `in2` to their common part, given the integer `shift` of `in2` w.r.t. `in1`.
+void CropToCommonPart(
       Image& in1,
       Image& in2,
-      UnsignedArray const& maxShift
+      FloatArray const& shift
 ) {
-   dip::uint nDims = in1.Dimensionality();
-   FloatArray shift;
-   DIP_STACK_TRACE_THIS( shift = FindShift_CC( in1, in2, maxShift ));
    if( shift.any() ) {
       // Shift is non-zero along at least one dimension
       // Correct for this integer shift by cropping both images
+      dip::uint nDims = in1.Dimensionality();
       UnsignedArray sizes = in1.Sizes();
       UnsignedArray origin( nDims, 0 );
       for( dip::uint ii = 0; ii < nDims; ++ii ) {
@@ -310,43 +318,63 @@ FloatArray CorrectIntegerShift(
       in1.dip__SetSizes( sizes );
       in1.dip__SetOrigin( in1.Pointer( origin ));
    }
+}
+
+FloatArray CorrectIntegerShift(
+      Image& in1,
+      Image& in2,
+      UnsignedArray const& maxShift
+) {
+   FloatArray shift;
+   DIP_STACK_TRACE_THIS( shift = FindShift_CC( in1, in2, maxShift ));
+   CropToCommonPart( in1, in2, shift );
    return shift;
 }
 
-} // namespace
+enum class FindShiftMethod { INTEGER_ONLY, CC, NCC, CPF, MTS, ITER, PROJ };
 
-FloatArray FindShift(
-      Image const& c_in1,
-      Image const& c_in2,
-      String const& method,
-      dfloat parameter,
-      UnsignedArray maxShift
-) {
-   DIP_THROW_IF( !c_in1.IsForged() || !c_in2.IsForged(), E::IMAGE_NOT_FORGED );
-   DIP_THROW_IF( !c_in1.IsScalar() || !c_in2.IsScalar(), E::IMAGE_NOT_SCALAR );
-   DIP_THROW_IF( !c_in1.DataType().IsReal() || !c_in2.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
-   DIP_THROW_IF( c_in1.Sizes() != c_in2.Sizes(), E::SIZES_DONT_MATCH );
-   dip::uint nDims = c_in1.Dimensionality();
-   DIP_STACK_TRACE_THIS( ArrayUseParameter( maxShift, nDims, std::numeric_limits< dip::uint >::max() ));
-   FloatArray shift( nDims, 0.0 );
+FindShiftMethod ParseFindShiftMethod( String const& method ) {
    if( method == "integer only" ) {
-      DIP_STACK_TRACE_THIS( shift = FindShift_CC( c_in1, c_in2, maxShift, S::DONT_NORMALIZE, false ));
+      return FindShiftMethod::INTEGER_ONLY;
    } else if( method == "CC" ) {
-      DIP_STACK_TRACE_THIS( shift = FindShift_CC( c_in1, c_in2, maxShift, S::DONT_NORMALIZE, true ));
+      return FindShiftMethod::CC;
    } else if( method == "NCC" ) {
-      DIP_STACK_TRACE_THIS( shift = FindShift_CC( c_in1, c_in2, maxShift, S::NORMALIZE, true ));
+      return FindShiftMethod::NCC;
+   } else if( method == "CPF" ) {
+      return FindShiftMethod::CPF;
+   } else if( method == "MTS" ) {
+      return FindShiftMethod::MTS;
+   } else if( method == "ITER" ) {
+      return FindShiftMethod::ITER;
+   } else if( method == "PROJ" ) {
+      return FindShiftMethod::PROJ;
    } else {
-      Image in1 = c_in1.QuickCopy();
-      Image in2 = c_in2.QuickCopy();
-      DIP_STACK_TRACE_THIS( shift = CorrectIntegerShift( in1, in2, maxShift )); // modifies in1 and in2
-      if( method == "CPF" ) {
-         DIP_STACK_TRACE_THIS( shift += FindShift_CPF( in1, in2, parameter ));
-      } else if( method == "MTS" ) {
+      DIP_THROW_INVALID_FLAG( method );
+   }
+}
+
+bool UsesCrossCorrelationOnly( FindShiftMethod method ) {
+   return ( method == FindShiftMethod::INTEGER_ONLY ) || ( method == FindShiftMethod::CC ) || ( method == FindShiftMethod::NCC );
+}
+
+// Sub-pixel shift estimation for the methods that require the integer shift to be corrected first.
+// `in1` and `in2` have been cropped to their common part.
+FloatArray FindSubpixelShift(
+      Image const& in1,
+      Image const& in2,
+      FindShiftMethod method,
+      dfloat parameter
+) {
+   switch( method ) {
+      case FindShiftMethod::CPF:
+         return FindShift_CPF( in1, in2, parameter );
+      case FindShiftMethod::MTS:
          if( parameter <= 0.0 ) {
             parameter = 1.0;
          }
-         DIP_STACK_TRACE_THIS( shift += FindShift_MTS( in1, in2, 1, 0.0, parameter ));
-      } else {
+         return FindShift_MTS( in1, in2, 1, 0.0, parameter );
+      case FindShiftMethod::ITER:
+      case FindShiftMethod::PROJ: {
          dip::uint maxIter = 5;  // default number of iteration => accuracy ~ 1e-4
          dfloat accuracy = 0.0;  // signals early break if bias correction is possible
          if( parameter < 0.0 ) {
@@ -356,23 +384,237 @@ FloatArray FindShift(
             maxIter = 20;        // NOTE: more iteration solution may end up very far from truth
             accuracy = parameter;
          }
-         if( method == "ITER" ) {
-            DIP_STACK_TRACE_THIS( shift += FindShift_MTS( in1, in2, maxIter, accuracy, 1.0 ));
-         } else if( method == "PROJ" ) {
-            DIP_STACK_TRACE_THIS( shift += FindShift_PROJ( in1, in2, maxIter, accuracy, 1.0 )); // calls FindShift_MTS
-         } else {
-            DIP_THROW_INVALID_FLAG( method );
+         if( method == FindShiftMethod::ITER ) {
+            return FindShift_MTS( in1, in2, maxIter, accuracy, 1.0 );
          }
+         return FindShift_PROJ( in1, in2, maxIter, accuracy, 1.0 ); // calls FindShift_MTS
+      }
+      default:
+         DIP_THROW( E::NOT_IMPLEMENTED ); // Should not happen
+   }
+}
+
+void FindShiftCheckInputs( Image const& in1, Image const& in2 ) {
+   DIP_THROW_IF( !in1.IsForged() || !in2.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in1.IsScalar() || !in2.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !in1.DataType().IsReal() || !in2.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( in1.Sizes() != in2.Sizes(), E::SIZES_DONT_MATCH );
+}
+
+} // namespace
+
+FloatArray FindShift(
+      Image const& c_in1,
+      Image const& c_in2,
+      String const& method,
+      dfloat parameter,
+      UnsignedArray maxShift
+) {
+   FindShiftCheckInputs( c_in1, c_in2 );
+   dip::uint nDims = c_in1.Dimensionality();
+   DIP_STACK_TRACE_THIS( ArrayUseParameter( maxShift, nDims, std::numeric_limits< dip::uint >::max() ));
+   FindShiftMethod shiftMethod;
+   DIP_STACK_TRACE_THIS( shiftMethod = ParseFindShiftMethod( method ));
+   FloatArray shift( nDims, 0.0 );
+   switch( shiftMethod ) {
+      case FindShiftMethod::INTEGER_ONLY:
+         DIP_STACK_TRACE_THIS( shift = FindShift_CC( c_in1, c_in2, maxShift, S::DONT_NORMALIZE, false ));
+         break;
+      case FindShiftMethod::CC:
+         DIP_STACK_TRACE_THIS( shift = FindShift_CC( c_in1, c_in2, maxShift, S::DONT_NORMALIZE, true ));
+         break;
+      case FindShiftMethod::NCC:
+         DIP_STACK_TRACE_THIS( shift = FindShift_CC( c_in1, c_in2, maxShift, S::NORMALIZE, true ));
+         break;
+      default: {
+         Image in1 = c_in1.QuickCopy();
+         Image in2 = c_in2.QuickCopy();
+         DIP_START_STACK_TRACE
+            shift = CorrectIntegerShift( in1, in2, maxShift ); // modifies in1 and in2
+            shift += FindSubpixelShift( in1, in2, shiftMethod, parameter );
+         DIP_END_STACK_TRACE
+         break;
       }
    }
    return shift;
 }
 
+FloatArray FindShiftCoarseToFine(
+      Image const& in1,
+      Image const& in2,
+      String const& method,
+      dfloat parameter,
+      UnsignedArray maxShift,
+      dip::uint windowSize
+) {
+   FindShiftCheckInputs( in1, in2 );
+   dip::uint nDims = in1.Dimensionality();
+   DIP_THROW_IF( nDims == 0, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF( windowSize < 16, E::PARAMETER_OUT_OF_RANGE );
+   DIP_STACK_TRACE_THIS( ArrayUseParameter( maxShift, nDims, std::numeric_limits< dip::uint >::max() ));
+   FindShiftMethod shiftMethod;
+   DIP_STACK_TRACE_THIS( shiftMethod = ParseFindShiftMethod( method ));
+
+   // Determine the number of pyramid levels: we reduce until the image fits in the window, but avoid making any
+   // dimension too small for a meaningful cross-correlation.
+   UnsignedArray sizes = in1.Sizes();
+   dip::uint nLevels = 1;
+   while( true ) {
+      dip::uint maxSize = 0;
+      dip::uint minSize = std::numeric_limits< dip::uint >::max();
+      for( auto sz : sizes ) {
+         maxSize = std::max( maxSize, sz );
+         if( sz > 1 ) {
+            minSize = std::min( minSize, sz );
+         }
+      }
+      if(( maxSize <= windowSize ) || ( minSize < 32 )) {
+         break;
+      }
+      for( auto& sz : sizes ) {
+         sz = ( sz + 1 ) / 2;
+      }
+      ++nLevels;
+   }
+   if( nLevels == 1 ) {
+      return FindShift( in1, in2, method, parameter, maxShift );
+   }
+
+   // Compute the pyramids. Each level is computed from the previous one, the full-resolution images are not copied.
+   ImageArray pyramid1;
+   ImageArray pyramid2;
+   DIP_START_STACK_TRACE
+      pyramid1 = GaussianPyramid( in1, nLevels );
+      pyramid2 = GaussianPyramid( in2, nLevels );
+   DIP_END_STACK_TRACE
+
+   // Integer shift at the coarsest level, using the full (small) images
+   UnsignedArray coarseMaxShift = maxShift;
+   for( auto& ms : coarseMaxShift ) {
+      if( ms != std::numeric_limits< dip::uint >::max() ) {
+         ms = ( ms >> ( nLevels - 1 )) + 1;
+      }
+   }
+   FloatArray shift;
+   DIP_STACK_TRACE_THIS( shift = FindShift_CC( pyramid1.back(), pyramid2.back(), coarseMaxShift, S::DONT_NORMALIZE, false ));
+
+   // Refine at each finer level, using only a window of at most `windowSize` pixels in the common part of the images.
+   // The shift estimated at the coarser level is accurate to within a pixel or so, so we restrict the residual shift.
+   UnsignedArray residualMaxShift( nDims, 2 );
+   Image window1;
+   Image window2;
+   for( dip::uint level = nLevels - 1; level > 0; ) {
+      --level;
+      Image const& level1 = pyramid1[ level ];
+      Image const& level2 = pyramid2[ level ];
+      RangeArray range1( nDims );
+      RangeArray range2( nDims );
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         dip::sint size = static_cast< dip::sint >( level1.Size( ii ));
+         dip::sint s = static_cast< dip::sint >( shift[ ii ] ) * 2;
+         s = clamp( s, -( size - 1 ), size - 1 );
+         shift[ ii ] = static_cast< dfloat >( s );
+         dip::sint common = size - std::abs( s );
+         dip::sint window = std::min( common, static_cast< dip::sint >( windowSize ));
+         dip::sint offset = ( common - window ) / 2;
+         dip::sint start1 = ( s < 0 ? -s : 0 ) + offset;
+         dip::sint start2 = ( s > 0 ? s : 0 ) + offset;
+         range1[ ii ] = Range{ start1, start1 + window - 1 };
+         range2[ ii ] = Range{ start2, start2 + window - 1 };
+      }
+      window1 = level1.At( range1 );
+      window2 = level2.At( range2 );
+      if( level > 0 || !UsesCrossCorrelationOnly( shiftMethod ) || ( shiftMethod == FindShiftMethod::INTEGER_ONLY )) {
+         FloatArray residual;
+         DIP_STACK_TRACE_THIS( residual = FindShift_CC( window1, window2, residualMaxShift, S::DONT_NORMALIZE, false ));
+         shift += residual;
+         CropToCommonPart( window1, window2, residual );
+      } else {
+         // The last level for "CC" and "NCC" methods: estimate the residual with sub-pixel precision
+         String normalize = shiftMethod == FindShiftMethod::NCC ? S::NORMALIZE : S::DONT_NORMALIZE;
+         DIP_STACK_TRACE_THIS( shift += FindShift_CC( window1, window2, residualMaxShift, normalize, true ));
+      }
+   }
+   if( !UsesCrossCorrelationOnly( shiftMethod )) {
+      // Sub-pixel refinement on the full-resolution windows, which are aligned to the integer shift
+      DIP_STACK_TRACE_THIS( shift += FindSubpixelShift( window1, window2, shiftMethod, parameter ));
+   }
+   return shift;
+}
+
+FloatCoordinateArray FindShift(
+      ImageConstRefArray const& in1,
+      ImageConstRefArray const& in2,
+      String const& method,
+      dfloat parameter,
+      UnsignedArray maxShift
+) {
+   dip::uint nPairs = in1.size();
+   DIP_THROW_IF( nPairs == 0, E::ARRAY_PARAMETER_EMPTY );
+   DIP_THROW_IF( in2.size() != nPairs, E::ARRAY_SIZES_DONT_MATCH );
+   UnsignedArray const& sizes = in1[ 0 ].get().Sizes();
+   for( dip::uint ii = 0; ii < nPairs; ++ii ) {
+      FindShiftCheckInputs( in1[ ii ].get(), in2[ ii ].get() );
+      DIP_THROW_IF( in1[ ii ].get().Sizes() != sizes, E::SIZES_DONT_MATCH );
+   }
+   dip::uint nDims = sizes.size();
+   DIP_THROW_IF( nDims == 0, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_STACK_TRACE_THIS( ArrayUseParameter( maxShift, nDims, std::numeric_limits< dip::uint >::max() ));
+   FindShiftMethod shiftMethod;
+   DIP_STACK_TRACE_THIS( shiftMethod = ParseFindShiftMethod( method ));
+
+   // Stack all pairs along a new dimension, and compute all cross-correlations with a single Fourier transform
+   // that processes only the original dimensions. This way, the DFT plans are computed only once, and the
+   // computation is parallelized over all image lines of all pairs.
+   Image cross;
+   DIP_START_STACK_TRACE
+      BooleanArray process( nDims + 1, true );
+      process.back() = false;
+      Image stack1 = Concatenate( in1, nDims );
+      Image stack2 = Concatenate( in2, nDims );
+      if( stack1.Dimensionality() == nDims ) {
+         // `Concatenate` returns the input image if there is only one pair
+         stack1.AddSingleton( nDims );
+         stack2.AddSingleton( nDims );
+      }
+      Image stack1FT = FourierTransform( stack1, {}, process );
+      stack1.Strip();
+      Image stack2FT = FourierTransform( stack2, {}, process );
+      stack2.Strip();
+      MultiplyConjugate( stack1FT, stack2FT, cross, stack1FT.DataType() );
+      if( shiftMethod == FindShiftMethod::NCC ) {
+         SquareModulus( stack1FT, stack2FT );
+         SafeDivide( cross, stack2FT, cross, cross.DataType() );
+      }
+      stack1FT.Strip();
+      stack2FT.Strip();
+      FourierTransform( cross, cross, { S::INVERSE, S::REAL }, process );
+   DIP_END_STACK_TRACE
+
+   bool subpixelPrecision = ( shiftMethod == FindShiftMethod::CC ) || ( shiftMethod == FindShiftMethod::NCC );
+   FloatCoordinateArray out( nPairs );
+   RangeArray ranges( nDims + 1 );
+   for( dip::uint ii = 0; ii < nPairs; ++ii ) {
+      ranges.back() = Range{ static_cast< dip::sint >( ii ) };
+      Image pairCross = cross.At( ranges );
+      pairCross.Squeeze( nDims );
+      DIP_STACK_TRACE_THIS( out[ ii ] = FindCrossCorrelationPeak( std::move( pairCross ), maxShift, subpixelPrecision ));
+      if( !UsesCrossCorrelationOnly( shiftMethod )) {
+         Image pair1 = in1[ ii ].get().QuickCopy();
+         Image pair2 = in2[ ii ].get().QuickCopy();
+         CropToCommonPart( pair1, pair2, out[ ii ] );
+         DIP_STACK_TRACE_THIS( out[ ii ] += FindSubpixelShift( pair1, pair2, shiftMethod, parameter ));
+      }
+   }
+   return out;
+}
+
 } // namespace dip
 
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
 #include "diplib/generation.h"
+#include "diplib/random.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the FindShift fuction") {
    // Something to shift
@@ -437,6 +679,96 @@ DOCTEST_TEST_CASE("[DIPlib] testing the FindShift fuction") {
    DOCTEST_REQUIRE( result.size() == 2 );
    DOCTEST_CHECK( std::abs( result[ 0 ] - shift[ 0 ] ) < 0.03 );
    DOCTEST_CHECK( std::abs( result[ 1 ] - shift[ 1 ] ) < 0.03 );
+
+   // Batched: should give identical results to individual pairs
+   dip::FloatCoordinateArray results = dip::FindShift( { in1, in2 }, { in2, in1 }, "CC" );
+   DOCTEST_REQUIRE( results.size() == 2 );
+   result = FindShift( in1, in2, "CC" );
+   DOCTEST_CHECK( std::abs( results[ 0 ][ 0 ] - result[ 0 ] ) < 1e-4 );
+   DOCTEST_CHECK( std::abs( results[ 0 ][ 1 ] - result[ 1 ] ) < 1e-4 );
+   result = FindShift( in2, in1, "CC" );
+   DOCTEST_CHECK( std::abs( results[ 1 ][ 0 ] - result[ 0 ] ) < 1e-4 );
+   DOCTEST_CHECK( std::abs( results[ 1 ][ 1 ] - result[ 1 ] ) < 1e-4 );
+   results = dip::FindShift( { in1, in2 }, { in2, in1 }, "ITER" );
+   DOCTEST_REQUIRE( results.size() == 2 );
+   DOCTEST_CHECK( std::abs( results[ 0 ][ 0 ] - shift[ 0 ] ) < 0.002 );
+   DOCTEST_CHECK( std::abs( results[ 0 ][ 1 ] - shift[ 1 ] ) < 0.002 );
+   DOCTEST_CHECK( std::abs( results[ 1 ][ 0 ] + shift[ 0 ] ) < 0.002 );
+   DOCTEST_CHECK( std::abs( results[ 1 ][ 1 ] + shift[ 1 ] ) < 0.002 );
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the FindShiftCoarseToFine fuction") {
+   // Something with texture everywhere
+   dip::Random random( 0 );
+   dip::Image in1( { 400, 330 }, 1, dip::DT_SFLOAT );
+   in1.Fill( 0 );
+   dip::UniformNoise( in1, in1, random );
+   dip::Gauss( in1, in1, { 2 } );
+   // A large shift
+   dip::FloatArray shift{ 57.3, -41.64 };
+   dip::Image in2 = dip::Shift( in1, shift, "3-cubic" );
+
+   dip::FloatArray result;
+
+   // Method: "integer only"
+   result = FindShiftCoarseToFine( in1, in2, "integer only", 0, {}, 64 );
+   DOCTEST_REQUIRE( result.size() == 2 );
+   DOCTEST_CHECK( result[ 0 ] == std::round( shift[ 0 ] ));
+   DOCTEST_CHECK( result[ 1 ] == std::round( shift[ 1 ] ));
+
+   // Method: "CC"
+   // (the sub-pixel estimate is computed on a small window only, so it is less precise than with `FindShift`)
+   result = FindShiftCoarseToFine( in1, in2, "CC", 0, {}, 64 );
+   DOCTEST_REQUIRE( result.size() == 2 );
+   DOCTEST_CHECK( std::abs( result[ 0 ] - shift[ 0 ] ) < 0.2 );
+   DOCTEST_CHECK( std::abs( result[ 1 ] - shift[ 1 ] ) < 0.2 );
+
+   // Method: "ITER"
+   result = FindShiftCoarseToFine( in1, in2, "ITER", 0, {}, 64 );
+   DOCTEST_REQUIRE( result.size() == 2 );
+   DOCTEST_CHECK( std::abs( result[ 0 ] - shift[ 0 ] ) < 0.01 );
+   DOCTEST_CHECK( std::abs( result[ 1 ] - shift[ 1 ] ) < 0.01 );
+
+   // The result approximates that of `FindShift`, to within the tolerances documented
+   for( auto method : { "CC", "MTS" } ) {
+      result = FindShiftCoarseToFine( in1, in2, method, 0, {}, 64 );
+      dip::FloatArray expected = FindShift( in1, in2, method );
+      dip::dfloat tolerance = std::string( method ) == "CC" ? 0.3 : 0.01;
+      DOCTEST_CHECK( std::abs( result[ 0 ] - expected[ 0 ] ) < tolerance );
+      DOCTEST_CHECK( std::abs( result[ 1 ] - expected[ 1 ] ) < tolerance );
+   }
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the batched FindShift fuction") {
+   // Tiles cut from a textured image, each pair with a different shift
+   dip::Random random( 0 );
+   dip::Image base( { 200, 180 }, 1, dip::DT_SFLOAT );
+   base.Fill( 0 );
+   dip::UniformNoise( base, base, random );
+   dip::Gauss( base, base, { 2 } );
+   dip::FloatCoordinateArray shifts{ { 3.2, -1.7 }, { -5.45, 4.1 }, { 0.3, 7.8 } };
+   dip::ImageArray tiles1;
+   dip::ImageArray tiles2;
+   for( dip::uint ii = 0; ii < shifts.size(); ++ii ) {
+      dip::Image shifted = dip::Shift( base, shifts[ ii ], "3-cubic" );
+      dip::RangeArray window{ dip::Range{ 40 + 10 * static_cast< dip::sint >( ii ), 119 + 10 * static_cast< dip::sint >( ii ) },
+                              dip::Range{ 50, 129 } };
+      tiles1.push_back( base.At( window ));
+      tiles2.push_back( shifted.At( window ));
+   }
+   dip::ImageConstRefArray in1 = dip::CreateImageConstRefArray( tiles1 );
+   dip::ImageConstRefArray in2 = dip::CreateImageConstRefArray( tiles2 );
+   // The result for each pair is the same as calling `FindShift` on it
+   for( auto method : { "integer only", "CC", "NCC", "CPF", "MTS" } ) {
+      dip::FloatCoordinateArray result = dip::FindShift( in1, in2, method );
+      DOCTEST_REQUIRE( result.size() == shifts.size() );
+      for( dip::uint ii = 0; ii < shifts.size(); ++ii ) {
+         dip::FloatArray expected = dip::FindShift( tiles1[ ii ], tiles2[ ii ], method );
+         DOCTEST_REQUIRE( result[ ii ].size() == 2 );
+         DOCTEST_CHECK( result[ ii ][ 0 ] == doctest::Approx( expected[ 0 ] ).epsilon( 1e-6 ));
+         DOCTEST_CHECK( result[ ii ][ 1 ] == doctest::Approx( expected[ 1 ] ).epsilon( 1e-6 ));
+      }
+   }
 }
 
 #endif // DIP__ENABLE_DOCTEST
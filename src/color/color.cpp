@@ -24,6 +24,7 @@
 #include "diplib.h"
 #include "diplib/color.h"
 #include "diplib/framework.h"
+#include "diplib/lookup_table.h"
 
 namespace dip {
 namespace {
@@ -151,7 +152,7 @@ class ConverterLineFilter : public Framework::ScanLineFilter {
       ConverterLineFilter( ConversionStepArray const& steps ) : steps_( steps ) {
          maxIntermediateChannels_ = steps[ 0 ].nOutputChannels;
          for( dip::uint ii = 1; ii < steps.size() - 1; ++ii ) {
-            maxIntermediateChannels_ = std::max( maxIntermediateChannels_, steps[ 1 ].nOutputChannels );
+            maxIntermediateChannels_ = std::max( maxIntermediateChannels_, steps[ ii ].nOutputChannels );
          }
          nBuffers_ = std::min< dip::uint >( 2, steps.size() - 1 );
       }
@@ -220,6 +221,168 @@ class ConverterLineFilter : public Framework::ScanLineFilter {
       // It also means we don't need to worry about how many channels an intermediate representation needs.
 };
 
+// For scalar images with a small set of possible values (8-bit and 16-bit unsigned integers), it is cheaper
+// to convert all possible input values once and use a look-up table, as long as the image has more pixels than the
+// table has entries. Returns 0 if a look-up table should not be used.
+dip::uint ConversionLookupTableSize( Image const& in ) {
+   if( !in.IsScalar() ) {
+      return 0;
+   }
+   dip::uint size;
+   switch( in.DataType() ) {
+      case DT_UINT8:
+         size = 256;
+         break;
+      case DT_UINT16:
+         size = 65536;
+         break;
+      default:
+         return 0;
+   }
+   return in.NumberOfPixels() > size ? size : 0;
+}
+
+// `ColorSpaceManager::ConvertApproximate` converts 8-bit RGB and sRGB images to Lab or Luv by computing the
+// conversion on a grid of sRGB values, and interpolating each pixel from it. The grid is in sRGB rather than linear RGB coordinates because the
+// Lab and Luv transforms are much smoother as a function of sRGB values, so the interpolation error is small
+// (less than 0.3 units in L, a, b, u and v, well below a perceptible difference). Other target color spaces
+// are either cheap to compute directly, or have a hue component that cannot be interpolated across its
+// discontinuity.
+constexpr dip::uint colorTableStep = 5;                            // distance between grid nodes in sRGB values
+constexpr dip::uint colorTableNodes = 255 / colorTableStep + 1;    // number of grid nodes along each axis
+
+bool UseColorLookupTable3D( Image const& in, String const& startColorSpace, String const& endColorSpace ) {
+   return ( in.DataType() == DT_UINT8 ) &&
+          (( startColorSpace == "RGB" ) || ( startColorSpace == "sRGB" )) &&
+          (( endColorSpace == "Lab" ) || ( endColorSpace == "Luv" ));
+}
+
+struct ColorTableEntry {
+   dip::uint offset;    // offset into the table of the grid node below the input value
+   sfloat weight;       // interpolation weight of the grid node above the input value
+};
+
+using ColorTableAxis = std::array< ColorTableEntry, 256 >;
+
+class ColorLookupTable3DLineFilter : public Framework::ScanLineFilter {
+   public:
+      ColorLookupTable3DLineFilter( std::vector< sfloat > const& table, std::array< ColorTableAxis, 3 > const& axes,
+                                    std::array< dip::uint, 3 > const& strides, dip::uint nOutputChannels )
+            : table_( table ), axes_( axes ), strides_( strides ), nOutputChannels_( nOutputChannels ) {}
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override {
+         return 15 * nOutputChannels_ + 10;
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         dip::uint8 const* in = static_cast< dip::uint8 const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint const inStride = params.inBuffer[ 0 ].stride;
+         dip::sint const inTStride = params.inBuffer[ 0 ].tensorStride;
+         sfloat* out = static_cast< sfloat* >( params.outBuffer[ 0 ].buffer );
+         dip::sint const outStride = params.outBuffer[ 0 ].stride;
+         dip::sint const outTStride = params.outBuffer[ 0 ].tensorStride;
+         dip::uint const s0 = strides_[ 0 ];
+         dip::uint const s1 = strides_[ 1 ];
+         dip::uint const s2 = strides_[ 2 ];
+         for( dip::uint ii = 0; ii < params.bufferLength; ++ii, in += inStride, out += outStride ) {
+            ColorTableEntry const& e0 = axes_[ 0 ][ in[ 0 ]];
+            ColorTableEntry const& e1 = axes_[ 1 ][ in[ inTStride ]];
+            ColorTableEntry const& e2 = axes_[ 2 ][ in[ 2 * inTStride ]];
+            sfloat const* node = table_.data() + e0.offset + e1.offset + e2.offset;
+            sfloat* optr = out;
+            for( dip::uint jj = 0; jj < nOutputChannels_; ++jj, ++node, optr += outTStride ) {
+               sfloat v00 = node[ 0 ] + e0.weight * ( node[ s0 ] - node[ 0 ] );
+               sfloat v10 = node[ s1 ] + e0.weight * ( node[ s1 + s0 ] - node[ s1 ] );
+               sfloat v01 = node[ s2 ] + e0.weight * ( node[ s2 + s0 ] - node[ s2 ] );
+               sfloat v11 = node[ s2 + s1 ] + e0.weight * ( node[ s2 + s1 + s0 ] - node[ s2 + s1 ] );
+               sfloat v0 = v00 + e1.weight * ( v10 - v00 );
+               sfloat v1 = v01 + e1.weight * ( v11 - v01 );
+               *optr = v0 + e2.weight * ( v1 - v0 );
+            }
+         }
+      }
+   private:
+      std::vector< sfloat > const& table_;
+      std::array< ColorTableAxis, 3 > const& axes_;
+      std::array< dip::uint, 3 > strides_;
+      dip::uint nOutputChannels_;
+};
+
+void ConvertThroughLookupTable3D(
+      ColorSpaceManager const& csm,
+      Image const& in,
+      Image& out,
+      String const& startColorSpace,
+      String const& endColorSpace,
+      DataType outDataType
+) {
+   // Convert the grid nodes
+   constexpr dip::uint N = colorTableNodes;
+   Image grid( { N, N, N }, 3, DT_DFLOAT );
+   grid.SetColorSpace( "sRGB" );
+   dfloat* gptr = static_cast< dfloat* >( grid.Origin() );
+   dip::sint gTStride = grid.TensorStride();
+   for( dip::uint i2 = 0; i2 < N; ++i2 ) {
+      for( dip::uint i1 = 0; i1 < N; ++i1 ) {
+         for( dip::uint i0 = 0; i0 < N; ++i0 ) {
+            dfloat* p = gptr + static_cast< dip::sint >( i0 ) * grid.Stride( 0 ) +
+                               static_cast< dip::sint >( i1 ) * grid.Stride( 1 ) +
+                               static_cast< dip::sint >( i2 ) * grid.Stride( 2 );
+            p[ 0 ] = static_cast< dfloat >( i0 * colorTableStep );
+            p[ gTStride ] = static_cast< dfloat >( i1 * colorTableStep );
+            p[ 2 * gTStride ] = static_cast< dfloat >( i2 * colorTableStep );
+         }
+      }
+   }
+   Image nodes = csm.Convert( grid, endColorSpace );
+   dip::uint nOut = nodes.TensorElements();
+   std::array< dip::uint, 3 > strides{{ nOut, nOut * N, nOut * N * N }};
+   std::vector< sfloat > table( nOut * N * N * N );
+   dip::sint nTStride = nodes.TensorStride();
+   auto tptr = table.begin();
+   for( dip::uint i2 = 0; i2 < N; ++i2 ) {
+      for( dip::uint i1 = 0; i1 < N; ++i1 ) {
+         for( dip::uint i0 = 0; i0 < N; ++i0 ) {
+            dfloat const* p = static_cast< dfloat const* >( nodes.Pointer( UnsignedArray{ i0, i1, i2 } ));
+            for( dip::uint jj = 0; jj < nOut; ++jj, ++tptr ) {
+               *tptr = static_cast< sfloat >( p[ static_cast< dip::sint >( jj ) * nTStride ] );
+            }
+         }
+      }
+   }
+   // Find the grid position for each input value: for sRGB input this is a uniform mapping, for RGB input we
+   // apply the sRGB transform first
+   std::array< dfloat, 256 > position;
+   if( startColorSpace == "sRGB" ) {
+      for( dip::uint ii = 0; ii < 256; ++ii ) {
+         position[ ii ] = static_cast< dfloat >( ii );
+      }
+   } else {
+      Image values( { 256 }, 3, DT_DFLOAT );
+      values.SetColorSpace( startColorSpace );
+      dfloat* vptr = static_cast< dfloat* >( values.Origin() );
+      for( dip::uint ii = 0; ii < 256; ++ii, vptr += values.Stride( 0 )) {
+         vptr[ 0 ] = vptr[ values.TensorStride() ] = vptr[ 2 * values.TensorStride() ] = static_cast< dfloat >( ii );
+      }
+      values = csm.Convert( values, "sRGB" );
+      vptr = static_cast< dfloat* >( values.Origin() );
+      for( dip::uint ii = 0; ii < 256; ++ii, vptr += values.Stride( 0 )) {
+         position[ ii ] = clamp( vptr[ 0 ], 0.0, 255.0 );
+      }
+   }
+   std::array< ColorTableAxis, 3 > axes;
+   for( dip::uint ii = 0; ii < 256; ++ii ) {
+      dfloat u = position[ ii ] / static_cast< dfloat >( colorTableStep );
+      dip::uint index = std::min( static_cast< dip::uint >( u ), N - 2 );
+      sfloat weight = static_cast< sfloat >( u - static_cast< dfloat >( index ));
+      for( dip::uint jj = 0; jj < 3; ++jj ) {
+         axes[ jj ][ ii ] = { index * strides[ jj ], weight };
+      }
+   }
+   // Interpolate each pixel from the table
+   ColorLookupTable3DLineFilter lineFilter( table, axes, strides, nOut );
+   ImageRefArray outar{ out };
+   Framework::Scan( { in }, outar, { DT_UINT8 }, { DT_SFLOAT }, { outDataType }, { nOut }, lineFilter );
+}
+
 } // namespace
 
 void ColorSpaceManager::Convert(
@@ -261,17 +424,39 @@ void ColorSpaceManager::Convert(
       }
       steps.back().last = true;
       //std::cout << colorSpaces_[ path.back() ].name << std::endl;
-      // Call scan framework
       DIP_START_STACK_TRACE
          ConverterLineFilter lineFilter( steps );
-         Framework::ScanMonadic(
-               in,
-               out,
-               DT_DFLOAT,
-               DataType::SuggestFloat( in.DataType() ),
-               steps.back().nOutputChannels,
-               lineFilter
-         );
+         DataType outDataType = DataType::SuggestFloat( in.DataType() );
+         dip::uint lutSize = ConversionLookupTableSize( in );
+         if( lutSize > 0 ) {
+            // Convert each of the possible input values once, then map the image through the resulting table
+            Image lutIndex( { lutSize }, 1, DT_DFLOAT );
+            dfloat* ptr = static_cast< dfloat* >( lutIndex.Origin() );
+            for( dip::uint ii = 0; ii < lutSize; ++ii ) {
+               ptr[ ii ] = static_cast< dfloat >( ii );
+            }
+            Image lutValues;
+            Framework::ScanMonadic(
+                  lutIndex,
+                  lutValues,
+                  DT_DFLOAT,
+                  out.IsProtected() ? out.DataType() : outDataType, // avoid rounding twice
+                  steps.back().nOutputChannels,
+                  lineFilter
+            );
+            LookupTable lut( lutValues );
+            lut.Apply( in, out, LookupTable::InterpolationMode::ZERO_ORDER_HOLD );
+         } else {
+            // Call scan framework
+            Framework::ScanMonadic(
+                  in,
+                  out,
+                  DT_DFLOAT,
+                  outDataType,
+                  steps.back().nOutputChannels,
+                  lineFilter
+            );
+         }
       DIP_END_STACK_TRACE
       out.ReshapeTensorAsVector();
    }
@@ -283,6 +468,29 @@ void ColorSpaceManager::Convert(
    }
 }
 
+void ColorSpaceManager::ConvertApproximate(
+      Image const& in,
+      Image& out,
+      String const& endColorSpace
+) const {
+   String const& startColorSpace = in.ColorSpace();
+   if( startColorSpace.empty() || endColorSpace.empty() ) {
+      DIP_STACK_TRACE_THIS( Convert( in, out, endColorSpace ));
+      return;
+   }
+   dip::uint startIndex = Index( startColorSpace );
+   dip::uint endIndex = Index( endColorSpace );
+   if( !UseColorLookupTable3D( in, colorSpaces_[ startIndex ].name, colorSpaces_[ endIndex ].name )) {
+      DIP_STACK_TRACE_THIS( Convert( in, out, endColorSpace ));
+      return;
+   }
+   DIP_THROW_IF( in.TensorElements() != colorSpaces_[ startIndex ].nChannels, E::INCONSISTENT_COLORSPACE );
+   DIP_STACK_TRACE_THIS( ConvertThroughLookupTable3D( *this, in, out, colorSpaces_[ startIndex ].name,
+                                                      colorSpaces_[ endIndex ].name, DT_SFLOAT ));
+   out.ReshapeTensorAsVector();
+   out.SetColorSpace( colorSpaces_[ endIndex ].name );
+}
+
 namespace {
 struct QueueElement {
    dip::uint cost;
@@ -385,6 +593,7 @@ void ColorSpaceManager::SetWhitePoint( XYZ whitePoint ) {
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
 #include "diplib/math.h"
+#include "diplib/statistics.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the ColorSpaceManager class") {
    dip::ColorSpaceManager csm;
@@ -426,6 +635,50 @@ DOCTEST_TEST_CASE("[DIPlib] testing the ColorSpaceManager class") {
    csm.SetWhitePoint( dip::ColorSpaceManager::IlluminantD50 );
    csm.Convert( img, out, "XYZ" );
    DOCTEST_CHECK_FALSE( xyz.At( 0 ) == out.At( 0 ));
+   // Check that the look-up table used for 8-bit grey images yields the same result as the direct computation.
+   img = dip::Image( { 300 }, 1, dip::DT_UINT8 );
+   dip::uint8* ptr = static_cast< dip::uint8* >( img.Origin() );
+   for( dip::uint ii = 0; ii < 300; ++ii ) {
+      ptr[ ii ] = static_cast< dip::uint8 >( ( ii * 7 ) % 256 );
+   }
+   out = csm.Convert( img, "Lab" );
+   dip::Image direct = csm.Convert( dip::Convert( img, dip::DT_SFLOAT ), "Lab" );
+   DOCTEST_CHECK( out.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( out.ColorSpace() == "Lab" );
+   dip::Image diff = out != direct;
+   diff.TensorToSpatial();
+   DOCTEST_CHECK( dip::Count( diff ) == 0 );
+   // Binary grey images are converted directly
+   img = dip::Image( { 10, 10 }, 1, dip::DT_BIN );
+   img.Fill( 0 );
+   img.At( 3, 4 ) = 1;
+   out = csm.Convert( img, "RGB" );
+   DOCTEST_CHECK( out.ColorSpace() == "RGB" );
+   DOCTEST_CHECK( out.At( 3, 4 ) == dip::Image::Pixel( { 1, 1, 1 } ));
+   DOCTEST_CHECK( out.At( 0, 0 ) == dip::Image::Pixel( { 0, 0, 0 } ));
+   // Check that the 3D look-up table used by `ConvertApproximate` for 8-bit RGB images yields nearly the same
+   // result as the direct computation, which `Convert` uses for any image size.
+   img = dip::Image( { 600, 500 }, 3, dip::DT_UINT8 );
+   ptr = static_cast< dip::uint8* >( img.Origin() );
+   for( dip::uint ii = 0; ii < img.NumberOfSamples(); ++ii ) {
+      ptr[ ii ] = static_cast< dip::uint8 >(( ii * 7919 + ii / 3 ) % 256 );
+   }
+   for( auto const& startColorSpace : { "RGB", "sRGB" } ) {
+      img.SetColorSpace( startColorSpace );
+      for( auto const& endColorSpace : { "Lab", "Luv" } ) {
+         out = csm.ConvertApproximate( img, endColorSpace );
+         direct = csm.Convert( dip::Convert( img, dip::DT_DFLOAT ), endColorSpace );
+         DOCTEST_CHECK( out.DataType() == dip::DT_SFLOAT );
+         DOCTEST_CHECK( out.ColorSpace() == endColorSpace );
+         out.TensorToSpatial();
+         direct.TensorToSpatial();
+         DOCTEST_CHECK( dip::MaximumAbsoluteError( out, direct ) < 0.3 );
+         // The default conversion is exact
+         dip::Image exact = csm.Convert( img, endColorSpace );
+         exact.TensorToSpatial();
+         DOCTEST_CHECK( dip::MaximumAbsoluteError( exact, direct ) < 1e-4 );
+      }
+   }
 }
 
 #endif // DIP__ENABLE_DOCTEST
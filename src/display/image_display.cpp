@@ -100,10 +100,43 @@ void ImageDisplay::ComputeLimits( bool set ) {
    }
 }
 
+std::vector< dip::uint > ImageDisplay::SliceKey() const {
+   std::vector< dip::uint > key{
+         static_cast< dip::uint >( projectionMode_ ), dim1_, dim2_,
+         static_cast< dip::uint >( red_ + 1 ), static_cast< dip::uint >( green_ + 1 ), static_cast< dip::uint >( blue_ + 1 )
+   };
+   if( projectionMode_ == ProjectionMode::SLICE ) {
+      for( auto ii : orthogonal_ ) {
+         key.push_back( coordinates_[ ii ] );
+      }
+   }
+   return key;
+}
+
 void ImageDisplay::InvalidateSliceLimits() {
-   for( auto& lim : sliceLimits_ ) {
-      lim.maxMin = { nan, nan };
-      lim.percentile = { nan, nan };
+   // Keep the limits computed for the previous slice, if any
+   if( !sliceLimitsKey_.empty() ) {
+      bool computed = false;
+      for( auto const& lim : sliceLimits_ ) {
+         computed |= !std::isnan( lim.maxMin.lower ) || !std::isnan( lim.percentile.lower );
+      }
+      if( computed ) {
+         if( sliceLimitsCache_.size() >= maxSliceLimitsCacheSize_ ) {
+            sliceLimitsCache_.clear();
+         }
+         sliceLimitsCache_[ sliceLimitsKey_ ] = sliceLimits_;
+      }
+   }
+   // Retrieve the limits for the new slice, if we computed them before
+   sliceLimitsKey_ = SliceKey();
+   auto it = sliceLimitsCache_.find( sliceLimitsKey_ );
+   if( it != sliceLimitsCache_.end() ) {
+      sliceLimits_ = it->second;
+   } else {
+      for( auto& lim : sliceLimits_ ) {
+         lim.maxMin = { nan, nan };
+         lim.percentile = { nan, nan };
+      }
    }
 }
 
@@ -225,15 +258,62 @@ dfloat convert( std::complex< T > v, bool usePhase ) {
    }
 }
 
+// The mapping from input sample values to output uint8 values
+struct Uint8Mapping {
+   bool usePhase;
+   bool logarithmic;
+   bool useModulo;
+   dfloat offset;
+   dfloat scale;
+
+   template< typename TPI >
+   uint8 operator()( TPI value ) const {
+      if( logarithmic ) {
+         return clamp_cast< uint8 >( std::log( convert( value, usePhase ) + offset ) * scale );
+      }
+      if( useModulo ) {
+         dfloat scaled = ( convert( value, usePhase ) + offset ) * scale;
+         scaled = scaled == 0 ? 0 : ( std::fmod( scaled - 1, 255.0 ) + 1 );
+         return clamp_cast< uint8 >( scaled );
+      }
+      return clamp_cast< uint8 >(( convert( value, usePhase ) + offset ) * scale );
+   }
+};
+
+// For integer types of up to 16 bits, we can tabulate the mapping for all possible input values.
+// Returns false if the type doesn't allow this. `lut[ 0 ]` corresponds to input value `lowest`.
+template< typename TPI, typename std::enable_if< std::is_integral< TPI >::value && ( sizeof( TPI ) <= 2 ), int >::type = 0 >
+bool MakeLookupTable( Uint8Mapping const& mapping, std::vector< uint8 >& lut, dip::sint& lowest, dip::uint nSamples ) {
+   lowest = std::numeric_limits< TPI >::lowest();
+   dip::uint size = static_cast< dip::uint >( static_cast< dip::sint >( std::numeric_limits< TPI >::max() ) - lowest + 1 );
+   if( nSamples <= size ) {
+      return false; // Computing the table is more expensive than mapping the samples directly.
+   }
+   lut.resize( size );
+   for( dip::uint ii = 0; ii < size; ++ii ) {
+      lut[ ii ] = mapping( static_cast< TPI >( static_cast< dip::sint >( ii ) + lowest ));
+   }
+   return true;
+}
+template< typename TPI, typename std::enable_if< !( std::is_integral< TPI >::value && ( sizeof( TPI ) <= 2 )), int >::type = 0 >
+bool MakeLookupTable( Uint8Mapping const&, std::vector< uint8 >&, dip::sint&, dip::uint ) {
+   return false;
+}
+
+template< typename TPI >
+dip::uint LookupTableIndex( TPI value, dip::sint lowest ) {
+   return static_cast< dip::uint >( static_cast< dip::sint >( value ) - lowest );
+}
+template< typename TPI >
+dip::uint LookupTableIndex( std::complex< TPI >, dip::sint ) {
+   return 0; // Never called, complex samples are not mapped through a table
+}
+
 template< typename TPI >
 void CastToUint8(
       Image const& slice,
       Image& out,
-      bool usePhase,
-      bool logarithmic,
-      bool useModulo,
-      dip::dfloat offset,
-      dip::dfloat scale
+      Uint8Mapping const& mapping
 ) {
    dip::uint width = slice.Size( 0 );
    dip::uint height = slice.Dimensionality() == 2 ? slice.Size( 1 ) : 1;
@@ -244,29 +324,24 @@ void CastToUint8(
    dip::uint telems = slice.TensorElements();
    dip::sint sliceStrideT = slice.TensorStride();
    dip::sint outStrideT = out.TensorStride();
+   std::vector< uint8 > lut;
+   dip::sint lowest = 0;
+   bool useLut = MakeLookupTable< TPI >( mapping, lut, lowest, width * height * telems );
    for( dip::sint kk = 0; kk < static_cast< dip::sint >( telems ); ++kk ) {
       TPI* slicePtr = static_cast< TPI* >( slice.Pointer( sliceStrideT * kk ) );
       uint8* outPtr = static_cast< uint8* >( out.Pointer( outStrideT * kk ) );
       for( dip::uint jj = 0; jj < height; ++jj ) {
          TPI* iPtr = slicePtr;
          uint8* oPtr = outPtr;
-         if( logarithmic ) {
-            for( dip::uint ii = 0; ii < width; ++ii ) {
-               *oPtr = clamp_cast< uint8 >( std::log( convert( *iPtr, usePhase ) + offset ) * scale );
-               iPtr += sliceStride0;
-               oPtr += outStride0;
-            }
-         } else if( useModulo ) {
+         if( useLut ) {
             for( dip::uint ii = 0; ii < width; ++ii ) {
-               dfloat scaled = ( convert( *iPtr, usePhase ) + offset ) * scale;
-               scaled = scaled == 0 ? 0 : ( std::fmod( scaled - 1, 255.0 ) + 1 );
-               *oPtr = clamp_cast< uint8 >( scaled );
+               *oPtr = lut[ LookupTableIndex( *iPtr, lowest ) ];
                iPtr += sliceStride0;
                oPtr += outStride0;
             }
          } else {
             for( dip::uint ii = 0; ii < width; ++ii ) {
-               *oPtr = clamp_cast< uint8 >(( convert( *iPtr, usePhase ) + offset ) * scale );
+               *oPtr = mapping( *iPtr );
                iPtr += sliceStride0;
                oPtr += outStride0;
             }
@@ -280,11 +355,7 @@ template<>
 void CastToUint8< bin >(
       Image const& slice,
       Image& out,
-      bool /*usePhase*/,
-      bool /*logarithmic*/,
-      bool /*useModulo*/,
-      dip::dfloat /*offset*/,
-      dip::dfloat /*scale*/
+      Uint8Mapping const& /*mapping*/
 ) {
    dip::uint width = slice.Size( 0 );
    dip::uint height = slice.Dimensionality() == 2 ? slice.Size( 1 ) : 1;
@@ -326,20 +397,19 @@ void ImageDisplay::UpdateOutput() {
          }
       }
       // Mapping function
-      bool logarithmic = mappingMode_ == MappingMode::LOGARITHMIC;
-      bool useModulo = mappingMode_ == MappingMode::MODULO;
-      dfloat offset;
-      dfloat scale;
-      if( logarithmic ) {
-         offset = 1.0 - range_.lower;
-         scale = 255.0 / std::log( range_.upper + offset );
+      Uint8Mapping mapping;
+      mapping.logarithmic = mappingMode_ == MappingMode::LOGARITHMIC;
+      mapping.useModulo = mappingMode_ == MappingMode::MODULO;
+      if( mapping.logarithmic ) {
+         mapping.offset = 1.0 - range_.lower;
+         mapping.scale = 255.0 / std::log( range_.upper + mapping.offset );
       } else {
-         offset = -range_.lower;
-         scale = 255.0 / ( range_.upper - range_.lower );
+         mapping.offset = -range_.lower;
+         mapping.scale = 255.0 / ( range_.upper - range_.lower );
       }
       // Complex to real
       Image slice = rgbSlice_.QuickCopy();
-      bool usePhase = false;
+      mapping.usePhase = false;
       if( slice.DataType().IsComplex() ) {
          switch( complexMode_ ) {
             //case ComplexMode::MAGNITUDE:
@@ -347,7 +417,7 @@ void ImageDisplay::UpdateOutput() {
                // Nothing to do.
                break;
             case ComplexMode::PHASE:
-               usePhase = true;
+               mapping.usePhase = true;
                break;
             case ComplexMode::REAL:
                slice = slice.Real();
@@ -361,7 +431,7 @@ void ImageDisplay::UpdateOutput() {
       DIP_ASSERT(( !twoDimOut_ && ( slice.Dimensionality() == 1 )) || ( twoDimOut_ && ( slice.Dimensionality() == 2 )));
       output_.ReForge( slice.Sizes(), slice.TensorElements(), DT_UINT8 );
       // Stretch and convert the data
-      DIP_OVL_CALL_ALL( CastToUint8, ( slice, output_, usePhase, logarithmic, useModulo, offset, scale ), slice.DataType() );
+      DIP_OVL_CALL_ALL( CastToUint8, ( slice, output_, mapping ), slice.DataType() );
       outputIsDirty_ = false;
    }
 }
@@ -270,18 +270,14 @@ void WriteTIFFStrips(
    }
 }
 
-} // namespace
-
-void ImageWriteTIFF(
+// Writes `image` to the current directory of `tiff`
+void WriteTIFFDirectory(
       Image const& image,
-      String const& filename,
-      String const& compression,
-      dip::uint jpegLevel
+      TiffFile& tiff,
+      uint16 compmode,
+      dip::uint jpegLevel,
+      bool reducedResolution
 ) {
-   DIP_THROW_IF( !image.IsForged(), E::IMAGE_NOT_FORGED );
-   DIP_THROW_IF( image.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
-   // TODO: Implement writing of 3D images as a stack of 2D images
-
    // Get image info and quit if we can't write
    DIP_THROW_IF(( image.Size( 0 ) > std::numeric_limits< uint32 >::max() ) ||
                 ( image.Size( 1 ) > std::numeric_limits< uint32 >::max() ), "Image size too large for TIFF file" );
@@ -314,11 +310,11 @@ void ImageWriteTIFF(
             break;
       }
    }
-   uint16 compmode = CompressionTranslate( compression );
-
-   // Create the TIFF file and set the tags
-   TiffFile tiff( filename );
 
+   // Set the tags
+   if( reducedResolution ) {
+      WRITE_TIFF_TAG( tiff, TIFFTAG_SUBFILETYPE, uint32( FILETYPE_REDUCEDIMAGE ));
+   }
    if( image.DataType().IsBinary() ) {
       WRITE_TIFF_TAG( tiff, TIFFTAG_PHOTOMETRIC, uint16( PHOTOMETRIC_MINISBLACK ));
    } else if( image.ColorSpace() == "RGB" ) {
@@ -369,6 +365,45 @@ void ImageWriteTIFF(
    TIFFSetField( tiff, TIFFTAG_RESOLUTIONUNIT, uint16( RESUNIT_CENTIMETER ));
 }
 
+} // namespace
+
+void ImageWriteTIFF(
+      Image const& image,
+      String const& filename,
+      String const& compression,
+      dip::uint jpegLevel
+) {
+   DIP_THROW_IF( !image.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( image.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
+   // TODO: Implement writing of 3D images as a stack of 2D images
+   uint16 compmode = CompressionTranslate( compression );
+   TiffFile tiff( filename );
+   DIP_STACK_TRACE_THIS( WriteTIFFDirectory( image, tiff, compmode, jpegLevel, false ));
+}
+
+void ImageWriteTIFFPyramid(
+      ImageArray const& pyramid,
+      String const& filename,
+      String const& compression,
+      dip::uint jpegLevel
+) {
+   DIP_THROW_IF( pyramid.empty(), E::ARRAY_PARAMETER_EMPTY );
+   for( auto const& level : pyramid ) {
+      DIP_THROW_IF( !level.IsForged(), E::IMAGE_NOT_FORGED );
+      DIP_THROW_IF( level.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
+   }
+   uint16 compmode = CompressionTranslate( compression );
+   TiffFile tiff( filename );
+   for( dip::uint ii = 0; ii < pyramid.size(); ++ii ) {
+      if( ii > 0 ) {
+         if( !TIFFWriteDirectory( tiff )) {
+            DIP_THROW_RUNTIME( "Error writing data" );
+         }
+      }
+      DIP_STACK_TRACE_THIS( WriteTIFFDirectory( pyramid[ ii ], tiff, compmode, jpegLevel, ii > 0 ));
+   }
+}
+
 } // namespace dip
 
 #ifdef DIP__ENABLE_DOCTEST
@@ -398,6 +433,21 @@ DOCTEST_TEST_CASE( "[DIPlib] testing TIFF file reading and writing" ) {
    dip::ImageWriteTIFF( image, "test2.tif" );
    result = dip::ImageReadTIFF( "test2" );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
+
+   // Write a pyramid, each level is a page in the file
+   dip::ImageArray pyramid( 3 );
+   pyramid[ 0 ] = dip::Image( { 40, 30 }, 1, dip::DT_UINT8 );
+   pyramid[ 1 ] = dip::Image( { 20, 15 }, 1, dip::DT_UINT8 );
+   pyramid[ 2 ] = dip::Image( { 10, 8 }, 1, dip::DT_SFLOAT );
+   pyramid[ 0 ].Fill( 10 );
+   pyramid[ 1 ].Fill( 20 );
+   pyramid[ 2 ].Fill( 30 );
+   dip::ImageWriteTIFFPyramid( pyramid, "test2.tif" );
+   DOCTEST_CHECK( dip::ImageReadTIFFInfo( "test2" ).numberOfImages == 3 );
+   for( dip::uint ii = 0; ii < pyramid.size(); ++ii ) {
+      result = dip::ImageReadTIFF( "test2", dip::Range{ static_cast< dip::sint >( ii ) } );
+      DOCTEST_CHECK( dip::testing::CompareImages( pyramid[ ii ], result ));
+   }
 }
 
 #endif // DIP__ENABLE_DOCTEST
@@ -415,6 +465,10 @@ void ImageWriteTIFF( Image const&, String const&, String const&, dip::uint ) {
    DIP_THROW( NOT_AVAILABLE );
 }
 
+void ImageWriteTIFFPyramid( ImageArray const&, String const&, String const&, dip::uint ) {
+   DIP_THROW( NOT_AVAILABLE );
+}
+
 }
 
 #endif // DIP__HAS_TIFF
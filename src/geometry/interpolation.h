@@ -22,6 +22,8 @@
 // NOTE!!! This file only to be included by `resampling.cpp`.
 
 
+#include <array>
+
 #include "diplib/library/types.h"
 #include "diplib/library/sample_iterator.h"
 #include "diplib/dft.h"
@@ -671,6 +673,149 @@ void Dispatch(
    }
 }
 
+// A resampling plan holds, for each output sample, the index of the first input sample it depends on and the
+// weights for the `Taps()` consecutive input samples. It is computed once for a given method, output size, zoom
+// and shift, and applied to each image line. The positions are computed in the same way as in the functions
+// above, but the weights are always computed in double precision.
+// Only for the methods that are a convolution with a kernel of fixed size: linear, cubic and Lanczos. With a
+// zoom of 1, the functions above compute the weights only once per line, and a plan brings no advantage.
+template< typename TPF >
+class ResamplingPlan {
+   public:
+      static bool Supports( Method method, dfloat zoom ) {
+         return ( zoom != 1.0 ) && ( NumberOfTaps( method ) > 0 );
+      }
+
+      ResamplingPlan( Method method, dip::uint outSize, dfloat zoom, dfloat shift ) : taps_( NumberOfTaps( method )) {
+         DIP_ASSERT( taps_ > 0 );
+         index_.resize( outSize );
+         weights_.resize( outSize * taps_ );
+         dip::sint first = 1 - static_cast< dip::sint >( taps_ / 2 ); // index of first tap w.r.t. `floor( position )`
+         dip::sint offset = floor_cast( shift );
+         dfloat pos = shift - static_cast< dfloat >( offset );
+         dfloat step = 1.0 / zoom;
+         TPF* weights = weights_.data();
+         for( dip::uint ii = 0; ii < outSize; ++ii ) {
+            index_[ ii ] = offset + first;
+            ComputeWeights( method, pos, weights );
+            weights += taps_;
+            pos += step;
+            if( pos >= 1.0 ) {
+               dip::sint integerStep = floor_cast( pos );
+               pos -= static_cast< dfloat >( integerStep );
+               offset += integerStep;
+            }
+         }
+      }
+
+      dip::uint Taps() const { return taps_; }
+      dip::uint OutputSize() const { return index_.size(); }
+
+      // Applies the plan to one image line. `input` is the same pointer that would be given to the functions above.
+      template< typename TPI >
+      void Apply( TPI const* input, SampleIterator< TPI > output ) const {
+         switch( taps_ ) {
+            case 2: ApplyTaps< TPI, 2 >( input, output ); break;
+            case 4: ApplyTaps< TPI, 4 >( input, output ); break;
+            case 6: ApplyTaps< TPI, 6 >( input, output ); break;
+            case 8: ApplyTaps< TPI, 8 >( input, output ); break;
+            case 12: ApplyTaps< TPI, 12 >( input, output ); break;
+            case 16: ApplyTaps< TPI, 16 >( input, output ); break;
+            default: DIP_THROW( E::NOT_IMPLEMENTED );
+         }
+      }
+
+   private:
+      static dip::uint NumberOfTaps( Method method ) {
+         switch( method ) {
+            case Method::LINEAR:
+               return 2;
+            case Method::CUBIC_ORDER_3:
+            case Method::LANCZOS2:
+               return 4;
+            case Method::CUBIC_ORDER_4:
+            case Method::LANCZOS3:
+               return 6;
+            case Method::LANCZOS4:
+               return 8;
+            case Method::LANCZOS6:
+               return 12;
+            case Method::LANCZOS8:
+               return 16;
+            default:
+               return 0;
+         }
+      }
+
+      // Computes the weights for `pos` in [0,1), the same as the functions above
+      void ComputeWeights( Method method, dfloat pos, TPF* weights ) const {
+         dfloat pos2 = pos * pos;
+         dfloat pos3 = pos2 * pos;
+         switch( method ) {
+            case Method::LINEAR:
+               weights[ 0 ] = static_cast< TPF >( 1.0 - pos );
+               weights[ 1 ] = static_cast< TPF >( pos );
+               break;
+            case Method::CUBIC_ORDER_3:
+               weights[ 0 ] = static_cast< TPF >(( -pos3 + 2.0 * pos2 - pos ) / 2.0 );
+               weights[ 1 ] = static_cast< TPF >(( 3.0 * pos3 - 5.0 * pos2 + 2.0 ) / 2.0 );
+               weights[ 2 ] = static_cast< TPF >(( -3.0 * pos3 + 4.0 * pos2 + pos ) / 2.0 );
+               weights[ 3 ] = static_cast< TPF >(( pos3 - pos2 ) / 2.0 );
+               break;
+            case Method::CUBIC_ORDER_4:
+               weights[ 0 ] = static_cast< TPF >(( pos3 - 2.0 * pos2 + pos ) / 12.0 );
+               weights[ 1 ] = static_cast< TPF >(( -7.0 * pos3 + 15.0 * pos2 - 8.0 * pos ) / 12.0 );
+               weights[ 2 ] = static_cast< TPF >(( 16.0 * pos3 - 28.0 * pos2 + 12.0 ) / 12.0 );
+               weights[ 3 ] = static_cast< TPF >(( -16.0 * pos3 + 20.0 * pos2 + 8.0 * pos ) / 12.0 );
+               weights[ 4 ] = static_cast< TPF >(( 7.0 * pos3 - 6.0 * pos2 - pos ) / 12.0 );
+               weights[ 5 ] = static_cast< TPF >(( -pos3 + pos2 ) / 12.0 );
+               break;
+            default: { // Lanczos
+               dip::uint a = taps_ / 2;
+               std::fill( weights, weights + taps_, TPF( 0 ));
+               if( pos < 1.0e-8 ) {
+                  weights[ a - 1 ] = 1;      // avoid computing the sinc function at x=0.
+               } else if( pos > 1.0 - 1.0e-8 ) {
+                  weights[ a ] = 1;          // avoid computing the sinc function at x=0.
+               } else {
+                  long double la = static_cast< long double >( a );
+                  std::array< dfloat, 16 > filter;
+                  dfloat sum = 0;
+                  for( dip::uint jj = 0; jj < taps_; ++jj ) {
+                     long double x = pi * ( pos - ( static_cast< long double >( jj ) - la + 1 ));
+                     filter[ jj ] = static_cast< dfloat >( la * std::sin( x ) * std::sin( x / la ) / ( x * x ));
+                     sum += filter[ jj ];
+                  }
+                  for( dip::uint jj = 0; jj < taps_; ++jj ) {
+                     weights[ jj ] = static_cast< TPF >( filter[ jj ] / sum ); // normalization avoids a large error
+                  }
+               }
+               break;
+            }
+         }
+      }
+
+      // With a compile-time number of taps, the compiler can unroll and vectorize the inner loop
+      template< typename TPI, dip::uint taps >
+      void ApplyTaps( TPI const* input, SampleIterator< TPI > output ) const {
+         TPF const* weights = weights_.data();
+         for( dip::uint ii = 0; ii < index_.size(); ++ii ) {
+            TPI const* in = input + index_[ ii ];
+            TPI value = in[ 0 ] * weights[ 0 ];
+            for( dip::uint jj = 1; jj < taps; ++jj ) {
+               value += in[ jj ] * weights[ jj ];
+            }
+            *output = value;
+            ++output;
+            weights += taps;
+         }
+      }
+
+      dip::uint taps_;
+      std::vector< dip::sint > index_;   // One per output sample
+      std::vector< TPF > weights_;       // `taps_` per output sample
+};
+
 } // namespace interpolation
 } // namespace dip
 
@@ -1057,4 +1202,42 @@ DOCTEST_TEST_CASE("[DIPlib] testing the Fourier interpolation function") {
 
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the interpolation resampling plan") {
+   std::vector< dip::sfloat > buffer( 100 );
+   for( dip::uint ii = 0; ii < buffer.size(); ++ii ) {
+      buffer[ ii ] = static_cast< dip::sfloat >( std::sin( 0.3 * static_cast< dip::dfloat >( ii )) * 50.0 + 0.1 * static_cast< dip::dfloat >( ii ));
+   }
+   dip::sfloat* input = buffer.data() + 20;
+   dip::uint inSize = 60;
+   dip::interpolation::Method methods[] = {
+         dip::interpolation::Method::LINEAR,
+         dip::interpolation::Method::CUBIC_ORDER_3,
+         dip::interpolation::Method::CUBIC_ORDER_4,
+         dip::interpolation::Method::LANCZOS2,
+         dip::interpolation::Method::LANCZOS3,
+         dip::interpolation::Method::LANCZOS4,
+         dip::interpolation::Method::LANCZOS6,
+         dip::interpolation::Method::LANCZOS8
+   };
+   for( auto method : methods ) {
+      for( dip::dfloat zoom : { 3.3, 0.41 } ) {
+         dip::uint outSize = dip::interpolation::ComputeOutputSize( inSize, zoom );
+         dip::dfloat shift = -0.37;
+         DOCTEST_REQUIRE( dip::interpolation::ResamplingPlan< dip::sfloat >::Supports( method, zoom ));
+         dip::interpolation::ResamplingPlan< dip::sfloat > plan( method, outSize, zoom, shift );
+         std::vector< dip::sfloat > expected( outSize, -1e6f );
+         std::vector< dip::sfloat > output( outSize, -1e6f );
+         dip::interpolation::Dispatch< dip::sfloat >( method, input, expected.data(), outSize, zoom, shift, nullptr );
+         plan.Apply( input, dip::SampleIterator< dip::sfloat >{ output.data() } );
+         bool error = false;
+         for( dip::uint ii = 0; ii < outSize; ++ii ) {
+            error |= abs_diff( output[ ii ], expected[ ii ] ) > 1e-3;
+         }
+         DOCTEST_CHECK_FALSE( error );
+      }
+   }
+   DOCTEST_CHECK_FALSE( dip::interpolation::ResamplingPlan< dip::sfloat >::Supports( dip::interpolation::Method::LINEAR, 1.0 ));
+   DOCTEST_CHECK_FALSE( dip::interpolation::ResamplingPlan< dip::sfloat >::Supports( dip::interpolation::Method::BSPLINE, 2.0 ));
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -0,0 +1,338 @@
+/*
+ * DIPlib 3.0
+ * This file contains definitions for Gaussian and Laplacian pyramids
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diplib.h"
+#include "diplib/geometry.h"
+#include "diplib/boundary.h"
+#include "diplib/framework.h"
+#include "diplib/overload.h"
+#include "diplib/iterators.h"
+
+namespace dip {
+
+namespace {
+
+// Convolution with [1 4 6 4 1]/16, computed only at even input locations
+template< typename TPI >
+class PyramidReduceLineFilter : public Framework::SeparableLineFilter {
+      using TPF = FloatType< TPI >;
+   public:
+      virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint, dip::uint, dip::uint ) override {
+         return lineLength * 4; // 8 operations per output sample, half as many output samples as input samples
+      }
+      virtual void Filter( Framework::SeparableLineFilterParameters const& params ) override {
+         TPI const* in = static_cast< TPI const* >( params.inBuffer.buffer );
+         DIP_ASSERT( params.inBuffer.stride == 1 );
+         DIP_ASSERT( params.inBuffer.border >= 2 );
+         SampleIterator< TPI > out{ static_cast< TPI* >( params.outBuffer.buffer ), params.outBuffer.stride };
+         dip::uint length = params.outBuffer.length;
+         for( dip::uint ii = 0; ii < length; ++ii, in += 2, ++out ) {
+            *out = static_cast< TPI >(( in[ -2 ] + in[ 2 ] + TPF( 4 ) * ( in[ -1 ] + in[ 1 ] ) + TPF( 6 ) * in[ 0 ] ) / TPF( 16 ));
+         }
+      }
+};
+
+// Convolution with 2*[1 4 6 4 1]/16 of the input upsampled by inserting zeros. The zeros are not stored, even output
+// samples see the weights [1 6 1]/8, odd output samples see the weights [4 4]/8.
+template< typename TPI >
+class PyramidExpandLineFilter : public Framework::SeparableLineFilter {
+      using TPF = FloatType< TPI >;
+   public:
+      virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint, dip::uint, dip::uint ) override {
+         return lineLength * 8; // 4 operations per output sample, twice as many output samples as input samples
+      }
+      virtual void Filter( Framework::SeparableLineFilterParameters const& params ) override {
+         TPI const* in = static_cast< TPI const* >( params.inBuffer.buffer );
+         DIP_ASSERT( params.inBuffer.stride == 1 );
+         DIP_ASSERT( params.inBuffer.border >= 1 );
+         SampleIterator< TPI > out{ static_cast< TPI* >( params.outBuffer.buffer ), params.outBuffer.stride };
+         dip::uint length = params.outBuffer.length;
+         for( dip::uint ii = 0; ii < length / 2; ++ii, ++in ) {
+            *out = static_cast< TPI >(( in[ -1 ] + in[ 1 ] + TPF( 6 ) * in[ 0 ] ) / TPF( 8 ));
+            ++out;
+            *out = static_cast< TPI >(( in[ 0 ] + in[ 1 ] ) / TPF( 2 ));
+            ++out;
+         }
+         if( length & 1u ) {
+            *out = static_cast< TPI >(( in[ -1 ] + in[ 1 ] + TPF( 6 ) * in[ 0 ] ) / TPF( 8 ));
+         }
+      }
+};
+
+} // namespace
+
+void PyramidReduce(
+      Image const& c_in,
+      Image& out,
+      StringArray const& boundaryCondition
+) {
+   DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   dip::uint nDims = c_in.Dimensionality();
+   DIP_THROW_IF( nDims == 0, E::DIMENSIONALITY_NOT_SUPPORTED );
+   BoundaryConditionArray bc;
+   DIP_STACK_TRACE_THIS( bc = StringArrayToBoundaryConditionArray( boundaryCondition ));
+
+   // Preserve input
+   Image in = c_in.QuickCopy();
+   PixelSize pixelSize = c_in.PixelSize();
+   String colorSpace = c_in.ColorSpace();
+
+   // Calculate new output sizes and other processing parameters
+   UnsignedArray outSizes = in.Sizes();
+   BooleanArray process( nDims, false );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      if( outSizes[ ii ] > 1 ) {
+         process[ ii ] = true;
+         outSizes[ ii ] = ( outSizes[ ii ] + 1 ) / 2;
+         pixelSize.Scale( ii, 2.0 );
+      }
+   }
+   UnsignedArray borders( nDims, 2 );
+
+   // Create output
+   DataType outType = in.DataType().IsBinary() ? DataType::SuggestFlex( in.DataType() ) : in.DataType();
+   out.ReForge( outSizes, in.TensorElements(), outType, Option::AcceptDataTypeChange::DO_ALLOW );
+   out.SetColorSpace( colorSpace );
+   DataType bufferType = DataType::SuggestFlex( out.DataType() );
+
+   // Find line filter
+   std::unique_ptr< Framework::SeparableLineFilter > lineFilter;
+   DIP_OVL_NEW_FLEX( lineFilter, PyramidReduceLineFilter, (), bufferType );
+
+   // Call line filter through framework
+   Framework::Separable( in, out, bufferType, out.DataType(), process, borders, bc, *lineFilter,
+                         Framework::SeparableOption::AsScalarImage + Framework::SeparableOption::DontResizeOutput + Framework::SeparableOption::UseInputBuffer );
+   out.SetPixelSize( pixelSize ); // The framework copies the input pixel size, which is not correct here
+}
+
+void PyramidExpand(
+      Image const& c_in,
+      Image& out,
+      UnsignedArray const& sizes,
+      StringArray const& boundaryCondition
+) {
+   DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   dip::uint nDims = c_in.Dimensionality();
+   DIP_THROW_IF( nDims == 0, E::DIMENSIONALITY_NOT_SUPPORTED );
+   BoundaryConditionArray bc;
+   DIP_STACK_TRACE_THIS( bc = StringArrayToBoundaryConditionArray( boundaryCondition ));
+
+   // Preserve input
+   Image in = c_in.QuickCopy();
+   PixelSize pixelSize = c_in.PixelSize();
+   String colorSpace = c_in.ColorSpace();
+
+   // Calculate new output sizes and other processing parameters
+   UnsignedArray outSizes = sizes;
+   if( outSizes.empty() ) {
+      outSizes = in.Sizes();
+      for( auto& sz : outSizes ) {
+         if( sz > 1 ) { // Singleton dimensions are not processed by `PyramidReduce` either
+            sz *= 2;
+         }
+      }
+   }
+   DIP_THROW_IF( outSizes.size() != nDims, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   BooleanArray process( nDims, false );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      DIP_THROW_IF(( outSizes[ ii ] + 1 ) / 2 != in.Size( ii ), E::SIZES_DONT_MATCH );
+      if( outSizes[ ii ] != in.Size( ii )) {
+         process[ ii ] = true;
+         pixelSize.Scale( ii, 0.5 );
+      }
+   }
+   UnsignedArray borders( nDims, 1 );
+
+   // Create output
+   DataType outType = in.DataType().IsBinary() ? DataType::SuggestFlex( in.DataType() ) : in.DataType();
+   out.ReForge( outSizes, in.TensorElements(), outType, Option::AcceptDataTypeChange::DO_ALLOW );
+   out.SetColorSpace( colorSpace );
+   DataType bufferType = DataType::SuggestFlex( out.DataType() );
+
+   // Find line filter
+   std::unique_ptr< Framework::SeparableLineFilter > lineFilter;
+   DIP_OVL_NEW_FLEX( lineFilter, PyramidExpandLineFilter, (), bufferType );
+
+   // Call line filter through framework
+   Framework::Separable( in, out, bufferType, out.DataType(), process, borders, bc, *lineFilter,
+                         Framework::SeparableOption::AsScalarImage + Framework::SeparableOption::DontResizeOutput + Framework::SeparableOption::UseInputBuffer );
+   out.SetPixelSize( pixelSize ); // The framework copies the input pixel size, which is not correct here
+}
+
+namespace {
+
+dip::uint PyramidLevels( UnsignedArray const& sizes, dip::uint nLevels ) {
+   if( nLevels > 0 ) {
+      return nLevels;
+   }
+   dip::uint maxSize = *std::max_element( sizes.begin(), sizes.end() );
+   nLevels = 1;
+   while( maxSize >= 8 ) {
+      maxSize = ( maxSize + 1 ) / 2;
+      ++nLevels;
+   }
+   return nLevels;
+}
+
+} // namespace
+
+ImageArray GaussianPyramid(
+      Image const& in,
+      dip::uint nLevels,
+      StringArray const& boundaryCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( in.Dimensionality() == 0, E::DIMENSIONALITY_NOT_SUPPORTED );
+   nLevels = PyramidLevels( in.Sizes(), nLevels );
+   ImageArray out( nLevels );
+   out[ 0 ] = in;
+   for( dip::uint ii = 1; ii < nLevels; ++ii ) {
+      DIP_STACK_TRACE_THIS( PyramidReduce( out[ ii - 1 ], out[ ii ], boundaryCondition ));
+   }
+   return out;
+}
+
+ImageArray LaplacianPyramid(
+      Image const& in,
+      dip::uint nLevels,
+      StringArray const& boundaryCondition
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( in.Dimensionality() == 0, E::DIMENSIONALITY_NOT_SUPPORTED );
+   nLevels = PyramidLevels( in.Sizes(), nLevels );
+   DataType flexType = DataType::SuggestFlex( in.DataType() );
+   ImageArray out( nLevels );
+   // `current` is the current level of the Gaussian pyramid, `out[ ii ]` is computed from it and the next level.
+   // The input is not copied if it already has a flex type, we never write to `current`.
+   Image current = in.DataType() == flexType ? in.QuickCopy() : Convert( in, flexType );
+   for( dip::uint ii = 0; ii < nLevels - 1; ++ii ) {
+      Image next;
+      DIP_START_STACK_TRACE
+         PyramidReduce( current, next, boundaryCondition );
+         PyramidExpand( next, out[ ii ], current.Sizes(), boundaryCondition );
+         Subtract( current, out[ ii ], out[ ii ], flexType );
+      DIP_END_STACK_TRACE
+      current = std::move( next );
+   }
+   out.back() = current;
+   return out;
+}
+
+void LaplacianPyramidReconstruction(
+      ImageArray const& pyramid,
+      Image& out,
+      StringArray const& boundaryCondition
+) {
+   DIP_THROW_IF( pyramid.empty(), E::ARRAY_PARAMETER_EMPTY );
+   for( auto const& level : pyramid ) {
+      DIP_THROW_IF( !level.IsForged(), E::IMAGE_NOT_FORGED );
+   }
+   if( pyramid.size() == 1 ) {
+      out.Copy( pyramid[ 0 ] );
+      return;
+   }
+   Image current = pyramid.back();
+   for( dip::uint ii = pyramid.size() - 1; ii > 1; --ii ) {
+      Image const& level = pyramid[ ii - 1 ];
+      Image next;
+      DIP_START_STACK_TRACE
+         PyramidExpand( current, next, level.Sizes(), boundaryCondition );
+         Add( next, level, next, next.DataType() );
+      DIP_END_STACK_TRACE
+      current = std::move( next );
+   }
+   // The last level is written directly into `out`
+   Image expanded;
+   DIP_START_STACK_TRACE
+      PyramidExpand( current, expanded, pyramid[ 0 ].Sizes(), boundaryCondition );
+      Add( expanded, pyramid[ 0 ], out, expanded.DataType() );
+   DIP_END_STACK_TRACE
+}
+
+} // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/statistics.h"
+#include "diplib/linear.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing Gaussian and Laplacian pyramids") {
+   dip::Image img{ dip::UnsignedArray{ 37, 24 }, 1, dip::DT_SFLOAT };
+   img.Fill( 3.0 );
+   img.SetPixelSize( dip::PhysicalQuantityArray{ 0.5 * dip::PhysicalQuantity::Micrometer(), 0.5 * dip::PhysicalQuantity::Micrometer() } );
+
+   // A constant image remains constant
+   dip::Image reduced = dip::PyramidReduce( img );
+   DOCTEST_CHECK( reduced.Sizes() == dip::UnsignedArray{ 19, 12 } );
+   DOCTEST_CHECK( reduced.PixelSize( 0 ) == 1.0 * dip::PhysicalQuantity::Micrometer() );
+   DOCTEST_CHECK( dip::Maximum( reduced ).As< dip::dfloat >() == doctest::Approx( 3.0 ));
+   DOCTEST_CHECK( dip::Minimum( reduced ).As< dip::dfloat >() == doctest::Approx( 3.0 ));
+   dip::Image expanded = dip::PyramidExpand( reduced, img.Sizes() );
+   DOCTEST_CHECK( expanded.Sizes() == img.Sizes() );
+   DOCTEST_CHECK( expanded.PixelSize( 0 ) == 0.5 * dip::PhysicalQuantity::Micrometer() );
+   DOCTEST_CHECK( dip::Maximum( expanded ).As< dip::dfloat >() == doctest::Approx( 3.0 ));
+   DOCTEST_CHECK( dip::Minimum( expanded ).As< dip::dfloat >() == doctest::Approx( 3.0 ));
+
+   // Singleton dimensions are preserved by both reduction and the default expansion
+   img = dip::Image{ dip::UnsignedArray{ 10, 1, 6 }, 1, dip::DT_SFLOAT };
+   img.Fill( 1.0 );
+   reduced = dip::PyramidReduce( img );
+   DOCTEST_CHECK( reduced.Sizes() == dip::UnsignedArray{ 5, 1, 3 } );
+   expanded = dip::PyramidExpand( reduced );
+   DOCTEST_CHECK( expanded.Sizes() == img.Sizes() );
+
+   // Fused smooth+decimate matches smoothing with the binomial kernel and subsampling
+   img = dip::Image{ dip::UnsignedArray{ 40 }, 1, dip::DT_DFLOAT };
+   img.Fill( 0.0 );
+   img.At( 20 ) = 16.0;
+   img.At( 23 ) = 32.0;
+   reduced = dip::PyramidReduce( img );
+   dip::Image kernel{ dip::UnsignedArray{ 5 }, 1, dip::DT_DFLOAT };
+   kernel.At( 0 ) = kernel.At( 4 ) = 1.0 / 16.0;
+   kernel.At( 1 ) = kernel.At( 3 ) = 4.0 / 16.0;
+   kernel.At( 2 ) = 6.0 / 16.0;
+   dip::Image smoothed = dip::GeneralConvolution( img, kernel );
+   smoothed = smoothed.At( dip::Range{ 0, -1, 2 } );
+   DOCTEST_CHECK( dip::MaximumAbs( reduced - smoothed ).As< dip::dfloat >() < 1e-12 );
+
+   // Gaussian pyramid levels
+   img = dip::Image{ dip::UnsignedArray{ 64, 50 }, 1, dip::DT_UINT8 };
+   img.Fill( 100 );
+   dip::ImageArray gauss = dip::GaussianPyramid( img );
+   DOCTEST_REQUIRE( gauss.size() == 5 );
+   DOCTEST_CHECK( gauss[ 4 ].Sizes() == dip::UnsignedArray{ 4, 4 } );
+   DOCTEST_CHECK( gauss[ 4 ].DataType() == dip::DT_UINT8 );
+
+   // Laplacian pyramid reconstruction is exact
+   dip::Random random( 0 );
+   img = dip::Image{ dip::UnsignedArray{ 45, 31 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0.0 );
+   dip::UniformNoise( img, img, random, 0.0, 255.0 );
+   dip::ImageArray laplace = dip::LaplacianPyramid( img, 4 );
+   DOCTEST_REQUIRE( laplace.size() == 4 );
+   DOCTEST_CHECK( laplace[ 3 ].Sizes() == dip::UnsignedArray{ 6, 4 } );
+   dip::Image recon = dip::LaplacianPyramidReconstruction( laplace );
+   DOCTEST_CHECK( recon.Sizes() == img.Sizes() );
+   DOCTEST_CHECK( dip::MaximumAbs( recon - img ).As< dip::dfloat >() < 1e-3 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
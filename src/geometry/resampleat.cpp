@@ -18,9 +18,11 @@
  * limitations under the License.
  */
 
+#include <vector>
+
 #include "diplib.h"
 #include "diplib/geometry.h"
-#include "diplib/generic_iterators.h"
+#include "diplib/framework.h"
 #include "diplib/overload.h"
 
 namespace dip {
@@ -45,18 +47,6 @@ Method ParseMethod( String const& method ) {
    }
 }
 
-// Takes `coords` and subtracts the integer value. The base pixel offset is returned
-UnsignedArray GetIntegerCoordinates( Image const& in, FloatArray& coords ) {
-   UnsignedArray intCoord{ coords };
-   for( dip::uint ii = 0; ii < coords.size(); ++ii ) {
-      if( intCoord[ ii ] == in.Size( ii ) - 1 ) {
-         --intCoord[ ii ];
-      }
-      coords[ ii ] -= static_cast< dfloat >( intCoord[ ii ] );
-   }
-   return intCoord;
-}
-
 //
 // 1D interpolation functions. TPD is dfloat or dcomplex
 //
@@ -66,123 +56,416 @@ TPD Linear1D( TPD a, TPD b, dfloat pos ) {
    return a * ( 1.0 - pos ) + b * pos;
 }
 
-template< typename TPD >
-TPD ThirdOrderCubicSpline1D( TPD a, TPD b, TPD c, TPD d, dfloat pos ) {
+inline void ThirdOrderCubicSplineWeights( dfloat pos, dfloat* weights ) {
    dfloat pos2 = pos * pos;
    dfloat pos3 = pos2 * pos;
-   dfloat filter_m1 = ( -pos3 + 2.0 * pos2 - pos ) / 2.0;
-   dfloat filter__0 = ( 3.0 * pos3 - 5.0 * pos2 + 2.0) / 2.0;
-   dfloat filter__1 = ( -3.0 * pos3 + 4.0 * pos2 + pos ) / 2.0;
-   dfloat filter__2 = ( pos3 - pos2 ) / 2.0;
-   return a * filter_m1 + b * filter__0 + c * filter__1 + d * filter__2;
+   weights[ 0 ] = ( -pos3 + 2.0 * pos2 - pos ) / 2.0;
+   weights[ 1 ] = ( 3.0 * pos3 - 5.0 * pos2 + 2.0) / 2.0;
+   weights[ 2 ] = ( -3.0 * pos3 + 4.0 * pos2 + pos ) / 2.0;
+   weights[ 3 ] = ( pos3 - pos2 ) / 2.0;
 }
 
 //
-// Recursive nD interpolation functions, call the 1D versions. TPI is the input image type.
+// Interpolates the image at arbitrary sub-pixel locations. 2D and 3D images use dedicated kernels, other
+// dimensionalities use a generic kernel that loops over all 2^n (linear) or 4^n (cubic) neighbors.
+// All buffers are allocated in the constructor, so sampling does not allocate. Each thread needs its own copy.
+// TPO is the output sample type, usually the same as the input sample type TPI.
 //
 
+template< typename TPI, typename TPO = TPI >
+class Interpolator {
+      using TPD = DoubleType< TPI >;
+      using SampleFunction = void ( Interpolator::* )( dfloat const*, TPO*, dip::sint );
+   public:
+      Interpolator( Image const& in, Method method ) :
+            origin_( static_cast< TPI const* >( in.Origin() )),
+            sizes_( in.Sizes() ), strides_( in.Strides() ),
+            tensorStride_( in.TensorStride() ), nTensor_( in.TensorElements() ), nDims_( in.Dimensionality() ) {
+         switch( method ) {
+            case Method::NEAREST_NEIGHBOR:
+               sample_ = &Interpolator::NearestNeighbor;
+               break;
+            case Method::LINEAR:
+               sample_ = nDims_ == 2 ? &Interpolator::Linear2D
+                       : nDims_ == 3 ? &Interpolator::Linear3D
+                       : &Interpolator::SeparableND< 2 >;
+               break;
+            case Method::CUBIC_ORDER_3:
+               sample_ = nDims_ == 2 ? &Interpolator::ThirdOrderCubicSpline2D
+                       : nDims_ == 3 ? &Interpolator::ThirdOrderCubicSpline3D
+                       : &Interpolator::SeparableND< 4 >;
+               break;
+         }
+         offsets_.resize( 4 * nDims_ );
+         weights_.resize( 4 * nDims_ );
+      }
+
+      // Tests whether `pos` is within the image domain, we do not extrapolate
+      bool IsInside( dfloat const* pos ) const {
+         for( dip::uint ii = 0; ii < nDims_; ++ii ) {
+            if( !( pos[ ii ] >= 0.0 ) || ( pos[ ii ] > static_cast< dfloat >( sizes_[ ii ] - 1 ))) {
+               return false; // also false for NaN
+            }
+         }
+         return true;
+      }
+
+      // Writes the value at `pos` to the `nTensor_` samples at `out`; `pos` must be inside the image domain
+      void Sample( dfloat const* pos, TPO* out, dip::sint outTensorStride ) {
+         ( this->*sample_ )( pos, out, outTensorStride );
+      }
+
+   private:
+      TPI const* origin_;
+      UnsignedArray sizes_;
+      IntegerArray strides_;
+      dip::sint tensorStride_;
+      dip::uint nTensor_;
+      dip::uint nDims_;
+      SampleFunction sample_ = nullptr;
+      std::vector< dip::sint > offsets_; // Per dimension, offsets to the 2 or 4 neighbors (generic kernel)
+      std::vector< dfloat > weights_;    // Per dimension, weights for the 2 or 4 neighbors (generic kernel)
+
+      // Finds the pixel at or before `pos` along dimension `dim`. At the last pixel `frac` is 0,
+      // and `step` is 0 so that we never read outside the image.
+      void LinearNeighbors( dfloat pos, dip::uint dim, dip::sint& offset, dip::sint& step, dfloat& frac ) const {
+         dip::sint last = static_cast< dip::sint >( sizes_[ dim ] ) - 1;
+         dip::sint index = std::min( floor_cast( pos ), last );
+         frac = pos - static_cast< dfloat >( index );
+         offset = index * strides_[ dim ];
+         step = index < last ? strides_[ dim ] : 0;
+      }
+
+      // Finds the 4 pixels around `pos` along dimension `dim`, and their weights. Pixels outside
+      // the image are replaced by the nearest one inside.
+      void CubicNeighbors( dfloat pos, dip::uint dim, dip::sint* offsets, dfloat* weights ) const {
+         dip::sint last = static_cast< dip::sint >( sizes_[ dim ] ) - 1;
+         dip::sint index = std::min( floor_cast( pos ), last );
+         ThirdOrderCubicSplineWeights( pos - static_cast< dfloat >( index ), weights );
+         for( dip::sint jj = 0; jj < 4; ++jj ) {
+            offsets[ jj ] = clamp( index - 1 + jj, dip::sint( 0 ), last ) * strides_[ dim ];
+         }
+      }
+
+      void NearestNeighbor( dfloat const* pos, TPO* out, dip::sint outTensorStride ) {
+         TPI const* src = origin_;
+         for( dip::uint ii = 0; ii < nDims_; ++ii ) {
+            dip::sint index = static_cast< dip::sint >( std::ceil( pos[ ii ] - 0.5 )); // rounds x.5 down
+            src += index * strides_[ ii ];
+         }
+         for( dip::uint jj = 0; jj < nTensor_; ++jj, src += tensorStride_, out += outTensorStride ) {
+            *out = clamp_cast< TPO >( *src );
+         }
+      }
+
+      void Linear2D( dfloat const* pos, TPO* out, dip::sint outTensorStride ) {
+         dip::sint offset0, offset1, step0, step1;
+         dfloat frac0, frac1;
+         LinearNeighbors( pos[ 0 ], 0, offset0, step0, frac0 );
+         LinearNeighbors( pos[ 1 ], 1, offset1, step1, frac1 );
+         TPI const* src = origin_ + offset0 + offset1;
+         for( dip::uint jj = 0; jj < nTensor_; ++jj, src += tensorStride_, out += outTensorStride ) {
+            TPD a = Linear1D( static_cast< TPD >( src[ 0 ] ), static_cast< TPD >( src[ step0 ] ), frac0 );
+            TPD b = Linear1D( static_cast< TPD >( src[ step1 ] ), static_cast< TPD >( src[ step1 + step0 ] ), frac0 );
+            *out = clamp_cast< TPO >( Linear1D( a, b, frac1 ));
+         }
+      }
+
+      void Linear3D( dfloat const* pos, TPO* out, dip::sint outTensorStride ) {
+         dip::sint offset0, offset1, offset2, step0, step1, step2;
+         dfloat frac0, frac1, frac2;
+         LinearNeighbors( pos[ 0 ], 0, offset0, step0, frac0 );
+         LinearNeighbors( pos[ 1 ], 1, offset1, step1, frac1 );
+         LinearNeighbors( pos[ 2 ], 2, offset2, step2, frac2 );
+         TPI const* src = origin_ + offset0 + offset1 + offset2;
+         for( dip::uint jj = 0; jj < nTensor_; ++jj, src += tensorStride_, out += outTensorStride ) {
+            TPI const* plane = src;
+            TPD a = Linear1D( static_cast< TPD >( plane[ 0 ] ), static_cast< TPD >( plane[ step0 ] ), frac0 );
+            TPD b = Linear1D( static_cast< TPD >( plane[ step1 ] ), static_cast< TPD >( plane[ step1 + step0 ] ), frac0 );
+            TPD c = Linear1D( a, b, frac1 );
+            plane += step2;
+            a = Linear1D( static_cast< TPD >( plane[ 0 ] ), static_cast< TPD >( plane[ step0 ] ), frac0 );
+            b = Linear1D( static_cast< TPD >( plane[ step1 ] ), static_cast< TPD >( plane[ step1 + step0 ] ), frac0 );
+            *out = clamp_cast< TPO >( Linear1D( c, Linear1D( a, b, frac1 ), frac2 ));
+         }
+      }
+
+      void ThirdOrderCubicSpline2D( dfloat const* pos, TPO* out, dip::sint outTensorStride ) {
+         dip::sint offsets0[ 4 ], offsets1[ 4 ];
+         dfloat weights0[ 4 ], weights1[ 4 ];
+         CubicNeighbors( pos[ 0 ], 0, offsets0, weights0 );
+         CubicNeighbors( pos[ 1 ], 1, offsets1, weights1 );
+         TPI const* src = origin_;
+         for( dip::uint jj = 0; jj < nTensor_; ++jj, src += tensorStride_, out += outTensorStride ) {
+            TPD value = 0;
+            for( dip::uint i1 = 0; i1 < 4; ++i1 ) {
+               TPI const* line = src + offsets1[ i1 ];
+               TPD lineValue = 0;
+               for( dip::uint i0 = 0; i0 < 4; ++i0 ) {
+                  lineValue += static_cast< TPD >( line[ offsets0[ i0 ]] ) * weights0[ i0 ];
+               }
+               value += lineValue * weights1[ i1 ];
+            }
+            *out = clamp_cast< TPO >( value );
+         }
+      }
+
+      void ThirdOrderCubicSpline3D( dfloat const* pos, TPO* out, dip::sint outTensorStride ) {
+         dip::sint offsets0[ 4 ], offsets1[ 4 ], offsets2[ 4 ];
+         dfloat weights0[ 4 ], weights1[ 4 ], weights2[ 4 ];
+         CubicNeighbors( pos[ 0 ], 0, offsets0, weights0 );
+         CubicNeighbors( pos[ 1 ], 1, offsets1, weights1 );
+         CubicNeighbors( pos[ 2 ], 2, offsets2, weights2 );
+         TPI const* src = origin_;
+         for( dip::uint jj = 0; jj < nTensor_; ++jj, src += tensorStride_, out += outTensorStride ) {
+            TPD value = 0;
+            for( dip::uint i2 = 0; i2 < 4; ++i2 ) {
+               TPD planeValue = 0;
+               for( dip::uint i1 = 0; i1 < 4; ++i1 ) {
+                  TPI const* line = src + offsets2[ i2 ] + offsets1[ i1 ];
+                  TPD lineValue = 0;
+                  for( dip::uint i0 = 0; i0 < 4; ++i0 ) {
+                     lineValue += static_cast< TPD >( line[ offsets0[ i0 ]] ) * weights0[ i0 ];
+                  }
+                  planeValue += lineValue * weights1[ i1 ];
+               }
+               value += planeValue * weights2[ i2 ];
+            }
+            *out = clamp_cast< TPO >( value );
+         }
+      }
+
+      // Generic kernel for any dimensionality, with N = 2 for linear and N = 4 for cubic interpolation
+      template< dip::uint N >
+      void SeparableND( dfloat const* pos, TPO* out, dip::sint outTensorStride ) {
+         dip::uint nNeighbors = 1;
+         for( dip::uint ii = 0; ii < nDims_; ++ii ) {
+            dip::sint* offsets = offsets_.data() + ii * N;
+            dfloat* weights = weights_.data() + ii * N;
+            if( N == 2 ) {
+               dip::sint step;
+               dfloat frac;
+               LinearNeighbors( pos[ ii ], ii, offsets[ 0 ], step, frac );
+               offsets[ 1 ] = offsets[ 0 ] + step;
+               weights[ 0 ] = 1.0 - frac;
+               weights[ 1 ] = frac;
+            } else {
+               CubicNeighbors( pos[ ii ], ii, offsets, weights );
+            }
+            nNeighbors *= N;
+         }
+         TPI const* src = origin_;
+         for( dip::uint jj = 0; jj < nTensor_; ++jj, src += tensorStride_, out += outTensorStride ) {
+            TPD value = 0;
+            for( dip::uint kk = 0; kk < nNeighbors; ++kk ) {
+               dip::uint index = kk;
+               dip::sint offset = 0;
+               dfloat weight = 1.0;
+               for( dip::uint ii = 0; ii < nDims_; ++ii ) {
+                  dip::uint n = ii * N + index % N;
+                  index /= N;
+                  offset += offsets_[ n ];
+                  weight *= weights_[ n ];
+               }
+               value += static_cast< TPD >( src[ offset ] ) * weight;
+            }
+            *out = clamp_cast< TPO >( value );
+         }
+      }
+};
+
+template< typename TPI, typename TPO >
+void ResampleAtInternal( Image const& in, Image& out, FloatCoordinateArray const& coordinates, Method method ) {
+   Interpolator< TPI, TPO > interpolator( in, method );
+   TPO* dest = static_cast< TPO* >( out.Origin() );
+   dip::sint stride = out.Stride( 0 );
+   dip::sint tensorStride = out.TensorStride();
+   dip::uint nTensor = out.TensorElements();
+   for( auto const& c : coordinates ) {
+      if( interpolator.IsInside( c.data() )) {
+         interpolator.Sample( c.data(), dest, tensorStride );
+      } else {
+         for( dip::uint jj = 0; jj < nTensor; ++jj ) {
+            dest[ static_cast< dip::sint >( jj ) * tensorStride ] = TPO( 0 );
+         }
+      }
+      dest += stride;
+   }
+}
+
 template< typename TPI >
-DoubleType< TPI > LinearND( TPI* src, IntegerArray const& srcStride,
-               UnsignedArray const& coords, FloatArray const& subpos, dip::uint nDims ) {
-   using TPD = DoubleType< TPI >;
-   --nDims;
-   dip::sint stride = srcStride[ nDims ];
-   src += static_cast< dip::sint >( coords[ nDims ] ) * srcStride[ nDims ];
-   // If there's only one dimension, directly compute and be done
-   if( nDims == 0 ) {
-      TPD a = static_cast< TPD >( src[ 0 ] );
-      TPD b = static_cast< TPD >( src[ stride] );
-      return Linear1D( a, b, subpos[ 0 ] );
+void ResampleAtInternal( Image const& in, Image& out, FloatCoordinateArray const& coordinates, Method method ) {
+   if( out.DataType() == in.DataType() ) {
+      ResampleAtInternal< TPI, TPI >( in, out, coordinates, method );
+   } else {
+      // `out` was protected: interpolate in double precision, then convert
+      using TPD = DoubleType< TPI >;
+      Image tmp( out.Sizes(), out.TensorElements(), DataType( TPD( 0 )));
+      ResampleAtInternal< TPI, TPD >( in, tmp, coordinates, method );
+      out.Copy( tmp );
    }
-   // Otherwise, recursively compute result at two points along the last dimension and linearly interpolate them
-   TPD a = LinearND( src, srcStride, coords, subpos, nDims );
-   TPD b = LinearND( src + srcStride[ nDims ], srcStride, coords, subpos, nDims );
-   return Linear1D( a, b, subpos[ nDims ] );
 }
 
 template< typename TPI >
-DoubleType< TPI > ThirdOrderCubicSplineND( TPI* src, UnsignedArray const& srcSizes, IntegerArray const& srcStride,
-                              UnsignedArray const& coords, FloatArray const& subpos, dip::uint nDims ) {
-   using TPD = DoubleType< TPI >;
-   --nDims;
-   bool start = coords[ nDims ] == 0;
-   bool end = coords[ nDims ] == srcSizes[ nDims ] - 2; // can never be srcSizes[ 0 ] - 1
-   dip::sint stride = srcStride[ nDims ];
-   src += static_cast< dip::sint >( coords[ nDims ] ) * stride;
-   // If there's only one dimension, directly compute and be done
-   if( nDims == 0 ) {
-      TPD b = static_cast< TPD >( src[ 0 ] );
-      TPD c = static_cast< TPD >( src[ stride ] );
-      TPD a = start ? b : static_cast< TPD >( src[ -stride ] );
-      TPD d = end ? c : static_cast< TPD >( src[ 2 * stride ] );
-      return ThirdOrderCubicSpline1D( a, b, c, d, subpos[ 0 ] );
+void ResampleAtInternal( Image const& in, Image::Pixel& out, FloatArray const& coordinates, Method method ) {
+   Interpolator< TPI > interpolator( in, method );
+   TPI* dest = static_cast< TPI* >( out.Origin() );
+   if( interpolator.IsInside( coordinates.data() )) {
+      interpolator.Sample( coordinates.data(), dest, out.TensorStride() );
+   } else {
+      out = 0;
    }
-   // Otherwise, recursively compute result at four points along the last dimension and linearly interpolate them
-   TPD b = ThirdOrderCubicSplineND( src, srcSizes, srcStride, coords, subpos, nDims );
-   TPD c = ThirdOrderCubicSplineND( src + stride, srcSizes, srcStride, coords, subpos, nDims );
-   TPD a = start ? b : ThirdOrderCubicSplineND( src - stride, srcSizes, srcStride, coords, subpos, nDims );
-   TPD d = end ? c : ThirdOrderCubicSplineND( src + 2 * stride, srcSizes, srcStride, coords, subpos, nDims );
-   return ThirdOrderCubicSpline1D( a, b, c, d, subpos[ nDims ] );
 }
 
 //
-// Driver interpolation functions, call the recursive functions
+// Affine and projective transformations
 //
 
-template< typename TPI >
-void NearestNeighborInterpolationFunction( Image const& in, Image::Pixel const& out, FloatArray pos ) {
-   UnsignedArray coords = GetIntegerCoordinates( in, pos );
-   DIP_ASSERT( in.DataType() == DataType( TPI( 0 )));
-   dip::uint nDims = in.Dimensionality();
-   TPI* src = static_cast< TPI* >( in.Pointer( coords ));
-   for( dip::uint ii = 0; ii < nDims; ++ii ) {
-      src += pos[ ii ] > 0.5 ? in.Stride( ii ) : 0;
-   }
-   for( auto it = out.begin(); it != out.end(); ++it ) {
-      *it = static_cast< FlexType< TPI >>( *src );
-      src += in.TensorStride();
+// Writes the product of the square matrices `lhs` and `rhs`, of size `n`x`n`, column-major, to `out`
+void MatrixProduct( dip::uint n, std::vector< dfloat > const& lhs, std::vector< dfloat > const& rhs, std::vector< dfloat >& out ) {
+   out.assign( n * n, 0.0 );
+   for( dip::uint cc = 0; cc < n; ++cc ) {
+      for( dip::uint kk = 0; kk < n; ++kk ) {
+         for( dip::uint rr = 0; rr < n; ++rr ) {
+            out[ rr + cc * n ] += lhs[ rr + kk * n ] * rhs[ kk + cc * n ];
+         }
+      }
    }
 }
 
 template< typename TPI >
-void LinearInterpolationFunction( Image const& in, Image::Pixel const& out, FloatArray pos ) {
-   UnsignedArray coords = GetIntegerCoordinates( in, pos );
-   DIP_ASSERT( in.DataType() == DataType( TPI( 0 )));
-   TPI* src = static_cast< TPI* >( in.Origin() );
-   for( auto it = out.begin(); it != out.end(); ++it ) {
-      *it = LinearND( src, in.Strides(), coords, pos, in.Dimensionality() );
-      src += in.TensorStride();
+class WarpLineFilter : public Framework::ScanLineFilter {
+   public:
+      // `matrix` maps homogeneous output pixel coordinates to homogeneous input pixel coordinates.
+      WarpLineFilter( Image const& in, Method method, std::vector< dfloat > const& matrix, bool projective ) :
+            in_( in ), method_( method ), matrix_( matrix ), projective_( projective ) {}
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         interpolators_.clear();
+         interpolators_.reserve( threads );
+         for( dip::uint ii = 0; ii < threads; ++ii ) {
+            interpolators_.emplace_back( in_, method_ );
+         }
+      }
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint nTensorElements ) override {
+         dip::uint nDims = in_.Dimensionality();
+         dip::uint neighbors = method_ == Method::NEAREST_NEIGHBOR ? 1 : ( method_ == Method::LINEAR ? 2 : 4 );
+         dip::uint ops = 1;
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            ops *= neighbors;
+         }
+         return 4 * nDims + ( projective_ ? 20 : 0 ) + 2 * ops * nTensorElements;
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         TPI* out = static_cast< TPI* >( params.outBuffer[ 0 ].buffer );
+         dip::sint stride = params.outBuffer[ 0 ].stride;
+         dip::sint tensorStride = params.outBuffer[ 0 ].tensorStride;
+         dip::uint nTensor = params.outBuffer[ 0 ].tensorLength;
+         dip::uint length = params.bufferLength;
+         dip::uint dim = params.dimension;
+         dip::uint nDims = in_.Dimensionality();
+         dip::uint n = nDims + 1;
+         Interpolator< TPI >& interpolator = interpolators_[ params.thread ];
+         // Input coordinates for the first pixel on the line, and their increment along the line
+         FloatArray coords( n );
+         FloatArray step( n );
+         for( dip::uint rr = 0; rr < n; ++rr ) {
+            coords[ rr ] = matrix_[ rr + nDims * n ];
+            for( dip::uint cc = 0; cc < nDims; ++cc ) {
+               coords[ rr ] += matrix_[ rr + cc * n ] * static_cast< dfloat >( params.position[ cc ] );
+            }
+            step[ rr ] = matrix_[ rr + dim * n ];
+         }
+         FloatArray pos( nDims );
+         for( dip::uint ii = 0; ii < length; ++ii, out += stride ) {
+            dfloat const* p = coords.data();
+            bool inside = true;
+            if( projective_ ) {
+               dfloat w = coords[ nDims ];
+               if( w > 0.0 ) {
+                  for( dip::uint rr = 0; rr < nDims; ++rr ) {
+                     pos[ rr ] = coords[ rr ] / w;
+                  }
+                  p = pos.data();
+               } else {
+                  inside = false; // the point is at or behind the projection center
+               }
+            }
+            if( inside && interpolator.IsInside( p )) {
+               interpolator.Sample( p, out, tensorStride );
+            } else {
+               for( dip::uint jj = 0; jj < nTensor; ++jj ) {
+                  out[ static_cast< dip::sint >( jj ) * tensorStride ] = TPI( 0 );
+               }
+            }
+            for( dip::uint rr = 0; rr < n; ++rr ) {
+               coords[ rr ] += step[ rr ];
+            }
+         }
+      }
+   private:
+      Image const& in_;
+      Method method_;
+      std::vector< dfloat > const& matrix_;
+      bool projective_;
+      std::vector< Interpolator< TPI >> interpolators_; // One per thread
+};
+
+// `matrix` is the (nDims+1)x(nDims+1) homogeneous forward transformation, with the origin at the central pixel
+void Warp( Image const& c_in, Image& out, std::vector< dfloat > const& matrix, bool projective, String const& interpolationMethod ) {
+   Method method;
+   DIP_STACK_TRACE_THIS( method = ParseMethod( interpolationMethod ));
+   dip::uint nDims = c_in.Dimensionality();
+   dip::uint n = nDims + 1;
+
+   // Backward mapping in pixel coordinates: translate to the central pixel, invert `matrix`, and translate back
+   std::vector< dfloat > inverse( n * n );
+   DIP_THROW_IF( Determinant( n, matrix.data() ) == 0.0, "The transformation matrix is not invertible" );
+   Inverse( n, matrix.data(), inverse.data() );
+   std::vector< dfloat > toCenter( n * n, 0.0 );
+   std::vector< dfloat > fromCenter( n * n, 0.0 );
+   for( dip::uint ii = 0; ii < n; ++ii ) {
+      toCenter[ ii * ( n + 1 ) ] = 1.0;
+      fromCenter[ ii * ( n + 1 ) ] = 1.0;
    }
-}
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      dfloat center = static_cast< dfloat >( c_in.Size( ii ) / 2 );
+      toCenter[ ii + nDims * n ] = -center;
+      fromCenter[ ii + nDims * n ] = center;
+   }
+   std::vector< dfloat > tmp;
+   std::vector< dfloat > backward;
+   MatrixProduct( n, inverse, toCenter, tmp );
+   MatrixProduct( n, fromCenter, tmp, backward );
 
-template< typename TPI >
-void ThirdOrderCubicSplineInterpolationFunction( Image const& in, Image::Pixel const& out, FloatArray pos ) {
-   UnsignedArray coords = GetIntegerCoordinates( in, pos );
-   DIP_ASSERT( in.DataType() == DataType( TPI( 0 )));
-   TPI* src = static_cast< TPI* >( in.Origin() );
-   for( auto it = out.begin(); it != out.end(); ++it ) {
-      *it = ThirdOrderCubicSplineND( src, in.Sizes(), in.Strides(), coords, pos, in.Dimensionality() );
-      src += in.TensorStride();
+   // Preserve input
+   Image in = c_in.QuickCopy();
+   PixelSize pixelSize = c_in.PixelSize();
+   String colorSpace = c_in.ColorSpace();
+   if( out.Aliases( in )) {
+      out.Strip(); // we cannot work in place
    }
-}
 
-using InterpolationFunctionPointer = void ( * )( Image const&, Image::Pixel const&, FloatArray );
-
-InterpolationFunctionPointer GetInterpFunctionPtr( String const& method, DataType dt ) {
-   InterpolationFunctionPointer function;
-   switch( ParseMethod( method ) ) {
-      case Method::NEAREST_NEIGHBOR:
-         DIP_OVL_ASSIGN_NONBINARY( function, NearestNeighborInterpolationFunction, dt );
-         break;
-      default:
-      //case Method::LINEAR:
-         DIP_OVL_ASSIGN_NONBINARY( function, LinearInterpolationFunction, dt );
-         break;
-      case Method::CUBIC_ORDER_3:
-         DIP_OVL_ASSIGN_NONBINARY( function, ThirdOrderCubicSplineInterpolationFunction, dt );
-         break;
+   // Create output
+   out.ReForge( in.Sizes(), in.TensorElements(), in.DataType(), Option::AcceptDataTypeChange::DO_ALLOW );
+   out.ReshapeTensor( in.Tensor() );
+   out.SetColorSpace( colorSpace );
+
+   std::unique_ptr< Framework::ScanLineFilter > lineFilter;
+   DIP_OVL_NEW_NONBINARY( lineFilter, WarpLineFilter, ( in, method, backward, projective ), in.DataType() );
+   DIP_STACK_TRACE_THIS( Framework::ScanSingleOutput( out, in.DataType(), *lineFilter, Framework::ScanOption::NeedCoordinates ));
+
+   // Pixel sizes are kept only if the transformation does not mix dimensions with different sizes
+   if( pixelSize.IsDefined() ) {
+      for( dip::uint rr = 0; rr < nDims; ++rr ) {
+         for( dip::uint cc = 0; cc < nDims; ++cc ) {
+            if(( rr != cc ) && ( matrix[ rr + cc * n ] != 0.0 ) && ( pixelSize[ rr ] != pixelSize[ cc ] )) {
+               pixelSize.Set( rr, {} );
+               pixelSize.Set( cc, {} );
+            }
+         }
+      }
+      out.SetPixelSize( pixelSize );
    }
-   return function;
 }
 
 } // namespace
@@ -213,19 +496,10 @@ void ResampleAt(
    out.SetPixelSize( pixelSize );
    out.SetColorSpace( colorSpace );
 
-   // Find interpolator
-   InterpolationFunctionPointer function;
-   DIP_STACK_TRACE_THIS( function = GetInterpFunctionPtr( method, in.DataType() ));
-
-   // Iterate over coordinates and out
-   GenericImageIterator<> outIt( out );
-   for( auto cIt = coordinates.begin(); cIt != coordinates.end(); ++cIt, ++outIt ) {
-      if( in.IsInside( *cIt ) ) {
-         function( in, *outIt, *cIt );
-      } else {
-         *outIt = 0;
-      }
-   }
+   // Interpolate
+   Method interpolationMethod;
+   DIP_STACK_TRACE_THIS( interpolationMethod = ParseMethod( method ));
+   DIP_OVL_CALL_NONBINARY( ResampleAtInternal, ( in, out, coordinates, interpolationMethod ), in.DataType() );
 }
 
 Image::Pixel ResampleAt(
@@ -243,18 +517,143 @@ Image::Pixel ResampleAt(
    Image::Pixel out( in.DataType(), in.TensorElements() );
    out.ReshapeTensor( in.Tensor() );
 
-   // Find interpolator
-   InterpolationFunctionPointer function;
-   DIP_STACK_TRACE_THIS( function = GetInterpFunctionPtr( method, in.DataType() ));
+   // Interpolate
+   Method interpolationMethod;
+   DIP_STACK_TRACE_THIS( interpolationMethod = ParseMethod( method ));
+   DIP_OVL_CALL_NONBINARY( ResampleAtInternal, ( in, out, coordinates, interpolationMethod ), in.DataType() );
 
-   // Call interpolator
-   if( in.IsInside( coordinates ) ) {
-      function( in, out, coordinates );
-   } else {
-      out = 0;
+   return out;
+}
+
+void AffineTransform(
+      Image const& in,
+      Image& out,
+      FloatArray const& matrix,
+      String const& interpolationMethod
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( in.DataType().IsBinary(), E::DATA_TYPE_NOT_SUPPORTED );
+   dip::uint nDims = in.Dimensionality();
+   DIP_THROW_IF( nDims == 0, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF(( matrix.size() != nDims * nDims ) && ( matrix.size() != nDims * ( nDims + 1 )), E::ARRAY_PARAMETER_WRONG_LENGTH );
+   // Homogeneous matrix: the last row is ( 0, 0, ..., 1 )
+   dip::uint n = nDims + 1;
+   std::vector< dfloat > homogeneous( n * n, 0.0 );
+   for( dip::uint cc = 0; cc < matrix.size() / nDims; ++cc ) {
+      for( dip::uint rr = 0; rr < nDims; ++rr ) {
+         homogeneous[ rr + cc * n ] = matrix[ rr + cc * nDims ];
+      }
    }
+   homogeneous.back() = 1.0;
+   DIP_STACK_TRACE_THIS( Warp( in, out, homogeneous, false, interpolationMethod ));
+}
 
-   return out;
+void ProjectiveTransform(
+      Image const& in,
+      Image& out,
+      FloatArray const& matrix,
+      String const& interpolationMethod
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( in.DataType().IsBinary(), E::DATA_TYPE_NOT_SUPPORTED );
+   dip::uint nDims = in.Dimensionality();
+   DIP_THROW_IF( nDims == 0, E::DIMENSIONALITY_NOT_SUPPORTED );
+   dip::uint n = nDims + 1;
+   DIP_THROW_IF( matrix.size() != n * n, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   std::vector< dfloat > homogeneous( matrix.begin(), matrix.end() );
+   DIP_STACK_TRACE_THIS( Warp( in, out, homogeneous, true, interpolationMethod ));
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::ResampleAt") {
+   // A 3D image with a singleton 4th dimension uses the generic kernel, results must match the 3D kernel
+   dip::Image img( { 9, 8, 7 }, 2, dip::DT_SFLOAT );
+   dip::Image tmp = img[ 0 ];
+   dip::FillXCoordinate( tmp );
+   tmp = img[ 1 ];
+   dip::FillRadiusCoordinate( tmp );
+   dip::Image img4 = img;
+   img4.ExpandDimensionality( 4 );
+   dip::FloatCoordinateArray coords3{ { 0.0, 0.0, 0.0 }, { 3.3, 2.1, 5.5 }, { 8.0, 7.0, 6.0 }, { 0.5, 6.9, 1.2 }, { 8.1, 0.0, 0.0 }};
+   dip::FloatCoordinateArray coords4;
+   for( auto c : coords3 ) {
+      c.push_back( 0.0 );
+      coords4.push_back( c );
+   }
+   for( auto method : { "nearest", "linear", "3-cubic" } ) {
+      dip::Image out3 = dip::ResampleAt( img, coords3, method );
+      dip::Image out4 = dip::ResampleAt( img4, coords4, method );
+      DOCTEST_REQUIRE( out3.Sizes() == dip::UnsignedArray{ 5 } );
+      DOCTEST_REQUIRE( out3.TensorElements() == 2 );
+      DOCTEST_CHECK( dip::MaximumAbs( out3 - out4 ).As< dip::dfloat >() < 1e-5 );
+      // The x-coordinate is reproduced exactly by all but nearest neighbor interpolation
+      dip::dfloat x = out3.At( 1 )[ 0 ].As< dip::dfloat >();
+      DOCTEST_CHECK( x == doctest::Approx( std::string( method ) == "nearest" ? -1.0 : -0.7 ));
+      DOCTEST_CHECK( out3.At( 4 )[ 0 ].As< dip::dfloat >() == 0.0 ); // outside of the image
+      dip::Image::Pixel p = dip::ResampleAt( img, coords3[ 3 ], method );
+      DOCTEST_CHECK( p[ 1 ].As< dip::dfloat >() == doctest::Approx( out3.At( 3 )[ 1 ].As< dip::dfloat >() ));
+   }
+   // Integer input with protected floating-point output
+   dip::Image ramp = dip::Convert( dip::CreateXCoordinate( { 10, 5 }, { "corner" } ), dip::DT_UINT8 );
+   dip::Image out;
+   out.SetDataType( dip::DT_SFLOAT );
+   out.Protect();
+   dip::ResampleAt( ramp, out, { { 2.25, 1.0 }, { 9.0, 4.0 } }, "linear" );
+   DOCTEST_CHECK( out.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( out.At( 0 ).As< dip::dfloat >() == doctest::Approx( 2.25 ));
+   DOCTEST_CHECK( out.At( 1 ).As< dip::dfloat >() == doctest::Approx( 9.0 ));
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::AffineTransform and dip::ProjectiveTransform") {
+   dip::Image img( { 15, 11 }, 1, dip::DT_SFLOAT );
+   dip::FillRadiusCoordinate( img );
+   dip::Image x = dip::CreateXCoordinate( img.Sizes() );
+   img += x * 0.3;
+   // A rotation by 180 degrees mirrors the image (the image sizes are odd)
+   dip::Image mirrored = img;
+   mirrored.Mirror( { true, true } );
+   for( auto method : { "nearest", "linear", "3-cubic" } ) {
+      dip::Image out = dip::AffineTransform( img, { -1.0, 0.0, 0.0, -1.0 }, method );
+      DOCTEST_CHECK( dip::MaximumAbs( out - mirrored ).As< dip::dfloat >() < 1e-5 );
+   }
+   // A translation
+   dip::Image out = dip::AffineTransform( img, { 1.0, 0.0, 0.0, 1.0, 2.0, -1.0 }, "linear" );
+   DOCTEST_CHECK( out.At( 5, 5 ).As< dip::dfloat >() == doctest::Approx( img.At( 3, 6 ).As< dip::dfloat >() ));
+   DOCTEST_CHECK( out.At( 1, 5 ).As< dip::dfloat >() == 0.0 );
+   // A scaling by 2 around the center
+   out = dip::AffineTransform( x, { 2.0, 0.0, 0.0, 2.0 }, "3-cubic" );
+   DOCTEST_CHECK( out.At( 3, 4 ).As< dip::dfloat >() == doctest::Approx( -2.0 ));
+   DOCTEST_CHECK( out.At( 12, 4 ).As< dip::dfloat >() == doctest::Approx( 2.5 ));
+   // A projective transformation with an arbitrary scaling is the identity
+   out = dip::ProjectiveTransform( img, { 3.0, 0.0, 0.0, 0.0, 3.0, 0.0, 0.0, 0.0, 3.0 }, "linear" );
+   DOCTEST_CHECK( dip::MaximumAbs( out - img ).As< dip::dfloat >() < 1e-5 );
+   // A projective transformation, compared to dip::ResampleAt at the backward-mapped coordinates
+   dip::FloatArray h{ 1.0, 0.1, 0.02, 0.05, 0.9, -0.01, 0.5, -0.3, 1.0 }; // column-major
+   out = dip::ProjectiveTransform( img, h, "3-cubic" );
+   dip::FloatArray inv( 9 );
+   dip::Inverse( 3, h.data(), inv.data() );
+   dip::FloatCoordinateArray coords;
+   dip::FloatCoordinateArray outCoords;
+   for( dip::uint yy = 0; yy < 11; yy += 3 ) {
+      for( dip::uint xx = 0; xx < 15; xx += 4 ) {
+         dip::dfloat u = static_cast< dip::dfloat >( xx ) - 7.0;
+         dip::dfloat v = static_cast< dip::dfloat >( yy ) - 5.0;
+         dip::dfloat w = inv[ 2 ] * u + inv[ 5 ] * v + inv[ 8 ];
+         coords.push_back( { ( inv[ 0 ] * u + inv[ 3 ] * v + inv[ 6 ] ) / w + 7.0,
+                             ( inv[ 1 ] * u + inv[ 4 ] * v + inv[ 7 ] ) / w + 5.0 } );
+         outCoords.push_back( { static_cast< dip::dfloat >( xx ), static_cast< dip::dfloat >( yy ) } );
+      }
+   }
+   dip::Image expected = dip::ResampleAt( img, coords, "3-cubic" );
+   dip::Image actual = dip::ResampleAt( out, outCoords, "nearest" );
+   DOCTEST_CHECK( dip::MaximumAbs( actual - expected ).As< dip::dfloat >() < 1e-4 );
+   DOCTEST_CHECK_THROWS( dip::AffineTransform( img, { 1.0, 2.0, 2.0, 4.0 } ));
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -88,13 +88,37 @@ namespace {
 
 template< typename TPI >
 class ResamplingLineFilter : public Framework::SeparableLineFilter {
+      using TPF = FloatType< TPI >;
    public:
-      ResamplingLineFilter( interpolation::Method method, FloatArray const& zoom, FloatArray const& shift ) :
-            method_( method ), zoom_( zoom ), shift_( shift ) {}
+      ResamplingLineFilter( interpolation::Method method, FloatArray const& zoom, FloatArray const& shift, UnsignedArray const& outSizes ) :
+            method_( method ), zoom_( zoom ), shift_( shift ) {
+         // Precompute the weights for each dimension, dimensions with the same geometry share a plan
+         if( method_ != interpolation::Method::BSPLINE ) {
+            dip::uint nDims = zoom.size();
+            plans_.resize( nDims );
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               if( !interpolation::ResamplingPlan< TPF >::Supports( method_, zoom[ ii ] )) {
+                  continue;
+               }
+               for( dip::uint jj = 0; jj < ii; ++jj ) {
+                  if( plans_[ jj ] && ( zoom[ jj ] == zoom[ ii ] ) && ( shift[ jj ] == shift[ ii ] ) && ( outSizes[ jj ] == outSizes[ ii ] )) {
+                     plans_[ ii ] = plans_[ jj ];
+                     break;
+                  }
+               }
+               if( !plans_[ ii ] ) {
+                  plans_[ ii ] = std::make_shared< interpolation::ResamplingPlan< TPF >>( method_, outSizes[ ii ], zoom[ ii ], -shift[ ii ] );
+               }
+            }
+         }
+      }
       virtual void SetNumberOfThreads( dip::uint threads ) override {
          buffer_.resize( threads );
       }
       virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint, dip::uint, dip::uint procDim ) override {
+         if( !plans_.empty() && plans_[ procDim ] ) {
+            return 2 * plans_[ procDim ]->Taps() * plans_[ procDim ]->OutputSize();
+         }
          return interpolation::GetNumberOfOperations( method_, lineLength, zoom_[ procDim ] );
       }
       virtual void Filter( Framework::SeparableLineFilterParameters const& params ) override {
@@ -102,6 +126,11 @@ class ResamplingLineFilter : public Framework::SeparableLineFilter {
          DIP_ASSERT( params.inBuffer.stride == 1 );
          dip::uint procDim = params.dimension;
          SampleIterator< TPI > out{ static_cast< TPI* >( params.outBuffer.buffer ), params.outBuffer.stride };
+         if( !plans_.empty() && plans_[ procDim ] ) {
+            DIP_ASSERT( plans_[ procDim ]->OutputSize() == params.outBuffer.length );
+            plans_[ procDim ]->Apply( in, out );
+            return;
+         }
          TPI* buffer = nullptr;
          if( method_ == interpolation::Method::BSPLINE ) {
             dip::uint size = params.inBuffer.length + 2 * params.inBuffer.border;
@@ -114,6 +143,7 @@ class ResamplingLineFilter : public Framework::SeparableLineFilter {
       interpolation::Method method_;
       FloatArray const& zoom_;                  // One per dimension
       FloatArray const& shift_;                 // One per dimension
+      std::vector< std::shared_ptr< interpolation::ResamplingPlan< TPF >>> plans_; // One per dimension, can be null
       std::vector< std::vector< TPI >> buffer_; // One per thread
 };
 
@@ -303,7 +333,7 @@ void Resampling(
    if( method == interpolation::Method::FOURIER ) {
       DIP_OVL_NEW_FLEX( lineFilter, FourierResamplingLineFilter, ( zoom, shift, in.Sizes() ), bufferType );
    } else {
-      DIP_OVL_NEW_FLEX( lineFilter, ResamplingLineFilter, ( method, zoom, shift ), bufferType );
+      DIP_OVL_NEW_FLEX( lineFilter, ResamplingLineFilter, ( method, zoom, shift, outSizes ), bufferType );
    }
 
    // Call line filter through framework
@@ -20,6 +20,8 @@
 
 #include <chrono> // std::chrono_literals::
 #include <thread> // std::this_thread::
+#include <limits>
+#include <type_traits>
 #include "diplib.h"
 #include "diplib/histogram.h"
 #include "diplib/statistics.h"
@@ -111,24 +113,85 @@ void CompleteConfiguration( Measurement::IteratorFeature const& featureValues, H
    CompleteConfiguration( configuration, false );
 }
 
+// For 8-bit and 16-bit integer types, the bin for each possible input value is computed upfront, so that
+// binning a pixel is a table lookup instead of a floating-point computation. The table stores the offset of
+// the bin in the histogram image, or -1 if the value is to be excluded.
+template< typename TPI, bool = std::is_integral< TPI >::value && ( sizeof( TPI ) <= 2 ) >
+class BinLookupTable {
+   public:
+      BinLookupTable( Histogram::Configuration const& configuration, dip::sint stride, dip::uint nPixels ) {
+         constexpr dip::sint lowest = std::numeric_limits< TPI >::lowest();
+         constexpr dip::uint size = static_cast< dip::uint >( std::numeric_limits< TPI >::max() - lowest ) + 1;
+         if( nPixels < size ) {
+            return; // Not worth the effort
+         }
+         table_.resize( size );
+         for( dip::uint ii = 0; ii < size; ++ii ) {
+            dfloat value = static_cast< dfloat >( static_cast< dip::sint >( ii ) + lowest );
+            if( configuration.excludeOutOfBoundValues &&
+                (( value < configuration.lowerBound ) || ( value >= configuration.upperBound ))) {
+               table_[ ii ] = -1;
+            } else {
+               table_[ ii ] = stride * detail::FindBin( value, configuration.lowerBound, configuration.binSize, configuration.nBins );
+            }
+         }
+      }
+      bool IsActive() const { return !table_.empty(); }
+      dip::sint operator()( TPI value ) const {
+         return table_[ static_cast< dip::uint >( static_cast< dip::sint >( value ) - std::numeric_limits< TPI >::lowest() ) ];
+      }
+   private:
+      std::vector< dip::sint > table_;
+};
+
+template< typename TPI >
+class BinLookupTable< TPI, false > {
+   public:
+      BinLookupTable( Histogram::Configuration const&, dip::sint, dip::uint ) {}
+      bool IsActive() const { return false; }
+      dip::sint operator()( TPI ) const { return -1; }
+};
+
 class dip__HistogramBase : public Framework::ScanLineFilter {
    public:
       dip__HistogramBase( Image& image ) : image_( image ) {}
       virtual void SetNumberOfThreads( dip::uint threads ) override {
          for( dip::uint ii = 1; ii < threads; ++ii ) {
-            imageArray_.emplace_back( image_ );       // makes a copy; image_ is not yet forged, so data is not shared.
+            imageArray_.emplace_back( image_ );       // makes a copy; if image_ is forged (we're adding to an existing histogram), the data is shared...
+            imageArray_.back().Strip();               // ...so we strip it, keeping only the sizes and data type.
          }
          // We don't forge the images here, the Filter() function should do that so each thread allocates its own
          // data segment. This ensures there's no false sharing.
       }
-      void Reduce() {
+      virtual void Reduce() {
          for( auto const& img : imageArray_ ) {
-            image_ += img;
+            if( img.IsForged() ) {
+               image_ += img;
+            }
          }
       }
    protected:
       Image& image_;
       ImageArray imageArray_;
+
+      CountType* GetData( dip::uint thread ) {
+         Image& image = thread == 0 ? image_ : imageArray_[ thread - 1 ];
+         if( !image.IsForged() ) {
+            image.Forge();
+            image.Fill( 0 );
+#if defined(_OPENMP) && defined(DIP__DUILDING_DIPIMAGE)
+            // For some reason, MATLAB crashes the second time that `mdhistogram` is called
+            // (only when using multi-threading). This tiny sleep prevents the crash. Don't ask.
+            // Note: A `std::cout <<` call also prevented the crash. Is it about the timing or
+            // about calling a library function? Some people say that these crashes are an issue
+            // of compatibility between OpenMP libraries (MATLAB links against Intel's they say).
+            using namespace std::chrono_literals;
+            std::this_thread::sleep_for(10ns);
+#endif
+         }
+         // Note: `image_` strides are always normal.
+         return static_cast< CountType* >( image.Origin() );
+      }
 };
 
 template< typename TPI >
@@ -139,17 +202,41 @@ class dip__ScalarImageHistogram : public dip__HistogramBase {
          TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
          auto bufferLength = params.bufferLength;
          auto inStride = params.inBuffer[ 0 ].stride;
-         Image& image = params.thread == 0 ? image_ : imageArray_[ params.thread - 1 ];
-         if( !image.IsForged() ) {
-            image.Forge();
-            image.Fill( 0 );
-         }
-         CountType* data = static_cast< CountType* >( image.Origin() );
-         // Note: `image_` strides are always normal.
+         CountType* data = GetData( params.thread );
+         bin const* mask = nullptr;
+         dip::sint maskStride = 0;
          if( params.inBuffer.size() > 1 ) {
             // If there's two input buffers, we have a mask image.
-            bin const* mask = static_cast< bin const* >( params.inBuffer[ 1 ].buffer );
-            auto maskStride = params.inBuffer[ 1 ].stride;
+            mask = static_cast< bin const* >( params.inBuffer[ 1 ].buffer );
+            maskStride = params.inBuffer[ 1 ].stride;
+         }
+         if( lut_.IsActive() ) {
+            if( mask ) {
+               for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+                  if( *mask ) {
+                     dip::sint offset = lut_( *in );
+                     if( offset >= 0 ) {
+                        ++data[ offset ];
+                     }
+                  }
+                  in += inStride;
+                  mask += maskStride;
+               }
+            } else if( configuration_.excludeOutOfBoundValues ) {
+               for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+                  dip::sint offset = lut_( *in );
+                  if( offset >= 0 ) {
+                     ++data[ offset ];
+                  }
+                  in += inStride;
+               }
+            } else {
+               for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+                  ++data[ lut_( *in ) ];
+                  in += inStride;
+               }
+            }
+         } else if( mask ) {
             if( configuration_.excludeOutOfBoundValues ) {
                for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
                   if( *mask && ( *in >= configuration_.lowerBound ) && ( *in < configuration_.upperBound )) {
@@ -184,10 +271,11 @@ class dip__ScalarImageHistogram : public dip__HistogramBase {
             }
          }
       }
-      dip__ScalarImageHistogram( Image& image, Histogram::Configuration const& configuration ) :
-            dip__HistogramBase( image ), configuration_( configuration ) {}
+      dip__ScalarImageHistogram( Image& image, Histogram::Configuration const& configuration, dip::uint nPixels ) :
+            dip__HistogramBase( image ), configuration_( configuration ), lut_( configuration, 1, nPixels ) {}
    private:
       Histogram::Configuration const& configuration_;
+      BinLookupTable< TPI > lut_;
 };
 
 template< typename TPI >
@@ -220,145 +308,131 @@ class dip__JointImageHistogram : public dip__HistogramBase {
             maskBuffer = 2;
          }
          auto bufferLength = params.bufferLength;
-         Image& image = params.thread == 0 ? image_ : imageArray_[ params.thread - 1 ];
-         if( !image.IsForged() ) {
-            image.Forge();
-            image.Fill( 0 );
-#if defined(_OPENMP) && defined(DIP__DUILDING_DIPIMAGE)
-            // For some reason, MATLAB crashes the second time that `mdhistogram` is called
-            // (only when using multi-threading). This tiny sleep prevents the crash. Don't ask.
-            // Note: A `std::cout <<` call also prevented the crash. Is it about the timing or
-            // about calling a library function? Some people say that these crashes are an issue
-            // of compatibility between OpenMP libraries (MATLAB links against Intel's they say).
-            using namespace std::chrono_literals;
-            std::this_thread::sleep_for(10ns);
-#endif
+         CountType* data = nullptr;
+         Histogram::SparseBins* sparse = nullptr;
+         if( sparse_ ) {
+            sparse = params.thread == 0 ? sparse_ : &sparseArray_[ params.thread - 1 ];
+         } else {
+            data = GetData( params.thread );
          }
-         CountType* data = static_cast< CountType* >( image.Origin() );
+         bin const* mask = nullptr;
+         dip::sint maskStride = 0;
          if( params.inBuffer.size() > maskBuffer ) {
             // We have a mask image.
-            bin const* mask = static_cast< bin const* >( params.inBuffer[ maskBuffer ].buffer );
-            auto maskStride = params.inBuffer[ maskBuffer ].stride;
-            for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
-               if( *mask ) {
-                  bool include = true;
-                  for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                     if( configuration_[ jj ].excludeOutOfBoundValues ) {
-                        if(( *( in[ jj ] ) < configuration_[ jj ].lowerBound ) || ( *( in[ jj ] ) >= configuration_[ jj ].upperBound )) {
-                           include = false;
-                           break;
-                        }
-                     }
+            mask = static_cast< bin const* >( params.inBuffer[ maskBuffer ].buffer );
+            maskStride = params.inBuffer[ maskBuffer ].stride;
+         }
+         for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+            if( !mask || *mask ) {
+               dip::sint offset = 0;
+               for( dip::uint jj = 0; jj < nDims; ++jj ) {
+                  dip::sint binOffset = BinOffset( *( in[ jj ] ), jj );
+                  if( binOffset < 0 ) {
+                     offset = -1;
+                     break;
                   }
-                  if( include ) {
-                     dip::sint offset = 0;
-                     for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                        offset += image_.Stride( jj ) *
-                                  detail::FindBin( *( in[ jj ] ), configuration_[ jj ].lowerBound, configuration_[ jj ].binSize, configuration_[ jj ].nBins );
-                     }
+                  offset += binOffset;
+               }
+               if( offset >= 0 ) {
+                  if( sparse ) {
+                     ++( *sparse )[ static_cast< dip::uint >( offset ) ];
+                  } else {
                      ++data[ offset ];
                   }
                }
-               for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                  in[ jj ] += stride[ jj ];
-               }
-               mask += maskStride;
             }
+            for( dip::uint jj = 0; jj < nDims; ++jj ) {
+               in[ jj ] += stride[ jj ];
+            }
+            mask += maskStride;
+         }
+      }
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         if( sparse_ ) {
+            sparseArray_.resize( threads - 1 );
          } else {
-            // We don't have a mask image.
-            for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
-               bool include = true;
-               for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                  if( configuration_[ jj ].excludeOutOfBoundValues ) {
-                     if(( *( in[ jj ] ) < configuration_[ jj ].lowerBound ) || ( *( in[ jj ] ) >= configuration_[ jj ].upperBound )) {
-                        include = false;
-                        break;
-                     }
-                  }
-               }
-               if( include ) {
-                  dip::sint offset = 0;
-                  for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                     offset += image_.Stride( jj ) *
-                               detail::FindBin( *( in[ jj ] ), configuration_[ jj ].lowerBound, configuration_[ jj ].binSize, configuration_[ jj ].nBins );
-                  }
-                  ++data[ offset ];
-               }
-               for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                  in[ jj ] += stride[ jj ];
+            dip__HistogramBase::SetNumberOfThreads( threads );
+         }
+      }
+      virtual void Reduce() override {
+         if( sparse_ ) {
+            for( auto const& bins : sparseArray_ ) {
+               for( auto const& bin : bins ) {
+                  ( *sparse_ )[ bin.first ] += bin.second;
                }
             }
+         } else {
+            dip__HistogramBase::Reduce();
+         }
+      }
+      // If `sparse` is not nullptr, the bins are accumulated there instead of in `image`.
+      dip__JointImageHistogram( Image& image, Histogram::SparseBins* sparse, Histogram::ConfigurationArray const& configuration, bool tensorInput, dip::uint nPixels ) :
+            dip__HistogramBase( image ), sparse_( sparse ), configuration_( configuration ), tensorInput_( tensorInput ) {
+         // The histogram image has normal strides
+         dip::sint stride = 1;
+         for( auto const& conf : configuration_ ) {
+            strides_.push_back( stride );
+            luts_.emplace_back( conf, stride, nPixels );
+            stride *= static_cast< dip::sint >( conf.nBins );
          }
       }
-      dip__JointImageHistogram( Image& image, Histogram::ConfigurationArray const& configuration, bool tensorInput ) :
-            dip__HistogramBase( image ), configuration_( configuration ), tensorInput_( tensorInput ) {}
    private:
+      Histogram::SparseBins* sparse_;
+      std::vector< Histogram::SparseBins > sparseArray_; // One for each thread except the first one
       Histogram::ConfigurationArray const& configuration_;
       bool tensorInput_;
-};
+      IntegerArray strides_;
+      std::vector< BinLookupTable< TPI >> luts_;
 
-} // namespace
+      // Returns the offset into the histogram for `value` along dimension `dim`, or -1 if it is to be excluded
+      dip::sint BinOffset( TPI value, dip::uint dim ) const {
+         if( luts_[ dim ].IsActive() ) {
+            return luts_[ dim ]( value );
+         }
+         Histogram::Configuration const& conf = configuration_[ dim ];
+         if( conf.excludeOutOfBoundValues && (( value < conf.lowerBound ) || ( value >= conf.upperBound ))) {
+            return -1;
+         }
+         return strides_[ dim ] * detail::FindBin( value, conf.lowerBound, conf.binSize, conf.nBins );
+      }
+};
 
-void Histogram::ScalarImageHistogram( Image const& input, Image const& mask, Histogram::Configuration& configuration ) {
-   DIP_STACK_TRACE_THIS( CompleteConfiguration( input, mask, configuration ));
-   lowerBounds_ = { configuration.lowerBound };
-   binSizes_ = { configuration.binSize };
-   data_.SetSizes( { configuration.nBins } );
-   data_.SetDataType( DT_COUNT );
-   std::unique_ptr< dip__HistogramBase >scanLineFilter;
-   DIP_OVL_NEW_REAL( scanLineFilter, dip__ScalarImageHistogram, ( data_, configuration ), input.DataType() );
-   Framework::ScanOptions opts;
+// Turn off multithreading if we'll do a lot of work to reduce. A sparse histogram only stores the bins that are
+// filled, so each thread has at most as many bins to merge as there are pixels.
+Framework::ScanOptions HistogramScanOptions( dip::uint nPixels, dip::uint nDims, dip::uint nBins, bool sparse ) {
+   if( sparse ) {
+      nBins = std::min( nBins, nPixels );
+   }
    if( GetNumberOfThreads() > 1 ) {
-      dip::uint parallelOperations = input.NumberOfPixels() * 6;
-      dip::uint sequentialOperations = ( GetNumberOfThreads() - 1 ) * ( data_.NumberOfPixels() * 2 + 10000 );
+      dip::uint parallelOperations = nPixels * nDims * 6;
+      dip::uint sequentialOperations = ( GetNumberOfThreads() - 1 ) * ( nBins * 2 + 10000 );
       if( parallelOperations / GetNumberOfThreads() + sequentialOperations + threadingThreshold > parallelOperations ) {
-         opts = Framework::ScanOption::NoMultiThreading; // Turn off multithreading if we'll do a lot of work to reduce.
+         return Framework::ScanOption::NoMultiThreading;
       }
    }
-   DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( input, mask, input.DataType(), *scanLineFilter, opts ));
-   scanLineFilter->Reduce();
+   return {};
 }
 
-void Histogram::TensorImageHistogram( Image const& input, Image const& mask, Histogram::ConfigurationArray& configuration ) {
-   dip::uint ndims = input.TensorElements();
-   lowerBounds_.resize( ndims );
-   binSizes_.resize( ndims );
-   UnsignedArray sizes( ndims, 1 );
-   for( dip::uint ii = 0; ii < ndims; ++ii ) {
-      DIP_STACK_TRACE_THIS( CompleteConfiguration( input[ static_cast< dip::sint >( ii ) ], mask, configuration[ ii ] ));
-      lowerBounds_[ ii ] = configuration[ ii ].lowerBound;
-      binSizes_[ ii ] = configuration[ ii ].binSize;
-      sizes[ ii ] = configuration[ ii ].nBins;
-   }
-   data_.SetSizes( sizes );
-   data_.SetDataType( DT_COUNT );
+} // namespace
+
+void Histogram::ImageHistogram( Image const& input, Image const& mask, Histogram::ConfigurationArray const& configuration ) {
+   DIP_ASSERT( configuration.size() == input.TensorElements() );
    std::unique_ptr< dip__HistogramBase >scanLineFilter;
-   DIP_OVL_NEW_REAL( scanLineFilter, dip__JointImageHistogram, ( data_, configuration, true ), input.DataType() );
-   Framework::ScanOptions opts;
-   if( GetNumberOfThreads() > 1 ) {
-      dip::uint parallelOperations = input.NumberOfPixels() * ndims * 6;
-      dip::uint sequentialOperations = ( GetNumberOfThreads() - 1 ) * ( data_.NumberOfPixels() * 2 + 10000 );
-      if( parallelOperations / GetNumberOfThreads() + sequentialOperations + threadingThreshold > parallelOperations ) {
-         opts = Framework::ScanOption::NoMultiThreading; // Turn off multithreading if we'll do a lot of work to reduce.
-      }
+   if( input.IsScalar() && !IsSparse() ) {
+      DIP_OVL_NEW_REAL( scanLineFilter, dip__ScalarImageHistogram, ( data_, configuration[ 0 ], input.NumberOfPixels() ), input.DataType() );
+   } else {
+      DIP_OVL_NEW_REAL( scanLineFilter, dip__JointImageHistogram, ( data_, sparse_.get(), configuration, true, input.NumberOfPixels() ), input.DataType() );
    }
+   Framework::ScanOptions opts = HistogramScanOptions( input.NumberOfPixels(), configuration.size(), data_.NumberOfPixels(), IsSparse() );
    DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( input, mask, input.DataType(), *scanLineFilter, opts ));
    scanLineFilter->Reduce();
 }
 
-void Histogram::JointImageHistogram( Image const& input1, Image const& input2, Image const& c_mask, Histogram::ConfigurationArray& configuration ) {
-   DIP_START_STACK_TRACE
-      CompleteConfiguration( input1, c_mask, configuration[ 0 ] );
-      CompleteConfiguration( input2, c_mask, configuration[ 1 ] );
-   DIP_END_STACK_TRACE
-   lowerBounds_ = { configuration[ 0 ].lowerBound, configuration[ 1 ].lowerBound };
-   binSizes_ = { configuration[ 0 ].binSize, configuration[ 1 ].binSize };
-   UnsignedArray sizes{ configuration[ 0 ].nBins, configuration[ 1 ].nBins };
-   data_.SetSizes( sizes );
-   data_.SetDataType( DT_COUNT );
+void Histogram::ImageHistogram( Image const& input1, Image const& input2, Image const& c_mask, Histogram::ConfigurationArray const& configuration ) {
+   DIP_ASSERT( configuration.size() == 2 );
    DataType dtype = DataType::SuggestDyadicOperation( input1.DataType(), input2.DataType() );
    std::unique_ptr< dip__HistogramBase >scanLineFilter;
-   DIP_OVL_NEW_REAL( scanLineFilter, dip__JointImageHistogram, ( data_, configuration, false ), dtype );
+   DIP_OVL_NEW_REAL( scanLineFilter, dip__JointImageHistogram, ( data_, sparse_.get(), configuration, false, input1.NumberOfPixels() ), dtype );
    ImageConstRefArray inar{ input1, input2 };
    DataTypeArray inBufT{ dtype, dtype };
    Image mask;
@@ -373,22 +447,86 @@ void Histogram::JointImageHistogram( Image const& input1, Image const& input2, I
       inBufT.push_back( mask.DataType() );
    }
    ImageRefArray outar{};
-   Framework::ScanOptions opts;
-   if( GetNumberOfThreads() > 1 ) {
-      dip::uint parallelOperations = input1.NumberOfPixels() * 2 * 6;
-      dip::uint sequentialOperations = ( GetNumberOfThreads() - 1 ) * ( data_.NumberOfPixels() * 2 + 10000 );
-      if( parallelOperations / GetNumberOfThreads() + sequentialOperations + threadingThreshold > parallelOperations ) {
-         opts = Framework::ScanOption::NoMultiThreading; // Turn off multithreading if we'll do a lot of work to reduce.
-      }
-   }
+   Framework::ScanOptions opts = HistogramScanOptions( input1.NumberOfPixels(), 2, data_.NumberOfPixels(), IsSparse() );
    DIP_STACK_TRACE_THIS( Framework::Scan( inar, outar, inBufT, {}, {}, {}, *scanLineFilter, opts ));
    scanLineFilter->Reduce();
 }
 
+void Histogram::ScalarImageHistogram( Image const& input, Image const& mask, Histogram::Configuration& configuration ) {
+   DIP_STACK_TRACE_THIS( CompleteConfiguration( input, mask, configuration ));
+   lowerBounds_ = { configuration.lowerBound };
+   binSizes_ = { configuration.binSize };
+   excludeOutOfBoundValues_ = { configuration.excludeOutOfBoundValues };
+   SetBins( { configuration.nBins }, configuration.sparse );
+   ImageHistogram( input, mask, { configuration } );
+}
+
+void Histogram::TensorImageHistogram( Image const& input, Image const& mask, Histogram::ConfigurationArray& configuration ) {
+   dip::uint ndims = input.TensorElements();
+   lowerBounds_.resize( ndims );
+   binSizes_.resize( ndims );
+   excludeOutOfBoundValues_.resize( ndims );
+   UnsignedArray sizes( ndims, 1 );
+   bool sparse = false;
+   for( dip::uint ii = 0; ii < ndims; ++ii ) {
+      DIP_STACK_TRACE_THIS( CompleteConfiguration( input[ static_cast< dip::sint >( ii ) ], mask, configuration[ ii ] ));
+      lowerBounds_[ ii ] = configuration[ ii ].lowerBound;
+      binSizes_[ ii ] = configuration[ ii ].binSize;
+      excludeOutOfBoundValues_[ ii ] = configuration[ ii ].excludeOutOfBoundValues;
+      sizes[ ii ] = configuration[ ii ].nBins;
+      sparse |= configuration[ ii ].sparse;
+   }
+   DIP_STACK_TRACE_THIS( SetBins( sizes, sparse ));
+   ImageHistogram( input, mask, configuration );
+}
+
+void Histogram::JointImageHistogram( Image const& input1, Image const& input2, Image const& c_mask, Histogram::ConfigurationArray& configuration ) {
+   DIP_START_STACK_TRACE
+      CompleteConfiguration( input1, c_mask, configuration[ 0 ] );
+      CompleteConfiguration( input2, c_mask, configuration[ 1 ] );
+   DIP_END_STACK_TRACE
+   lowerBounds_ = { configuration[ 0 ].lowerBound, configuration[ 1 ].lowerBound };
+   binSizes_ = { configuration[ 0 ].binSize, configuration[ 1 ].binSize };
+   excludeOutOfBoundValues_ = { configuration[ 0 ].excludeOutOfBoundValues, configuration[ 1 ].excludeOutOfBoundValues };
+   UnsignedArray sizes{ configuration[ 0 ].nBins, configuration[ 1 ].nBins };
+   DIP_STACK_TRACE_THIS( SetBins( sizes, configuration[ 0 ].sparse || configuration[ 1 ].sparse ));
+   ImageHistogram( input1, input2, c_mask, configuration );
+}
+
+Histogram::ConfigurationArray Histogram::GetConfiguration() const {
+   dip::uint ndims = Dimensionality();
+   ConfigurationArray configuration( ndims );
+   for( dip::uint ii = 0; ii < ndims; ++ii ) {
+      configuration[ ii ] = Configuration( lowerBounds_[ ii ], static_cast< int >( data_.Size( ii )), binSizes_[ ii ] );
+      configuration[ ii ].upperBound = UpperBound( ii );
+      configuration[ ii ].excludeOutOfBoundValues = excludeOutOfBoundValues_[ ii ];
+   }
+   return configuration;
+}
+
+Histogram& Histogram::Add( Image const& input, Image const& mask ) {
+   DIP_THROW_IF( !input.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !input.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( input.TensorElements() != Dimensionality(), E::NTENSORELEM_DONT_MATCH );
+   DIP_STACK_TRACE_THIS( ImageHistogram( input, mask, GetConfiguration() ));
+   return *this;
+}
+
+Histogram& Histogram::Add( Image const& input1, Image const& input2, Image const& mask ) {
+   DIP_THROW_IF( !input1.IsForged() || !input2.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !input1.IsScalar() || !input2.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !input1.DataType().IsReal() || !input2.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( input1.Sizes() != input2.Sizes(), E::SIZES_DONT_MATCH );
+   DIP_THROW_IF( Dimensionality() != 2, E::ILLEGAL_DIMENSIONALITY );
+   DIP_STACK_TRACE_THIS( ImageHistogram( input1, input2, mask, GetConfiguration() ));
+   return *this;
+}
+
 void Histogram::MeasurementFeatureHistogram( Measurement::IteratorFeature const& featureValues, Histogram::ConfigurationArray& configuration ) {
    dip::uint ndims = featureValues.NumberOfValues();
    lowerBounds_.resize( ndims );
    binSizes_.resize( ndims );
+   excludeOutOfBoundValues_.resize( ndims );
    UnsignedArray sizes( ndims );
    for( dip::uint ii = 0; ii < ndims; ++ii ) {
       DIP_START_STACK_TRACE
@@ -398,6 +536,7 @@ void Histogram::MeasurementFeatureHistogram( Measurement::IteratorFeature const&
       DIP_END_STACK_TRACE
       lowerBounds_[ ii ] = configuration[ ii ].lowerBound;
       binSizes_[ ii ] = configuration[ ii ].binSize;
+      excludeOutOfBoundValues_[ ii ] = configuration[ ii ].excludeOutOfBoundValues;
       sizes[ ii ] = configuration[ ii ].nBins;
    }
    data_.SetSizes( sizes );
@@ -432,24 +571,54 @@ void Histogram::EmptyHistogram( Histogram::ConfigurationArray configuration ) {
    dip::uint ndims = configuration.size();
    lowerBounds_.resize( ndims );
    binSizes_.resize( ndims );
+   excludeOutOfBoundValues_.resize( ndims );
    UnsignedArray sizes( ndims );
+   bool sparse = false;
    for( dip::uint ii = 0; ii < ndims; ++ii ) {
       DIP_STACK_TRACE_THIS( CompleteConfiguration( configuration[ ii ], false ));
       lowerBounds_[ ii ] = configuration[ ii ].lowerBound;
       binSizes_[ ii ] = configuration[ ii ].binSize;
+      excludeOutOfBoundValues_[ ii ] = configuration[ ii ].excludeOutOfBoundValues;
       sizes[ ii ] = configuration[ ii ].nBins;
+      sparse |= configuration[ ii ].sparse;
+   }
+   DIP_STACK_TRACE_THIS( SetBins( sizes, sparse ));
+   if( !sparse ) {
+      data_.Forge();
+      data_.Fill( 0 );
    }
+}
+
+void Histogram::SetBins( UnsignedArray const& sizes, bool sparse ) {
    data_.SetSizes( sizes );
    data_.SetDataType( DT_COUNT );
-   data_.Forge();
-   data_.Fill( 0 );
+   if( sparse ) {
+      // The linear index of a bin must fit in a `dip::sint`
+      dip::uint maxIndex = static_cast< dip::uint >( std::numeric_limits< dip::sint >::max() );
+      dip::uint nBins = 1;
+      for( auto sz : sizes ) {
+         DIP_THROW_IF( sz > maxIndex / nBins, "Too many bins for a sparse histogram" );
+         nBins *= sz;
+      }
+      sparse_ = std::make_shared< SparseBins >();
+   } else {
+      sparse_ = nullptr;
+   }
 }
 
 dip::uint Histogram::Count() const {
+   if( IsSparse() ) {
+      dip::uint count = 0;
+      for( auto const& bin : *sparse_ ) {
+         count += bin.second;
+      }
+      return count;
+   }
    return Sum( data_ ).As< dip::uint >();
 }
 
 Histogram& Histogram::Cumulative() {
+   DIP_THROW_IF( IsSparse(), "Not available for sparse histograms" );
    data_.Protect();
    CumulativeSum( data_, {}, data_ );
    data_.Protect( false );
@@ -458,6 +627,24 @@ Histogram& Histogram::Cumulative() {
 
 Histogram Histogram::GetMarginal( dip::uint dim ) const {
    DIP_THROW_IF( dim >= Dimensionality(), E::PARAMETER_OUT_OF_RANGE );
+   if( IsSparse() ) {
+      Histogram out( *this );
+      out.sparse_ = nullptr;
+      out.data_ = Image( { data_.Size( dim ) }, 1, DT_COUNT );
+      out.data_.Fill( 0 );
+      CountType* data = static_cast< CountType* >( out.data_.Origin() );
+      dip::uint stride = 1;
+      for( dip::uint ii = 0; ii < dim; ++ii ) {
+         stride *= data_.Size( ii );
+      }
+      for( auto const& bin : *sparse_ ) {
+         data[ ( bin.first / stride ) % data_.Size( dim ) ] += bin.second;
+      }
+      out.lowerBounds_ = { lowerBounds_[ dim ] };
+      out.binSizes_ = { binSizes_[ dim ] };
+      out.excludeOutOfBoundValues_ = { excludeOutOfBoundValues_[ dim ] };
+      return out;
+   }
    Histogram out = Copy();
    BooleanArray ps( Dimensionality(), true );
    ps[ dim ] = false;
@@ -468,10 +655,12 @@ Histogram Histogram::GetMarginal( dip::uint dim ) const {
    out.data_.PermuteDimensions( { dim } );
    out.lowerBounds_ = { lowerBounds_[ dim ] };
    out.binSizes_ = { binSizes_[ dim ] };
+   out.excludeOutOfBoundValues_ = { excludeOutOfBoundValues_[ dim ] };
    return out;
 }
 
 Histogram& Histogram::Smooth( FloatArray sigma ) {
+   DIP_THROW_IF( IsSparse(), "Not available for sparse histograms" );
    UnsignedArray sizes = data_.Sizes();
    dip::uint nDims = sizes.size();
    DIP_STACK_TRACE_THIS( ArrayUseParameter( sigma, nDims, 1.0 ));
@@ -494,6 +683,7 @@ Histogram& Histogram::Smooth( FloatArray sigma ) {
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
 #include "diplib/random.h"
+#include "diplib/generation.h"
 
 DOCTEST_TEST_CASE( "[DIPlib] testing dip::Histogram" ) {
    dip::Image zero( {}, 1, dip::DT_SFLOAT );
@@ -614,4 +804,108 @@ DOCTEST_TEST_CASE( "[DIPlib] testing dip::Histogram" ) {
    DOCTEST_CHECK( tensorCov[ 5 ] == 0.0 ); // covariance 2nd & 3rd
 }
 
+DOCTEST_TEST_CASE( "[DIPlib] testing dip::Histogram::Add and integer binning" ) {
+   dip::Random random( 0 );
+   dip::Image tmp( { 300, 250 }, 1, dip::DT_SFLOAT );
+   tmp.Fill( 128 );
+   dip::Image img1 = dip::Convert( dip::GaussianNoise( tmp, random, 50.0 * 50.0 ), dip::DT_UINT8 );
+   dip::Image img2 = dip::Convert( dip::UniformNoise( tmp, random, -100.0, 100.0 ), dip::DT_UINT8 );
+   dip::Histogram::Configuration conf( 20.0, 200.0, 45 );
+   conf.excludeOutOfBoundValues = true;
+   // Integer images use a look-up table, float images don't; they should give identical results
+   dip::Histogram h1( img1, {}, conf );
+   dip::Image img1f = dip::Convert( img1, dip::DT_SFLOAT );
+   dip::Histogram h1f( img1f, {}, conf );
+   DOCTEST_CHECK( dip::Count( h1.GetImage() != h1f.GetImage() ) == 0 );
+   dip::Image img2s = dip::Convert( img2, dip::DT_SINT16 );
+   img2s -= 300;
+   dip::Image img2f = dip::Convert( img2s, dip::DT_DFLOAT );
+   conf.excludeOutOfBoundValues = false;
+   conf.lowerBound = -200.0;
+   dip::Histogram h2( img2s, {}, conf );
+   dip::Histogram h2f( img2f, {}, conf );
+   DOCTEST_CHECK( dip::Count( h2.GetImage() != h2f.GetImage() ) == 0 );
+   DOCTEST_CHECK( h2.Count() == img2.NumberOfPixels() );
+   // Adding an image to a histogram is the same as adding the two histograms
+   dip::Histogram h3( img1, {}, conf );
+   dip::Histogram h4( img2, {}, conf );
+   h3.Add( img2 );
+   h4 += dip::Histogram( img1, {}, conf );
+   DOCTEST_CHECK( dip::Count( h3.GetImage() != h4.GetImage() ) == 0 );
+   DOCTEST_CHECK( h3.Count() == 2 * img1.NumberOfPixels() );
+   // Also for joint histograms
+   dip::Histogram h5( img1, img2, {}, { conf, conf } );
+   dip::Histogram h6( img1f, dip::Convert( img2, dip::DT_SFLOAT ), {}, { conf, conf } );
+   DOCTEST_CHECK( dip::Count( h5.GetImage() != h6.GetImage() ) == 0 );
+   h5.Add( img1, img2, {} );
+   h6 += h6;
+   DOCTEST_CHECK( dip::Count( h5.GetImage() != h6.GetImage() ) == 0 );
+   DOCTEST_CHECK_THROWS( h5.Add( img1 ));
+}
+
+DOCTEST_TEST_CASE( "[DIPlib] testing sparse histograms" ) {
+   dip::Random random( 0 );
+   dip::Image tmp( { 100, 80 }, 2, dip::DT_SFLOAT );
+   tmp.Fill( 100 );
+   dip::Image img = dip::Convert( dip::GaussianNoise( tmp, random, 30.0 * 30.0 ), dip::DT_UINT8 );
+   dip::Histogram::Configuration conf( dip::DT_UINT8 );
+   dip::Histogram dense( img, {}, conf );
+   conf.sparse = true;
+   dip::Histogram sparse( img, {}, conf );
+   DOCTEST_REQUIRE( sparse.IsSparse() );
+   DOCTEST_CHECK( !dense.IsSparse() );
+   DOCTEST_CHECK( sparse.Dimensionality() == 2 );
+   DOCTEST_CHECK( sparse.Count() == img.NumberOfPixels() );
+   DOCTEST_CHECK( sparse.GetSparseBins().size() <= img.NumberOfPixels() );
+   DOCTEST_CHECK( sparse.At( 100, 100 ) == dense.At( 100, 100 ));
+   DOCTEST_CHECK( sparse.At( 90, 110 ) == dense.At( 90, 110 ));
+   auto sparseMean = dip::Mean( sparse );
+   auto denseMean = dip::Mean( dense );
+   DOCTEST_CHECK( sparseMean[ 0 ] == doctest::Approx( denseMean[ 0 ] ));
+   DOCTEST_CHECK( sparseMean[ 1 ] == doctest::Approx( denseMean[ 1 ] ));
+   auto sparseCov = dip::Covariance( sparse );
+   auto denseCov = dip::Covariance( dense );
+   DOCTEST_CHECK( sparseCov[ 0 ] == doctest::Approx( denseCov[ 0 ] ));
+   DOCTEST_CHECK( sparseCov[ 1 ] == doctest::Approx( denseCov[ 1 ] ));
+   DOCTEST_CHECK( sparseCov[ 2 ] == doctest::Approx( denseCov[ 2 ] ));
+   DOCTEST_CHECK( dip::MarginalMedian( sparse ) == dip::MarginalMedian( dense ));
+   DOCTEST_CHECK( dip::Mode( sparse ) == dip::Mode( dense ));
+   DOCTEST_CHECK( dip::MutualInformation( sparse ) == doctest::Approx( dip::MutualInformation( dense )));
+   DOCTEST_CHECK( dip::Count( sparse.GetMarginal( 1 ).GetImage() != dense.GetMarginal( 1 ).GetImage() ) == 0 );
+   DOCTEST_CHECK_THROWS( sparse.GetImage() );
+   dip::Histogram sparse1( img[ 0 ], {}, conf );
+   dip::Histogram dense1( img[ 0 ] );
+   DOCTEST_CHECK( dip::Entropy( sparse1 ) == doctest::Approx( dip::Entropy( dense1 )));
+   // Adding to and copying sparse histograms
+   dip::Histogram sparse2 = sparse.Copy();
+   sparse2.Add( img );
+   sparse += sparse;
+   DOCTEST_CHECK( sparse2.Count() == 2 * img.NumberOfPixels() );
+   DOCTEST_CHECK( sparse2.At( 100, 100 ) == sparse.At( 100, 100 ));
+   DOCTEST_CHECK( sparse2.At( 100, 100 ) == 2 * dense.At( 100, 100 ));
+   // A 5D histogram with 256 bins along each dimension, which would take 4 TB of memory as a dense histogram
+   dip::Image tmp5( { 50, 40 }, 5, dip::DT_SFLOAT );
+   tmp5.Fill( 128 );
+   dip::Image img5 = dip::Convert( dip::GaussianNoise( tmp5, random, 20.0 * 20.0 ), dip::DT_UINT8 );
+   dip::Histogram sparse5( img5, {}, conf );
+   DOCTEST_CHECK( sparse5.Dimensionality() == 5 );
+   DOCTEST_CHECK( sparse5.Bins( 4 ) == 256 );
+   DOCTEST_CHECK( sparse5.Count() == img5.NumberOfPixels() );
+   auto mean5 = dip::Mean( sparse5 );
+   DOCTEST_CHECK( std::abs( mean5[ 4 ] - 128.5 ) < 2.0 );
+   DOCTEST_CHECK( sparse5.GetMarginal( 3 ).Count() == img5.NumberOfPixels() );
+   // Large sparse histograms are computed in parallel, merging the bins of each thread
+   tmp5 = dip::Image( { 200, 150 }, 5, dip::DT_SFLOAT );
+   tmp5.Fill( 128 );
+   img5 = dip::Convert( dip::GaussianNoise( tmp5, random, 20.0 * 20.0 ), dip::DT_UINT8 );
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Histogram reference5( img5, {}, conf );
+   dip::SetNumberOfThreads( std::max< dip::uint >( nThreads, 4 ));
+   sparse5 = dip::Histogram( img5, {}, conf );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( sparse5.Count() == img5.NumberOfPixels() );
+   DOCTEST_CHECK( sparse5.GetSparseBins() == reference5.GetSparseBins() );
+}
+
 #endif // DIP__ENABLE_DOCTEST
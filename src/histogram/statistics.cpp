@@ -31,17 +31,24 @@ FloatArray Mean( Histogram const& in ) {
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
       binCenters[ ii ] = in.BinCenters( ii );
    }
-   ImageIterator< Histogram::CountType > it( in.GetImage() );
-   // Histogram always has normal strides, it.Optimize() would not do anything here.
-   do {
-      UnsignedArray const& coord = it.Coordinates();
-      dfloat v = static_cast< dfloat >( *it );
+   auto accumulate = [ & ]( UnsignedArray const& coord, dfloat v ) {
       for( dip::uint ii = 0; ii < nDims; ++ii ) {
          dfloat bin = binCenters[ ii ][ coord[ ii ] ];
          mean[ ii ] += bin * v;
       }
       weight += v;
-   } while( ++it );
+   };
+   if( in.IsSparse() ) {
+      for( auto const& bin : in.GetSparseBins() ) {
+         accumulate( in.BinCoordinates( bin.first ), static_cast< dfloat >( bin.second ));
+      }
+   } else {
+      ImageIterator< Histogram::CountType > it( in.GetImage() );
+      // Histogram always has normal strides, it.Optimize() would not do anything here.
+      do {
+         accumulate( it.Coordinates(), static_cast< dfloat >( *it ));
+      } while( ++it );
+   }
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
       mean[ ii ] /= weight;
    }
@@ -57,12 +64,8 @@ FloatArray Covariance( Histogram const& in ) {
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
       binCenters[ ii ] = in.BinCenters( ii );
    }
-   ImageIterator< Histogram::CountType > it( in.GetImage() );
-   // Histogram always has notmal strides, it.Optimize() would not do anything here.
    FloatArray diff( nDims, 0 );
-   do {
-      UnsignedArray const& coord = it.Coordinates();
-      dfloat w = static_cast< dfloat >( *it );
+   auto accumulate = [ & ]( UnsignedArray const& coord, dfloat w ) {
       for( dip::uint ii = 0; ii < nDims; ++ii ) {
          diff[ ii ] = binCenters[ ii ][ coord[ ii ] ] - mean[ ii ];
       }
@@ -78,7 +81,18 @@ FloatArray Covariance( Histogram const& in ) {
          }
       }
       weight += w;
-   } while( ++it );
+   };
+   if( in.IsSparse() ) {
+      for( auto const& bin : in.GetSparseBins() ) {
+         accumulate( in.BinCoordinates( bin.first ), static_cast< dfloat >( bin.second ));
+      }
+   } else {
+      ImageIterator< Histogram::CountType > it( in.GetImage() );
+      // Histogram always has normal strides, it.Optimize() would not do anything here.
+      do {
+         accumulate( it.Coordinates(), static_cast< dfloat >( *it ));
+      } while( ++it );
+   }
    dfloat norm = 1.0 / ( weight - 1 );
    for( auto& c : cov ) {
       c *= norm;
@@ -89,6 +103,23 @@ FloatArray Covariance( Histogram const& in ) {
 FloatArray MarginalMedian( Histogram const& in ) {
    dip::uint nDims = in.Dimensionality();
    FloatArray median( nDims );
+   if( in.IsSparse() ) {
+      // We compute the cumulative sum of each marginal histogram (which are dense)
+      dfloat n = static_cast< dfloat >( in.Count() );
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         Histogram marginal = in.GetMarginal( ii );
+         Histogram::CountType const* ptr = marginal.Origin();
+         dip::uint nBins = marginal.Bins();
+         dip::uint jj = 0;
+         dfloat cum = static_cast< dfloat >( ptr[ 0 ] );
+         while(( cum / n < 0.5 ) && ( jj < nBins - 1 )) {
+            ++jj;
+            cum += static_cast< dfloat >( ptr[ jj ] );
+         }
+         median[ ii ] = in.BinCenter( jj, ii );
+      }
+      return median;
+   }
    Histogram cum = CumulativeHistogram( in ); // we look along the last line in each direction
    Image const& cumImg = cum.GetImage();
    Histogram::CountType* pcum = static_cast< Histogram::CountType* >( cumImg.Origin() );
@@ -115,14 +146,26 @@ FloatArray Mode( Histogram const& in ) {
    dip::uint nDims = in.Dimensionality();
    UnsignedArray coord( nDims, 0 );
    Histogram::CountType maxVal = 0;
-   ImageIterator< Histogram::CountType > it( in.GetImage() );
-   // Histogram always has normal strides, it.Optimize() would not do anything here.
-   do {
-      if( *it > maxVal ) {
-         maxVal = *it;
-         coord = it.Coordinates();
+   if( in.IsSparse() ) {
+      // Bins are not sorted, so on ties we look for the lowest linear index
+      dip::uint index = 0;
+      for( auto const& bin : in.GetSparseBins() ) {
+         if(( bin.second > maxVal ) || (( bin.second == maxVal ) && ( bin.first < index ))) {
+            maxVal = bin.second;
+            index = bin.first;
+         }
       }
-   } while( ++it );
+      coord = in.BinCoordinates( index );
+   } else {
+      ImageIterator< Histogram::CountType > it( in.GetImage() );
+      // Histogram always has normal strides, it.Optimize() would not do anything here.
+      do {
+         if( *it > maxVal ) {
+            maxVal = *it;
+            coord = it.Coordinates();
+         }
+      } while( ++it );
+   }
    FloatArray mode( nDims );
    for( dip::uint ii = 0; ii < nDims; ++ii ) {
       mode[ ii ] = in.BinCenter( coord[ ii ], ii );
@@ -133,6 +176,24 @@ FloatArray Mode( Histogram const& in ) {
 dfloat MutualInformation( Histogram const& hist ) {
    DIP_THROW_IF( hist.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
 
+   if( hist.IsSparse() ) {
+      Histogram c1 = hist.GetMarginal( 0 );
+      Histogram c2 = hist.GetMarginal( 1 );
+      Histogram::CountType const* c1Ptr = c1.Origin();
+      Histogram::CountType const* c2Ptr = c2.Origin();
+      dip::uint n1 = c1.Bins();
+      dfloat norm = 1.0 / static_cast< dfloat >( hist.Count() );
+      dfloat out = 0.0;
+      for( auto const& bin : hist.GetSparseBins() ) {
+         if( bin.second > 0 ) {
+            dfloat h = static_cast< dfloat >( bin.second );
+            out += h * std::log2( h / ( static_cast< dfloat >( c1Ptr[ bin.first % n1 ] ) *
+                                        static_cast< dfloat >( c2Ptr[ bin.first / n1 ] ) * norm ));
+         }
+      }
+      return out * norm;
+   }
+
    Image const& histImg = hist.GetImage();
    dip::uint n1 = histImg.Size( 0 );
    dip::uint n2 = histImg.Size( 1 );
@@ -175,10 +236,19 @@ dfloat MutualInformation( Histogram const& hist ) {
 
 dfloat Entropy( Histogram const& hist ) {
    DIP_THROW_IF( hist.Dimensionality() != 1, E::DIMENSIONALITY_NOT_SUPPORTED );
-   Image const& histImg = hist.GetImage();
-   dip::uint n = histImg.Size( 0 );
    dfloat norm = 1.0 / static_cast< dfloat >( hist.Count() );
    dfloat out = 0.0;
+   if( hist.IsSparse() ) {
+      for( auto const& bin : hist.GetSparseBins() ) {
+         if( bin.second > 0 ) {
+            dfloat c = static_cast< dfloat >( bin.second ) * norm;
+            out += c * std::log2( c );
+         }
+      }
+      return -out;
+   }
+   Image const& histImg = hist.GetImage();
+   dip::uint n = histImg.Size( 0 );
    Histogram::CountType* hPtr = static_cast< Histogram::CountType* >( histImg.Origin() );
    for( dip::uint ii = 0; ii < n; ii++ ) {
       if( *hPtr > 0 ) {
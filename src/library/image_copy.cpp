@@ -41,7 +41,7 @@ void CopyFrom( Image const& src, Image& dest, Image const& mask ) {
    dest.CopyNonDataProperties( src );
    // Samples
    dip::uint telems = src.TensorElements();
-   dip::uint bytes = DataType().SizeOf(); // both source and destination have the same types
+   dip::uint bytes = src.DataType().SizeOf(); // both source and destination have the same types
    if(( src.TensorStride() == 1 ) && ( dest.TensorStride() == 1 )) {
       // We copy the whole tensor as a single data block
       bytes *= telems;
@@ -77,7 +77,7 @@ void CopyFrom( Image const& src, Image& dest, IntegerArray const& offsets ) {
    dest.CopyNonDataProperties( src );
    // Samples
    dip::uint telems = src.TensorElements();
-   dip::uint bytes = DataType().SizeOf(); // both source and destination have the same types
+   dip::uint bytes = src.DataType().SizeOf(); // both source and destination have the same types
    if(( src.TensorStride() == 1 ) && ( dest.TensorStride() == 1 )) {
       // We copy the whole tensor as a single data block
       bytes *= telems;
@@ -154,9 +154,9 @@ void CopyTo( Image const& src, Image& dest, IntegerArray const& offsets ) {
    DIP_THROW_IF( src.TensorElements() != dest.TensorElements(), E::NTENSORELEM_DONT_MATCH );
    DIP_THROW_IF( offsets.empty(), E::ARRAY_PARAMETER_EMPTY );
    DIP_THROW_IF( src.NumberOfPixels() != offsets.size(), "Number of pixels does not match offset list" );
-   if( DataType() == src.DataType() ) {
+   if( dest.DataType() == src.DataType() ) {
       dip::uint telems = dest.TensorElements();
-      dip::uint bytes = DataType().SizeOf(); // both source and destination have the same types
+      dip::uint bytes = src.DataType().SizeOf(); // both source and destination have the same types
       if(( dest.TensorStride() == 1 ) && ( src.TensorStride() == 1 )) {
          // We copy the whole tensor as a single data block
          bytes *= telems;
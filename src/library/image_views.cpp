@@ -623,4 +623,37 @@ DOCTEST_TEST_CASE( "[DIPlib] testing dip::Image::View" ) {
    DOCTEST_CHECK( img.At( 1, 1, 0 )[ 2 ] == 4 + 2000 );
 }
 
+DOCTEST_TEST_CASE( "[DIPlib] testing dip::Image::View with data types other than sfloat" ) {
+   dip::Image img{ dip::UnsignedArray{ 5, 4 }, 1, dip::DT_DFLOAT };
+   for( dip::uint ii = 0; ii < img.NumberOfPixels(); ++ii ) {
+      img.At( ii ) = 1e10 + static_cast< dip::dfloat >( ii );
+   }
+   dip::Image mask = img > 1e10 + 7;
+   dip::Image ref = img.At( mask );
+   DOCTEST_CHECK( ref.DataType() == dip::DT_DFLOAT );
+   DOCTEST_REQUIRE( ref.Sizes() == dip::UnsignedArray{ 12 } );
+   DOCTEST_CHECK( ref.At( 0 ) == 1e10 + 8 );
+   DOCTEST_CHECK( ref.At( 11 ) == 1e10 + 19 );
+   dip::CoordinateArray coords{ dip::UnsignedArray{ 1, 0 }, dip::UnsignedArray{ 4, 3 } };
+   ref = img.At( coords );
+   DOCTEST_CHECK( ref.At( 0 ) == 1e10 + 1 );
+   DOCTEST_CHECK( ref.At( 1 ) == 1e10 + 19 );
+   // Copying into views
+   dip::Image src{ dip::UnsignedArray{ 2 }, 1, dip::DT_DFLOAT };
+   src.At( 0 ) = -1e10;
+   src.At( 1 ) = -2e10;
+   img.At( coords ) = src;
+   DOCTEST_CHECK( img.At( 1, 0 ) == -1e10 );
+   DOCTEST_CHECK( img.At( 4, 3 ) == -2e10 );
+   // Copying into views of a different data type
+   dip::Image intImg{ dip::UnsignedArray{ 5, 4 }, 1, dip::DT_SINT32 };
+   intImg.Fill( 0 );
+   src = dip::Image{ dip::UnsignedArray{ 2 }, 1, dip::DT_SFLOAT };
+   src.At( 0 ) = 7;
+   src.At( 1 ) = -8;
+   intImg.At( coords ) = src;
+   DOCTEST_CHECK( intImg.At( 1, 0 ) == 7 );
+   DOCTEST_CHECK( intImg.At( 4, 3 ) == -8 );
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -350,8 +350,8 @@ namespace {
 template< typename TPI >
 class GeneralConvolutionLineFilter : public Framework::FullLineFilter {
    public:
-      virtual void SetNumberOfThreads( dip::uint, PixelTableOffsets const& pixelTable ) override {
-         offsets_ = pixelTable.Offsets();
+      virtual void SetNumberOfThreads( dip::uint threads, PixelTableOffsets const& ) override {
+         buffers_.resize( threads );
       }
       virtual void Filter( Framework::FullLineFilterParameters const& params ) override {
          TPI* in = static_cast< TPI* >( params.inBuffer.buffer );
@@ -360,23 +360,44 @@ class GeneralConvolutionLineFilter : public Framework::FullLineFilter {
          dip::sint outStride = params.outBuffer.stride;
          dip::uint length = params.bufferLength;
          PixelTableOffsets const& pixelTable = params.pixelTable;
+         dip::sint runStride = pixelTable.Stride();
          std::vector< dfloat > const& weights = pixelTable.Weights();
-         for( dip::uint ii = 0; ii < length; ++ii ) {
-            TPI sum = 0;
-            auto ito = offsets_.begin();
+         // The line is processed in blocks. For each block, we loop over the pixel table runs and the filter weights,
+         // and accumulate the contribution of that one weight to all output pixels in the block (weight-major order).
+         // The inner loop is a simple multiply-add over consecutive input pixels, which the compiler can vectorize.
+         constexpr dip::uint blockSize = 256;
+         std::vector< TPI >& buffer = buffers_[ params.thread ];
+         buffer.resize( std::min( length, blockSize ));
+         TPI* acc = buffer.data();
+         for( dip::uint start = 0; start < length; start += blockSize ) {
+            dip::uint n = std::min( blockSize, length - start );
+            std::fill( acc, acc + n, TPI( 0 ));
+            TPI const* inBlock = in + static_cast< dip::sint >( start ) * inStride;
             auto itw = weights.begin();
-            while( ito != offsets_.end() ) {
-               sum += in[ *ito ] * static_cast< FloatType< TPI >>( *itw );
-               ++ito;
-               ++itw;
+            for( auto const& run : pixelTable.Runs() ) {
+               TPI const* pin = inBlock + run.offset;
+               for( dip::uint jj = 0; jj < run.length; ++jj, ++itw, pin += runStride ) {
+                  FloatType< TPI > weight = static_cast< FloatType< TPI >>( *itw );
+                  if( inStride == 1 ) {
+                     for( dip::uint ii = 0; ii < n; ++ii ) {
+                        acc[ ii ] += pin[ ii ] * weight;
+                     }
+                  } else {
+                     TPI const* pp = pin;
+                     for( dip::uint ii = 0; ii < n; ++ii, pp += inStride ) {
+                        acc[ ii ] += *pp * weight;
+                     }
+                  }
+               }
+            }
+            TPI* pout = out + static_cast< dip::sint >( start ) * outStride;
+            for( dip::uint ii = 0; ii < n; ++ii, pout += outStride ) {
+               *pout = acc[ ii ];
             }
-            *out = sum;
-            in += inStride;
-            out += outStride;
          }
       }
    private:
-      std::vector< dip::sint > offsets_;
+      std::vector< std::vector< TPI >> buffers_; // one accumulation buffer per thread
 };
 
 } // namespace
@@ -405,6 +426,92 @@ void GeneralConvolution(
    DIP_END_STACK_TRACE
 }
 
+namespace {
+
+void LowRankConvolution(
+      Image const& c_in,
+      std::vector< OneDimensionalFilterArray > const& terms,
+      Image& out,
+      StringArray const& boundaryCondition
+) {
+   DIP_ASSERT( !terms.empty() );
+   Image in = c_in.QuickCopy();
+   if( in.Aliases( out )) {
+      out.Strip();
+   }
+   SeparableConvolution( in, out, terms[ 0 ], boundaryCondition );
+   Image tmp;
+   for( dip::uint ii = 1; ii < terms.size(); ++ii ) {
+      SeparableConvolution( in, tmp, terms[ ii ], boundaryCondition );
+      Add( out, tmp, out, out.DataType() );
+   }
+}
+
+} // namespace
+
+void Convolution(
+      Image const& in,
+      Image const& filter,
+      Image& out,
+      String const& method,
+      StringArray const& boundaryCondition,
+      dfloat tolerance
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !filter.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !filter.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !filter.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_START_STACK_TRACE
+      if( filter.DataType().IsBinary() ) {
+         GeneralConvolution( in, filter, out, boundaryCondition ); // calls Uniform
+         return;
+      }
+      if( method == S::DIRECT ) {
+         GeneralConvolution( in, filter, out, boundaryCondition );
+         return;
+      }
+      if( method == S::FOURIER ) {
+         ConvolveFT( in, filter, out );
+         return;
+      }
+      if(( method != S::SEPARABLE ) && ( method != S::BEST )) {
+         DIP_THROW_INVALID_FLAG( method );
+      }
+      std::vector< OneDimensionalFilterArray > terms = SeparateFilterLowRank( filter, tolerance );
+      if( method == S::SEPARABLE ) {
+         DIP_THROW_IF( terms.empty(), "Filter cannot be decomposed into separable terms" );
+         LowRankConvolution( in, terms, out, boundaryCondition );
+         return;
+      }
+      // Estimate costs, in number of multiply-adds per pixel
+      dfloat separableCost = std::numeric_limits< dfloat >::infinity();
+      if( !terms.empty() ) {
+         dip::uint length = 0;
+         for( auto const& f : terms[ 0 ] ) {
+            length += f.filter.size();
+         }
+         separableCost = static_cast< dfloat >( terms.size() * length );
+      }
+      dfloat directCost = static_cast< dfloat >( Kernel{ filter }.PixelTable( in.Dimensionality(), 0 ).NumberOfPixels() );
+      dfloat fourierCost = std::numeric_limits< dfloat >::infinity();
+      Image filterExpanded = filter.QuickCopy();
+      if( filterExpanded.Dimensionality() < in.Dimensionality() ) {
+         filterExpanded.ExpandDimensionality( in.Dimensionality() );
+      }
+      if(( filterExpanded.Dimensionality() == in.Dimensionality() ) && ( filterExpanded.Sizes() <= in.Sizes() )) {
+         // Three transforms (image, filter, inverse), each about 5 log2(N) operations per pixel
+         fourierCost = 15.0 * std::log2( static_cast< dfloat >( in.NumberOfPixels() ));
+      }
+      if(( separableCost <= directCost ) && ( separableCost <= fourierCost )) {
+         LowRankConvolution( in, terms, out, boundaryCondition );
+      } else if( directCost <= fourierCost ) {
+         GeneralConvolution( in, filter, out, boundaryCondition );
+      } else {
+         ConvolveFT( in, filter, out );
+      }
+   DIP_END_STACK_TRACE
+}
+
 
 } // namespace dip
 
@@ -501,4 +608,54 @@ DOCTEST_TEST_CASE("[DIPlib] testing the separable convolution") {
    DOCTEST_CHECK( dip::Mean( out1 - out2 ).As< dip::dfloat >() / meanval == doctest::Approx( 0.0 ));
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the convolution dispatcher") {
+   dip::Image img{ dip::UnsignedArray{ 64, 48 }, 1, dip::DT_SFLOAT };
+   img.Fill( 100.0 );
+   dip::Random random( 0 );
+   dip::GaussianNoise( img, img, random, 10.0 );
+   // A rank-2 kernel
+   dip::Image kernel{ dip::UnsignedArray{ 9, 7 }, 1, dip::DT_DFLOAT };
+   dip::ImageIterator< dip::dfloat > it( kernel );
+   do {
+      dip::dfloat x = static_cast< dip::dfloat >( it.Coordinates()[ 0 ] ) - 4.0;
+      dip::dfloat y = static_cast< dip::dfloat >( it.Coordinates()[ 1 ] ) - 3.0;
+      *it = std::exp( -x * x / 8.0 ) * ( y + 0.5 ) + std::exp( -y * y / 2.0 ) * x * x / 40.0;
+   } while( ++it );
+   // Output values are around 2000, the tolerance corresponds to the precision of `sfloat`
+   dip::Image ref = dip::GeneralConvolution( img, kernel, { "periodic" } );
+   dip::Image out = dip::Convolution( img, kernel, "separable", { "periodic" } );
+   DOCTEST_CHECK( dip::MaximumAbs( out - ref ).As< dip::dfloat >() < 5e-3 );
+   out = dip::Convolution( img, kernel, "best", { "periodic" } );
+   DOCTEST_CHECK( dip::MaximumAbs( out - ref ).As< dip::dfloat >() < 5e-3 );
+   out = dip::Convolution( img, kernel, "fourier" );
+   DOCTEST_CHECK( dip::MaximumAbs( out - ref ).As< dip::dfloat >() < 1e-2 );
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the general convolution") {
+   // Lines longer than the block size used by the line filter, and a kernel with several runs
+   dip::Image img{ dip::UnsignedArray{ 700, 9 }, 1, dip::DT_SFLOAT };
+   img.Fill( 50.0 );
+   dip::Random random( 0 );
+   dip::GaussianNoise( img, img, random, 10.0 );
+   dip::OneDimensionalFilterArray filterArray( 2 );
+   filterArray[ 0 ].filter = { 1.0, -2.0, 4.0, 0.5, 3.0 };
+   filterArray[ 1 ].filter = { 0.2, 1.0, -0.7 };
+   dip::Image kernel{ dip::UnsignedArray{ 5, 3 }, 1, dip::DT_DFLOAT };
+   for( dip::uint jj = 0; jj < 3; ++jj ) {
+      for( dip::uint ii = 0; ii < 5; ++ii ) {
+         kernel.At( ii, jj ) = filterArray[ 0 ].filter[ ii ] * filterArray[ 1 ].filter[ jj ];
+      }
+   }
+   dip::Image out1 = dip::GeneralConvolution( img, kernel );
+   dip::Image out2 = dip::SeparableConvolution( img, filterArray );
+   DOCTEST_CHECK( dip::MaximumAbs( out1 - out2 ).As< dip::dfloat >() < 1e-3 );
+   // The same along the other dimension, where the input stride is not 1
+   img.SwapDimensions( 0, 1 );
+   kernel.SwapDimensions( 0, 1 );
+   std::swap( filterArray[ 0 ], filterArray[ 1 ] );
+   out1 = dip::GeneralConvolution( img, kernel );
+   out2 = dip::SeparableConvolution( img, filterArray );
+   DOCTEST_CHECK( dip::MaximumAbs( out1 - out2 ).As< dip::dfloat >() < 1e-3 );
+}
+
 #endif // DIP__ENABLE_DOCTEST
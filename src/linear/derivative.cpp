@@ -27,36 +27,52 @@ namespace dip {
 
 namespace {
 
-void GaussDispatch(
-      Image const& in,
-      Image& out,
+enum class GaussMethod { FIR, FT, IIR };
+
+GaussMethod GaussDispatchMethod(
       FloatArray const& sigmas,
-      UnsignedArray const& derivativeOrder,
-      StringArray const& boundaryCondition,
-      dfloat truncation
+      UnsignedArray const& derivativeOrder
 ) {
    // If any( sigmas < 0.8 ) || any( derivativeOrder > 3 )  ==>  FT
    // Else if any( sigmas > 10 )  ==>  IIR
    // Else ==>  FIR
    for( dip::uint ii = 0; ii < derivativeOrder.size(); ++ii ) { // We can't fold this loop in with the next one, the two arrays might be of different size
       if( derivativeOrder[ ii ] > 3 ) {
-         GaussFT( in, out, sigmas, derivativeOrder, truncation ); // ignores boundaryCondition
-         return;
+         return GaussMethod::FT;
       }
    }
    for( dip::uint ii = 0; ii < sigmas.size(); ++ii ) {
       if(( sigmas[ ii ] < 0.8 ) && ( sigmas[ ii ] > 0.0 )) {
-         GaussFT( in, out, sigmas, derivativeOrder, truncation ); // ignores boundaryCondition
-         return;
+         return GaussMethod::FT;
       }
    }
    for( dip::uint ii = 0; ii < sigmas.size(); ++ii ) {
       if( sigmas[ ii ] > 10 ) {
-         GaussIIR( in, out, sigmas, derivativeOrder, boundaryCondition, {}, S::DISCRETE_TIME_FIT, truncation );
-         return;
+         return GaussMethod::IIR;
       }
    }
-   GaussFIR( in, out, sigmas, derivativeOrder, boundaryCondition, truncation );
+   return GaussMethod::FIR;
+}
+
+void GaussDispatch(
+      Image const& in,
+      Image& out,
+      FloatArray const& sigmas,
+      UnsignedArray const& derivativeOrder,
+      StringArray const& boundaryCondition,
+      dfloat truncation
+) {
+   switch( GaussDispatchMethod( sigmas, derivativeOrder )) {
+      case GaussMethod::FT:
+         GaussFT( in, out, sigmas, derivativeOrder, truncation ); // ignores boundaryCondition
+         break;
+      case GaussMethod::IIR:
+         GaussIIR( in, out, sigmas, derivativeOrder, boundaryCondition, {}, S::DISCRETE_TIME_FIT, truncation );
+         break;
+      case GaussMethod::FIR:
+         GaussFIR( in, out, sigmas, derivativeOrder, boundaryCondition, truncation );
+         break;
+   }
 }
 
 } // namespace
@@ -141,6 +157,150 @@ UnsignedArray FindGradientDimensions(
    return dims;
 }
 
+// Lists the derivative orders for the components of the gradient
+std::vector< UnsignedArray > GradientOrders( dip::uint nDims, UnsignedArray const& dims ) {
+   std::vector< UnsignedArray > orders( dims.size(), UnsignedArray( nDims, 0 ));
+   for( dip::uint ii = 0; ii < dims.size(); ++ii ) {
+      orders[ ii ][ dims[ ii ]] = 1;
+   }
+   return orders;
+}
+
+// Lists the derivative orders for the components of the Hessian, in the storage order of a symmetric matrix
+std::vector< UnsignedArray > HessianOrders( dip::uint nDims, UnsignedArray const& dims ) {
+   std::vector< UnsignedArray > orders;
+   for( dip::uint ii = 0; ii < dims.size(); ++ii ) { // Symmetric matrix stores diagonal elements first
+      orders.emplace_back( nDims, 0 );
+      orders.back()[ dims[ ii ]] = 2;
+   }
+   for( dip::uint jj = 1; jj < dims.size(); ++jj ) { // Elements above diagonal stored column-wise
+      for( dip::uint ii = 0; ii < jj; ++ii ) {
+         orders.emplace_back( nDims, 0 );
+         orders.back()[ dims[ ii ]] = 1;
+         orders.back()[ dims[ jj ]] = 1;
+      }
+   }
+   return orders;
+}
+
+// One level of the derivative bank: filters `in` along `passDims[ level ]` once for each distinct derivative order
+// required by `components`, and recurses into the next dimension with the subset of components that share that
+// intermediate result.
+void DerivativeBankPass(
+      Image const& in,
+      ImageArray& out,
+      std::vector< UnsignedArray > const& orders,
+      std::vector< dip::uint > const& components,
+      UnsignedArray const& passDims,
+      dip::uint level,
+      FloatArray const& sigmas,
+      StringArray const& boundaryCondition,
+      dfloat truncation
+) {
+   dip::uint nDims = in.Dimensionality();
+   dip::uint dim = passDims[ level ];
+   bool last = level + 1 == passDims.size();
+   FloatArray passSigmas( nDims, 0.0 );
+   passSigmas[ dim ] = sigmas[ dim ];
+   UnsignedArray passOrder( nDims, 0 );
+   std::vector< bool > done( components.size(), false );
+   for( dip::uint ii = 0; ii < components.size(); ++ii ) {
+      if( done[ ii ] ) {
+         continue;
+      }
+      dip::uint order = orders[ components[ ii ]][ dim ];
+      std::vector< dip::uint > subset;
+      for( dip::uint jj = ii; jj < components.size(); ++jj ) {
+         if( !done[ jj ] && ( orders[ components[ jj ]][ dim ] == order )) {
+            subset.push_back( components[ jj ] );
+            done[ jj ] = true;
+         }
+      }
+      passOrder[ dim ] = order;
+      if( last ) {
+         // Components that reach this point have identical orders, there's normally only one
+         GaussFIR( in, out[ subset[ 0 ]], passSigmas, passOrder, boundaryCondition, truncation );
+         for( dip::uint jj = 1; jj < subset.size(); ++jj ) {
+            out[ subset[ jj ]].Copy( out[ subset[ 0 ]] );
+         }
+      } else {
+         Image tmp;
+         GaussFIR( in, tmp, passSigmas, passOrder, boundaryCondition, truncation );
+         DerivativeBankPass( tmp, out, orders, subset, passDims, level + 1, sigmas, boundaryCondition, truncation );
+      }
+   }
+}
+
+// Computes the derivatives of `in` for each of the derivative orders in `orders`, writing them to the corresponding
+// element of `out`. Elements of `out` can be forged views into a larger image. `sigmas` must have one element per
+// image dimension.
+//
+// For the FIR implementation of the Gaussian derivatives, the 1D passes are arranged in a tree, such that the
+// components that share derivative orders along the first few dimensions share the intermediate results: dimensions
+// that are only smoothed are filtered once for all components, and e.g. for the 3D Hessian only 15 1D passes are
+// needed instead of 18. For other methods each component is computed independently.
+void DerivativeBank(
+      Image const& in,
+      ImageArray& out,
+      std::vector< UnsignedArray > const& orders,
+      FloatArray const& sigmas,
+      String const& method,
+      StringArray const& boundaryCondition,
+      dfloat truncation
+) {
+   DIP_ASSERT( out.size() == orders.size() );
+   dip::uint nDims = in.Dimensionality();
+   DIP_ASSERT( sigmas.size() == nDims );
+   bool useBank = ( method == "gaussFIR" ) || ( method == "gaussfir" );
+   if( !useBank && (( method == S::BEST ) || ( method == "gauss" ))) {
+      useBank = true;
+      for( auto const& order : orders ) {
+         if( GaussDispatchMethod( sigmas, order ) != GaussMethod::FIR ) {
+            useBank = false;
+            break;
+         }
+      }
+   }
+   if( !useBank || ( orders.size() < 2 )) {
+      for( dip::uint ii = 0; ii < orders.size(); ++ii ) {
+         DIP_STACK_TRACE_THIS( Derivative( in, out[ ii ], orders[ ii ], sigmas, method, boundaryCondition, truncation ));
+      }
+      return;
+   }
+   // Dimensions that are only smoothed go first, they're shared by all components
+   UnsignedArray passDims;
+   UnsignedArray derivativeDims;
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      if(( sigmas[ ii ] > 0.0 ) && ( in.Size( ii ) > 1 )) {
+         bool derivative = false;
+         for( auto const& order : orders ) {
+            if( order[ ii ] > 0 ) {
+               derivative = true;
+               break;
+            }
+         }
+         ( derivative ? derivativeDims : passDims ).push_back( ii );
+      }
+   }
+   passDims.push_back( derivativeDims );
+   DIP_ASSERT( !passDims.empty() );
+   std::vector< dip::uint > components( orders.size() );
+   for( dip::uint ii = 0; ii < orders.size(); ++ii ) {
+      components[ ii ] = ii;
+   }
+   DIP_STACK_TRACE_THIS( DerivativeBankPass( in, out, orders, components, passDims, 0, sigmas, boundaryCondition, truncation ));
+}
+
+// Collects views to all tensor elements of `img`
+ImageArray TensorElementViews( Image const& img ) {
+   ImageArray views;
+   views.reserve( img.TensorElements() );
+   for( auto it = ImageTensorIterator( img ); it; ++it ) {
+      views.push_back( *it );
+   }
+   return views;
+}
+
 } // namespace
 
 void Gradient(
@@ -164,14 +324,8 @@ void Gradient(
       out.Strip();
    }
    out.ReForge( in.Sizes(), nDims, DataType::SuggestFlex( in.DataType() ));
-   UnsignedArray order( in.Dimensionality(), 0 );
-   auto it = ImageTensorIterator( out );
-   for( dip::uint ii = 0; ii < nDims; ++ii ) {
-      order[ dims[ ii ]] = 1;
-      DIP_STACK_TRACE_THIS( Derivative( in, *it, order, sigmas, method, boundaryCondition, truncation ));
-      order[ dims[ ii ]] = 0;
-      ++it;
-   }
+   ImageArray components = TensorElementViews( out );
+   DIP_STACK_TRACE_THIS( DerivativeBank( in, components, GradientOrders( in.Dimensionality(), dims ), sigmas, method, boundaryCondition, truncation ));
    out.SetPixelSize( pxsz );
 }
 
@@ -193,22 +347,19 @@ void GradientMagnitude(
    if( in.Aliases( out ) ) {
       out.Strip();
    }
-   UnsignedArray order( in.Dimensionality(), 0 );
-   order[ dims[ 0 ]] = 1;
-   Derivative( in, out, order, sigmas, method, boundaryCondition, truncation );
+   ImageArray components( nDims );
+   DIP_STACK_TRACE_THIS( DerivativeBank( in, components, GradientOrders( in.Dimensionality(), dims ), sigmas, method, boundaryCondition, truncation ));
    if( nDims > 1 ) {
-      MultiplySampleWise( out, out, out, out.DataType() );
-      Image tmp;
+      MultiplySampleWise( components[ 0 ], components[ 0 ], out, components[ 0 ].DataType() );
       for( dip::uint ii = 1; ii < nDims; ++ii ) {
-         order[ dims[ ii - 1 ]] = 0;
-         order[ dims[ ii ]] = 1;
-         DIP_STACK_TRACE_THIS( Derivative( in, tmp, order, sigmas, method, boundaryCondition, truncation ));
+         Image& tmp = components[ ii ];
          MultiplySampleWise( tmp, tmp, tmp, tmp.DataType() );
          Add( out, tmp, out, out.DataType() );
+         tmp.Strip();
       }
       Sqrt( out, out );
    } else {
-      Abs( out, out );
+      Abs( components[ 0 ], out );
    }
 }
 
@@ -354,24 +505,8 @@ void Hessian (
    Tensor tensor( Tensor::Shape::SYMMETRIC_MATRIX, nDims, nDims );
    out.ReForge( in.Sizes(), tensor.Elements(), DataType::SuggestFlex( in.DataType() ));
    out.ReshapeTensor( tensor );
-   UnsignedArray order( in.Dimensionality(), 0 );
-   auto it = ImageTensorIterator( out );
-   for( dip::uint ii = 0; ii < nDims; ++ii ) { // Symmetric matrix stores diagonal elements first
-      order[ dims[ ii ]] = 2;
-      DIP_STACK_TRACE_THIS( Derivative( in, *it, order, sigmas, method, boundaryCondition, truncation ));
-      order[ dims[ ii ]] = 0;
-      ++it;
-   }
-   for( dip::uint jj = 1; jj < nDims; ++jj ) { // Elements above diagonal stored column-wise
-      for( dip::uint ii = 0; ii < jj; ++ii ) {
-         order[ dims[ ii ]] = 1;
-         order[ dims[ jj ]] = 1;
-         DIP_STACK_TRACE_THIS( Derivative( in, *it, order, sigmas, method, boundaryCondition, truncation ));
-         order[ dims[ ii ]] = 0;
-         order[ dims[ jj ]] = 0;
-         ++it;
-      }
-   }
+   ImageArray components = TensorElementViews( out );
+   DIP_STACK_TRACE_THIS( DerivativeBank( in, components, HessianOrders( in.Dimensionality(), dims ), sigmas, method, boundaryCondition, truncation ));
    out.SetPixelSize( pxsz );
 }
 
@@ -407,15 +542,16 @@ void Laplace (
       if( in.Aliases( out ) ) {
          out.Strip();
       }
-      UnsignedArray order( in.Dimensionality(), 0 );
-      order[ dims[ 0 ]] = 2;
-      DIP_STACK_TRACE_THIS( Derivative( in, out, order, sigmas, method, boundaryCondition, truncation ));
-      Image tmp;
+      std::vector< UnsignedArray > orders( nDims, UnsignedArray( in.Dimensionality(), 0 ));
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         orders[ ii ][ dims[ ii ]] = 2;
+      }
+      ImageArray components( nDims );
+      DIP_STACK_TRACE_THIS( DerivativeBank( in, components, orders, sigmas, method, boundaryCondition, truncation ));
+      out.Copy( components[ 0 ] );
       for( dip::uint ii = 1; ii < nDims; ++ii ) {
-         order[ dims[ ii - 1 ]] = 0;
-         order[ dims[ ii ]] = 2;
-         DIP_STACK_TRACE_THIS( Derivative( in, tmp, order, sigmas, method, boundaryCondition, truncation ));
-         out += tmp;
+         out += components[ ii ];
+         components[ ii ].Strip();
       }
    }
 }
@@ -437,10 +573,28 @@ void DggFamily(
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
 
-   Image g, H;
-   DIP_STACK_TRACE_THIS( Gradient( in, g, sigmas, method, boundaryCondition, process, truncation ));
-   DIP_STACK_TRACE_THIS( Hessian( in, H, sigmas, method, boundaryCondition, process, truncation ));
-   DIP_ASSERT( g.TensorElements() == H.TensorRows());
+   // Compute the gradient and the Hessian together, they share most of their 1D passes
+   FloatArray ss = sigmas;
+   UnsignedArray dims;
+   DIP_STACK_TRACE_THIS( dims = FindGradientDimensions( in.Sizes(), ss, process ));
+   dip::uint nDims = dims.size();
+   DIP_THROW_IF( nDims < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DataType dt = DataType::SuggestFlex( in.DataType() );
+   Image g( in.Sizes(), nDims, dt );
+   Tensor tensor( Tensor::Shape::SYMMETRIC_MATRIX, nDims, nDims );
+   Image H( in.Sizes(), tensor.Elements(), dt );
+   H.ReshapeTensor( tensor );
+   {
+      ImageArray components = TensorElementViews( g );
+      ImageArray hessianComponents = TensorElementViews( H );
+      components.insert( components.end(), hessianComponents.begin(), hessianComponents.end() );
+      std::vector< UnsignedArray > orders = GradientOrders( in.Dimensionality(), dims );
+      std::vector< UnsignedArray > hessianOrders = HessianOrders( in.Dimensionality(), dims );
+      orders.insert( orders.end(), hessianOrders.begin(), hessianOrders.end() );
+      DIP_STACK_TRACE_THIS( DerivativeBank( in, components, orders, ss, method, boundaryCondition, truncation ));
+   }
+   g.SetPixelSize( in.PixelSize() );
+   H.SetPixelSize( in.PixelSize() );
 
    // The easy way to compute this:
    //    out = Transpose( g ) * H * g;
@@ -564,3 +718,41 @@ void NormalizedDifferentialConvolution(
 };
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/statistics.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the derivative bank") {
+   dip::Image img{ dip::UnsignedArray{ 40, 30, 20 }, 1, dip::DT_SFLOAT };
+   img.Fill( 100.0 );
+   dip::Random random( 0 );
+   dip::GaussianNoise( img, img, random, 20.0 );
+   dip::FloatArray sigmas{ 1.5, 2.0, 1.0 };
+   // Gradient computed in one go compared to individual derivatives
+   dip::Image grad = dip::Gradient( img, sigmas );
+   DOCTEST_REQUIRE( grad.TensorElements() == 3 );
+   for( dip::uint ii = 0; ii < 3; ++ii ) {
+      dip::UnsignedArray order( 3, 0 );
+      order[ ii ] = 1;
+      dip::Image ref = dip::Derivative( img, order, sigmas, "gaussFIR" );
+      DOCTEST_CHECK( dip::MaximumAbs( grad[ ii ] - ref ).As< dip::dfloat >() < 1e-4 );
+   }
+   // Hessian, with one dimension excluded
+   dip::Image hess = dip::Hessian( img, sigmas, "gaussFIR", {}, { true, false, true } );
+   DOCTEST_REQUIRE( hess.TensorElements() == 3 );
+   dip::Image ref = dip::Derivative( img, { 2, 0, 0 }, sigmas, "gaussFIR" );
+   DOCTEST_CHECK( dip::MaximumAbs( hess[ 0 ] - ref ).As< dip::dfloat >() < 1e-4 );
+   ref = dip::Derivative( img, { 0, 0, 2 }, sigmas, "gaussFIR" );
+   DOCTEST_CHECK( dip::MaximumAbs( hess[ 1 ] - ref ).As< dip::dfloat >() < 1e-4 );
+   ref = dip::Derivative( img, { 1, 0, 1 }, sigmas, "gaussFIR" );
+   DOCTEST_CHECK( dip::MaximumAbs( hess[ 2 ] - ref ).As< dip::dfloat >() < 1e-4 );
+   // Gradient magnitude
+   dip::Image gm = dip::GradientMagnitude( img, sigmas );
+   ref = dip::Norm( grad );
+   DOCTEST_CHECK( dip::MaximumAbs( gm - ref ).As< dip::dfloat >() < 1e-4 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
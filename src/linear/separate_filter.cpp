@@ -87,6 +87,67 @@ OneDimensionalFilterArray SeparateFilter( Image const& c_in ) {
    return out;
 }
 
+std::vector< OneDimensionalFilterArray > SeparateFilterLowRank( Image const& c_in, dfloat tolerance, dip::uint maxTerms ) {
+   DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !c_in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( !c_in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   dip::uint ndims = c_in.Dimensionality();
+   DIP_THROW_IF( ndims < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF( tolerance < 0, E::PARAMETER_OUT_OF_RANGE );
+   // Separable filters are the simplest case
+   OneDimensionalFilterArray separable = SeparateFilter( c_in );
+   if( !separable.empty() ) {
+      return { separable };
+   }
+   // Find the two dimensions along which the filter has a size larger than 1
+   UnsignedArray dims;
+   for( dip::uint ii = 0; ii < ndims; ++ii ) {
+      if( c_in.Size( ii ) > 1 ) {
+         dims.push_back( ii );
+      }
+   }
+   if( dims.size() != 2 ) {
+      return {};
+   }
+   Image filter = Convert( c_in, DT_DFLOAT ); // Filter is DFLOAT and has normal strides
+   DIP_ASSERT( filter.HasNormalStrides() );
+   dip::uint rows = filter.Size( dims[ 0 ] );
+   dip::uint cols = filter.Size( dims[ 1 ] );
+   // Because the other dimensions are singletons, the first dimension is contiguous, and we can see the filter
+   // as a column-major matrix
+   Eigen::Map< Eigen::MatrixXd > matrix( static_cast< dfloat* >( filter.Origin() ),
+                                         static_cast< Eigen::Index >( rows ), static_cast< Eigen::Index >( cols ));
+   Eigen::JacobiSVD< Eigen::MatrixXd > svd( matrix, Eigen::ComputeThinU | Eigen::ComputeThinV );
+   auto S = svd.singularValues();
+   dip::uint nValues = static_cast< dip::uint >( S.size() );
+   // The squared Frobenius norm of the error when keeping `rank` terms is the sum of the remaining squared singular values
+   dfloat total = S.squaredNorm();
+   dfloat limit = tolerance * tolerance * total;
+   dip::uint rank = nValues;
+   dfloat error = 0.0;
+   while( rank > 1 ) {
+      dfloat s = S( static_cast< Eigen::Index >( rank - 1 ));
+      if( error + s * s > limit ) {
+         break;
+      }
+      error += s * s;
+      --rank;
+   }
+   if(( maxTerms > 0 ) && ( rank > maxTerms )) {
+      return {};
+   }
+   std::vector< OneDimensionalFilterArray > out( rank, OneDimensionalFilterArray( ndims ));
+   for( dip::uint kk = 0; kk < rank; ++kk ) {
+      Eigen::Index k = static_cast< Eigen::Index >( kk );
+      OneDimensionalFilter& f0 = out[ kk ][ dims[ 0 ]];
+      f0.filter.resize( rows );
+      Eigen::Map< Eigen::VectorXd >( f0.filter.data(), static_cast< Eigen::Index >( rows )) = svd.matrixU().col( k ) * S( k );
+      OneDimensionalFilter& f1 = out[ kk ][ dims[ 1 ]];
+      f1.filter.resize( cols );
+      Eigen::Map< Eigen::VectorXd >( f1.filter.data(), static_cast< Eigen::Index >( cols )) = svd.matrixV().col( k );
+   }
+   return out;
+}
 
 } // namespace dip
 
@@ -164,4 +225,28 @@ DOCTEST_TEST_CASE("[DIPlib] testing the filter separation") {
    DOCTEST_CHECK( m.Maximum() < 1e-5 );
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the low-rank filter separation") {
+   // A sum of two separable Gaussian kernels is not separable, but has rank 2
+   dip::Image delta( { 25, 21 }, 1, dip::DT_DFLOAT );
+   delta.Fill( 0 );
+   delta.At( 12, 10 ) = 1;
+   dip::Image kernel = dip::GaussFIR( delta, { 2, 4 }, { 0, 1 } );
+   kernel += dip::GaussFIR( delta, { 4, 1.5 }, { 2, 0 } );
+   DOCTEST_CHECK( dip::SeparateFilter( kernel ).empty() );
+   auto terms = dip::SeparateFilterLowRank( kernel, 1e-6 );
+   DOCTEST_REQUIRE( terms.size() == 2 );
+   DOCTEST_CHECK( dip::SeparateFilterLowRank( kernel, 1e-6, 1 ).empty() );
+   dip::Image img( { 60, 50 }, 1, dip::DT_SFLOAT );
+   img.Fill( 0 );
+   img.At( 20, 30 ) = 100;
+   img.At( 41, 12 ) = 50;
+   dip::Image ref = dip::GeneralConvolution( img, kernel );
+   dip::Image sum = dip::SeparableConvolution( img, terms[ 0 ] );
+   sum += dip::SeparableConvolution( img, terms[ 1 ] );
+   DOCTEST_CHECK( dip::MaximumAbs( sum - ref ).As< dip::dfloat >() < 1e-4 );
+   // A 3D kernel with three non-singleton dimensions can only be decomposed if it's separable
+   auto circ = dip::Convert( dip::PixelTable( "elliptic", { 10, 11, 5 } ).AsImage(), dip::DT_UINT8 );
+   DOCTEST_CHECK( dip::SeparateFilterLowRank( circ ).empty() );
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -23,6 +23,7 @@
 #include "diplib/framework.h"
 #include "diplib/pixel_table.h"
 #include "diplib/overload.h"
+#include "mapping_support.h"
 
 namespace dip {
 
@@ -281,14 +282,95 @@ class dip__IndexedLUT_Float : public Framework::ScanLineFilter {
       LookupTable::InterpolationMode interpolation_;
 };
 
+template< typename TPI, typename TPIn >
+class dip__TabulatedLUT : public Framework::ScanLineFilter {
+      // Applies a LUT that was evaluated for every possible value of the 8-bit or 16-bit integer input type TPIn.
+      // `table` has one pixel per input value, starting at the lowest value of TPIn. Out-of-bounds handling,
+      // the index and interpolation are all accounted for in the table, so no tests are needed here.
+   public:
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override { return 2; }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         TPIn const* in = static_cast< TPIn const* >( params.inBuffer[ 0 ].buffer );
+         auto bufferLength = params.bufferLength;
+         auto inStride = params.inBuffer[ 0 ].stride;
+         TPI* out = static_cast< TPI* >( params.outBuffer[ 0 ].buffer );
+         auto outStride = params.outBuffer[ 0 ].stride;
+         auto tensorLength = params.outBuffer[ 0 ].tensorLength;
+         auto outTensorStride = params.outBuffer[ 0 ].tensorStride;
+         constexpr dip::sint lowest = std::numeric_limits< TPIn >::lowest();
+         TPI const* table = static_cast< TPI const* >( table_.Origin() ) - lowest * table_.Stride( 0 );
+         auto tableStride = table_.Stride( 0 );
+         auto tableTensorStride = table_.TensorStride();
+         DIP_ASSERT( table_.TensorElements() == tensorLength );
+         if( tensorLength == 1 ) {
+            for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+               *out = table[ static_cast< dip::sint >( *in ) * tableStride ];
+               in += inStride;
+               out += outStride;
+            }
+         } else {
+            for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+               CopyPixel( table + static_cast< dip::sint >( *in ) * tableStride, out, tensorLength, tableTensorStride, outTensorStride );
+               in += inStride;
+               out += outStride;
+            }
+         }
+      }
+      dip__TabulatedLUT( Image const& table ) : table_( table ) {}
+   private:
+      Image const& table_;
+};
+
+template< typename TPI > using dip__TabulatedLUT_UInt8 = dip__TabulatedLUT< TPI, uint8 >;
+template< typename TPI > using dip__TabulatedLUT_SInt8 = dip__TabulatedLUT< TPI, sint8 >;
+template< typename TPI > using dip__TabulatedLUT_UInt16 = dip__TabulatedLUT< TPI, uint16 >;
+template< typename TPI > using dip__TabulatedLUT_SInt16 = dip__TabulatedLUT< TPI, sint16 >;
+
+// Returns a 1D image of type `dataType` containing all possible values for that type, in increasing order.
+// `dataType` must be an 8-bit or 16-bit integer type.
+Image AllIntegerValues( DataType dataType ) {
+   dip::sint lowest;
+   dip::sint highest;
+   switch( dataType ) {
+      case DT_UINT8: lowest = std::numeric_limits< uint8 >::lowest(); highest = std::numeric_limits< uint8 >::max(); break;
+      case DT_SINT8: lowest = std::numeric_limits< sint8 >::lowest(); highest = std::numeric_limits< sint8 >::max(); break;
+      case DT_UINT16: lowest = std::numeric_limits< uint16 >::lowest(); highest = std::numeric_limits< uint16 >::max(); break;
+      case DT_SINT16: lowest = std::numeric_limits< sint16 >::lowest(); highest = std::numeric_limits< sint16 >::max(); break;
+      default: DIP_THROW( E::DATA_TYPE_NOT_SUPPORTED );
+   }
+   Image values( { static_cast< dip::uint >( highest - lowest + 1 ) }, 1, DT_SINT32 );
+   sint32* ptr = static_cast< sint32* >( values.Origin() );
+   for( dip::sint ii = lowest; ii <= highest; ++ii, ++ptr ) {
+      *ptr = static_cast< sint32 >( ii );
+   }
+   values.Convert( dataType );
+   return values;
 }
 
+} // namespace
+
 void LookupTable::Apply( Image const& in, Image& out, InterpolationMode interpolation ) const {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
    DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
    ImageRefArray outar{ out };
    std::unique_ptr< Framework::ScanLineFilter >scanLineFilter;
+   if( UseTabulatedMapping( in )) {
+      // Evaluate the LUT for all possible input values, then index into that table directly.
+      Image table;
+      DIP_STACK_TRACE_THIS( Apply( AllIntegerValues( in.DataType() ), table, interpolation ));
+      switch( in.DataType() ) {
+         case DT_UINT8: DIP_OVL_NEW_ALL( scanLineFilter, dip__TabulatedLUT_UInt8, ( table ), values_.DataType() ); break;
+         case DT_SINT8: DIP_OVL_NEW_ALL( scanLineFilter, dip__TabulatedLUT_SInt8, ( table ), values_.DataType() ); break;
+         case DT_UINT16: DIP_OVL_NEW_ALL( scanLineFilter, dip__TabulatedLUT_UInt16, ( table ), values_.DataType() ); break;
+         case DT_SINT16: DIP_OVL_NEW_ALL( scanLineFilter, dip__TabulatedLUT_SInt16, ( table ), values_.DataType() ); break;
+         default: DIP_THROW( E::DATA_TYPE_NOT_SUPPORTED );
+      }
+      DIP_STACK_TRACE_THIS( Scan( { in }, outar, { in.DataType() }, { values_.DataType() }, { values_.DataType() }, { values_.TensorElements() }, *scanLineFilter ));
+      out.ReshapeTensor( values_.Tensor() );
+      out.SetColorSpace( values_.ColorSpace() );
+      return;
+   }
    dip::DataType inBufType;
    if( HasIndex() ) {
       DIP_OVL_NEW_ALL( scanLineFilter, dip__IndexedLUT_Float, ( values_, index_, outOfBoundsMode_, outOfBoundsLowerValue_, outOfBoundsUpperValue_, interpolation ), values_.DataType() );
@@ -331,6 +413,7 @@ Image::Pixel LookupTable::Apply( dfloat value, InterpolationMode interpolation )
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
 #include "diplib/iterators.h"
+#include "diplib/statistics.h"
 
 DOCTEST_TEST_CASE( "[DIPlib] testing dip::LookupTable" ) {
    // LUT without index
@@ -423,4 +506,56 @@ DOCTEST_TEST_CASE( "[DIPlib] testing dip::LookupTable" ) {
    } while( ++outIt3 );
 }
 
+DOCTEST_TEST_CASE( "[DIPlib] testing dip::LookupTable on 8-bit and 16-bit images" ) {
+   // These use a table with all possible input values, which must give identical results to the general code
+   auto countDifferent = []( dip::Image const& a, dip::Image const& b ) {
+      dip::Image diff = a != b;
+      diff.TensorToSpatial();
+      return dip::Count( diff );
+   };
+   dip::Image lutIm( { 200 }, 3, dip::DT_SFLOAT );
+   dip::ImageIterator< dip::sfloat > lutIt( lutIm );
+   dip::sfloat v = 10;
+   do {
+      lutIt[ 0 ] = v;
+      lutIt[ 1 ] = 2 * v;
+      lutIt[ 2 ] = -v;
+      v += 1.5f;
+   } while( ++lutIt );
+   dip::LookupTable lut1( lutIm );
+   lut1.SetOutOfBoundsValue( -1, 1000 );
+   dip::Image img( { 40, 30 }, 1, dip::DT_SINT32 );
+   dip::ImageIterator< dip::sint32 > imgIt( img );
+   dip::sint32 ii = -300;
+   do {
+      *imgIt = ii;
+      ii += 1;
+   } while( ++imgIt );
+   dip::Image img8 = dip::Convert( img, dip::DT_UINT8 );
+   dip::Image ref = lut1.Apply( dip::Convert( img8, dip::DT_UINT32 ));
+   dip::Image out = lut1.Apply( img8 );
+   DOCTEST_REQUIRE( out.TensorElements() == 3 );
+   DOCTEST_CHECK( countDifferent( out, ref ) == 0 );
+   dip::Image img16 = dip::Convert( img, dip::DT_SINT16 );
+   img16.Protect();
+   img16 += 100; // 16-bit images must be larger than 65536 pixels to use the table
+   img16.Protect( false );
+   img16 = img16.Pad( { 400, 300 } );
+   lut1.KeepInputValueOnOutOfBounds();
+   ref = lut1.Apply( dip::Convert( img16, dip::DT_SINT32 ), "nearest" );
+   out = lut1.Apply( img16, "nearest" );
+   DOCTEST_CHECK( countDifferent( out, ref ) == 0 );
+   // With index
+   dip::FloatArray index( lutIm.Size( 0 ), 0 );
+   dip::dfloat d = -50.0;
+   for( auto& ind : index ) {
+      ind = d;
+      d += 0.7;
+   }
+   dip::LookupTable lut2( lutIm, index );
+   ref = lut2.Apply( dip::Convert( img16, dip::DT_SINT32 ));
+   out = lut2.Apply( img16 );
+   DOCTEST_CHECK( countDifferent( out, ref ) == 0 );
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -21,8 +21,10 @@
 #include "diplib.h"
 #include "diplib/mapping.h"
 #include "diplib/statistics.h"
+#include "diplib/lookup_table.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
+#include "mapping_support.h"
 
 namespace dip {
 
@@ -399,7 +401,52 @@ void ContrastStretch(
    } else {
       DIP_THROW_INVALID_FLAG( method );
    }
+   if( in.IsScalar() && UseTabulatedMapping( in )) {
+      // Map each possible input value once, and apply the result as a look-up table
+      dip::sint lowest = in.DataType().IsSigned() ? -( dip::sint( 1 ) << ( 8 * in.DataType().SizeOf() - 1 )) : 0;
+      dip::uint nValues = dip::uint( 1 ) << ( 8 * in.DataType().SizeOf() );
+      Image values( { nValues }, 1, DT_DFLOAT );
+      dfloat* ptr = static_cast< dfloat* >( values.Origin() );
+      for( dip::uint ii = 0; ii < nValues; ++ii ) {
+         ptr[ ii ] = static_cast< dfloat >( lowest + static_cast< dip::sint >( ii ));
+      }
+      FloatArray index;
+      if( lowest != 0 ) {
+         index = FloatArray( nValues );
+         std::copy( ptr, ptr + nValues, index.begin() );
+      }
+      Image table;
+      Framework::ScanMonadic( values, table, DT_DFLOAT, outType, 1, *lineFilter );
+      LookupTable lut( table, index );
+      PixelSize pixelSize = in.PixelSize();
+      lut.Apply( in, out, LookupTable::InterpolationMode::ZERO_ORDER_HOLD );
+      out.SetPixelSize( pixelSize );
+      return;
+   }
    Framework::ScanMonadic( in, out, DT_DFLOAT, outType, in.TensorElements(), *lineFilter, Framework::ScanOption::TensorAsSpatialDim );
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
+
+DOCTEST_TEST_CASE( "[DIPlib] testing dip::ContrastStretch on 8-bit and 16-bit images" ) {
+   // These are mapped through a table, the result must be identical to mapping each pixel
+   dip::Random random( 0 );
+   dip::Image tmp( { 300, 250 }, 1, dip::DT_SFLOAT );
+   tmp.Fill( 120 );
+   dip::Image img = dip::GaussianNoise( tmp, random, 40.0 * 40.0 );
+   for( auto dt : { dip::DT_UINT8, dip::DT_SINT8, dip::DT_UINT16, dip::DT_SINT16 } ) {
+      dip::Image in = dip::Convert( img, dt );
+      dip::Image ref = dip::ContrastStretch( dip::Convert( in, dip::DT_SINT32 ), 1.0, 99.0, 0.0, 255.0, "logarithmic" );
+      dip::Image out = dip::ContrastStretch( in, 1.0, 99.0, 0.0, 255.0, "logarithmic" );
+      DOCTEST_CHECK( out.DataType() == dip::DT_SFLOAT );
+      DOCTEST_CHECK( dip::Count( out != dip::Convert( ref, dip::DT_SFLOAT )) == 0 );
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -0,0 +1,40 @@
+/*
+ * DIPlib 3.0
+ * This file contains support functions for lookup_table.cpp and mapping.cpp.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_MAPPING_SUPPORT_H
+#define DIP_MAPPING_SUPPORT_H
+
+#include "diplib.h"
+
+namespace dip {
+
+// Returns true if `in` is better mapped through a table with one entry per possible input value, that is,
+// if mapping the pixels of `in` is more expensive than mapping every possible value of its data type.
+inline bool UseTabulatedMapping( Image const& in ) {
+   DataType dt = in.DataType();
+   if(( dt != DT_UINT8 ) && ( dt != DT_SINT8 ) && ( dt != DT_UINT16 ) && ( dt != DT_SINT16 )) {
+      return false;
+   }
+   // Building the table costs about as much as mapping that many pixels
+   return in.NumberOfPixels() > ( dip::uint( 1 ) << ( 8 * dt.SizeOf() ));
+}
+
+} // namespace dip
+
+#endif // DIP_MAPPING_SUPPORT_H
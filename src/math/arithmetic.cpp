@@ -351,6 +351,8 @@ void Invert(
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
 #include "diplib/math.h"
+#include "diplib/statistics.h"
+#include "diplib/lazy.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the matrix multiplication operation") {
    dip::Image lhs( { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 } );
@@ -395,4 +397,43 @@ DOCTEST_TEST_CASE("[DIPlib] testing the operator overloading") {
    out = 1 + rhs[ 0 ];
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing lazy expressions") {
+   dip::Image a( { 4, 3 }, 1, dip::DT_UINT8 );
+   dip::Image b( { 4, 3 }, 1, dip::DT_SFLOAT );
+   dip::Image c( { 4, 1 }, 1, dip::DT_SINT16 );
+   dip::Image d( { 1.0, -2.0 } ); // 0D tensor image
+   a.Fill( 10 );
+   b.Fill( 1.5 );
+   c.Fill( -3 );
+   b.At( 2, 1 ) = 4.0;
+   // Arithmetic, with singleton expansion and scalars
+   dip::Image out = dip::Lazy( a ) * b + 2 - c / 2;
+   dip::Image ref = a * b + 2 - c / 2;
+   DOCTEST_CHECK( out.DataType() == ref.DataType() );
+   DOCTEST_CHECK( out.Sizes() == ref.Sizes() );
+   DOCTEST_CHECK( dip::Count( out != ref ) == 0 );
+   // Expressions can be stored, and evaluated later
+   auto expression = Sqrt( Abs( 1 - dip::Lazy( b )));
+   out = expression;
+   ref = dip::Sqrt( dip::Abs( 1 - b ));
+   DOCTEST_CHECK( out.DataType() == ref.DataType() );
+   DOCTEST_CHECK( dip::MaximumAbs( out - ref ).As< dip::dfloat >() < 1e-6 );
+   // Comparisons yield binary images, which combine as in the eager operators
+   out = ( dip::Lazy( b ) > 2 ) + ( dip::Lazy( a ) < 5 );
+   DOCTEST_CHECK( out.DataType() == dip::DT_BIN );
+   DOCTEST_CHECK( dip::Count( out ) == 1 );
+   out = ( dip::Lazy( b ) > 1 ) - ( b > 2 );
+   DOCTEST_CHECK( dip::Count( out ) == 11 );
+   // Tensor images, output to a protected image
+   out = dip::Image( { 4, 3 }, 2, dip::DT_DFLOAT );
+   out.Protect();
+   ( dip::Lazy( b ) * d + 1 ).Evaluate( out );
+   DOCTEST_CHECK( out.DataType() == dip::DT_DFLOAT );
+   DOCTEST_CHECK( out.TensorElements() == 2 );
+   DOCTEST_CHECK( out.At( 2, 1 ) == dip::Image::Pixel( { 5.0, -7.0 } ));
+   // In-place evaluation
+   b = dip::Lazy( b ) * 2;
+   DOCTEST_CHECK( b.At( 2, 1 ) == 8.0 );
+}
+
 #endif // DIP__ENABLE_DOCTEST
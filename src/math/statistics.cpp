@@ -345,6 +345,70 @@ void CumulativeSum(
    }
 }
 
+void IntegralImage(
+      Image const& in,
+      Image& out,
+      BooleanArray const& process
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( in.Dimensionality() < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DataType dataType = in.DataType().IsComplex() ? DT_DCOMPLEX : DT_DFLOAT;
+   std::unique_ptr< Framework::SeparableLineFilter > lineFilter;
+   DIP_OVL_NEW_FLEX( lineFilter, CumSumFilter, (), dataType );
+   DIP_STACK_TRACE_THIS( Framework::Separable( in, out, dataType, dataType, process, { 0 }, {}, *lineFilter,
+                                               Framework::SeparableOption::AsScalarImage ));
+}
+
+void IntegralSquareImage(
+      Image const& in,
+      Image& out,
+      BooleanArray const& process
+) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_START_STACK_TRACE
+      MultiplySampleWise( in, in, out, DT_DFLOAT );
+      IntegralImage( out, out, process );
+   DIP_END_STACK_TRACE
+}
+
+dfloat BoxSum( Image const& integral, UnsignedArray const& origin, UnsignedArray const& sizes ) {
+   DIP_THROW_IF( !integral.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !integral.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !integral.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   dip::uint nDims = integral.Dimensionality();
+   DIP_THROW_IF( origin.size() != nDims, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   DIP_THROW_IF( sizes.size() != nDims, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      DIP_THROW_IF( sizes[ ii ] == 0, E::INVALID_PARAMETER );
+      DIP_THROW_IF( origin[ ii ] + sizes[ ii ] > integral.Size( ii ), E::INDEX_OUT_OF_RANGE );
+   }
+   // Inclusion-exclusion over the 2^nDims corners of the box. Corners that fall just before the image contribute 0.
+   dfloat sum = 0;
+   UnsignedArray coords( nDims );
+   for( dip::uint corner = 0; corner < ( dip::uint( 1 ) << nDims ); ++corner ) {
+      bool outside = false;
+      bool negative = false;
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         if( corner & ( dip::uint( 1 ) << ii )) {
+            coords[ ii ] = origin[ ii ] + sizes[ ii ] - 1;
+         } else {
+            if( origin[ ii ] == 0 ) {
+               outside = true;
+               break;
+            }
+            coords[ ii ] = origin[ ii ] - 1;
+            negative = !negative;
+         }
+      }
+      if( !outside ) {
+         dfloat value = integral.At( coords ).As< dfloat >();
+         sum += negative ? -value : value;
+      }
+   }
+   return sum;
+}
+
 namespace {
 
 class dip__MaximumAndMinimumBase : public Framework::ScanLineFilter {
@@ -152,6 +152,47 @@ std::unique_ptr< Framework::ScanLineFilter > NewTensorTriadicScanLineFilter( F c
    return static_cast< std::unique_ptr< Framework::ScanLineFilter >>( new TensorTriadicScanLineFilter< TPI, TPO, F >( func, cost ));
 }
 
+template< typename TPI >
+std::unique_ptr< Framework::ScanLineFilter > NewSymmetricEigenScanLineFilter( dip::uint n, bool vectors ) {
+   if( vectors ) {
+      if( n == 2 ) {
+         return NewTensorDyadicScanLineFilter< TPI >(
+               []( auto const& pin, auto const& pout1, auto const& pout2 ) { SymmetricEigenDecomposition2( pin, pout1, pout2 ); }, 60
+         );
+      }
+      return NewTensorDyadicScanLineFilter< TPI >(
+            []( auto const& pin, auto const& pout1, auto const& pout2 ) { SymmetricEigenDecomposition3( pin, pout1, pout2 ); }, 400
+      );
+   }
+   if( n == 2 ) {
+      return NewTensorMonadicScanLineFilter< TPI >(
+            []( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition2( pin, pout ); }, 30
+      );
+   }
+   return NewTensorMonadicScanLineFilter< TPI >(
+         []( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition3( pin, pout ); }, 150
+   );
+}
+
+// Returns a scan line filter that computes the eigenvalues (and optionally the eigenvectors) of 2x2 or 3x3
+// symmetric matrices, using the closed-form solutions. The input buffer holds the packed symmetric matrix.
+// Single-precision input is processed in single-precision buffers, all other types in double-precision buffers;
+// `bufferType` is set accordingly.
+std::unique_ptr< Framework::ScanLineFilter > NewSymmetricEigenScanLineFilter(
+      dip::uint n,
+      DataType intype,
+      bool vectors,
+      DataType& bufferType
+) {
+   DIP_ASSERT(( n == 2 ) || ( n == 3 ));
+   if( intype == DT_SFLOAT ) {
+      bufferType = DT_SFLOAT;
+      return NewSymmetricEigenScanLineFilter< sfloat >( n, vectors );
+   }
+   bufferType = DT_DFLOAT;
+   return NewSymmetricEigenScanLineFilter< dfloat >( n, vectors );
+}
+
 void SortTensorElements( Image& out ) {
    if( !out.IsScalar() ) {
       DataType outtype = out.DataType();
@@ -497,7 +538,14 @@ void Eigenvalues( Image const& in, Image& out ) {
       DataType outbuffertype;
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
-      if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
+      Framework::ScanOptions opts = Framework::ScanOption::ExpandTensorInBuffer;
+      if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() ) && (( n == 2 ) || ( n == 3 ))) {
+         // Closed-form solution, works directly on the packed symmetric matrix
+         DIP_STACK_TRACE_THIS( scanLineFilter = NewSymmetricEigenScanLineFilter( n, intype, false, inbuffertype ));
+         outbuffertype = inbuffertype;
+         outtype = intype;
+         opts = {};
+      } else if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
          scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
                [ n ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition( n, pin, pout ); }, 400 * n // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
          );
@@ -519,8 +567,7 @@ void Eigenvalues( Image const& in, Image& out ) {
          outtype = DataType::SuggestComplex( intype );
       }
       ImageRefArray outar{ out };
-      DIP_STACK_TRACE_THIS( Framework::Scan( { in }, outar, { inbuffertype }, { outbuffertype }, { outtype }, { n }, *scanLineFilter,
-                                             Framework::ScanOption::ExpandTensorInBuffer ));
+      DIP_STACK_TRACE_THIS( Framework::Scan( { in }, outar, { inbuffertype }, { outbuffertype }, { outtype }, { n }, *scanLineFilter, opts ));
    }
 }
 
@@ -542,7 +589,14 @@ void EigenDecomposition( Image const& in, Image& out, Image& eigenvectors ) {
       DataType outbuffertype;
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
-      if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
+      Framework::ScanOptions opts = Framework::ScanOption::ExpandTensorInBuffer;
+      if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() ) && (( n == 2 ) || ( n == 3 ))) {
+         // Closed-form solution, works directly on the packed symmetric matrix
+         DIP_STACK_TRACE_THIS( scanLineFilter = NewSymmetricEigenScanLineFilter( n, intype, true, inbuffertype ));
+         outbuffertype = inbuffertype;
+         outtype = intype;
+         opts = {};
+      } else if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
          scanLineFilter = NewTensorDyadicScanLineFilter< dfloat, dfloat >(
                [ n ]( auto const& pin, auto const& pout1, auto const& pout2 ) { SymmetricEigenDecomposition( n, pin, pout1, pout2 ); }, 600 * n // cost of decomposition???
          );
@@ -565,7 +619,7 @@ void EigenDecomposition( Image const& in, Image& out, Image& eigenvectors ) {
       }
       ImageRefArray outar{ out, eigenvectors };
       DIP_STACK_TRACE_THIS( Framework::Scan( { in }, outar, { inbuffertype }, { outbuffertype, outbuffertype }, { outtype, outtype },
-                                             { n, n * n }, *scanLineFilter, Framework::ScanOption::ExpandTensorInBuffer ));
+                                             { n, n * n }, *scanLineFilter, opts ));
       eigenvectors.ReshapeTensor( n, n );
       out.ReshapeTensorAsDiagonal();
    }
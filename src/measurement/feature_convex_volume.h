@@ -0,0 +1,55 @@
+/*
+ * DIPlib 3.0
+ * This file defines the "ConvexVolume" measurement feature
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+namespace dip {
+namespace Feature {
+
+
+class FeatureConvexVolume : public MeshBased {
+   public:
+      FeatureConvexVolume() : MeshBased( { "ConvexVolume", "Volume of the convex hull (3D)", false } ) {};
+
+      virtual ValueInformationArray Initialize( Image const& label, Image const&, dip::uint ) override {
+         DIP_THROW_IF( label.Dimensionality() != 3, E::DIMENSIONALITY_NOT_SUPPORTED );
+         ValueInformationArray out( 1 );
+         PhysicalQuantity pq = label.PixelSize( 0 );
+         if( label.IsIsotropic() && pq.IsPhysical() ) {
+            pq = pq * pq * pq;
+            scale_ = pq.magnitude;
+            out[ 0 ].units = pq.units;
+         } else {
+            scale_ = 1;
+            out[ 0 ].units = Units::CubicPixel();
+         }
+         out[ 0 ].name = "";
+         return out;
+      }
+
+      virtual void Measure( SurfaceMesh const& mesh, Measurement::ValueIterator output ) override {
+         output[ 0 ] = mesh.ConvexHull().Volume() * scale_;
+      }
+
+   private:
+      dfloat scale_;
+};
+
+
+} // namespace feature
+} // namespace dip
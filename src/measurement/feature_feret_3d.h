@@ -0,0 +1,59 @@
+/*
+ * DIPlib 3.0
+ * This file defines the "Feret3D" measurement feature
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+namespace dip {
+namespace Feature {
+
+
+class FeatureFeret3D : public MeshBased {
+   public:
+      FeatureFeret3D() : MeshBased( { "Feret3D", "Maximum and minimum object diameters (3D)", false } ) {};
+
+      virtual ValueInformationArray Initialize( Image const& label, Image const&, dip::uint ) override {
+         DIP_THROW_IF( label.Dimensionality() != 3, E::DIMENSIONALITY_NOT_SUPPORTED );
+         ValueInformationArray out( 2 );
+         PhysicalQuantity pq = label.PixelSize( 0 );
+         if( label.IsIsotropic() && pq.IsPhysical() ) {
+            scale_ = pq.magnitude;
+            out[ 0 ].units = pq.units;
+            out[ 1 ].units = pq.units;
+         } else {
+            scale_ = 1;
+            out[ 0 ].units = Units::Pixel();
+            out[ 1 ].units = Units::Pixel();
+         }
+         out[ 0 ].name = "Max";
+         out[ 1 ].name = "Min";
+         return out;
+      }
+
+      virtual void Measure( SurfaceMesh const& mesh, Measurement::ValueIterator output ) override {
+         Feret3DValues feret = mesh.Feret();
+         output[ 0 ] = feret.maxDiameter * scale_;
+         output[ 1 ] = feret.minDiameter * scale_;
+      }
+
+   private:
+      dfloat scale_;
+};
+
+
+} // namespace feature
+} // namespace dip
@@ -0,0 +1,61 @@
+/*
+ * DIPlib 3.0
+ * This file defines the "MinPerimeterRectangle" measurement feature
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+namespace dip {
+namespace Feature {
+
+
+class FeatureMinPerimeterRectangle : public ConvexHullBased {
+   public:
+      FeatureMinPerimeterRectangle() : ConvexHullBased( { "MinPerimeterRectangle", "Minimum perimeter bounding rectangle (2D)", false } ) {};
+
+      virtual ValueInformationArray Initialize( Image const& label, Image const&, dip::uint ) override {
+         ValueInformationArray out( 3 );
+         PhysicalQuantity pq = label.PixelSize( 0 );
+         if( label.IsIsotropic() && pq.IsPhysical() ) {
+            scale_ = pq.magnitude;
+            out[ 0 ].units = pq.units;
+            out[ 1 ].units = pq.units;
+         } else {
+            scale_ = 1;
+            out[ 0 ].units = Units::Pixel();
+            out[ 1 ].units = Units::Pixel();
+         }
+         out[ 2 ].units = Units::Radian();
+         out[ 0 ].name = "Length";
+         out[ 1 ].name = "Width";
+         out[ 2 ].name = "Angle";
+         return out;
+      }
+
+      virtual void Measure( ConvexHull const& convexHull, Measurement::ValueIterator output ) override {
+         RectangleValues rect = convexHull.MinimumPerimeterRectangle();
+         output[ 0 ] = rect.length * scale_;
+         output[ 1 ] = rect.width * scale_;
+         output[ 2 ] = rect.angle;
+      }
+
+   private:
+      dfloat scale_;
+};
+
+
+} // namespace feature
+} // namespace dip
@@ -25,6 +25,8 @@
 #include "diplib/chain_code.h"
 #include "diplib/regions.h"
 #include "diplib/overload.h"
+#include "diplib/multithreading.h"
+#include "parallel_for.h"
 
 namespace dip {
 
@@ -34,7 +36,7 @@ constexpr VertexInteger ChainCode::deltas8[8];
 
 namespace {
 
-struct ObjectData { dip::uint index; bool done; };
+struct ObjectData { dip::uint index; };
 using ObjectIdList = std::map< dip::uint, ObjectData >; // key is the objectID (label)
 
 template< typename TPI >
@@ -97,42 +99,69 @@ static ChainCode dip__OneChainCode(
 template< typename TPI >
 static ChainCodeArray dip__ChainCodes(
       Image const& labels,
-      ObjectIdList& objectIDs,
+      ObjectIdList const& objectIDs,
       dip::uint nObjects, // potentially different from the number of entries in objectIDs, if there were repeated elements in the original list.
       dip::uint connectivity,
       ChainCode::CodeTable const& codeTable
 ) {
    DIP_ASSERT( labels.DataType() == DataType( TPI( 0 ) ) );
    TPI* data = static_cast< TPI* >( labels.Origin() );
-   ChainCodeArray ccArray( nObjects );  // output array
    VertexInteger dims = { static_cast< dip::sint >( labels.Size( 0 ) - 1 ), static_cast< dip::sint >( labels.Size( 1 ) - 1 ) }; // our local copy of `dims` now contains the largest coordinates
    IntegerArray const& strides = labels.Strides();
 
-   // Find first pixel of requested label
-   dip::uint label = 0;
-   VertexInteger coord;
-   for( coord.y = 0; coord.y <= dims.y; ++coord.y ) {
-      dip::sint pos = coord.y * strides[ 1 ];
-      for( coord.x = 0; coord.x <= dims.x; ++coord.x ) {
-         bool process = false;
-         dip::uint index = 0;
-         dip::uint newlabel = data[ pos ];
-         if( ( newlabel != 0 ) && ( newlabel != label ) ) {
-            // Check whether newlabel is start of not processed object
-            auto it = objectIDs.find( newlabel );
-            if( ( it != objectIDs.end() ) && !it->second.done ) {
-               it->second.done = true;
-               index = it->second.index;
+   // Determine the number of threads we'll be using
+   dip::uint nLines = labels.Size( 1 );
+   dip::uint nThreads = std::min( GetNumberOfThreads(), nLines );
+   if(( nThreads > 1 ) && ( labels.NumberOfPixels() * 2 < threadingThreshold )) {
+      nThreads = 1;
+   }
+
+   // Find first pixel of each requested label. Each thread scans a strip of image lines; the first pixel of an
+   // object is the one found in the first strip it appears in. A start position with `x < 0` means "not found".
+   std::vector< std::vector< VertexInteger >> starts( nThreads, std::vector< VertexInteger >( nObjects, VertexInteger{ -1, -1 } ));
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      std::vector< VertexInteger >& found = starts[ thread ];
+      dip::sint firstLine = static_cast< dip::sint >( thread * nLines / nThreads );
+      dip::sint lastLine = static_cast< dip::sint >(( thread + 1 ) * nLines / nThreads );
+      dip::uint label = 0;
+      VertexInteger coord;
+      for( coord.y = firstLine; coord.y < lastLine; ++coord.y ) {
+         dip::sint pos = coord.y * strides[ 1 ];
+         for( coord.x = 0; coord.x <= dims.x; ++coord.x ) {
+            dip::uint newlabel = data[ pos ];
+            if( ( newlabel != 0 ) && ( newlabel != label ) ) {
+               // Check whether newlabel is start of not processed object
                label = newlabel;
-               process = true;
+               auto it = objectIDs.find( newlabel );
+               if(( it != objectIDs.end() ) && ( found[ it->second.index ].x < 0 )) {
+                  found[ it->second.index ] = coord;
+               }
             }
+            pos += strides[ 0 ];
          }
-         if( process ) {
-            ccArray[ index ] = dip__OneChainCode< TPI >( data + pos, coord, dims, connectivity, codeTable, true );
+      }
+   }
+   for( dip::uint thread = 1; thread < nThreads; ++thread ) {
+      for( dip::uint ii = 0; ii < nObjects; ++ii ) {
+         if(( starts[ 0 ][ ii ].x < 0 ) && ( starts[ thread ][ ii ].x >= 0 )) {
+            starts[ 0 ][ ii ] = starts[ thread ][ ii ];
          }
-         pos += strides[ 0 ];
       }
    }
+   std::vector< VertexInteger > const& start = starts[ 0 ];
+
+   // Trace the boundary of each object, objects are independent of each other
+   ChainCodeArray ccArray( nObjects );  // output array
+   DIP_STACK_TRACE_THIS( ParallelFor( nObjects, nThreads, 64, [ & ]( dip::uint ii ) {
+      VertexInteger coord = start[ ii ];
+      if( coord.x < 0 ) {
+         return;
+      }
+      dip::sint pos = coord.x * strides[ 0 ] + coord.y * strides[ 1 ];
+      ccArray[ ii ] = dip__OneChainCode< TPI >( data + pos, coord, dims, connectivity, codeTable, true );
+   } ));
    return ccArray;
 }
 
@@ -157,12 +186,12 @@ ChainCodeArray GetImageChainCodes(
    if( objectIDs.empty() ) {
       UnsignedArray allObjectIDs = GetObjectLabels( labels, Image(), S::EXCLUDE );
       for( dip::uint ii = 0; ii < allObjectIDs.size(); ++ii ) {
-         objectIdList.emplace( allObjectIDs[ ii ], ObjectData{ ii, false } );
+         objectIdList.emplace( allObjectIDs[ ii ], ObjectData{ ii } );
       }
       nObjects = allObjectIDs.size();
    } else {
       for( dip::uint ii = 0; ii < objectIDs.size(); ++ii ) {
-         objectIdList.emplace( objectIDs[ ii ], ObjectData{ ii, false } );
+         objectIdList.emplace( objectIDs[ ii ], ObjectData{ ii } );
       }
       nObjects = objectIDs.size();
    }
@@ -295,6 +324,20 @@ DOCTEST_TEST_CASE("[DIPlib] testing chain code conversion to image and back") {
    }
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing dip::ParallelFor") {
+   std::vector< dip::uint > out( 1000, 0 );
+   dip::ParallelFor( out.size(), 4, 16, [ & ]( dip::uint ii ) { out[ ii ] = ii + 1; } );
+   bool correct = true;
+   for( dip::uint ii = 0; ii < out.size(); ++ii ) {
+      correct &= out[ ii ] == ii + 1;
+   }
+   DOCTEST_CHECK( correct );
+   // Exceptions are propagated with their original type
+   auto throwing = [ & ]( dip::uint ii ) { if( ii == 500 ) { DIP_THROW_INVALID_FLAG( "foo" ); }};
+   DOCTEST_CHECK_THROWS_AS( dip::ParallelFor( out.size(), 4, 16, throwing ), dip::ParameterError );
+   DOCTEST_CHECK_THROWS_AS( dip::ParallelFor( out.size(), 1, 16, throwing ), dip::ParameterError );
+}
+
 #include "diplib/pixel_table.h"
 #include "diplib/morphology.h"
 
@@ -311,4 +354,37 @@ DOCTEST_TEST_CASE("[DIPlib] testing ChainCode::Offset") {
    }
 }
 
+#include "diplib/generation.h"
+#include "diplib/math.h"
+#include "diplib/multithreading.h"
+#include "parallel_for.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::GetImageChainCodes") {
+   // Many objects, some of which span the boundaries between the strips processed by different threads
+   dip::Image x = dip::CreateXCoordinate( { 400, 300 } );
+   dip::Image y = dip::CreateYCoordinate( { 400, 300 } );
+   dip::Image img = dip::Sin( x * 0.13 ) * dip::Sin( y * 0.07 + x * 0.01 ) > 0.3;
+   dip::Image labels = dip::Label( img, 2 );
+   dip::UnsignedArray objectIDs = dip::GetObjectLabels( labels, {}, "exclude" );
+   DOCTEST_REQUIRE( objectIDs.size() > 20 );
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::ChainCodeArray reference = dip::GetImageChainCodes( labels, objectIDs, 2 );
+   dip::SetNumberOfThreads( std::max< dip::uint >( nThreads, 4 ));
+   dip::ChainCodeArray ccs = dip::GetImageChainCodes( labels, objectIDs, 2 );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( ccs.size() == reference.size() );
+   bool equal = true;
+   for( dip::uint ii = 0; ii < ccs.size(); ++ii ) {
+      equal &= ccs[ ii ].objectID == objectIDs[ ii ];
+      equal &= ccs[ ii ].objectID == reference[ ii ].objectID;
+      equal &= ccs[ ii ].start == reference[ ii ].start;
+      equal &= ccs[ ii ].codes.size() == reference[ ii ].codes.size();
+      for( dip::uint jj = 0; equal && ( jj < ccs[ ii ].codes.size() ); ++jj ) {
+         equal &= ccs[ ii ].codes[ jj ] == reference[ ii ].codes[ jj ];
+      }
+   }
+   DOCTEST_CHECK( equal );
+}
+
 #endif // DIP__ENABLE_DOCTEST
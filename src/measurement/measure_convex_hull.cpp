@@ -18,22 +18,142 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <random>
+
 #include "diplib.h"
 #include "diplib/chain_code.h"
 #include "diplib/accumulators.h"
 
 namespace dip {
 
-// An operator that increments the iterator but treating the container as a circular one
-template< typename Iterator, typename Container >
-static inline Iterator Next( Iterator it, Container const& con ) {
-   ++it;
-   if( it == con.end() ) {
-      it = con.begin();
+namespace {
+
+// For one edge of the convex hull, the calipers: the vertex farthest from the edge, and the vertices with the
+// smallest and largest projection onto the edge.
+struct Calipers {
+   VertexFloat origin;  // first vertex of the edge
+   VertexFloat axis;    // unit vector along the edge
+   VertexFloat normal;  // unit vector perpendicular to the edge, pointing into the hull
+   dip::uint far;       // index of the vertex farthest from the edge
+   dfloat height;       // distance of `far` to the edge
+   dfloat low;          // smallest projection onto `axis`, relative to `origin`
+   dfloat high;         // largest projection onto `axis`, relative to `origin`
+};
+
+// Rotating calipers (Toussaint, 1983) over a convex polygon with at least 3 vertices. The three extremal vertices
+// rotate in the same direction as the edge, so each advances at most once around the polygon, and the whole loop
+// is linear in the number of vertices. `edgeFunction` is called for each edge with the `Calipers` for that edge,
+// `pairFunction` is called for each antipodal vertex pair (some pairs are visited more than once).
+template< typename EdgeFunction, typename PairFunction >
+void RotatingCalipers( std::vector< VertexFloat > const& vertices, EdgeFunction edgeFunction, PairFunction pairFunction ) {
+   dip::uint n = vertices.size();
+   DIP_ASSERT( n >= 3 );
+   auto next = [ n ]( dip::uint ii ) { return ii + 1 == n ? 0 : ii + 1; };
+   // The orientation of the polygon determines on which side of the edges the vertices lie
+   dfloat sign = 0.0;
+   for( dip::uint ii = 0; ii < n; ++ii ) {
+      sign += CrossProduct( vertices[ ii ], vertices[ next( ii ) ] );
    }
-   return it;
+   sign = sign < 0 ? -1.0 : 1.0;
+   Calipers c;
+   auto height = [ & ]( dip::uint ii ) { return c.normal.x * ( vertices[ ii ].x - c.origin.x ) + c.normal.y * ( vertices[ ii ].y - c.origin.y ); };
+   auto projection = [ & ]( dip::uint ii ) { return c.axis.x * ( vertices[ ii ].x - c.origin.x ) + c.axis.y * ( vertices[ ii ].y - c.origin.y ); };
+   dip::uint lowIndex = 0;
+   dip::uint highIndex = 0;
+   c.far = 0;
+   bool first = true;
+   for( dip::uint ii = 0; ii < n; ++ii ) {
+      VertexFloat edge = vertices[ next( ii ) ] - vertices[ ii ];
+      dfloat length = Norm( edge );
+      if( length == 0.0 ) {
+         continue; // repeated vertex
+      }
+      c.origin = vertices[ ii ];
+      c.axis = edge / length;
+      c.normal = VertexFloat{ -c.axis.y, c.axis.x } * sign;
+      if( first ) {
+         // Find the extremal vertices for the first edge by brute force
+         for( dip::uint jj = 1; jj < n; ++jj ) {
+            if( height( jj ) > height( c.far )) {
+               c.far = jj;
+            }
+            if( projection( jj ) < projection( lowIndex )) {
+               lowIndex = jj;
+            }
+            if( projection( jj ) > projection( highIndex )) {
+               highIndex = jj;
+            }
+         }
+         first = false;
+      } else {
+         // Advance the calipers from where they were for the previous edge
+         for( dip::uint kk = 0; ( kk < n ) && ( height( next( c.far )) > height( c.far )); ++kk ) {
+            c.far = next( c.far );
+            pairFunction( vertices[ ii ], vertices[ c.far ] );
+         }
+         for( dip::uint kk = 0; ( kk < n ) && ( projection( next( lowIndex )) < projection( lowIndex )); ++kk ) {
+            lowIndex = next( lowIndex );
+         }
+         for( dip::uint kk = 0; ( kk < n ) && ( projection( next( highIndex )) > projection( highIndex )); ++kk ) {
+            highIndex = next( highIndex );
+         }
+      }
+      pairFunction( vertices[ ii ], vertices[ c.far ] );
+      pairFunction( vertices[ next( ii ) ], vertices[ c.far ] );
+      if( height( next( c.far )) == height( c.far )) {
+         // An edge parallel to this one: both its vertices are antipodal to both vertices of this edge
+         pairFunction( vertices[ ii ], vertices[ next( c.far ) ] );
+      }
+      c.height = height( c.far );
+      c.low = projection( lowIndex );
+      c.high = projection( highIndex );
+      edgeFunction( c );
+   }
+}
+
+RectangleValues MakeRectangle( Calipers const& c ) {
+   RectangleValues rect;
+   dfloat size = c.high - c.low;
+   rect.center = c.origin + c.axis * (( c.low + c.high ) / 2.0 ) + c.normal * ( c.height / 2.0 );
+   VertexFloat direction = c.axis;
+   if( size >= c.height ) {
+      rect.length = size;
+      rect.width = c.height;
+   } else {
+      rect.length = c.height;
+      rect.width = size;
+      direction = c.normal;
+   }
+   rect.angle = std::atan2( direction.y, direction.x );
+   if( rect.angle <= -pi / 2.0 ) {
+      rect.angle += pi;
+   } else if( rect.angle > pi / 2.0 ) {
+      rect.angle -= pi;
+   }
+   return rect;
 }
 
+// Bounding rectangle for hulls with fewer than 3 vertices
+RectangleValues DegenerateRectangle( std::vector< VertexFloat > const& vertices ) {
+   RectangleValues rect;
+   if( vertices.size() == 2 ) {
+      rect.center = ( vertices[ 0 ] + vertices[ 1 ] ) / 2.0;
+      rect.length = Distance( vertices[ 0 ], vertices[ 1 ] );
+      rect.angle = Angle( vertices[ 0 ], vertices[ 1 ] );
+      if( rect.angle <= -pi / 2.0 ) {
+         rect.angle += pi;
+      } else if( rect.angle > pi / 2.0 ) {
+         rect.angle -= pi;
+      }
+   } else if( vertices.size() == 1 ) {
+      rect.center = vertices[ 0 ];
+   }
+   return rect;
+}
+
+} // namespace
+
 FeretValues ConvexHull::Feret() const {
 
    FeretValues feret;
@@ -54,92 +174,22 @@ FeretValues ConvexHull::Feret() const {
       return feret;
    }
 
-   /* Algorithm by Preparata and Shamos (1985) to obtain list of anti-podal pairs
-    *    (from http://cgm.cs.mcgill.ca/~orm/rotcal.html)
-    *
-    * begin
-    *   p0:=pn;
-    *   q:=NEXT[p];
-    *   while (Area(p,NEXT[p],NEXT[q]) > Area(p,NEXT[p],q)) do
-    *     q:=NEXT[q];
-    *     q0:=q;                                                <= WRONG INDENTING!!!
-    *     while (q != p0) do                                    <= TYPO! (p != p0)
-    *       begin
-    *         p:=NEXT[p];
-    *         Print(p,q);
-    *         while (Area(p,NEXT[p],NEXT[q]) > Area(p,NEXT[p],q) do
-    *           begin
-    *             q:=NEXT[q];
-    *             if ((p,q) != (q0,p0)) then Print(p,q)
-    *             else return                                   <= NEVER SEEMS TO HAPPEN?
-    *           end;
-    *         if (Area(p,NEXT[p],NEXT[q]) = Area(p,NEXT[p],q)) then
-    *           if ((p,q) != (q0,p0)) then Print(p,NEXT[q])
-    *           else Print(NEXT[p],q)                           <= NEVER SEEMS TO HAPPEN?
-    *       end
-    * end.
-    */
-   auto first = vertices.begin();
-   auto p = first;
-   auto q = p + 1;
-   while( ParallelogramSignedArea( *p, *Next( p, vertices ), *Next( q, vertices )) >
-          ParallelogramSignedArea( *p, *Next( p, vertices ), *q ) ) {
-      q = Next( q, vertices );
-   }
-
-   //auto q0 = q;
-   auto p0 = vertices.end() - 1;
    feret.minDiameter = std::numeric_limits< dfloat >::max();
-   while( p != p0 ) {
-      ++p;
-      // (p,q) is an antipodal pair
-      dfloat d = Distance( *p, *q );
-      if( d > feret.maxDiameter ) {
-         feret.maxDiameter = d;
-         feret.maxAngle = Angle( *p, *q );
-      }
-      while( ParallelogramSignedArea( *p, *Next( p, vertices ), *Next( q, vertices )) >
-             ParallelogramSignedArea( *p, *Next( p, vertices ), *q ) ) {
-         // (p,q+1) is an antipodal pair
-         d = TriangleHeight( *q, *Next( q, vertices ), *p );
-         if( d < feret.minDiameter ) {
-            feret.minDiameter = d;
-            feret.minAngle = Angle( *q, *Next( q, vertices ) );
-         }
-         q = Next( q, vertices );
-         d = Distance( *p, *q );
-         if( d > feret.maxDiameter ) {
-            feret.maxDiameter = d;
-            feret.maxAngle = Angle( *p, *q );
-         }
+   dfloat maxDiameter2 = 0.0;
+   RotatingCalipers( vertices, [ & ]( Calipers const& c ) {
+      if( c.height < feret.minDiameter ) {
+         feret.minDiameter = c.height;
+         feret.maxPerpendicular = c.high - c.low;
+         feret.minAngle = std::atan2( c.axis.y, c.axis.x );
       }
-      if( ParallelogramSignedArea( *p, *Next( p, vertices ), *Next( q, vertices ) ) ==
-          ParallelogramSignedArea( *p, *Next( p, vertices ), *q ) ) {
-         // (p,q+1) is an antipodal pair also, but we don't advance q
-         d = TriangleHeight( *q, *Next( q, vertices ), *p );
-         if( d < feret.minDiameter ) {
-            feret.minDiameter = d;
-            feret.minAngle = Angle( *q, *Next( q, vertices ) );
-         }
-         d = Distance( *p, *Next( q, vertices ) );
-         if( d > feret.maxDiameter ) {
-            feret.maxDiameter = d;
-            feret.maxAngle = Angle( *p, *Next( q, vertices ) );
-         }
+   }, [ & ]( VertexFloat const& p, VertexFloat const& q ) {
+      dfloat d2 = DistanceSquare( p, q );
+      if( d2 > maxDiameter2 ) {
+         maxDiameter2 = d2;
+         feret.maxAngle = Angle( p, q );
       }
-   }
-
-   // Get the diameter perpendicular to feret.minDiameter
-   dfloat cos = std::cos( feret.minAngle );
-   dfloat sin = std::sin( feret.minAngle );
-   dfloat pmin = std::numeric_limits< dfloat >::max();
-   dfloat pmax = std::numeric_limits< dfloat >::lowest();
-   for( auto const& v : vertices ) {
-      dfloat d = v.x * cos + v.y * sin;
-      pmin = std::min( pmin, d );
-      pmax = std::max( pmax, d );
-   }
-   feret.maxPerpendicular = pmax - pmin;
+   } );
+   feret.maxDiameter = std::sqrt( maxDiameter2 );
 
    // We want to give the minimum diameter angle correctly
    feret.minAngle = feret.minAngle + pi / 2.0;
@@ -147,6 +197,98 @@ FeretValues ConvexHull::Feret() const {
    return feret;
 }
 
+RectangleValues ConvexHull::MinimumAreaRectangle() const {
+   auto const& vertices = Vertices();
+   if( vertices.size() < 3 ) {
+      return DegenerateRectangle( vertices );
+   }
+   RectangleValues rect;
+   dfloat minArea = std::numeric_limits< dfloat >::max();
+   RotatingCalipers( vertices, [ & ]( Calipers const& c ) {
+      dfloat area = c.height * ( c.high - c.low );
+      if( area < minArea ) {
+         minArea = area;
+         rect = MakeRectangle( c );
+      }
+   }, []( VertexFloat const&, VertexFloat const& ) {} );
+   return rect;
+}
+
+RectangleValues ConvexHull::MinimumPerimeterRectangle() const {
+   auto const& vertices = Vertices();
+   if( vertices.size() < 3 ) {
+      return DegenerateRectangle( vertices );
+   }
+   RectangleValues rect;
+   dfloat minPerimeter = std::numeric_limits< dfloat >::max();
+   RotatingCalipers( vertices, [ & ]( Calipers const& c ) {
+      dfloat perimeter = c.height + ( c.high - c.low ); // half the perimeter
+      if( perimeter < minPerimeter ) {
+         minPerimeter = perimeter;
+         rect = MakeRectangle( c );
+      }
+   }, []( VertexFloat const&, VertexFloat const& ) {} );
+   return rect;
+}
+
+namespace {
+
+// Circle through three points; if they are collinear, the circle with the two farthest apart as diameter
+CircleValues Circumcircle( VertexFloat const& a, VertexFloat const& b, VertexFloat const& c ) {
+   VertexFloat ab = b - a;
+   VertexFloat ac = c - a;
+   dfloat d = 2.0 * CrossProduct( ab, ac );
+   if( std::abs( d ) <= 1e-12 * ( DistanceSquare( a, b ) + DistanceSquare( a, c ))) {
+      VertexFloat p = a;
+      VertexFloat q = b;
+      if( DistanceSquare( a, c ) > DistanceSquare( p, q )) {
+         q = c;
+      }
+      if( DistanceSquare( b, c ) > DistanceSquare( p, q )) {
+         p = b;
+         q = c;
+      }
+      return { ( p + q ) / 2.0, Distance( p, q ) };
+   }
+   dfloat ab2 = ab.x * ab.x + ab.y * ab.y;
+   dfloat ac2 = ac.x * ac.x + ac.y * ac.y;
+   VertexFloat center{ ( ac.y * ab2 - ab.y * ac2 ) / d, ( ab.x * ac2 - ac.x * ab2 ) / d };
+   return { a + center, 2.0 * Norm( center ) };
+}
+
+inline bool IsOutside( CircleValues const& circle, VertexFloat const& p ) {
+   return Distance( circle.center, p ) > circle.diameter / 2.0 * ( 1.0 + 1e-12 ) + 1e-12;
+}
+
+} // namespace
+
+CircleValues ConvexHull::MinimumEnclosingCircle() const {
+   std::vector< VertexFloat > points = Vertices();
+   if( points.empty() ) {
+      return {};
+   }
+   // The vertices of the convex hull are sorted by angle, which is a worst case for the incremental algorithm
+   std::shuffle( points.begin(), points.end(), std::minstd_rand( 5489u ));
+   CircleValues circle{ points[ 0 ], 0.0 };
+   for( dip::uint ii = 1; ii < points.size(); ++ii ) {
+      if( !IsOutside( circle, points[ ii ] )) {
+         continue;
+      }
+      circle = { points[ ii ], 0.0 };
+      for( dip::uint jj = 0; jj < ii; ++jj ) {
+         if( !IsOutside( circle, points[ jj ] )) {
+            continue;
+         }
+         circle = { ( points[ ii ] + points[ jj ] ) / 2.0, Distance( points[ ii ], points[ jj ] ) };
+         for( dip::uint kk = 0; kk < jj; ++kk ) {
+            if( IsOutside( circle, points[ kk ] )) {
+               circle = Circumcircle( points[ ii ], points[ jj ], points[ kk ] );
+            }
+         }
+      }
+   }
+   return circle;
+}
 
 } // namespace dip
 
@@ -194,4 +336,84 @@ DOCTEST_TEST_CASE("[DIPlib] testing chain code polygons") {
    DOCTEST_CHECK( h.IsClockWise() );
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing rotating calipers on convex hulls") {
+   std::mt19937 generator( 17 );
+   std::uniform_real_distribution< dip::dfloat > distribution( -20.0, 20.0 );
+   for( dip::uint test = 0; test < 20; ++test ) {
+      // A star-shaped polygon around the origin, its convex hull is a random convex polygon
+      dip::Polygon p;
+      for( dip::uint ii = 0; ii < 40; ++ii ) {
+         p.vertices.push_back( { distribution( generator ), distribution( generator ) * 0.5 } );
+      }
+      std::sort( p.vertices.begin(), p.vertices.end(), []( dip::VertexFloat const& a, dip::VertexFloat const& b ) {
+         return std::atan2( a.y, a.x ) > std::atan2( b.y, b.x );
+      } );
+      dip::ConvexHull h = p.ConvexHull();
+      auto const& v = h.Vertices();
+      dip::uint n = v.size();
+      DOCTEST_REQUIRE( n >= 3 );
+      // Brute-force computation of the diameters and the bounding rectangles
+      dip::dfloat maxDiameter = 0;
+      for( auto const& a : v ) {
+         for( auto const& b : v ) {
+            maxDiameter = std::max( maxDiameter, dip::Distance( a, b ));
+         }
+      }
+      dip::dfloat minDiameter = std::numeric_limits< dip::dfloat >::max();
+      dip::dfloat minArea = std::numeric_limits< dip::dfloat >::max();
+      dip::dfloat minPerimeter = std::numeric_limits< dip::dfloat >::max();
+      for( dip::uint ii = 0; ii < n; ++ii ) {
+         dip::VertexFloat a = v[ ii ];
+         dip::VertexFloat b = v[ ( ii + 1 ) % n ];
+         dip::VertexFloat axis = ( b - a ) / dip::Distance( a, b );
+         dip::dfloat height = 0;
+         dip::dfloat low = 0;
+         dip::dfloat high = 0;
+         for( auto const& c : v ) {
+            height = std::max( height, dip::TriangleHeight( a, b, c ));
+            dip::dfloat proj = axis.x * ( c.x - a.x ) + axis.y * ( c.y - a.y );
+            low = std::min( low, proj );
+            high = std::max( high, proj );
+         }
+         minDiameter = std::min( minDiameter, height );
+         minArea = std::min( minArea, height * ( high - low ));
+         minPerimeter = std::min( minPerimeter, 2.0 * ( height + high - low ));
+      }
+      dip::FeretValues f = h.Feret();
+      DOCTEST_CHECK( f.maxDiameter == doctest::Approx( maxDiameter ));
+      DOCTEST_CHECK( f.minDiameter == doctest::Approx( minDiameter ));
+      dip::RectangleValues r = h.MinimumAreaRectangle();
+      DOCTEST_CHECK( r.length * r.width == doctest::Approx( minArea ));
+      DOCTEST_CHECK( r.length >= r.width );
+      r = h.MinimumPerimeterRectangle();
+      DOCTEST_CHECK( 2.0 * ( r.length + r.width ) == doctest::Approx( minPerimeter ));
+      // The enclosing circle contains all vertices, and touches at least two of them
+      dip::CircleValues c = h.MinimumEnclosingCircle();
+      dip::dfloat radius = c.diameter / 2.0;
+      dip::uint touching = 0;
+      bool inside = true;
+      for( auto const& a : v ) {
+         dip::dfloat d = dip::Distance( c.center, a );
+         inside &= d <= radius + 1e-9;
+         touching += d >= radius - 1e-9;
+      }
+      DOCTEST_CHECK( inside );
+      DOCTEST_CHECK( touching >= 2 );
+      DOCTEST_CHECK( c.diameter >= maxDiameter - 1e-9 );
+      DOCTEST_CHECK( c.diameter <= maxDiameter * 2.0 / std::sqrt( 3.0 ) + 1e-9 );
+   }
+   // A square rotated by 30 degrees
+   dip::Polygon p;
+   dip::dfloat cos = std::cos( dip::pi / 6.0 );
+   dip::dfloat sin = std::sin( dip::pi / 6.0 );
+   p.vertices = {{ 0, 0 }, { -sin * 3, cos * 3 }, { cos * 3 - sin * 3, sin * 3 + cos * 3 }, { cos * 3, sin * 3 }};
+   dip::RectangleValues r = p.ConvexHull().MinimumAreaRectangle();
+   DOCTEST_CHECK( r.length == doctest::Approx( 3.0 ));
+   DOCTEST_CHECK( r.width == doctest::Approx( 3.0 ));
+   DOCTEST_CHECK( r.center.x == doctest::Approx(( cos - sin ) * 1.5 ));
+   DOCTEST_CHECK( r.center.y == doctest::Approx(( sin + cos ) * 1.5 ));
+   dip::CircleValues c = p.ConvexHull().MinimumEnclosingCircle();
+   DOCTEST_CHECK( c.diameter == doctest::Approx( 3.0 * std::sqrt( 2.0 )));
+}
+
 #endif // DIP__ENABLE_DOCTEST
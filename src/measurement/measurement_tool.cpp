@@ -23,7 +23,10 @@
 #include "diplib/iterators.h"
 #include "diplib/chain_code.h"
 #include "diplib/framework.h"
+#include "diplib/multithreading.h"
 #include "diplib/regions.h"
+#include "diplib/surface_mesh.h"
+#include "parallel_for.h"
 
 // FEATURES:
 // Size
@@ -37,6 +40,12 @@
 #include "feature_feret.h"
 #include "feature_convex_area.h"
 #include "feature_convex_perimeter.h"
+#include "feature_min_area_rectangle.h"
+#include "feature_min_perimeter_rectangle.h"
+#include "feature_enclosing_circle.h"
+#include "feature_mesh_surface_area.h"
+#include "feature_convex_volume.h"
+#include "feature_feret_3d.h"
 // Shape
 #include "feature_aspect_ratio_feret.h"
 #include "feature_radius.h"
@@ -49,6 +58,7 @@
 #include "feature_ellipse_variance.h"
 #include "feature_eccentricity.h"
 #include "feature_bending_energy.h"
+#include "feature_sphericity.h"
 // Intensity
 #include "feature_mass.h"
 #include "feature_mean.h"
@@ -87,6 +97,12 @@ MeasurementTool::MeasurementTool() {
    Register( new Feature::FeatureSolidArea );
    Register( new Feature::FeatureConvexArea );
    Register( new Feature::FeatureConvexPerimeter );
+   Register( new Feature::FeatureMinAreaRectangle );
+   Register( new Feature::FeatureMinPerimeterRectangle );
+   Register( new Feature::FeatureEnclosingCircle );
+   Register( new Feature::FeatureMeshSurfaceArea );
+   Register( new Feature::FeatureConvexVolume );
+   Register( new Feature::FeatureFeret3D );
    // Shape
    Register( new Feature::FeatureAspectRatioFeret );
    Register( new Feature::FeatureRadius );
@@ -99,6 +115,7 @@ MeasurementTool::MeasurementTool() {
    Register( new Feature::FeatureEllipseVariance );
    Register( new Feature::FeatureEccentricity );
    Register( new Feature::FeatureBendingEnergy );
+   Register( new Feature::FeatureSphericity );
    // Intensity
    Register( new Feature::FeatureMass );
    Register( new Feature::FeatureMean );
@@ -228,6 +245,7 @@ Measurement MeasurementTool::Measure(
    bool doChaincodeBased = false;
    bool doPolygonBased = false;
    bool doConvHullBased = false;
+   bool doMeshBased = false;
    bool doComposite = false;
    for( auto const& feature : featureArray ) {
       switch( feature->type ) {
@@ -247,6 +265,9 @@ Measurement MeasurementTool::Measure(
          case Feature::Type::CONVEXHULL_BASED:
             doConvHullBased = true;
             break;
+         case Feature::Type::MESH_BASED:
+            doMeshBased = true;
+            break;
          case Feature::Type::COMPOSITE:
             doComposite = true;
             break;
@@ -293,30 +314,89 @@ Measurement MeasurementTool::Measure(
    // Let the chaincode based functions do their work
    if( doChaincodeBased || doPolygonBased || doConvHullBased ) {
       ChainCodeArray chainCodeArray = GetImageChainCodes( label, measurement.Objects(), connectivity );
-      auto itCC = chainCodeArray.begin();
-      auto itObj = measurement.FirstObject(); // these two arrays are ordered the same way
-      do {
+      // Find where each feature writes its values, objects are in the same order as `chainCodeArray`
+      std::vector< Feature::Base* > objectFeatures;
+      std::vector< dip::uint > columns;
+      for( auto const& feature : featureArray ) {
+         if(( feature->type == Feature::Type::CHAINCODE_BASED ) ||
+            ( feature->type == Feature::Type::POLYGON_BASED ) ||
+            ( feature->type == Feature::Type::CONVEXHULL_BASED )) {
+            objectFeatures.push_back( feature );
+            columns.push_back( measurement.ValueIndex( feature->information.name ));
+         }
+      }
+      Measurement::ValueType* data = measurement.Data();
+      dip::sint stride = measurement.Stride();
+      // Each object is measured independently, we distribute them over threads
+      dip::uint nObjects = chainCodeArray.size();
+      dip::uint nThreads = std::min( GetNumberOfThreads(), nObjects );
+      if( nThreads > 1 ) {
+         dip::uint operations = 0;
+         for( auto const& cc : chainCodeArray ) {
+            operations += cc.codes.size();
+         }
+         if( operations * ( 20 + 10 * objectFeatures.size() ) < threadingThreshold ) {
+            nThreads = 1;
+         }
+      }
+      DIP_STACK_TRACE_THIS( ParallelFor( nObjects, nThreads, 16, [ & ]( dip::uint ii ) {
+         ChainCode const& chainCode = chainCodeArray[ ii ];
+         Measurement::ValueType* row = data + static_cast< dip::sint >( ii ) * stride;
          Polygon polygon;
          ConvexHull convexHull;
          if( doPolygonBased || doConvHullBased ) {
-            polygon = itCC->Polygon();
+            polygon = chainCode.Polygon();
          }
          if( doConvHullBased ) {
             convexHull = polygon.ConvexHull();
          }
-         for( auto const& feature : featureArray ) {
+         for( dip::uint jj = 0; jj < objectFeatures.size(); ++jj ) {
+            Feature::Base* feature = objectFeatures[ jj ];
+            Measurement::ValueType* cell = row + columns[ jj ];
             if( feature->type == Feature::Type::CHAINCODE_BASED ) {
-               auto cell = itObj[ feature->information.name ];
-               dynamic_cast< Feature::ChainCodeBased* >( feature )->Measure( *itCC, cell.data() );
+               static_cast< Feature::ChainCodeBased* >( feature )->Measure( chainCode, cell );
             } else if( feature->type == Feature::Type::POLYGON_BASED ) {
-               auto cell = itObj[ feature->information.name ];
-               dynamic_cast< Feature::PolygonBased* >( feature )->Measure( polygon, cell.data() );
-            } else if( feature->type == Feature::Type::CONVEXHULL_BASED ) {
-               auto cell = itObj[ feature->information.name ];
-               dynamic_cast< Feature::ConvexHullBased* >( feature )->Measure( convexHull, cell.data() );
+               static_cast< Feature::PolygonBased* >( feature )->Measure( polygon, cell );
+            } else {
+               static_cast< Feature::ConvexHullBased* >( feature )->Measure( convexHull, cell );
             }
          }
-      } while( ++itCC, ++itObj );
+      } ));
+   }
+
+   // Let the surface-mesh based functions do their work
+   if( doMeshBased ) {
+      SurfaceMeshArray meshArray = GetImageSurfaceMeshes( label, measurement.Objects() );
+      // Find where each feature writes its values, objects are in the same order as `meshArray`
+      std::vector< Feature::MeshBased* > meshFeatures;
+      std::vector< dip::uint > columns;
+      for( auto const& feature : featureArray ) {
+         if( feature->type == Feature::Type::MESH_BASED ) {
+            meshFeatures.push_back( static_cast< Feature::MeshBased* >( feature ));
+            columns.push_back( measurement.ValueIndex( feature->information.name ));
+         }
+      }
+      Measurement::ValueType* data = measurement.Data();
+      dip::sint stride = measurement.Stride();
+      // Each object is measured independently, we distribute them over threads
+      dip::uint nObjects = meshArray.size();
+      dip::uint nThreads = std::min( GetNumberOfThreads(), nObjects );
+      if( nThreads > 1 ) {
+         dip::uint operations = 0;
+         for( auto const& mesh : meshArray ) {
+            operations += mesh.triangles.size();
+         }
+         if( operations * 50 * meshFeatures.size() < threadingThreshold ) {
+            nThreads = 1;
+         }
+      }
+      DIP_STACK_TRACE_THIS( ParallelFor( nObjects, nThreads, 4, [ & ]( dip::uint ii ) {
+         SurfaceMesh const& mesh = meshArray[ ii ];
+         Measurement::ValueType* row = data + static_cast< dip::sint >( ii ) * stride;
+         for( dip::uint jj = 0; jj < meshFeatures.size(); ++jj ) {
+            meshFeatures[ jj ]->Measure( mesh, row + columns[ jj ] );
+         }
+      } ));
    }
 
    // Let the composite functions do their work
@@ -341,3 +421,36 @@ Measurement MeasurementTool::Measure(
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the mesh-based features of dip::MeasurementTool") {
+   dip::Image labels( { 50, 40, 35 }, 1, dip::DT_UINT8 );
+   labels.Fill( 0 );
+   dip::DrawEllipsoid( labels, { 24, 16, 12 }, { 14, 18, 16 }, { 2 } );
+   labels.At( dip::Range{ 30, 45 }, dip::Range{ 25, 39 }, dip::Range{ 3, 30 } ).Fill( 5 );
+   dip::MeasurementTool tool;
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( std::max< dip::uint >( nThreads, 4 ));
+   dip::Measurement msr = tool.Measure( labels, {}, { "MeshSurfaceArea", "ConvexVolume", "Feret3D", "Sphericity" } );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( msr.NumberOfObjects() == 2 );
+   // Each object's values are those of its own mesh, written to the object's row
+   dip::SurfaceMeshArray meshes = dip::GetImageSurfaceMeshes( labels, { 5, 2 } );
+   DOCTEST_REQUIRE( meshes.size() == 2 );
+   for( auto const& mesh : meshes ) {
+      dip::uint id = mesh.objectID;
+      DOCTEST_CHECK( msr[ "MeshSurfaceArea" ][ id ][ 0 ] == mesh.Area() );
+      DOCTEST_CHECK( msr[ "ConvexVolume" ][ id ][ 0 ] == mesh.ConvexHull().Volume() );
+      dip::Feret3DValues feret = mesh.Feret();
+      DOCTEST_CHECK( msr[ "Feret3D" ][ id ][ 0 ] == feret.maxDiameter );
+      DOCTEST_CHECK( msr[ "Feret3D" ][ id ][ 1 ] == feret.minDiameter );
+      DOCTEST_CHECK( msr[ "Sphericity" ][ id ][ 0 ] == mesh.Sphericity() );
+   }
+   DOCTEST_CHECK( msr[ "MeshSurfaceArea" ][ 2 ][ 0 ] != msr[ "MeshSurfaceArea" ][ 5 ][ 0 ] );
+}
+
+#endif // DIP__ENABLE_DOCTEST
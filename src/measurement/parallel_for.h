@@ -0,0 +1,55 @@
+/*
+ * DIPlib 3.0
+ * This file contains support for distributing independent per-object computations over threads.
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_PARALLEL_FOR_H
+#define DIP_PARALLEL_FOR_H
+
+#include <exception>
+
+#include "diplib.h"
+#include "diplib/multithreading.h"
+
+namespace dip {
+
+// Calls `function( ii )` for each `ii` in [0,`n`), distributing the calls over `nThreads` threads, in dynamically
+// scheduled chunks of `chunkSize` calls. An exception thrown by `function` does not stop the other calls; after
+// all threads are done, the first exception caught is re-thrown as is, keeping its type (`dip::ParameterError`,
+// `dip::AssertionError`, etc.) and its stack trace.
+template< typename F >
+void ParallelFor( dip::uint n, dip::uint nThreads, dip::uint chunkSize, F const& function ) {
+   std::exception_ptr error;
+   #pragma omp parallel for num_threads( static_cast< int >( nThreads )) schedule( dynamic, static_cast< int >( chunkSize ))
+   for( dip::sint ii = 0; ii < static_cast< dip::sint >( n ); ++ii ) {
+      try {
+         function( static_cast< dip::uint >( ii ));
+      } catch( ... ) {
+         #pragma omp critical( dip__ParallelFor )
+         if( !error ) {
+            error = std::current_exception();
+         }
+      }
+   }
+   if( error ) {
+      std::rethrow_exception( error );
+   }
+}
+
+} // namespace dip
+
+#endif // DIP_PARALLEL_FOR_H
@@ -0,0 +1,853 @@
+/*
+ * DIPlib 3.0
+ * This file contains functions for extracting and measuring object surfaces as triangle meshes
+ *
+ * (c)2018, Cris Luengo.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <map>
+
+#include "diplib.h"
+#include "diplib/surface_mesh.h"
+#include "diplib/regions.h"
+#include "diplib/overload.h"
+#include "diplib/multithreading.h"
+#include "parallel_for.h"
+
+namespace dip {
+
+dfloat SurfaceMesh::Area() const {
+   dfloat area = 0.0;
+   for( auto const& t : triangles ) {
+      area += Norm( Cross( vertices[ t[ 1 ]] - vertices[ t[ 0 ]], vertices[ t[ 2 ]] - vertices[ t[ 0 ]] ));
+   }
+   return area / 2.0;
+}
+
+dfloat SurfaceMesh::Volume() const {
+   if( IsEmpty() ) {
+      return 0.0;
+   }
+   // Tetrahedra are formed with an arbitrary vertex, which keeps values small for objects far from the origin
+   Vertex3D origin = vertices[ triangles[ 0 ][ 0 ]];
+   dfloat volume = 0.0;
+   for( auto const& t : triangles ) {
+      volume += Dot( vertices[ t[ 0 ]] - origin, Cross( vertices[ t[ 1 ]] - origin, vertices[ t[ 2 ]] - origin ));
+   }
+   return volume / 6.0;
+}
+
+namespace {
+
+struct HullFace {
+   SurfaceMesh::Triangle vertices;
+   std::array< dip::uint, 3 > neighbors;  // the face across the edge from `vertices[k]` to `vertices[k+1]`
+   Vertex3D anchor;                       // the first vertex
+   Vertex3D normal;                       // outward normal, not normalized
+   dfloat tolerance;                      // points closer to the plane than this are considered to be on it
+   std::vector< dip::uint > outside;      // indices of the points above this face
+   dip::uint visited = 0;                 // the iteration in which `visible` was last set
+   bool visible = false;
+   bool deleted = false;
+};
+
+HullFace MakeFace( std::vector< Vertex3D > const& points, dip::uint a, dip::uint b, dip::uint c, dfloat tolerance ) {
+   HullFace face;
+   face.vertices = { a, b, c };
+   face.anchor = points[ a ];
+   face.normal = Cross( points[ b ] - points[ a ], points[ c ] - points[ a ] );
+   face.tolerance = tolerance * Norm( face.normal );
+   return face;
+}
+
+// Signed distance of `p` to the plane of `face`, multiplied by the length of the face normal.
+inline dfloat Height( HullFace const& face, Vertex3D p ) {
+   return Dot( face.normal, p - face.anchor );
+}
+
+inline bool IsAbove( HullFace const& face, Vertex3D p ) {
+   return Height( face, p ) > face.tolerance;
+}
+
+// Returns the index `k` such that the edge from `vertices[k]` to `vertices[k+1]` goes from `a` to `b`.
+inline dip::uint EdgeIndex( SurfaceMesh::Triangle const& vertices, dip::uint a, dip::uint b ) {
+   for( dip::uint kk = 0; kk < 3; ++kk ) {
+      if(( vertices[ kk ] == a ) && ( vertices[ ( kk + 1 ) % 3 ] == b )) {
+         return kk;
+      }
+   }
+   DIP_THROW_ASSERTION( "Convex hull faces are not connected" );
+}
+
+struct HorizonEdge {
+   dip::uint a;         // start vertex of the edge, as seen from the visible face
+   dip::uint b;         // end vertex
+   dip::uint neighbor;  // the face that is not visible
+   dip::uint newFace;   // the new face built on this edge
+};
+
+} // namespace
+
+SurfaceMesh SurfaceMesh::ConvexHull() const {
+   std::vector< Vertex3D > const& points = vertices;
+   dip::uint nPoints = points.size();
+   SurfaceMesh out;
+   out.objectID = objectID;
+   if( nPoints < 4 ) {
+      return out;
+   }
+
+   // Initial tetrahedron: the two most distant of the extreme points along the axes, the point farthest
+   // from the line through them, and the point farthest from the plane through those three.
+   std::array< dip::uint, 6 > extremes{};
+   for( dip::uint ii = 1; ii < nPoints; ++ii ) {
+      Vertex3D p = points[ ii ];
+      if( p.x < points[ extremes[ 0 ]].x ) { extremes[ 0 ] = ii; }
+      if( p.x > points[ extremes[ 1 ]].x ) { extremes[ 1 ] = ii; }
+      if( p.y < points[ extremes[ 2 ]].y ) { extremes[ 2 ] = ii; }
+      if( p.y > points[ extremes[ 3 ]].y ) { extremes[ 3 ] = ii; }
+      if( p.z < points[ extremes[ 4 ]].z ) { extremes[ 4 ] = ii; }
+      if( p.z > points[ extremes[ 5 ]].z ) { extremes[ 5 ] = ii; }
+   }
+   dip::uint i0 = 0;
+   dip::uint i1 = 0;
+   dfloat best = 0.0;
+   for( dip::uint ii = 0; ii < 6; ++ii ) {
+      for( dip::uint jj = ii + 1; jj < 6; ++jj ) {
+         Vertex3D d = points[ extremes[ jj ]] - points[ extremes[ ii ]];
+         if( Dot( d, d ) > best ) {
+            best = Dot( d, d );
+            i0 = extremes[ ii ];
+            i1 = extremes[ jj ];
+         }
+      }
+   }
+   if( best == 0.0 ) {
+      return out;
+   }
+   // Distances relative to the object size below this value are attributed to rounding errors
+   dfloat tolerance = 1e-10 * std::sqrt( best );
+   dip::uint i2 = 0;
+   best = 0.0;
+   Vertex3D axis = points[ i1 ] - points[ i0 ];
+   for( dip::uint ii = 0; ii < nPoints; ++ii ) {
+      Vertex3D c = Cross( axis, points[ ii ] - points[ i0 ] );
+      if( Dot( c, c ) > best ) {
+         best = Dot( c, c );
+         i2 = ii;
+      }
+   }
+   if( best == 0.0 ) {
+      return out;
+   }
+   dip::uint i3 = 0;
+   best = 0.0;
+   HullFace base = MakeFace( points, i0, i1, i2, tolerance );
+   for( dip::uint ii = 0; ii < nPoints; ++ii ) {
+      dfloat h = std::abs( Height( base, points[ ii ] ));
+      if( h > best ) {
+         best = h;
+         i3 = ii;
+      }
+   }
+   if( best <= base.tolerance ) {
+      return out;
+   }
+   std::vector< HullFace > faces;
+   std::array< std::array< dip::uint, 4 >, 4 > simplex{{ // three face vertices and the opposite vertex
+         {{ i0, i1, i2, i3 }}, {{ i0, i1, i3, i2 }}, {{ i0, i2, i3, i1 }}, {{ i1, i2, i3, i0 }}
+   }};
+   for( auto const& s : simplex ) {
+      HullFace face = MakeFace( points, s[ 0 ], s[ 1 ], s[ 2 ], tolerance );
+      if( Height( face, points[ s[ 3 ]] ) > 0 ) {
+         face = MakeFace( points, s[ 0 ], s[ 2 ], s[ 1 ], tolerance );
+      }
+      faces.push_back( std::move( face ));
+   }
+   for( dip::uint ff = 0; ff < 4; ++ff ) {
+      for( dip::uint kk = 0; kk < 3; ++kk ) {
+         dip::uint a = faces[ ff ].vertices[ kk ];
+         dip::uint b = faces[ ff ].vertices[ ( kk + 1 ) % 3 ];
+         for( dip::uint gg = 0; gg < 4; ++gg ) {
+            if(( gg != ff ) && ( std::find( faces[ gg ].vertices.begin(), faces[ gg ].vertices.end(), a ) != faces[ gg ].vertices.end() )
+                            && ( std::find( faces[ gg ].vertices.begin(), faces[ gg ].vertices.end(), b ) != faces[ gg ].vertices.end() )) {
+               faces[ ff ].neighbors[ kk ] = gg;
+            }
+         }
+      }
+   }
+   for( dip::uint ii = 0; ii < nPoints; ++ii ) {
+      if(( ii == i0 ) || ( ii == i1 ) || ( ii == i2 ) || ( ii == i3 )) {
+         continue;
+      }
+      for( auto& face : faces ) {
+         if( IsAbove( face, points[ ii ] )) {
+            face.outside.push_back( ii );
+            break;
+         }
+      }
+   }
+
+   // Quickhull: repeatedly add the point farthest above a face, replacing all faces it sees by a cone
+   // of new faces from the horizon to the point. Points not above any of the new faces are inside the hull.
+   std::vector< dip::uint > stack{ 0, 1, 2, 3 };
+   std::vector< dip::uint > visible;
+   std::vector< HorizonEdge > horizon;
+   dip::uint iteration = 0;
+   while( !stack.empty() ) {
+      dip::uint current = stack.back();
+      stack.pop_back();
+      if( faces[ current ].deleted || faces[ current ].outside.empty() ) {
+         continue;
+      }
+      dip::uint apex = faces[ current ].outside[ 0 ];
+      best = Height( faces[ current ], points[ apex ] );
+      for( dip::uint ii : faces[ current ].outside ) {
+         dfloat h = Height( faces[ current ], points[ ii ] );
+         if( h > best ) {
+            best = h;
+            apex = ii;
+         }
+      }
+      Vertex3D p = points[ apex ];
+      // Find the faces visible from `p`, they are connected to `current`; their boundary is the horizon
+      ++iteration;
+      faces[ current ].visited = iteration;
+      faces[ current ].visible = true;
+      visible.assign( 1, current );
+      horizon.clear();
+      for( dip::uint ii = 0; ii < visible.size(); ++ii ) {
+         dip::uint ff = visible[ ii ];
+         for( dip::uint kk = 0; kk < 3; ++kk ) {
+            dip::uint gg = faces[ ff ].neighbors[ kk ];
+            HullFace& neighbor = faces[ gg ];
+            if( neighbor.visited != iteration ) {
+               neighbor.visited = iteration;
+               neighbor.visible = IsAbove( neighbor, p );
+               if( neighbor.visible ) {
+                  visible.push_back( gg );
+               }
+            }
+            if( !neighbor.visible ) {
+               horizon.push_back( { faces[ ff ].vertices[ kk ], faces[ ff ].vertices[ ( kk + 1 ) % 3 ], gg, 0 } );
+            }
+         }
+      }
+      // Build the new faces and connect them to the rest of the hull and to each other
+      for( auto& edge : horizon ) {
+         edge.newFace = faces.size();
+         HullFace face = MakeFace( points, edge.a, edge.b, apex, tolerance );
+         face.neighbors[ 0 ] = edge.neighbor;
+         faces[ edge.neighbor ].neighbors[ EdgeIndex( faces[ edge.neighbor ].vertices, edge.b, edge.a ) ] = edge.newFace;
+         faces.push_back( std::move( face ));
+      }
+      for( auto const& edge : horizon ) {
+         for( auto const& other : horizon ) {
+            if( other.a == edge.b ) {
+               faces[ edge.newFace ].neighbors[ 1 ] = other.newFace;
+            }
+            if( other.b == edge.a ) {
+               faces[ edge.newFace ].neighbors[ 2 ] = other.newFace;
+            }
+         }
+      }
+      // Points above the removed faces are either above one of the new faces, or inside the hull
+      for( dip::uint ff : visible ) {
+         for( dip::uint ii : faces[ ff ].outside ) {
+            if( ii == apex ) {
+               continue;
+            }
+            for( auto const& edge : horizon ) {
+               if( IsAbove( faces[ edge.newFace ], points[ ii ] )) {
+                  faces[ edge.newFace ].outside.push_back( ii );
+                  break;
+               }
+            }
+         }
+         faces[ ff ].deleted = true;
+         faces[ ff ].outside.clear();
+         faces[ ff ].outside.shrink_to_fit();
+      }
+      for( auto const& edge : horizon ) {
+         if( !faces[ edge.newFace ].outside.empty() ) {
+            stack.push_back( edge.newFace );
+         }
+      }
+   }
+
+   // Copy the vertices that are used by the hull
+   std::vector< dip::uint > newIndex( nPoints, nPoints );
+   for( auto const& face : faces ) {
+      if( face.deleted ) {
+         continue;
+      }
+      SurfaceMesh::Triangle t;
+      for( dip::uint kk = 0; kk < 3; ++kk ) {
+         dip::uint ii = face.vertices[ kk ];
+         if( newIndex[ ii ] == nPoints ) {
+            newIndex[ ii ] = out.vertices.size();
+            out.vertices.push_back( points[ ii ] );
+         }
+         t[ kk ] = newIndex[ ii ];
+      }
+      out.triangles.push_back( t );
+   }
+   return out;
+}
+
+namespace {
+
+struct PointCell {
+   std::vector< dip::uint > points;
+   Vertex3D lower;
+   Vertex3D upper;
+};
+
+struct CellPair {
+   dfloat bound;  // upper bound for the squared distance between points in the two cells
+   dip::uint a;
+   dip::uint b;
+   bool operator>( CellPair const& other ) const { return bound > other.bound; }
+};
+
+inline dfloat LargestSquareDistance( PointCell const& a, PointCell const& b ) {
+   Vertex3D d{ std::max( a.upper.x - b.lower.x, b.upper.x - a.lower.x ),
+               std::max( a.upper.y - b.lower.y, b.upper.y - a.lower.y ),
+               std::max( a.upper.z - b.lower.z, b.upper.z - a.lower.z ) };
+   return Dot( d, d );
+}
+
+// Returns the largest squared distance between two of the `points`. The points are binned in a coarse grid, and
+// pairs of cells are examined in order of decreasing upper bound for the distance between their points, until
+// that bound is no larger than the largest distance found. The result is exact, but only pairs of cells at
+// nearly the largest distance are compared point by point. The grid is chosen such that cells have only a few
+// points if the points lie on a surface, as the vertices of a convex hull do.
+dfloat MaxSquareDistance( std::vector< Vertex3D > const& points ) {
+   dip::uint nPoints = points.size();
+   if( nPoints < 2 ) {
+      return 0.0;
+   }
+   Vertex3D lower = points[ 0 ];
+   Vertex3D upper = points[ 0 ];
+   for( auto const& p : points ) {
+      lower = { std::min( lower.x, p.x ), std::min( lower.y, p.y ), std::min( lower.z, p.z ) };
+      upper = { std::max( upper.x, p.x ), std::max( upper.y, p.y ), std::max( upper.z, p.z ) };
+   }
+   dip::uint k = std::max< dip::uint >( 1, static_cast< dip::uint >( std::sqrt( static_cast< dfloat >( nPoints ) / 32.0 )));
+   Vertex3D size = upper - lower;
+   auto CellIndex = [ & ]( dfloat v, dfloat low, dfloat sz ) {
+      if( sz <= 0.0 ) {
+         return dip::uint( 0 );
+      }
+      return std::min( static_cast< dip::uint >(( v - low ) / sz * static_cast< dfloat >( k )), k - 1 );
+   };
+   std::vector< PointCell > grid( k * k * k );
+   for( dip::uint ii = 0; ii < nPoints; ++ii ) {
+      Vertex3D p = points[ ii ];
+      PointCell& cell = grid[ CellIndex( p.x, lower.x, size.x ) +
+                              k * ( CellIndex( p.y, lower.y, size.y ) + k * CellIndex( p.z, lower.z, size.z )) ];
+      if( cell.points.empty() ) {
+         cell.lower = p;
+         cell.upper = p;
+      } else {
+         cell.lower = { std::min( cell.lower.x, p.x ), std::min( cell.lower.y, p.y ), std::min( cell.lower.z, p.z ) };
+         cell.upper = { std::max( cell.upper.x, p.x ), std::max( cell.upper.y, p.y ), std::max( cell.upper.z, p.z ) };
+      }
+      cell.points.push_back( ii );
+   }
+   std::vector< PointCell > cells;
+   for( auto& cell : grid ) {
+      if( !cell.points.empty() ) {
+         cells.push_back( std::move( cell ));
+      }
+   }
+   // A lower bound: the distance between the point farthest from an arbitrary point and the point farthest
+   // from that one, repeated while it increases
+   dfloat maxDistance = 0.0;
+   dip::uint from = 0;
+   while( true ) {
+      dip::uint farthest = from;
+      dfloat distance = 0.0;
+      for( dip::uint ii = 0; ii < nPoints; ++ii ) {
+         Vertex3D d = points[ ii ] - points[ from ];
+         if( Dot( d, d ) > distance ) {
+            distance = Dot( d, d );
+            farthest = ii;
+         }
+      }
+      if( distance <= maxDistance ) {
+         break;
+      }
+      maxDistance = distance;
+      from = farthest;
+   }
+   // Only cell pairs that could contain a larger distance are examined
+   std::vector< CellPair > pairs;
+   for( dip::uint ii = 0; ii < cells.size(); ++ii ) {
+      for( dip::uint jj = ii; jj < cells.size(); ++jj ) {
+         dfloat bound = LargestSquareDistance( cells[ ii ], cells[ jj ] );
+         if( bound > maxDistance ) {
+            pairs.push_back( { bound, ii, jj } );
+         }
+      }
+   }
+   std::sort( pairs.begin(), pairs.end(), std::greater< CellPair >() );
+   for( auto const& pair : pairs ) {
+      if( pair.bound <= maxDistance ) {
+         break;
+      }
+      std::vector< dip::uint > const& a = cells[ pair.a ].points;
+      std::vector< dip::uint > const& b = cells[ pair.b ].points;
+      for( dip::uint ii = 0; ii < a.size(); ++ii ) {
+         for( dip::uint jj = ( pair.a == pair.b ) ? ii + 1 : 0; jj < b.size(); ++jj ) {
+            Vertex3D d = points[ b[ jj ]] - points[ a[ ii ]];
+            maxDistance = std::max( maxDistance, Dot( d, d ));
+         }
+      }
+   }
+   return maxDistance;
+}
+
+} // namespace
+
+Feret3DValues SurfaceMesh::Feret() const {
+   Feret3DValues out;
+   SurfaceMesh hull = ConvexHull();
+   std::vector< Vertex3D > const& points = hull.IsEmpty() ? vertices : hull.vertices; // all vertices are coplanar
+   out.maxDiameter = std::sqrt( MaxSquareDistance( points ));
+   if( hull.IsEmpty() ) {
+      return out; // minDiameter is 0
+   }
+   // The vertex farthest from a face is found by walking along hull edges, starting at the vertex found for
+   // the previous face. On a convex polyhedron, a vertex without farther neighbors is the farthest vertex.
+   std::vector< std::vector< dip::uint >> adjacent( points.size() );
+   for( auto const& t : hull.triangles ) {
+      for( dip::uint kk = 0; kk < 3; ++kk ) {
+         adjacent[ t[ kk ]].push_back( t[ ( kk + 1 ) % 3 ] );
+      }
+   }
+   out.minDiameter = std::numeric_limits< dfloat >::max();
+   dip::uint far = 0;
+   for( auto const& t : hull.triangles ) {
+      Vertex3D anchor = points[ t[ 0 ]];
+      Vertex3D normal = Cross( points[ t[ 1 ]] - anchor, points[ t[ 2 ]] - anchor );
+      normal *= 1.0 / Norm( normal );
+      // The normal points outward, all vertices have a negative height
+      dfloat height = Dot( normal, points[ far ] - anchor );
+      bool moved;
+      do {
+         moved = false;
+         for( dip::uint ii : adjacent[ far ] ) {
+            dfloat h = Dot( normal, points[ ii ] - anchor );
+            if( h < height ) {
+               height = h;
+               far = ii;
+               moved = true;
+            }
+         }
+      } while( moved );
+      out.minDiameter = std::min( out.minDiameter, -height );
+   }
+   return out;
+}
+
+namespace {
+
+struct ObjectBox {
+   std::array< dip::sint, 3 > lower{{ std::numeric_limits< dip::sint >::max(), 0, 0 }};
+   std::array< dip::sint, 3 > upper{{ -1, -1, -1 }};
+   bool IsEmpty() const { return upper[ 0 ] < 0; }
+   void Expand( dip::sint x0, dip::sint x1, dip::sint y, dip::sint z ) {
+      if( IsEmpty() ) {
+         lower = {{ x0, y, z }};
+         upper = {{ x1, y, z }};
+      } else {
+         lower[ 0 ] = std::min( lower[ 0 ], x0 );
+         upper[ 0 ] = std::max( upper[ 0 ], x1 );
+         lower[ 1 ] = std::min( lower[ 1 ], y );
+         upper[ 1 ] = std::max( upper[ 1 ], y );
+         lower[ 2 ] = std::min( lower[ 2 ], z );
+         upper[ 2 ] = std::max( upper[ 2 ], z );
+      }
+   }
+   void Expand( ObjectBox const& other ) {
+      if( !other.IsEmpty() ) {
+         Expand( other.lower[ 0 ], other.upper[ 0 ], other.lower[ 1 ], other.lower[ 2 ] );
+         Expand( other.lower[ 0 ], other.upper[ 0 ], other.upper[ 1 ], other.upper[ 2 ] );
+      }
+   }
+};
+
+using ObjectIdList = std::map< dip::uint, dip::uint >; // key is the objectID (label), value is the index into the output
+
+// The 6 tetrahedra of the Freudenthal (Kuhn) subdivision of a cube. Corners are encoded with bit 0 for x,
+// bit 1 for y and bit 2 for z. Each tetrahedron is a path from corner 0 to corner 7, so that each corner is
+// a subset of the following ones. The subdivision is the same in each cube, so the faces of neighboring cubes
+// are split along the same diagonal and the surfaces in neighboring cubes match up.
+constexpr std::array< std::array< unsigned, 4 >, 6 > tetrahedra{{
+      {{ 0, 1, 3, 7 }}, {{ 0, 1, 5, 7 }}, {{ 0, 2, 3, 7 }}, {{ 0, 2, 6, 7 }}, {{ 0, 4, 5, 7 }}, {{ 0, 4, 6, 7 }}
+}};
+
+inline Vertex3D CornerPosition( unsigned corner ) {
+   return { static_cast< dfloat >( corner & 1u ), static_cast< dfloat >(( corner >> 1u ) & 1u ), static_cast< dfloat >(( corner >> 2u ) & 1u ) };
+}
+
+template< typename TPI >
+SurfaceMesh dip__OneSurfaceMesh(
+      TPI const* data,
+      IntegerArray const& strides,
+      dip::uint objectID,
+      ObjectBox const& box
+) {
+   SurfaceMesh mesh;
+   mesh.objectID = objectID;
+   if( box.IsEmpty() ) {
+      return mesh;
+   }
+   // Copy the object into a binary mask, with a border of one background pixel
+   dip::sint n0 = box.upper[ 0 ] - box.lower[ 0 ] + 3;
+   dip::sint n1 = box.upper[ 1 ] - box.lower[ 1 ] + 3;
+   dip::sint n2 = box.upper[ 2 ] - box.lower[ 2 ] + 3;
+   std::vector< uint8 > mask( static_cast< dip::uint >( n0 * n1 * n2 ), 0 );
+   for( dip::sint z = 1; z < n2 - 1; ++z ) {
+      for( dip::sint y = 1; y < n1 - 1; ++y ) {
+         TPI const* in = data + ( box.lower[ 0 ] ) * strides[ 0 ]
+                              + ( box.lower[ 1 ] + y - 1 ) * strides[ 1 ]
+                              + ( box.lower[ 2 ] + z - 1 ) * strides[ 2 ];
+         uint8* out = mask.data() + 1 + y * n0 + z * n0 * n1;
+         for( dip::sint x = 1; x < n0 - 1; ++x, in += strides[ 0 ], ++out ) {
+            *out = *in == objectID;
+         }
+      }
+   }
+   Vertex3D offset{ static_cast< dfloat >( box.lower[ 0 ] - 1 ),
+                    static_cast< dfloat >( box.lower[ 1 ] - 1 ),
+                    static_cast< dfloat >( box.lower[ 2 ] - 1 ) };
+   std::array< dip::sint, 8 > cornerOffsets;
+   for( unsigned corner = 0; corner < 8; ++corner ) {
+      cornerOffsets[ corner ] = static_cast< dip::sint >( corner & 1u ) +
+                                static_cast< dip::sint >(( corner >> 1u ) & 1u ) * n0 +
+                                static_cast< dip::sint >(( corner >> 2u ) & 1u ) * n0 * n1;
+   }
+
+   // A smoothed version of the mask is used to place the vertices along the edges, reducing the staircase
+   // effect of the binary surface. The mask decides which edges are crossed, so the topology is not affected.
+   // The smoothing is a [1,2,1] filter along each dimension. We don't normalize, so that the result is an
+   // integer in [0,64], which fits in a `uint8` (`level / 64` is the smoothed mask). This keeps the memory
+   // needed per object at 3 bytes per pixel in its bounding box.
+   constexpr dfloat levelScale = 1.0 / 64.0;
+   std::vector< uint8 > level( mask );
+   {
+      std::array< dip::sint, 3 > sizes{{ n0, n1, n2 }};
+      std::array< dip::sint, 3 > steps{{ 1, n0, n0 * n1 }};
+      std::vector< uint8 > buffer( level.size() );
+      for( dip::uint dd = 0; dd < 3; ++dd ) {
+         dip::uint index = 0;
+         std::array< dip::sint, 3 > pos{};
+         for( pos[ 2 ] = 0; pos[ 2 ] < n2; ++pos[ 2 ] ) {
+            for( pos[ 1 ] = 0; pos[ 1 ] < n1; ++pos[ 1 ] ) {
+               for( pos[ 0 ] = 0; pos[ 0 ] < n0; ++pos[ 0 ], ++index ) {
+                  unsigned value = 2u * level[ index ];
+                  if( pos[ dd ] > 0 ) {
+                     value += level[ index - static_cast< dip::uint >( steps[ dd ] ) ];
+                  }
+                  if( pos[ dd ] < sizes[ dd ] - 1 ) {
+                     value += level[ index + static_cast< dip::uint >( steps[ dd ] ) ];
+                  }
+                  buffer[ index ] = static_cast< uint8 >( value );
+               }
+            }
+         }
+         level.swap( buffer );
+      }
+   }
+
+   // Vertices are identified by the lattice point at their lower end and the direction of the lattice edge.
+   // We keep the indices for the edges starting at the two planes of lattice points of the current cubes.
+   constexpr dip::uint noVertex = std::numeric_limits< dip::uint >::max();
+   std::array< std::vector< dip::uint >, 2 > vertexIndex{{
+         std::vector< dip::uint >( static_cast< dip::uint >( n0 * n1 ) * 8, noVertex ),
+         std::vector< dip::uint >( static_cast< dip::uint >( n0 * n1 ) * 8, noVertex )
+   }};
+   Vertex3D cell;
+   dip::sint z = 0;
+   auto EdgeVertex = [ & ]( dip::sint index, unsigned c0, unsigned c1 ) -> dip::uint { // c0 is a subset of c1
+      dip::uint i0 = static_cast< dip::uint >( index + cornerOffsets[ c0 ] );
+      dip::uint i1 = static_cast< dip::uint >( index + cornerOffsets[ c1 ] );
+      dip::uint plane = static_cast< dip::uint >( z + (( c0 >> 2u ) & 1u )) & 1u;
+      dip::uint& vertex = vertexIndex[ plane ][ ( i0 % static_cast< dip::uint >( n0 * n1 )) * 8 + ( c0 ^ c1 ) ];
+      if( vertex == noVertex ) {
+         vertex = mesh.vertices.size();
+         // Find where the smoothed mask crosses 0.5, not too close to either end of the edge
+         dfloat l0 = static_cast< dfloat >( level[ i0 ] ) * levelScale;
+         dfloat l1 = static_cast< dfloat >( level[ i1 ] ) * levelScale;
+         dfloat v0 = mask[ i0 ] ? l0 : 1.0 - l0;
+         dfloat v1 = mask[ i1 ] ? 1.0 - l1 : l1;
+         dfloat t = 0.5;
+         if(( v0 > 0.5 ) && ( v1 < 0.5 )) {
+            t = ( v0 - 0.5 ) / ( v0 - v1 );
+         }
+         t = clamp( t, 0.1, 0.9 );
+         mesh.vertices.push_back( cell + CornerPosition( c0 ) + ( CornerPosition( c1 ) - CornerPosition( c0 )) * t );
+      }
+      return vertex;
+   };
+   // Adds a triangle with its normal pointing away from `inside`, a tetrahedron corner inside the object
+   auto AddTriangle = [ & ]( dip::uint a, dip::uint b, dip::uint c, unsigned inside ) {
+      Vertex3D normal = Cross( mesh.vertices[ b ] - mesh.vertices[ a ], mesh.vertices[ c ] - mesh.vertices[ a ] );
+      if( Dot( normal, cell + CornerPosition( inside ) - mesh.vertices[ a ] ) > 0 ) {
+         std::swap( b, c );
+      }
+      mesh.triangles.push_back( { a, b, c } );
+   };
+
+   // March through the cubes
+   for( ; z < n2 - 1; ++z ) {
+      if( z > 0 ) {
+         // The plane at `z + 1` is new, forget the vertices of the plane at `z - 1` that were stored there
+         std::fill( vertexIndex[ ( z + 1 ) & 1 ].begin(), vertexIndex[ ( z + 1 ) & 1 ].end(), noVertex );
+      }
+      for( dip::sint y = 0; y < n1 - 1; ++y ) {
+         for( dip::sint x = 0; x < n0 - 1; ++x ) {
+            dip::sint index = x + y * n0 + z * n0 * n1;
+            unsigned inside = 0;
+            for( unsigned corner = 0; corner < 8; ++corner ) {
+               inside |= static_cast< unsigned >( mask[ static_cast< dip::uint >( index + cornerOffsets[ corner ] ) ] ) << corner;
+            }
+            if(( inside == 0 ) || ( inside == 255 )) {
+               continue;
+            }
+            cell = offset + Vertex3D{ static_cast< dfloat >( x ), static_cast< dfloat >( y ), static_cast< dfloat >( z ) };
+            for( auto const& tet : tetrahedra ) {
+               std::array< dip::uint, 4 > in{};  // indices into `tet` for inside corners
+               std::array< dip::uint, 4 > out{}; // indices into `tet` for outside corners
+               dip::uint nIn = 0;
+               dip::uint nOut = 0;
+               for( dip::uint ii = 0; ii < 4; ++ii ) {
+                  if( inside & ( 1u << tet[ ii ] )) {
+                     in[ nIn++ ] = ii;
+                  } else {
+                     out[ nOut++ ] = ii;
+                  }
+               }
+               if(( nIn == 0 ) || ( nOut == 0 )) {
+                  continue;
+               }
+               // Edges always go from the lower to the higher index in `tet`
+               auto Edge = [ & ]( dip::uint ii, dip::uint jj ) {
+                  return ii < jj ? EdgeVertex( index, tet[ ii ], tet[ jj ] ) : EdgeVertex( index, tet[ jj ], tet[ ii ] );
+               };
+               if( nIn == 1 ) {
+                  AddTriangle( Edge( in[ 0 ], out[ 0 ] ), Edge( in[ 0 ], out[ 1 ] ), Edge( in[ 0 ], out[ 2 ] ), tet[ in[ 0 ]] );
+               } else if( nOut == 1 ) {
+                  AddTriangle( Edge( out[ 0 ], in[ 0 ] ), Edge( out[ 0 ], in[ 1 ] ), Edge( out[ 0 ], in[ 2 ] ), tet[ in[ 0 ]] );
+               } else {
+                  // A quadrilateral, its corners in order around the perimeter
+                  dip::uint v0 = Edge( in[ 0 ], out[ 0 ] );
+                  dip::uint v1 = Edge( in[ 0 ], out[ 1 ] );
+                  dip::uint v2 = Edge( in[ 1 ], out[ 1 ] );
+                  dip::uint v3 = Edge( in[ 1 ], out[ 0 ] );
+                  AddTriangle( v0, v1, v2, tet[ in[ 0 ]] );
+                  AddTriangle( v0, v2, v3, tet[ in[ 1 ]] );
+               }
+            }
+         }
+      }
+   }
+   return mesh;
+}
+
+template< typename TPI >
+SurfaceMeshArray dip__SurfaceMeshes(
+      Image const& labels,
+      ObjectIdList const& objectIdList,
+      UnsignedArray const& objectIDs
+) {
+   DIP_ASSERT( labels.DataType() == DataType( TPI( 0 ) ) );
+   TPI const* data = static_cast< TPI const* >( labels.Origin() );
+   IntegerArray const& strides = labels.Strides();
+   dip::sint sizeX = static_cast< dip::sint >( labels.Size( 0 ));
+   dip::sint sizeY = static_cast< dip::sint >( labels.Size( 1 ));
+   dip::uint nPlanes = labels.Size( 2 );
+   dip::uint nObjects = objectIDs.size();
+
+   // Find the bounding box of each object. Each thread scans a set of image planes.
+   dip::uint nThreads = std::min( GetNumberOfThreads(), nPlanes );
+   if(( nThreads > 1 ) && ( labels.NumberOfPixels() * 2 < threadingThreshold )) {
+      nThreads = 1;
+   }
+   std::vector< std::vector< ObjectBox >> boxes( nThreads, std::vector< ObjectBox >( nObjects ));
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      std::vector< ObjectBox >& found = boxes[ thread ];
+      dip::sint firstPlane = static_cast< dip::sint >( thread * nPlanes / nThreads );
+      dip::sint lastPlane = static_cast< dip::sint >(( thread + 1 ) * nPlanes / nThreads );
+      for( dip::sint z = firstPlane; z < lastPlane; ++z ) {
+         for( dip::sint y = 0; y < sizeY; ++y ) {
+            TPI const* line = data + y * strides[ 1 ] + z * strides[ 2 ];
+            dip::sint x = 0;
+            while( x < sizeX ) {
+               // Process one run of pixels with the same label
+               TPI label = line[ x * strides[ 0 ]];
+               dip::sint start = x;
+               do {
+                  ++x;
+               } while(( x < sizeX ) && ( line[ x * strides[ 0 ]] == label ));
+               if( label != 0 ) {
+                  auto it = objectIdList.find( label );
+                  if( it != objectIdList.end() ) {
+                     found[ it->second ].Expand( start, x - 1, y, z );
+                  }
+               }
+            }
+         }
+      }
+   }
+   for( dip::uint thread = 1; thread < nThreads; ++thread ) {
+      for( dip::uint ii = 0; ii < nObjects; ++ii ) {
+         boxes[ 0 ][ ii ].Expand( boxes[ thread ][ ii ] );
+      }
+   }
+   std::vector< ObjectBox > const& box = boxes[ 0 ];
+
+   // Extract the surface of each object, objects are independent of each other
+   nThreads = std::min( nThreads, nObjects );
+   SurfaceMeshArray meshes( nObjects );
+   DIP_STACK_TRACE_THIS( ParallelFor( nObjects, nThreads, 4, [ & ]( dip::uint ii ) {
+      meshes[ ii ] = dip__OneSurfaceMesh< TPI >( data, strides, objectIDs[ ii ], box[ ii ] );
+   } ));
+   return meshes;
+}
+
+} // namespace
+
+SurfaceMeshArray GetImageSurfaceMeshes(
+      Image const& labels,
+      UnsignedArray const& objectIDs
+) {
+   // Check input image
+   DIP_THROW_IF( !labels.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_STACK_TRACE_THIS( labels.CheckProperties( 3, 1, DataType::Class_UInt ));
+
+   // Create a map for the object IDs
+   UnsignedArray ids = objectIDs.empty() ? GetObjectLabels( labels, Image(), S::EXCLUDE ) : objectIDs;
+   ObjectIdList objectIdList;
+   for( dip::uint ii = 0; ii < ids.size(); ++ii ) {
+      objectIdList.emplace( ids[ ii ], ii );
+   }
+
+   // Get the surface mesh for each label
+   SurfaceMeshArray meshes;
+   DIP_OVL_CALL_ASSIGN_UINT( meshes, dip__SurfaceMeshes, ( labels, objectIdList, ids ), labels.DataType() );
+   return meshes;
+}
+
+} // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/math.h"
+#include "diplib/statistics.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::GetImageSurfaceMeshes") {
+   // A ball with a cavity, and a box touching the image edge
+   dip::Image labels( { 60, 50, 45 }, 1, dip::DT_UINT16 );
+   labels.Fill( 0 );
+   dip::DrawEllipsoid( labels, { 30, 30, 30 }, { 20, 20, 20 }, { 1 } );
+   labels.At( dip::Range{ 18, 22 }, dip::Range{ 18, 22 }, dip::Range{ 18, 22 } ).Fill( 0 );
+   labels.At( dip::Range{ 45, 59 }, dip::Range{ 30, 49 }, dip::Range{ 40, 44 } ).Fill( 7 );
+   dip::dfloat ballSize = static_cast< dip::dfloat >( dip::Count( labels == 1 ));
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::SurfaceMeshArray reference = dip::GetImageSurfaceMeshes( labels, { 7, 1 } );
+   dip::SetNumberOfThreads( std::max< dip::uint >( nThreads, 4 ));
+   dip::SurfaceMeshArray meshes = dip::GetImageSurfaceMeshes( labels, { 7, 1 } );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( meshes.size() == 2 );
+   DOCTEST_CHECK( meshes[ 0 ].objectID == 7 );
+   DOCTEST_CHECK( meshes[ 1 ].objectID == 1 );
+   for( dip::uint ii = 0; ii < 2; ++ii ) {
+      dip::SurfaceMesh const& mesh = meshes[ ii ];
+      DOCTEST_CHECK( mesh.vertices == reference[ ii ].vertices );
+      DOCTEST_CHECK( mesh.triangles == reference[ ii ].triangles );
+      // The mesh is closed and consistently oriented: each directed edge appears once, and so does its reverse
+      std::map< std::pair< dip::uint, dip::uint >, dip::uint > edges;
+      for( auto const& t : mesh.triangles ) {
+         for( dip::uint kk = 0; kk < 3; ++kk ) {
+            ++edges[ std::make_pair( t[ kk ], t[ ( kk + 1 ) % 3 ] ) ];
+         }
+      }
+      bool closed = true;
+      for( auto const& e : edges ) {
+         closed &= e.second == 1;
+         auto reverse = edges.find( std::make_pair( e.first.second, e.first.first ));
+         closed &= ( reverse != edges.end() ) && ( reverse->second == 1 );
+      }
+      DOCTEST_CHECK( closed );
+   }
+
+   // The box: faces are halfway between pixels, edges and corners are rounded off
+   dip::SurfaceMesh const& box = meshes[ 0 ];
+   DOCTEST_CHECK( box.Volume() < 15.0 * 20.0 * 5.0 );
+   DOCTEST_CHECK( box.Volume() > 15.0 * 20.0 * 5.0 - ( 15.0 + 20.0 + 5.0 ) * 4.0 * 0.5 );
+   DOCTEST_CHECK( box.Area() < 2.0 * ( 15.0 * 20.0 + 15.0 * 5.0 + 20.0 * 5.0 ));
+   DOCTEST_CHECK( box.Area() > 2.0 * ( 14.0 * 19.0 + 14.0 * 4.0 + 19.0 * 4.0 ));
+   dip::SurfaceMesh hull = box.ConvexHull();
+   DOCTEST_CHECK( hull.vertices.size() < box.vertices.size() );
+   DOCTEST_CHECK( hull.Volume() >= box.Volume() );
+   DOCTEST_CHECK( hull.Volume() <= 15.0 * 20.0 * 5.0 );
+   dip::Feret3DValues feret = box.Feret();
+   DOCTEST_CHECK( feret.minDiameter == doctest::Approx( 5.0 ));
+   DOCTEST_CHECK( feret.maxDiameter <= std::sqrt( 15.0 * 15.0 + 20.0 * 20.0 + 5.0 * 5.0 ));
+   DOCTEST_CHECK( feret.maxDiameter > std::sqrt( 14.0 * 14.0 + 19.0 * 19.0 + 4.0 * 4.0 ));
+
+   // The ball: the cavity is subtracted, the convex hull contains all vertices
+   dip::SurfaceMesh const& ball = meshes[ 1 ];
+   DOCTEST_CHECK( ball.Volume() == doctest::Approx( ballSize ).epsilon( 0.02 ));
+   hull = ball.ConvexHull();
+   DOCTEST_CHECK( hull.Volume() > ball.Volume() + 125.0 );
+   DOCTEST_CHECK( hull.Volume() < 4.0 / 3.0 * dip::pi * 15.5 * 15.5 * 15.5 );
+   dip::dfloat distance = -1.0; // largest distance of a vertex outside of the hull
+   for( auto const& t : hull.triangles ) {
+      dip::Vertex3D normal = dip::Cross( hull.vertices[ t[ 1 ]] - hull.vertices[ t[ 0 ]], hull.vertices[ t[ 2 ]] - hull.vertices[ t[ 0 ]] );
+      normal *= 1.0 / dip::Norm( normal );
+      for( auto const& v : ball.vertices ) {
+         distance = std::max( distance, dip::Dot( normal, v - hull.vertices[ t[ 0 ]] ));
+      }
+   }
+   DOCTEST_CHECK( distance < 1e-6 );
+   feret = ball.Feret();
+   dip::dfloat maxDiameter = 0.0; // compare all pairs of hull vertices
+   for( dip::uint ii = 0; ii < hull.vertices.size(); ++ii ) {
+      for( dip::uint jj = ii + 1; jj < hull.vertices.size(); ++jj ) {
+         maxDiameter = std::max( maxDiameter, dip::Norm( hull.vertices[ jj ] - hull.vertices[ ii ] ));
+      }
+   }
+   DOCTEST_CHECK( feret.maxDiameter == doctest::Approx( maxDiameter ));
+   DOCTEST_CHECK( feret.maxDiameter >= 31.0 );
+   DOCTEST_CHECK( feret.maxDiameter <= 32.0 );
+   DOCTEST_CHECK( feret.minDiameter >= 29.0 );
+   DOCTEST_CHECK( feret.minDiameter <= 31.0 );
+   // Without the cavity, the surface of the ball is close to that of a sphere
+   DOCTEST_CHECK( hull.Sphericity() > 0.97 );
+   DOCTEST_CHECK( ball.Sphericity() < hull.Sphericity() );
+}
+
+#endif // DIP__ENABLE_DOCTEST
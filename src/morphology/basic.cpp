@@ -250,8 +250,8 @@ class GreyValueSEMorphologyLineFilter : public Framework::FullLineFilter {
       virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint, dip::uint nKernelPixels, dip::uint ) override {
          return lineLength * nKernelPixels * 3;
       }
-      virtual void SetNumberOfThreads( dip::uint, PixelTableOffsets const& pixelTable ) override {
-         offsets_ = pixelTable.Offsets();
+      virtual void SetNumberOfThreads( dip::uint threads, PixelTableOffsets const& ) override {
+         buffers_.resize( threads );
       }
       virtual void Filter( Framework::FullLineFilterParameters const& params ) override {
          TPI* in = static_cast< TPI* >( params.inBuffer.buffer );
@@ -259,40 +259,57 @@ class GreyValueSEMorphologyLineFilter : public Framework::FullLineFilter {
          TPI* out = static_cast< TPI* >( params.outBuffer.buffer );
          dip::sint outStride = params.outBuffer.stride;
          dip::uint length = params.bufferLength;
-         std::vector< dfloat > const& weights =  params.pixelTable.Weights();
-         if( dilation_ ) {
-            for( dip::uint ii = 0; ii < length; ++ii ) {
-               TPI max = std::numeric_limits< TPI >::lowest();
-               auto ito = offsets_.begin();
-               auto itw = weights.begin();
-               while( ito != offsets_.end() ) {
-                  max = std::max( max, clamp_cast< TPI >( static_cast< dfloat >( in[ *ito ] ) + *itw ));
-                  ++ito;
-                  ++itw;
+         PixelTableOffsets const& pixelTable = params.pixelTable;
+         dip::sint runStride = pixelTable.Stride();
+         std::vector< dfloat > const& weights = pixelTable.Weights();
+         // Like in `GeneralConvolutionLineFilter`, the line is processed in blocks, and within a block each weight
+         // is applied to all output pixels before moving on to the next one.
+         constexpr dip::uint blockSize = 256;
+         std::vector< TPI >& buffer = buffers_[ params.thread ];
+         buffer.resize( std::min( length, blockSize ));
+         TPI* acc = buffer.data();
+         for( dip::uint start = 0; start < length; start += blockSize ) {
+            dip::uint n = std::min( blockSize, length - start );
+            std::fill( acc, acc + n, dilation_ ? std::numeric_limits< TPI >::lowest() : std::numeric_limits< TPI >::max() );
+            TPI const* inBlock = in + static_cast< dip::sint >( start ) * inStride;
+            auto itw = weights.begin();
+            for( auto const& run : pixelTable.Runs() ) {
+               TPI const* pin = inBlock + run.offset;
+               for( dip::uint jj = 0; jj < run.length; ++jj, ++itw, pin += runStride ) {
+                  dfloat weight = dilation_ ? *itw : -*itw;
+                  if( inStride == 1 ) {
+                     if( dilation_ ) {
+                        for( dip::uint ii = 0; ii < n; ++ii ) {
+                           acc[ ii ] = std::max( acc[ ii ], clamp_cast< TPI >( static_cast< dfloat >( pin[ ii ] ) + weight ));
+                        }
+                     } else {
+                        for( dip::uint ii = 0; ii < n; ++ii ) {
+                           acc[ ii ] = std::min( acc[ ii ], clamp_cast< TPI >( static_cast< dfloat >( pin[ ii ] ) + weight ));
+                        }
+                     }
+                  } else {
+                     TPI const* pp = pin;
+                     if( dilation_ ) {
+                        for( dip::uint ii = 0; ii < n; ++ii, pp += inStride ) {
+                           acc[ ii ] = std::max( acc[ ii ], clamp_cast< TPI >( static_cast< dfloat >( *pp ) + weight ));
+                        }
+                     } else {
+                        for( dip::uint ii = 0; ii < n; ++ii, pp += inStride ) {
+                           acc[ ii ] = std::min( acc[ ii ], clamp_cast< TPI >( static_cast< dfloat >( *pp ) + weight ));
+                        }
+                     }
+                  }
                }
-               *out = max;
-               in += inStride;
-               out += outStride;
             }
-         } else {
-            for( dip::uint ii = 0; ii < length; ++ii ) {
-               TPI min = std::numeric_limits< TPI >::max();
-               auto ito = offsets_.begin();
-               auto itw = weights.begin();
-               while( ito != offsets_.end() ) {
-                  min = std::min( min, clamp_cast< TPI >( static_cast< dfloat >( in[ *ito ] ) - *itw ));
-                  ++ito;
-                  ++itw;
-               }
-               *out = min;
-               in += inStride;
-               out += outStride;
+            TPI* pout = out + static_cast< dip::sint >( start ) * outStride;
+            for( dip::uint ii = 0; ii < n; ++ii, pout += outStride ) {
+               *pout = acc[ ii ];
             }
          }
       }
    private:
       bool dilation_;
-      std::vector< dip::sint > offsets_;
+      std::vector< std::vector< TPI >> buffers_; // one accumulation buffer per thread
 };
 
 void GeneralSEMorphology(
@@ -877,6 +894,8 @@ void BasicMorphology(
 #include "doctest.h"
 #include "diplib/statistics.h"
 #include "diplib/iterators.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the basic morphological filters") {
    dip::Image in( { 64, 41 }, 1, dip::DT_UINT8 );
@@ -1066,4 +1085,74 @@ DOCTEST_TEST_CASE("[DIPlib] testing the basic morphological filters") {
    DOCTEST_CHECK( out.At( 32, 20 ) == pval );
 }
 
+namespace {
+
+// Brute-force grey-value SE dilation (`sign` = 1) or erosion (`sign` = -1) of a 2D sfloat image, pixels outside
+// the image are ignored. `se` is a 2D sfloat image with odd sizes, its origin in the middle. If `mirror`, the SE
+// is mirrored.
+dip::Image BruteForceGreyValueMorphology( dip::Image const& in, dip::Image const& se, bool mirror, dip::dfloat sign ) {
+   dip::Image out = in.Similar();
+   dip::sint n0 = static_cast< dip::sint >( in.Size( 0 ));
+   dip::sint n1 = static_cast< dip::sint >( in.Size( 1 ));
+   dip::sint k0 = static_cast< dip::sint >( se.Size( 0 ));
+   dip::sint k1 = static_cast< dip::sint >( se.Size( 1 ));
+   for( dip::sint y = 0; y < n1; ++y ) {
+      for( dip::sint x = 0; x < n0; ++x ) {
+         dip::dfloat value = -sign * dip::infinity;
+         for( dip::sint j = 0; j < k1; ++j ) {
+            for( dip::sint i = 0; i < k0; ++i ) {
+               dip::dfloat weight = se.At( static_cast< dip::uint >( i ), static_cast< dip::uint >( j )).As< dip::dfloat >();
+               if( weight == -dip::infinity ) {
+                  continue;
+               }
+               dip::sint di = i - k0 / 2;
+               dip::sint dj = j - k1 / 2;
+               if( mirror ) {
+                  di = -di;
+                  dj = -dj;
+               }
+               dip::sint xx = x + di;
+               dip::sint yy = y + dj;
+               if(( xx < 0 ) || ( xx >= n0 ) || ( yy < 0 ) || ( yy >= n1 )) {
+                  continue;
+               }
+               dip::dfloat v = in.At( static_cast< dip::uint >( xx ), static_cast< dip::uint >( yy )).As< dip::dfloat >() + sign * weight;
+               value = sign > 0 ? std::max( value, v ) : std::min( value, v );
+            }
+         }
+         out.At( static_cast< dip::uint >( x ), static_cast< dip::uint >( y )) = value;
+      }
+   }
+   return out;
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("[DIPlib] testing grey-value SE morphology with an asymmetric SE") {
+   dip::Random random( 0 );
+   dip::Image in( { 30, 25 }, 1, dip::DT_SFLOAT );
+   in.Fill( 0 );
+   dip::UniformNoise( in, in, random, 0.0, 100.0 );
+   // An asymmetric structuring element, with weights that differ within each run along the processing dimension
+   dip::Image seImg( { 7, 5 }, 1, dip::DT_SFLOAT );
+   seImg.Fill( 0 );
+   dip::UniformNoise( seImg, seImg, random, -20.0, 0.0 );
+   seImg.At( 6, 0 ) = -dip::infinity;
+   seImg.At( 5, 0 ) = -dip::infinity;
+   seImg.At( 0, 4 ) = -dip::infinity;
+   seImg.At( 3, 2 ) = -dip::infinity;
+   for( bool mirror : { false, true } ) {
+      dip::StructuringElement se = seImg;
+      if( mirror ) {
+         se.Mirror();
+      }
+      dip::Image out = dip::Dilation( in, se );
+      dip::Image ref = BruteForceGreyValueMorphology( in, seImg, mirror, 1.0 );
+      DOCTEST_CHECK( dip::MaximumAbs( out - ref ).As< dip::dfloat >() < 1e-4 );
+      out = dip::Erosion( in, se );
+      ref = BruteForceGreyValueMorphology( in, seImg, mirror, -1.0 );
+      DOCTEST_CHECK( dip::MaximumAbs( out - ref ).As< dip::dfloat >() < 1e-4 );
+   }
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -18,11 +18,16 @@
  * limitations under the License.
  */
 
+#include <map>
+#include <unordered_map>
+
 #include "diplib/nonlinear.h"
 #include "diplib/framework.h"
 #include "diplib/generation.h"
+#include "diplib/iterators.h"
 #include "diplib/overload.h"
 #include "diplib/pixel_table.h"
+#include "diplib/statistics.h"
 #include "diplib/private/constfor.h"
 
 #if defined(__GNUG__) || defined(__clang__)
@@ -776,6 +781,388 @@ private:
    bool mirrorAtInputBoundaries_;   // Boundary condition: either mirror or zeros
 };
 
+// Exposes the kernel scale for each tensor element at given image coordinates
+class KernelScaleReader : public KernelTransformScale< 2 >
+{
+public:
+   KernelScaleReader( Image const& kernelScale, dip::uint inputTensorElements ) : KernelTransformScale< 2 >( kernelScale, inputTensorElements ) {}
+   void SetImageCoords( UnsignedArray const& imgCoords ) { SetScaleAtImgCoords( imgCoords ); }
+   std::array< dfloat, 2 > const& Scale( dip::uint tensorIndex ) const { return scaleAtImgCoords_[ tensorIndex ]; }
+};
+
+// Quantizes a parameter linearly into `nLevels` levels in the range [`min`,`max`]
+class ParameterQuantizer
+{
+public:
+   ParameterQuantizer() = default;
+   ParameterQuantizer( dfloat min, dfloat max, dip::uint nLevels ) : min_( min ) {
+      if(( max > min ) && ( nLevels > 1 )) {
+         nLevels_ = nLevels;
+         step_ = ( max - min ) / static_cast< dfloat >( nLevels - 1 );
+      }
+   }
+   dip::uint Levels() const { return nLevels_; }
+   dip::uint Level( dfloat value ) const {
+      if( nLevels_ == 1 ) {
+         return 0;
+      }
+      dip::sint level = round_cast(( value - min_ ) / step_ );
+      return static_cast< dip::uint >( clamp( level, dip::sint( 0 ), static_cast< dip::sint >( nLevels_ - 1 )));
+   }
+   dfloat Value( dip::uint level ) const { return min_ + static_cast< dfloat >( level ) * step_; }
+private:
+   dfloat min_ = 0.0;
+   dfloat step_ = 0.0;
+   dip::uint nLevels_ = 1;
+};
+
+// A set of 2D kernels, one for each combination of quantized orientation, scale and curvature. Each kernel is
+// the Gaussian kernel transformed as in `KernelTransform2DScaledBanana`, and splatted onto the integer grid
+// using the interpolation weights. Applying such a kernel yields the same result as transforming the kernel
+// and interpolating the input for each pixel. The combinations of parameters are identified by a key, but only
+// the combinations that are used are stored; these are numbered consecutively, and the kernel index refers to
+// this numbering.
+class AdaptiveKernelCache2D
+{
+public:
+   AdaptiveKernelCache2D(
+         Kernel const& kernel,
+         dip::uint nAngles,
+         dfloat anglePeriod,
+         ParameterQuantizer const& scale,
+         bool hasScale,
+         ParameterQuantizer const& curvature,
+         bool linear
+   ) : nAngles_( nAngles ), angleStep_( anglePeriod / static_cast< dfloat >( nAngles )), scale_( scale ),
+       hasScale_( hasScale ), curvature_( curvature ), linear_( linear ) {
+      nScales_ = hasScale_ ? scale_.Levels() : 1;
+      PixelTable pixelTable = kernel.PixelTable( 2, 0 );
+      for( auto it = pixelTable.begin(); it != pixelTable.end(); ++it ) {
+         gaussCoords_.push_back( {{ static_cast< dfloat >(( *it )[ 0 ] ), static_cast< dfloat >(( *it )[ 1 ] ) }} );
+      }
+      gaussWeights_ = pixelTable.Weights();
+   }
+
+   // Returns the index of the kernel for the given parameters, and marks it as used. In case of linear
+   // interpolation, this is the kernel for the orientation just below `angle`, and `fraction` is the weight
+   // for the next orientation, which is then also marked as used.
+   dip::uint Use( dfloat angle, std::array< dfloat, 2 > const& scale, dfloat curvature, dfloat& fraction ) {
+      dfloat t = angle / angleStep_;
+      dfloat bin = linear_ ? std::floor( t ) : std::round( t );
+      fraction = linear_ ? t - bin : 0.0;
+      dip::sint angleBin = static_cast< dip::sint >( bin ) % static_cast< dip::sint >( nAngles_ );
+      if( angleBin < 0 ) {
+         angleBin += static_cast< dip::sint >( nAngles_ );
+      }
+      dip::uint key = static_cast< dip::uint >( angleBin );
+      key = key * nScales_ + ( hasScale_ ? scale_.Level( scale[ 0 ] ) : 0 );
+      key = key * nScales_ + ( hasScale_ ? scale_.Level( scale[ 1 ] ) : 0 );
+      key = key * curvature_.Levels() + curvature_.Level( curvature );
+      dip::uint index = Insert( key );
+      if(( fraction > 0.0 ) && ( kernels_[ index ].next == noKernel )) {
+         dip::uint next = Insert( NextAngleKey( key ));
+         kernels_[ index ].next = next;
+      }
+      return index;
+   }
+
+   // Returns the index of the kernel with the next orientation, only valid if it was marked as used
+   dip::uint NextAngle( dip::uint index ) const {
+      return kernels_[ index ].next;
+   }
+
+   // Builds the kernels that were marked as used, returns the largest distance of a kernel pixel to the origin
+   dip::uint Build() {
+      dip::uint radius = 0;
+      for( auto& k : kernels_ ) {
+         BuildKernel( k );
+         for( auto const& c : k.coords ) {
+            radius = std::max( radius, static_cast< dip::uint >( std::max( std::abs( c[ 0 ] ), std::abs( c[ 1 ] ))));
+         }
+      }
+      return radius;
+   }
+
+   // Converts kernel coordinates to offsets. `boxOffsets` has the offsets for a square box of size 2*`radius`+1.
+   void SetOffsets( std::vector< dip::sint > const& boxOffsets, dip::sint radius ) {
+      dip::sint size = 2 * radius + 1;
+      for( auto& k : kernels_ ) {
+         k.offsets.resize( k.coords.size() );
+         for( dip::uint ii = 0; ii < k.coords.size(); ++ii ) {
+            k.offsets[ ii ] = boxOffsets[ static_cast< dip::uint >(( k.coords[ ii ][ 1 ] + radius ) * size + k.coords[ ii ][ 0 ] + radius ) ];
+         }
+      }
+   }
+
+   std::vector< dip::sint > const& Offsets( dip::uint index ) const { return kernels_[ index ].offsets; }
+   std::vector< dfloat > const& Weights( dip::uint index ) const { return kernels_[ index ].weights; }
+   bool Linear() const { return linear_; }
+
+   // Average number of pixels in the kernels that were built
+   dip::uint AverageKernelSize() const {
+      dip::uint total = 0;
+      for( auto const& k : kernels_ ) {
+         total += k.weights.size();
+      }
+      return kernels_.empty() ? 0 : total / kernels_.size();
+   }
+
+private:
+   static constexpr dip::uint noKernel = std::numeric_limits< dip::uint >::max();
+
+   struct CachedKernel {
+      dip::uint key;
+      dip::uint next = noKernel; // index of the kernel with the next orientation
+      std::vector< std::array< dip::sint, 2 >> coords;
+      std::vector< dip::sint > offsets;
+      std::vector< dfloat > weights;
+   };
+
+   // Returns the index of the kernel with the given key, adding it if it is not yet used
+   dip::uint Insert( dip::uint key ) {
+      auto res = indices_.emplace( key, kernels_.size() );
+      if( res.second ) {
+         kernels_.emplace_back();
+         kernels_.back().key = key;
+      }
+      return res.first->second;
+   }
+
+   // Returns the key of the kernel with the next orientation
+   dip::uint NextAngleKey( dip::uint key ) const {
+      dip::uint stride = nScales_ * nScales_ * curvature_.Levels();
+      dip::uint angleBin = key / stride;
+      return angleBin + 1 == nAngles_ ? key - angleBin * stride : key + stride;
+   }
+
+   void BuildKernel( CachedKernel& k ) {
+      dip::uint rest = k.key;
+      dip::uint curvatureLevel = rest % curvature_.Levels();
+      rest /= curvature_.Levels();
+      dip::uint scaleLevel1 = rest % nScales_;
+      rest /= nScales_;
+      dip::uint scaleLevel0 = rest % nScales_;
+      dip::uint angleBin = rest / nScales_;
+      dfloat angle = static_cast< dfloat >( angleBin ) * angleStep_;
+      dfloat csn = std::cos( dip::pi * 0.5 - angle );
+      dfloat sn = std::sin( dip::pi * 0.5 - angle );
+      dfloat scale0 = hasScale_ ? scale_.Value( scaleLevel0 ) : 1.0;
+      dfloat scale1 = hasScale_ ? scale_.Value( scaleLevel1 ) : 1.0;
+      dfloat hcurv = -0.5 * curvature_.Value( curvatureLevel );
+      // Splat the transformed kernel onto the integer grid
+      std::map< std::pair< dip::sint, dip::sint >, dfloat > grid;
+      for( dip::uint ii = 0; ii < gaussCoords_.size(); ++ii ) {
+         dfloat kx = scale0 * gaussCoords_[ ii ][ 0 ];
+         dfloat ky = scale1 * gaussCoords_[ ii ][ 1 ] + hcurv * kx * kx;
+         dfloat t0 = SnapToInteger( kx * csn + ky * sn );
+         dfloat t1 = SnapToInteger( -kx * sn + ky * csn );
+         dip::sint x = floor_cast( t0 );
+         dip::sint y = floor_cast( t1 );
+         dfloat w = gaussWeights_[ ii ];
+         if( linear_ ) {
+            dfloat fx = t0 - static_cast< dfloat >( x );
+            dfloat fy = t1 - static_cast< dfloat >( y );
+            grid[ { x, y } ] += w * ( 1 - fx ) * ( 1 - fy );
+            grid[ { x + 1, y } ] += w * fx * ( 1 - fy );
+            grid[ { x, y + 1 } ] += w * ( 1 - fx ) * fy;
+            grid[ { x + 1, y + 1 } ] += w * fx * fy;
+         } else {
+            grid[ { x, y } ] += w;
+         }
+      }
+      for( auto const& g : grid ) {
+         if( g.second != 0.0 ) {
+            k.coords.push_back( {{ g.first.first, g.first.second }} );
+            k.weights.push_back( g.second );
+         }
+      }
+   }
+
+   // In the direct method, the transformed kernel coordinates are added to the image coordinates, which rounds
+   // away tiny deviations from an integer value, that would otherwise change the result of `floor_cast`.
+   static dfloat SnapToInteger( dfloat value ) {
+      dfloat rounded = std::round( value );
+      return std::abs( value - rounded ) < 1e-9 ? rounded : value;
+   }
+
+   dip::uint nAngles_;
+   dfloat angleStep_;
+   ParameterQuantizer scale_;
+   bool hasScale_;
+   dip::uint nScales_;
+   ParameterQuantizer curvature_;
+   bool linear_;
+   std::vector< std::array< dfloat, 2 >> gaussCoords_;
+   std::vector< dfloat > gaussWeights_;
+   std::vector< CachedKernel > kernels_;                 // the kernels that are used
+   std::unordered_map< dip::uint, dip::uint > indices_;  // maps the key of each used kernel to its index
+};
+
+// Applies the kernels in an `AdaptiveKernelCache2D`, `index` and `fraction` select the kernel(s) for each
+// pixel and tensor element. The input buffer has an expanded border of size `radius`.
+template< typename TPI, typename TPO = FlexType< TPI > >
+class AdaptiveCachedConvolutionLineFilter : public Framework::FullLineFilter
+{
+public:
+   AdaptiveCachedConvolutionLineFilter( AdaptiveKernelCache2D& cache, Image const& index, Image const& fraction, Kernel const& box, dip::sint radius )
+         : cache_( cache ), index_( index ), fraction_( fraction ), box_( box ), radius_( radius ) {}
+
+   virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint nTensorElements, dip::uint, dip::uint ) override {
+      dip::uint kernelSize = cache_.AverageKernelSize() * ( cache_.Linear() ? 2 : 1 );
+      return lineLength * nTensorElements * ( 2 * kernelSize + 10 );
+   }
+
+   virtual void SetNumberOfThreads( dip::uint, PixelTableOffsets const& pixelTable ) override {
+      // Find the offset for each pixel in the box, and convert the kernel coordinates to offsets
+      dip::sint size = 2 * radius_ + 1;
+      std::vector< dip::sint > boxOffsets( static_cast< dip::uint >( size * size ));
+      PixelTable boxTable = box_.PixelTable( 2, pixelTable.ProcessingDimension() );
+      auto itCoords = boxTable.begin();
+      for( auto itOffset = pixelTable.begin(); !itOffset.IsAtEnd(); ++itOffset, ++itCoords ) {
+         IntegerArray const& coords = *itCoords;
+         boxOffsets[ static_cast< dip::uint >(( coords[ 1 ] + radius_ ) * size + coords[ 0 ] + radius_ ) ] = *itOffset;
+      }
+      cache_.SetOffsets( boxOffsets, radius_ );
+   }
+
+   virtual void Filter( Framework::FullLineFilterParameters const& params ) override {
+      TPI const* in = static_cast< TPI const* >( params.inBuffer.buffer );
+      dip::sint inStride = params.inBuffer.stride;
+      dip::sint inTensorStride = params.inBuffer.tensorStride;
+      TPO* out = static_cast< TPO* >( params.outBuffer.buffer );
+      dip::sint outStride = params.outBuffer.stride;
+      dip::sint outTensorStride = params.outBuffer.tensorStride;
+      dip::uint nTensor = params.outBuffer.tensorLength;
+      dip::uint length = params.bufferLength;
+      uint32 const* index = static_cast< uint32 const* >( index_.Pointer( params.position ));
+      dip::sint indexStride = index_.Stride( params.dimension );
+      dip::sint indexTensorStride = index_.TensorStride();
+      sfloat const* fraction = static_cast< sfloat const* >( fraction_.Pointer( params.position ));
+      dip::sint fractionStride = fraction_.Stride( params.dimension );
+      dip::sint fractionTensorStride = fraction_.TensorStride();
+      for( dip::uint ii = 0; ii < length; ++ii ) {
+         for( dip::uint iTE = 0; iTE < nTensor; ++iTE ) {
+            TPI const* inPtr = in + static_cast< dip::sint >( iTE ) * inTensorStride;
+            dip::uint kernel = index[ static_cast< dip::sint >( iTE ) * indexTensorStride ];
+            TPO value = Apply( inPtr, kernel );
+            dfloat f = fraction[ static_cast< dip::sint >( iTE ) * fractionTensorStride ];
+            if( f > 0.0 ) {
+               TPO next = Apply( inPtr, cache_.NextAngle( kernel ));
+               value = static_cast< TPO >( value * static_cast< FloatType< TPO >>( 1.0 - f ) + next * static_cast< FloatType< TPO >>( f ));
+            }
+            out[ static_cast< dip::sint >( iTE ) * outTensorStride ] = value;
+         }
+         in += inStride;
+         out += outStride;
+         index += indexStride;
+         fraction += fractionStride;
+      }
+   }
+
+private:
+   TPO Apply( TPI const* in, dip::uint kernel ) const {
+      std::vector< dip::sint > const& offsets = cache_.Offsets( kernel );
+      std::vector< dfloat > const& weights = cache_.Weights( kernel );
+      TPO sum = 0;
+      for( dip::uint jj = 0; jj < offsets.size(); ++jj ) {
+         sum += static_cast< TPO >( in[ offsets[ jj ]] ) * static_cast< FloatType< TPO >>( weights[ jj ] );
+      }
+      return sum;
+   }
+
+   AdaptiveKernelCache2D& cache_;
+   Image const& index_;
+   Image const& fraction_;
+   Kernel const& box_;
+   dip::sint radius_;
+};
+
+// Adaptive filtering of a 2D image using a cache of precomputed kernels, see `AdaptiveKernelCache2D`
+void AdaptiveFilterCached(
+   Image const& in,
+   ImageConstRefArray const& params,
+   Image& out,
+   Kernel const& kernel,
+   bool symmetricKernel,
+   dip::uint nBins,
+   String const& interpolationMethod,
+   BoundaryCondition bc,
+   String const& transform
+) {
+   bool linear;
+   if( interpolationMethod == S::LINEAR ) {
+      linear = true;
+   } else if( interpolationMethod == S::ZERO_ORDER ) {
+      linear = false;
+   } else {
+      DIP_THROW( "Unknown interpolation \"" + interpolationMethod + "\"" );
+   }
+   bool banana = transform == "banana";
+   dip::uint nParams = params.size();
+   DIP_THROW_IF( banana ? ( nParams != 2 && nParams != 3 ) : ( nParams != 1 && nParams != 2 ), E::ARRAY_PARAMETER_WRONG_LENGTH );
+   bool hasScale = nParams == ( banana ? 3u : 2u );
+   dip::uint nTensor = in.TensorElements();
+   // Parameter images as double-precision floats, with expanded sizes and tensor
+   auto prepare = [ & ]( Image const& param, bool expandTensor ) {
+      Image p = param.DataType() == DT_DFLOAT ? param.QuickCopy() : Convert( param, DT_DFLOAT );
+      p.ExpandSingletonDimensions( in.Sizes() );
+      if( expandTensor && ( p.TensorElements() != nTensor )) {
+         p.ExpandSingletonTensor( nTensor );
+      }
+      return p;
+   };
+   Image orientation = prepare( params[ 0 ], true );
+   // Orientation is quantized into `nBins` bins, the other parameters into at most `maxParameterLevels` levels
+   constexpr dip::uint maxParameterLevels = 16;
+   dip::uint nLevels = std::min( nBins, maxParameterLevels );
+   Image curvature;
+   ParameterQuantizer curvatureQuantizer;
+   if( banana ) {
+      curvature = prepare( params[ 1 ], true );
+      MinMaxAccumulator range = MaximumAndMinimum( curvature );
+      curvatureQuantizer = ParameterQuantizer( range.Minimum(), range.Maximum(), nLevels );
+   }
+   std::unique_ptr< KernelScaleReader > scaleReader;
+   ParameterQuantizer scaleQuantizer;
+   if( hasScale ) {
+      Image scale = prepare( params[ nParams - 1 ], false );
+      MinMaxAccumulator range = MaximumAndMinimum( scale );
+      scaleQuantizer = ParameterQuantizer( range.Minimum(), range.Maximum(), nLevels );
+      scaleReader = std::make_unique< KernelScaleReader >( scale, nTensor );
+   }
+   AdaptiveKernelCache2D cache( kernel, nBins, symmetricKernel ? dip::pi : 2.0 * dip::pi, scaleQuantizer, hasScale, curvatureQuantizer, linear );
+
+   // Determine which kernel to use for each pixel
+   Image index( in.Sizes(), nTensor, DT_UINT32 );
+   Image fraction( in.Sizes(), nTensor, DT_SFLOAT );
+   JointImageIterator< uint32, sfloat > it( { index, fraction } );
+   std::array< dfloat, 2 > const noScale{{ 1.0, 1.0 }};
+   do {
+      UnsignedArray const& coords = it.Coordinates();
+      dfloat const* angle = static_cast< dfloat const* >( orientation.Pointer( coords ));
+      dfloat const* curv = banana ? static_cast< dfloat const* >( curvature.Pointer( coords )) : nullptr;
+      if( scaleReader ) {
+         scaleReader->SetImageCoords( coords );
+      }
+      for( dip::uint iTE = 0; iTE < nTensor; ++iTE ) {
+         dfloat f;
+         dip::uint kk = cache.Use( angle[ static_cast< dip::sint >( iTE ) * orientation.TensorStride() ],
+                                   scaleReader ? scaleReader->Scale( iTE ) : noScale,
+                                   curv ? curv[ static_cast< dip::sint >( iTE ) * curvature.TensorStride() ] : 0.0, f );
+         it.template Sample< 0 >( iTE ) = static_cast< uint32 >( kk );
+         it.template Sample< 1 >( iTE ) = static_cast< sfloat >( f );
+      }
+   } while( ++it );
+
+   // Build the kernels, and apply them
+   dip::sint radius = static_cast< dip::sint >( cache.Build());
+   Kernel box( Kernel::ShapeCode::RECTANGULAR, { static_cast< dfloat >( 2 * radius + 1 ) } );
+   DataType outputType = DataType::SuggestFlex( in.DataType() );
+   std::unique_ptr< Framework::FullLineFilter > lineFilter;
+   DIP_OVL_NEW_ALL( lineFilter, AdaptiveCachedConvolutionLineFilter, ( cache, index, fraction, box, radius ), in.DataType() );
+   Framework::Full( in, out, in.DataType(), outputType, outputType, nTensor, { bc }, box, *lineFilter );
+}
+
 } // namespace
 
 
@@ -789,7 +1176,8 @@ void AdaptiveFilter(
    UnsignedArray const& exponents,
    String const& interpolationMethod,
    String const& boundaryCondition,
-   String const& transform
+   String const& transform,
+   dip::uint nBins
 ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    // TODO: all param images must be of type DT_DFLOAT?
@@ -809,6 +1197,17 @@ void AdaptiveFilter(
       Kernel kernel{ CreateGauss( sigmas, orders, truncation, exponents ) };
 
       BoundaryCondition bc = StringToBoundaryCondition( boundaryCondition );
+      if(( nBins > 0 ) && ( in.Dimensionality() == 2 )) {
+         // The kernel is point symmetric if the sum of derivative orders and exponents is even
+         UnsignedArray kernelOrders = orders;
+         UnsignedArray kernelExponents = exponents;
+         ArrayUseParameter( kernelOrders, 2, dip::uint( 0 ));
+         ArrayUseParameter( kernelExponents, 2, dip::uint( 0 ));
+         dip::uint parity = kernelOrders.sum() + kernelExponents.sum();
+         bool symmetricKernel = ( transform == "ellipse" ) && ( parity % 2 == 0 );
+         AdaptiveFilterCached( in, params, out, kernel, symmetricKernel, nBins, interpolationMethod, bc, transform );
+         return;
+      }
       DataType outputType = DataType::SuggestFlex( in.DataType() );
       std::unique_ptr< Framework::FullLineFilter > lineFilter;
       DIP_OVL_NEW_ALL( lineFilter, AdaptiveWindowConvolutionLineFilter, ( in, kernel, paramImages, interpolationMethod, bc, transform ), in.DataType() );
@@ -827,9 +1226,10 @@ void AdaptiveGauss(
    dfloat truncation,
    UnsignedArray const& exponents,
    String const& interpolationMethod,
-   String const& boundaryCondition
+   String const& boundaryCondition,
+   dip::uint nBins
 ) {
-   AdaptiveFilter( in, params, out, sigmas, orders, truncation, exponents, interpolationMethod, boundaryCondition, "ellipse" );
+   AdaptiveFilter( in, params, out, sigmas, orders, truncation, exponents, interpolationMethod, boundaryCondition, "ellipse", nBins );
 }
 
 void AdaptiveBanana(
@@ -841,9 +1241,10 @@ void AdaptiveBanana(
    dfloat truncation,
    UnsignedArray const& exponents,
    String const& interpolationMethod,
-   String const& boundaryCondition
+   String const& boundaryCondition,
+   dip::uint nBins
 ) {
-   AdaptiveFilter( in, params, out, sigmas, orders, truncation, exponents, interpolationMethod, boundaryCondition, "banana" );
+   AdaptiveFilter( in, params, out, sigmas, orders, truncation, exponents, interpolationMethod, boundaryCondition, "banana", nBins );
 }
 
 } // namespace dip
@@ -851,3 +1252,62 @@ void AdaptiveBanana(
 #if defined(__GNUG__) || defined(__clang__)
 #pragma GCC diagnostic pop
 #endif
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/linear.h"
+#include "diplib/random.h"
+#include "diplib/statistics.h"
+
+namespace {
+
+// Maximum absolute difference between `a` and `b`, ignoring `border` pixels at the image edge
+dip::dfloat InteriorDifference( dip::Image const& a, dip::Image const& b, dip::uint border ) {
+   dip::RangeArray window( 2, dip::Range{ static_cast< dip::sint >( border ), -1 - static_cast< dip::sint >( border ) } );
+   return dip::MaximumAbs( a.At( window ) - b.At( window )).As< dip::dfloat >();
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("[DIPlib] testing the kernel cache in dip::AdaptiveGauss and dip::AdaptiveBanana") {
+   dip::Image img{ dip::UnsignedArray{ 64, 60 }, 1, dip::DT_SFLOAT };
+   img.Fill( 50 );
+   dip::Random random( 0 );
+   dip::GaussianNoise( img, img, random, 100.0 );
+   dip::uint border = 12;
+   // With an orientation at a bin center, the precomputed kernels are identical to the transformed kernels. For
+   // zero order interpolation we use an orientation along the axes, otherwise rounding errors in the transformed
+   // coordinates cause kernel pixels to be assigned to a different input pixel.
+   dip::Image curvature{ dip::Image::Sample( 0.08 ) };
+   dip::Image scale{ dip::UnsignedArray{ 1, 1 }, 2, dip::DT_DFLOAT };
+   scale.Fill( 1.0 );
+   scale.At( 0, 0 )[ 1 ] = 0.8;
+   for( auto interpolation : { dip::S::LINEAR, dip::S::ZERO_ORDER } ) {
+      dip::Image angle{ dip::Image::Sample( interpolation == dip::S::LINEAR ? dip::pi / 4.0 : dip::pi / 2.0 ) };
+      dip::Image ref = dip::AdaptiveGauss( img, { angle }, { 3.0, 1.0 }, { 0 }, 2.0, { 0 }, interpolation );
+      dip::Image out = dip::AdaptiveGauss( img, { angle }, { 3.0, 1.0 }, { 0 }, 2.0, { 0 }, interpolation, dip::S::SYMMETRIC_MIRROR, 8 );
+      DOCTEST_CHECK( out.Sizes() == img.Sizes() );
+      DOCTEST_CHECK( InteriorDifference( out, ref, border ) < 1e-3 );
+      ref = dip::AdaptiveGauss( img, { angle, scale }, { 3.0, 1.0 }, { 1, 0 }, 2.0, { 0 }, interpolation );
+      out = dip::AdaptiveGauss( img, { angle, scale }, { 3.0, 1.0 }, { 1, 0 }, 2.0, { 0 }, interpolation, dip::S::SYMMETRIC_MIRROR, 8 );
+      DOCTEST_CHECK( InteriorDifference( out, ref, border ) < 1e-3 );
+      ref = dip::AdaptiveBanana( img, { angle, curvature }, { 3.0, 1.0 }, { 0 }, 2.0, { 0 }, interpolation );
+      out = dip::AdaptiveBanana( img, { angle, curvature }, { 3.0, 1.0 }, { 0 }, 2.0, { 0 }, interpolation, dip::S::SYMMETRIC_MIRROR, 8 );
+      DOCTEST_CHECK( InteriorDifference( out, ref, border ) < 1e-3 );
+   }
+   // With a varying orientation, the quantization error is small
+   dip::Image smooth = dip::Gauss( img, { 2.0 } );
+   dip::Image varying = dip::CreatePhiCoordinate( img.Sizes() );
+   dip::Image ref = dip::AdaptiveGauss( smooth, { varying }, { 3.0, 1.0 } );
+   dip::Image out = dip::AdaptiveGauss( smooth, { varying }, { 3.0, 1.0 }, { 0 }, 2.0, { 0 }, dip::S::LINEAR, dip::S::SYMMETRIC_MIRROR, 32 );
+   DOCTEST_CHECK( InteriorDifference( out, ref, border ) < 0.05 * dip::MaximumAbs( smooth - dip::Mean( smooth )).As< dip::dfloat >() );
+   // A fine angular resolution, with varying curvature and scale, only builds the kernels that are used
+   dip::Image varyingCurvature = dip::CreateXCoordinate( img.Sizes() ) * 0.002;
+   dip::Image varyingScale = dip::CreateYCoordinate( img.Sizes() ) * 0.005 + 1.0;
+   ref = dip::AdaptiveBanana( smooth, { varying, varyingCurvature, varyingScale }, { 3.0, 1.0 } );
+   out = dip::AdaptiveBanana( smooth, { varying, varyingCurvature, varyingScale }, { 3.0, 1.0 }, { 0 }, 2.0, { 0 }, dip::S::LINEAR, dip::S::SYMMETRIC_MIRROR, 180 );
+   DOCTEST_CHECK( InteriorDifference( out, ref, border ) < 0.05 * dip::MaximumAbs( smooth - dip::Mean( smooth )).As< dip::dfloat >() );
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -18,6 +18,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include "diplib.h"
 #include "diplib/nonlinear.h"
 #include "diplib/linear.h"
@@ -27,60 +29,217 @@
 #include "diplib/analysis.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
-#include "diplib/pixel_table.h"
+#include "diplib/multithreading.h"
 
 namespace dip {
 
 namespace {
 
+// Calls `lineFunction( coords, length )` for each image line along dimension 0 within the box [`lo`,`hi`).
 template< typename F >
-class PeronaMalikLineFilter : public Framework::FullLineFilter {
-   public:
-      PeronaMalikLineFilter( F g, dip::uint cost, sfloat lambda ) : g_( std::move( g )), cost_( cost ), lambda_( lambda ) {}
-      virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint, dip::uint, dip::uint ) override {
-         return cost_ * lineLength;
+void ForEachLineInBox( IntegerArray const& lo, IntegerArray const& hi, F const& lineFunction ) {
+   dip::uint nDims = lo.size();
+   if( nDims == 0 ) {
+      return;
+   }
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      if( hi[ ii ] <= lo[ ii ] ) {
+         return;
       }
-      virtual void Filter( Framework::FullLineFilterParameters const& params ) override {
-         sfloat* in = static_cast< sfloat* >( params.inBuffer.buffer );
-         dip::sint inStride = params.inBuffer.stride;
-         sfloat* out = static_cast< sfloat* >( params.outBuffer.buffer );
-         dip::sint outStride = params.outBuffer.stride;
-         dip::uint length = params.bufferLength;
-         dip::uint nDims = params.pixelTable.Dimensionality();
-         std::vector< PixelTableOffsets::PixelRun > pixelTableRuns = params.pixelTable.Runs(); // copy!
-         // The pixel table has `(nDims-1)*2+1` runs of length 1, and 1 run of length 3:
-         DIP_ASSERT( pixelTableRuns.size() == ( nDims - 1 ) * 2 + 1 );
-         for( dip::uint ii = 0; ii < ( nDims - 1 ) * 2 + 1; ++ii ) {
-            if( pixelTableRuns[ ii ].length == 3 ) {
-               //DIP_ASSERT( pixelTableRuns[ ii ].offset == -inStride );
-               pixelTableRuns[ ii ].length = 1; // the run should have a length of 1
-               pixelTableRuns.push_back( { -pixelTableRuns[ ii ].offset, 1 } ); // add another run of length one to the other side
-            //} else {
-               //DIP_ASSERT( pixelTableRuns[ ii ].length == 1 );
+   }
+   dip::uint length = static_cast< dip::uint >( hi[ 0 ] - lo[ 0 ] );
+   IntegerArray coords = lo;
+   dip::uint dd;
+   do {
+      lineFunction( coords, length );
+      for( dd = 1; dd < nDims; ++dd ) {
+         ++coords[ dd ];
+         if( coords[ dd ] < hi[ dd ] ) {
+            break;
+         }
+         coords[ dd ] = lo[ dd ];
+      }
+   } while( dd < nDims );
+}
+
+inline dip::sint OffsetInBox( IntegerArray const& coords, IntegerArray const& origin, IntegerArray const& strides ) {
+   dip::sint offset = 0;
+   for( dip::uint ii = 0; ii < coords.size(); ++ii ) {
+      offset += ( coords[ ii ] - origin[ ii ] ) * strides[ ii ];
+   }
+   return offset;
+}
+
+// Applies `iterations` iterations of an explicit scheme with a small stencil (the pixel and its `2*nDims` direct
+// neighbors) to `in`, writing the result to `out`. `update( ptr, offsets )` returns the new value for the pixel
+// at `ptr`, where `offsets` are the offsets to its neighbors. Pixels outside the image are 0 (as with the
+// boundary condition `"add zeros"`).
+//
+// Instead of streaming the whole image through memory once per iteration, we use temporal blocking: the image is
+// divided into tiles that fit in the cache, and each tile, together with a halo that is as wide as the number of
+// iterations `T` applied at once, is copied into a buffer. After each iteration, one more pixel of the halo is
+// no longer correct, so after `T` iterations only the tile itself is, and it is written to the output. The halo
+// pixels are computed redundantly by neighboring tiles, but the image is read and written only once every `T`
+// iterations. Tiles are independent, so they are processed in parallel.
+template< typename F >
+void BlockedStencilIterations( Image const& in, Image& out, dip::uint iterations, dip::uint cost, F const& update ) {
+   dip::uint nDims = in.Dimensionality();
+   UnsignedArray const& sizes = in.Sizes();
+   IntegerArray imSizes( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      imSizes[ ii ] = static_cast< dip::sint >( sizes[ ii ] );
+   }
+
+   // Number of iterations per block, and tile sizes: each of the two buffers must fit in about 256 kB
+   constexpr dip::uint bufferSize = 1u << 16; // number of pixels
+   dip::uint blockIterations = nDims == 1 ? 16 : nDims == 2 ? 8 : nDims == 3 ? 3 : 1;
+   blockIterations = std::min( blockIterations, iterations );
+   dip::uint border = blockIterations + 1;
+   UnsignedArray tileSizes = sizes;
+   while( true ) {
+      dip::uint n = 1;
+      for( auto sz : tileSizes ) {
+         n *= sz + 2 * border;
+      }
+      if( n <= bufferSize ) {
+         break;
+      }
+      auto largest = std::max_element( tileSizes.begin(), tileSizes.end() );
+      if( *largest == 1 ) {
+         break;
+      }
+      *largest = div_ceil( *largest, dip::uint( 2 ));
+   }
+   UnsignedArray nTiles( nDims );
+   dip::uint totalTiles = 1;
+   dip::uint maxBufferSize = 1;
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      nTiles[ ii ] = div_ceil( sizes[ ii ], tileSizes[ ii ] );
+      totalTiles *= nTiles[ ii ];
+      maxBufferSize *= tileSizes[ ii ] + 2 * border;
+   }
+
+   // Determine the number of threads we'll be using
+   dip::uint nThreads = std::min( GetNumberOfThreads(), totalTiles );
+   if(( nThreads > 1 ) && ( in.NumberOfPixels() * blockIterations * cost < threadingThreshold )) {
+      nThreads = 1;
+   }
+   std::vector< std::vector< sfloat >> buffers( 2 * nThreads, std::vector< sfloat >( maxBufferSize ));
+
+   // We work on two images, and swap them after each block of iterations
+   Image current;
+   current.ReForge( sizes, 1, DT_SFLOAT );
+   current.Copy( in );
+   Image next;
+   next.ReForge( sizes, 1, DT_SFLOAT );
+   IntegerArray const& imStrides = current.Strides();
+   DIP_ASSERT( next.Strides() == imStrides );
+
+   for( dip::uint iter = 0; iter < iterations; iter += blockIterations ) {
+      dip::sint nIter = static_cast< dip::sint >( std::min( blockIterations, iterations - iter ));
+      sfloat const* src = static_cast< sfloat const* >( current.Origin() );
+      sfloat* dest = static_cast< sfloat* >( next.Origin() );
+      #pragma omp parallel for num_threads( static_cast< int >( nThreads )) schedule( dynamic )
+      for( dip::sint tile = 0; tile < static_cast< dip::sint >( totalTiles ); ++tile ) {
+         dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+         sfloat* buf1 = buffers[ 2 * thread ].data();
+         sfloat* buf2 = buffers[ 2 * thread + 1 ].data();
+         // Find the tile's box in the image, and the box of the buffer, which includes the halo and one extra pixel
+         IntegerArray tileLo( nDims, 0 );
+         IntegerArray tileHi( nDims, 0 );
+         IntegerArray bufLo( nDims, 0 );
+         IntegerArray bufStrides( nDims, 0 );
+         dip::uint index = static_cast< dip::uint >( tile );
+         dip::sint stride = 1;
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            tileLo[ ii ] = static_cast< dip::sint >(( index % nTiles[ ii ] ) * tileSizes[ ii ] );
+            index /= nTiles[ ii ];
+            tileHi[ ii ] = std::min( tileLo[ ii ] + static_cast< dip::sint >( tileSizes[ ii ] ), imSizes[ ii ] );
+            bufLo[ ii ] = tileLo[ ii ] - nIter - 1;
+            bufStrides[ ii ] = stride;
+            stride *= tileHi[ ii ] - tileLo[ ii ] + 2 * ( nIter + 1 );
+         }
+         IntegerArray neighbors( 2 * nDims );
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            neighbors[ 2 * ii ] = -bufStrides[ ii ];
+            neighbors[ 2 * ii + 1 ] = bufStrides[ ii ];
+         }
+         // Pixels outside the image must be 0 in both buffers
+         std::fill( buf1, buf1 + stride, 0.0f );
+         std::fill( buf2, buf2 + stride, 0.0f );
+         // Copy the tile and its halo into the buffer
+         IntegerArray lo( nDims, 0 );
+         IntegerArray hi( nDims, 0 );
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            lo[ ii ] = std::max( tileLo[ ii ] - nIter, dip::sint( 0 ));
+            hi[ ii ] = std::min( tileHi[ ii ] + nIter, imSizes[ ii ] );
+         }
+         ForEachLineInBox( lo, hi, [ & ]( IntegerArray const& coords, dip::uint length ) {
+            sfloat const* pin = src + OffsetInBox( coords, IntegerArray( nDims, 0 ), imStrides );
+            sfloat* pbuf = buf1 + OffsetInBox( coords, bufLo, bufStrides );
+            for( dip::uint ii = 0; ii < length; ++ii, pin += imStrides[ 0 ] ) {
+               pbuf[ ii ] = *pin;
             }
+         } );
+         // Iterate, the region that is computed shrinks by one pixel each time
+         for( dip::sint kk = nIter - 1; kk >= 0; --kk ) {
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               lo[ ii ] = std::max( tileLo[ ii ] - kk, dip::sint( 0 ));
+               hi[ ii ] = std::min( tileHi[ ii ] + kk, imSizes[ ii ] );
+            }
+            ForEachLineInBox( lo, hi, [ & ]( IntegerArray const& coords, dip::uint length ) {
+               dip::sint offset = OffsetInBox( coords, bufLo, bufStrides );
+               sfloat const* pin = buf1 + offset;
+               sfloat* pout = buf2 + offset;
+               for( dip::uint ii = 0; ii < length; ++ii ) {
+                  pout[ ii ] = update( pin + ii, neighbors );
+               }
+            } );
+            std::swap( buf1, buf2 );
          }
-         //DIP_ASSERT( pixelTableRuns.size() == nDims * 2 );
-         // Now the pixel table has `2*nDims` runs, one for each neighbor. The `offset` is the address of the neighbor.
-         for( dip::uint ii = 0; ii < length; ++ii ) {
-            sfloat delta = 0;
-            for( auto run : pixelTableRuns ) {
-               sfloat diff = in[ run.offset ] - in[ 0 ];
-               delta += g_( diff ) * diff;
+         // Write the tile to the output
+         ForEachLineInBox( tileLo, tileHi, [ & ]( IntegerArray const& coords, dip::uint length ) {
+            sfloat const* pbuf = buf1 + OffsetInBox( coords, bufLo, bufStrides );
+            sfloat* pout = dest + OffsetInBox( coords, IntegerArray( nDims, 0 ), imStrides );
+            for( dip::uint ii = 0; ii < length; ++ii, pout += imStrides[ 0 ] ) {
+               *pout = pbuf[ ii ];
             }
-            *out = *in + lambda_ * delta;
-            in += inStride;
-            out += outStride;
+         } );
+      }
+      std::swap( current, next );
+   }
+
+   PixelSize pixelSize = in.PixelSize();
+   if( out.IsProtected() ) {
+      out.ReForge( current, Option::AcceptDataTypeChange::DO_ALLOW );
+      out.Copy( current );
+   } else {
+      out = std::move( current );
+   }
+   out.SetPixelSize( pixelSize );
+}
+
+// The Perona-Malik update for a single pixel: `v + lambda * sum( g( diff ) * diff )`
+template< typename F >
+class PeronaMalikUpdate {
+   public:
+      PeronaMalikUpdate( F g, sfloat lambda ) : g_( std::move( g )), lambda_( lambda ) {}
+      sfloat operator()( sfloat const* in, IntegerArray const& neighbors ) const {
+         sfloat delta = 0;
+         for( auto offset : neighbors ) {
+            sfloat diff = in[ offset ] - in[ 0 ];
+            delta += g_( diff ) * diff;
          }
+         return in[ 0 ] + lambda_ * delta;
       }
    private:
       F g_;
-      dip::uint cost_;
       sfloat lambda_;
 };
 
 template< typename F >
-inline std::unique_ptr< Framework::FullLineFilter > NewPeronaMalikLineFilter( F g, dip::uint cost, sfloat lambda ) {
-   return static_cast< std::unique_ptr< Framework::FullLineFilter >>( new PeronaMalikLineFilter< F >( std::move( g ), cost, lambda ));
+void PeronaMalikIterations( Image const& in, Image& out, dip::uint iterations, dip::uint cost, sfloat lambda, F g ) {
+   BlockedStencilIterations( in, out, iterations, cost * 2 * in.Dimensionality(), PeronaMalikUpdate< F >( std::move( g ), lambda ));
 }
 
 } // namespace
@@ -96,39 +255,31 @@ void PeronaMalikDiffusion(
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
    DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( in.Dimensionality() < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
    DIP_THROW_IF( iterations < 1, E::PARAMETER_OUT_OF_RANGE );
    DIP_THROW_IF( K <= 0.0, E::PARAMETER_OUT_OF_RANGE );
    DIP_THROW_IF(( lambda <= 0.0 ) || ( lambda > 1.0 ), E::PARAMETER_OUT_OF_RANGE );
 
-   // Create a line filter for the scan framework that applies `g`.
-   std::unique_ptr< Framework::FullLineFilter > lineFilter;
+   // Iterate with the selected `g`.
    sfloat fK = static_cast< sfloat >( K );
-   if( g == "Gauss" ) {
-      lineFilter = NewPeronaMalikLineFilter(
-            [ fK ]( sfloat v ) { v /= fK; return std::exp( -v * v ); },
-            20, static_cast< sfloat >( lambda ));
-   } else if( g == "quadratic") {
-      lineFilter = NewPeronaMalikLineFilter(
-            [ fK ]( sfloat v ) { v /= fK; return 1.0f / ( 1.0f + ( v * v )); },
-            4, static_cast< sfloat >( lambda ));
-   } else if( g == "exponential") {
-      lineFilter = NewPeronaMalikLineFilter(
-            [ fK ]( sfloat v ) { v /= fK; return std::exp( -std::abs( v )); },
-            20, static_cast< sfloat >( lambda ));
-   } else if( g == "Tukey") {
-      lineFilter = NewPeronaMalikLineFilter(
-            [ fK ]( sfloat v ) { v /= fK; return std::abs( v ) < 1.0f ? ( 1 - ( v * v )) * ( 1 - ( v * v )) : 0.0f; },
-            6, static_cast< sfloat >( lambda ));
-   } else {
-      DIP_THROW_INVALID_FLAG( g );
-   }
-
-   // Each iteration is applied to `out`.
-   BoundaryConditionArray bc( in.Dimensionality(), BoundaryCondition::ADD_ZEROS );
-   Kernel kernel( Kernel::ShapeCode::DIAMOND, { 3 } );
-   for( dip::uint ii = 0; ii < iterations; ++ii ) {
-      Framework::Full( ii == 0 ? in : out, out, DT_SFLOAT, DT_SFLOAT, DT_SFLOAT, 1, bc, kernel, *lineFilter, Framework::FullOption::AsScalarImage );
-   }
+   sfloat fL = static_cast< sfloat >( lambda );
+   DIP_START_STACK_TRACE
+      if( g == "Gauss" ) {
+         PeronaMalikIterations( in, out, iterations, 20, fL,
+               [ fK ]( sfloat v ) { v /= fK; return std::exp( -v * v ); } );
+      } else if( g == "quadratic") {
+         PeronaMalikIterations( in, out, iterations, 4, fL,
+               [ fK ]( sfloat v ) { v /= fK; return 1.0f / ( 1.0f + ( v * v )); } );
+      } else if( g == "exponential") {
+         PeronaMalikIterations( in, out, iterations, 20, fL,
+               [ fK ]( sfloat v ) { v /= fK; return std::exp( -std::abs( v )); } );
+      } else if( g == "Tukey") {
+         PeronaMalikIterations( in, out, iterations, 6, fL,
+               [ fK ]( sfloat v ) { v /= fK; return std::abs( v ) < 1.0f ? ( 1 - ( v * v )) * ( 1 - ( v * v )) : 0.0f; } );
+      } else {
+         DIP_THROW_INVALID_FLAG( g );
+      }
+   DIP_END_STACK_TRACE
 }
 
 namespace {
@@ -223,15 +374,157 @@ void GaussianAnisotropicDiffusion(
 }
 
 namespace {
-   inline void EigenComposition(
-      Image const& eigenvalues,
-      Image const& eigenvectors,
-      Image& out
-   ) {
-      Multiply( eigenvectors, eigenvalues, out, eigenvalues.DataType() );
-      Multiply( out, Transpose( eigenvectors ), out, out.DataType() );
-   }
-}
+
+// Computes the diffusion tensor `D` from the structure tensor `S`, and multiplies it with the gradient (`"variable"`
+// mode, the output is the flux vector) or with the Hessian (`"const"` mode, the output is the update). `D` itself
+// is never stored.
+class CoherenceEnhancingDiffusionLineFilter : public Framework::ScanLineFilter {
+   public:
+      CoherenceEnhancingDiffusionLineFilter( dip::uint nDims, bool first, bool variable, dfloat c ) :
+            nDims_( nDims ), first_( first ), variable_( variable ), c_( c ) {}
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override {
+         return 50 * nDims_ * nDims_ * nDims_; // dominated by the eigen decomposition
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         dfloat const* S = static_cast< dfloat const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint sStride = params.inBuffer[ 0 ].stride;
+         dip::sint sTStride = params.inBuffer[ 0 ].tensorStride;
+         dfloat const* derivatives = static_cast< dfloat const* >( params.inBuffer[ 1 ].buffer );
+         dip::sint dStride = params.inBuffer[ 1 ].stride;
+         dip::sint dTStride = params.inBuffer[ 1 ].tensorStride;
+         dfloat* out = static_cast< dfloat* >( params.outBuffer[ 0 ].buffer );
+         dip::sint oStride = params.outBuffer[ 0 ].stride;
+         dip::sint oTStride = params.outBuffer[ 0 ].tensorStride;
+         dip::uint n = nDims_;
+         std::vector< dfloat > mu( n );
+         std::vector< dfloat > vectors( n * n );
+         std::vector< dfloat > d( n );
+         std::vector< dfloat > D( n * n );
+         for( dip::uint ii = 0; ii < params.bufferLength; ++ii ) {
+            ConstSampleIterator< dfloat > Sit( S, sTStride );
+            switch( n ) {
+               case 2: SymmetricEigenDecomposition2( Sit, mu.data(), vectors.data() ); break;
+               case 3: SymmetricEigenDecomposition3( Sit, mu.data(), vectors.data() ); break;
+               default: SymmetricEigenDecompositionPacked( n, Sit, mu.data(), vectors.data() ); break;
+            }
+            Diffusivities( mu, d );
+            // D = V diag(d) V^T
+            for( dip::uint jj = 0; jj < n; ++jj ) {
+               for( dip::uint kk = jj; kk < n; ++kk ) {
+                  dfloat sum = 0;
+                  for( dip::uint ll = 0; ll < n; ++ll ) {
+                     sum += d[ ll ] * vectors[ ll * n + jj ] * vectors[ ll * n + kk ];
+                  }
+                  D[ jj * n + kk ] = D[ kk * n + jj ] = sum;
+               }
+            }
+            if( variable_ ) {
+               // flux = D * gradient
+               for( dip::uint jj = 0; jj < n; ++jj ) {
+                  dfloat sum = 0;
+                  for( dip::uint kk = 0; kk < n; ++kk ) {
+                     sum += D[ jj * n + kk ] * derivatives[ static_cast< dip::sint >( kk ) * dTStride ];
+                  }
+                  out[ static_cast< dip::sint >( jj ) * oTStride ] = sum;
+               }
+            } else {
+               // update = sum( D .* H ), with H stored as a symmetric tensor: first the diagonal, then the upper
+               // triangle column-wise
+               dfloat sum = 0;
+               dip::sint index = 0;
+               for( dip::uint jj = 0; jj < n; ++jj, ++index ) {
+                  sum += D[ jj * n + jj ] * derivatives[ index * dTStride ];
+               }
+               for( dip::uint kk = 1; kk < n; ++kk ) {
+                  for( dip::uint jj = 0; jj < kk; ++jj, ++index ) {
+                     sum += 2 * D[ jj * n + kk ] * derivatives[ index * dTStride ];
+                  }
+               }
+               *out = sum;
+            }
+            S += sStride;
+            derivatives += dStride;
+            out += oStride;
+         }
+      }
+   private:
+      dip::uint nDims_;
+      bool first_;
+      bool variable_;
+      dfloat c_;
+
+      // Computes the eigenvalues `d` of the diffusion tensor from the eigenvalues `mu` of the structure tensor,
+      // which are sorted largest to smallest.
+      void Diffusivities( std::vector< dfloat > const& mu, std::vector< dfloat >& d ) const {
+         dip::uint n = mu.size();
+         if( first_ ) {
+            constexpr dfloat alpha = 0.01;
+            d[ 0 ] = alpha;
+            for( dip::uint ii = 1; ii < n; ++ii ) {
+               dfloat diff = mu[ 0 ] - mu[ ii ];
+               dfloat sum = mu[ 0 ] + mu[ ii ];
+               dfloat anisotropy = sum == 0 ? 0 : diff / sum;
+               d[ ii ] = anisotropy > alpha ? alpha + ( 1.0 - alpha ) * std::exp( -c_ / ( diff * diff )) : alpha;
+            }
+         } else {
+            // d = mu^-1 / trace( mu^-1 ). If some of the `mu` are zero, this tends to 1 for those, and 0 for others.
+            dip::uint nZeros = 0;
+            for( auto m : mu ) {
+               if( m <= 0 ) {
+                  ++nZeros;
+               }
+            }
+            if( nZeros > 0 ) {
+               for( dip::uint ii = 0; ii < n; ++ii ) {
+                  d[ ii ] = mu[ ii ] <= 0 ? 1.0 / static_cast< dfloat >( nZeros ) : 0.0;
+               }
+            } else {
+               dfloat trace = 0;
+               for( dip::uint ii = 0; ii < n; ++ii ) {
+                  d[ ii ] = 1.0 / mu[ ii ];
+                  trace += d[ ii ];
+               }
+               for( auto& v : d ) {
+                  v /= trace;
+               }
+            }
+         }
+      }
+};
+
+// Computes the smallest eigenvalue of the structure tensor `S`, needed in "first" mode before the diffusion tensor
+// can be computed. The eigenvectors are not computed.
+class SmallestEigenvalueLineFilter : public Framework::ScanLineFilter {
+   public:
+      SmallestEigenvalueLineFilter( dip::uint nDims ) : nDims_( nDims ) {}
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override {
+         return 20 * nDims_ * nDims_;
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         dfloat const* S = static_cast< dfloat const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint sStride = params.inBuffer[ 0 ].stride;
+         dip::sint sTStride = params.inBuffer[ 0 ].tensorStride;
+         dfloat* out = static_cast< dfloat* >( params.outBuffer[ 0 ].buffer );
+         dip::sint oStride = params.outBuffer[ 0 ].stride;
+         dip::uint n = nDims_;
+         std::vector< dfloat > mu( n );
+         for( dip::uint ii = 0; ii < params.bufferLength; ++ii ) {
+            ConstSampleIterator< dfloat > Sit( S, sTStride );
+            switch( n ) {
+               case 2: SymmetricEigenDecomposition2( Sit, mu.data() ); break;
+               case 3: SymmetricEigenDecomposition3( Sit, mu.data() ); break;
+               default: SymmetricEigenDecompositionPacked( n, Sit, mu.data() ); break;
+            }
+            *out = mu[ n - 1 ];
+            S += sStride;
+            out += oStride;
+         }
+      }
+   private:
+      dip::uint nDims_;
+};
+
+} // namespace
 
 void CoherenceEnhancingDiffusion(
       Image const& in,
@@ -266,9 +559,6 @@ void CoherenceEnhancingDiffusion(
          DIP_THROW_INVALID_FLAG( flag );
       }
    }
-   if( nDims > 2 ) {
-      first = false; // we cannot do this yet.
-   }
 
    // Resample the input image, and copy to `out`
    if( !out.IsProtected() ) {
@@ -280,72 +570,34 @@ void CoherenceEnhancingDiffusion(
    derivativeSigma *= 2;
    regularizationSigma *= 2;
 
-   Image S;            // structure tensor, 2x2 symmetric matrix
-   Image D;            // diffusion tensor, 2x2 matrix (symmetric, but the way we construct it it's stored as a full matrix)
-   Image eigenvalues;  // 2x2 diagonal matrix
-   Image eigenvectors; // 2x2 matrix
-   Image diff;         // scalar
-   Image anisotropy;   // scalar
-   Image mask;         // scalar
-   Image gradient;     // 2-vector
-   Image hessian;      // 2x2 symmetric matrix
+   // These images are forged in the first iteration, and reused in subsequent ones
+   Image S;            // structure tensor, symmetric matrix
+   Image smallest;     // smallest eigenvalue of `S`, only used in "first" mode
+   Image derivatives;  // gradient (vector) in "variable" mode, Hessian (symmetric matrix) in "const" mode
+   Image flux;         // vector, only used in "variable" mode
    Image delta;        // scalar
+   DataType dataType = out.DataType();
    for( dip::uint ii = 0; ii < iterations; ++ii ) {
-
       StructureTensor( out, {}, S, { derivativeSigma }, { regularizationSigma }, "gaussFIR" );
-      EigenDecomposition( S, eigenvalues, eigenvectors );
+      dfloat c = 0;
       if( first ) {
-         // Parameters
-         constexpr dfloat alpha = 0.01;
-         dfloat c_par = Percentile( eigenvalues[ 1 ], {}, 50.0 ).As< dfloat >();
-         c_par *= c_par; // 50th percentile of square of 2nd eigenvalue.
-         // TODO: stuff below here can be a `D = NewDyadicScanLineFilter( eigenvalues, eigenvectors )`
-         // Anisotropy = ( mu_1 - mu_2 ) / ( mu_1 + mu_2 )
-         Subtract( eigenvalues[ 0 ], eigenvalues[ 1 ], diff, eigenvalues.DataType() );
-         SafeDivide( diff, eigenvalues[ 0 ] + eigenvalues[ 1 ], anisotropy, eigenvalues.DataType() );
-         // l_2 = ( conf > 0.01 ) * ( alpha + ( 1.0 - alpha ) * exp( -c_par / ( mu_1 - mu_2 ) ^ ( 2 * m_par ))) + ~( conf > 0.01 ) * ( alpha );
-         Greater( anisotropy, alpha, mask );
-         Image tmp = diff.At( mask );
-         tmp *= tmp;
-         Divide( -c_par, tmp, tmp, tmp.DataType() );
-         Exp( tmp, tmp );
-         tmp *= 1.0 - alpha;
-         tmp += alpha;
-         eigenvalues.Fill( alpha );
-         eigenvalues.At( mask )[ 1 ] = tmp;
-         EigenComposition( eigenvalues, eigenvectors, D );
-      } else { // all
-         // This is not exactly the same as the code in DIPimage 2. That was specifically 2D. It does:
-         //  - normalize D by its trace
-         //  - swap D[0] and D[1] (the two diagonal elements)
-         //  - negate D[2] (the two off-diagonal elements)
-         // The last two steps is equivalent to swapping the two eigenvalues. Here, instead, we compute the
-         // reciprocal of each eigenvalue, then normalize the trace one to 1 (that is, we divide by the trace).
-         // Swapping eigenvectors does not generalize to higher dimensionalities.
-         // TODO: All of this can be a `D = NewMonadicScanLineFilter( D )`
-         Divide( 1, eigenvalues, eigenvalues, eigenvalues.DataType() );
-         Divide( eigenvalues, Trace( eigenvalues ), eigenvalues, eigenvalues.DataType() );
-         EigenComposition( eigenvalues, eigenvectors, D );
-         //
-         //DataType dt = D.DataType();
-         //dip::uint nTElem = D.TensorElements(); // == ((nDims+1)*nDims)/2
-         //std::unique_ptr< dip::Framework::ScanLineFilter > scanLineFilter;
-         //DIP_OVL_CALL_ASSIGN_FLOAT( scanLineFilter, Framework::NewMonadicScanLineFilter, (
-         //   [ nDims, nTElem ]( auto its ) {
-         //
-         //   }, 1 ), dt );
-         //dip::Framework::ScanMonadic( D, D, dt, dt, nTElem, *scanLineFilter );
+         // 50th percentile of square of smallest eigenvalue.
+         SmallestEigenvalueLineFilter eigenvalueFilter( nDims );
+         ImageRefArray outar{ smallest };
+         Framework::Scan( { S }, outar, { DT_DFLOAT }, { DT_DFLOAT }, { DT_DFLOAT }, { 1 }, eigenvalueFilter );
+         c = Percentile( smallest, {}, 50.0 ).As< dfloat >();
+         c *= c;
       }
-
+      CoherenceEnhancingDiffusionLineFilter lineFilter( nDims, first, variable, c );
       if( variable ) {
-         Gradient( out, gradient, { 1 }, "gaussFIR" );
-         Multiply( D, gradient, gradient, gradient.DataType() );
-         Divergence( gradient, delta, { 1 }, "gaussFIR" );
-      } else { // const
-         Hessian( out, hessian, { 1 }, "gaussFIR" );
-         MultiplySampleWise( D, hessian, D, D.DataType() );
-         DIP_ASSERT( D.TensorElements() == nDims * nDims ); // make sure D is a full matrix
-         SumTensorElements( D, delta );
+         Gradient( out, derivatives, { 1 }, "gaussFIR" );
+         ImageRefArray outar{ flux };
+         Framework::Scan( { S, derivatives }, outar, { DT_DFLOAT, DT_DFLOAT }, { DT_DFLOAT }, { dataType }, { nDims }, lineFilter );
+         Divergence( flux, delta, { 1 }, "gaussFIR" );
+      } else {
+         Hessian( out, derivatives, { 1 }, "gaussFIR" );
+         ImageRefArray outar{ delta };
+         Framework::Scan( { S, derivatives }, outar, { DT_DFLOAT, DT_DFLOAT }, { DT_DFLOAT }, { dataType }, { 1 }, lineFilter );
       }
       out += delta;
    }
@@ -358,3 +610,150 @@ void CoherenceEnhancingDiffusion(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/iterators.h"
+
+namespace {
+
+// Straight-forward implementation of the Perona-Malik diffusion with the Gauss function
+dip::Image PeronaMalikReference( dip::Image const& in, dip::uint iterations, dip::sfloat K, dip::sfloat lambda ) {
+   dip::Image current = dip::Convert( in, dip::DT_SFLOAT );
+   for( dip::uint iter = 0; iter < iterations; ++iter ) {
+      dip::Image next( current.Sizes(), 1, dip::DT_SFLOAT );
+      dip::ImageIterator< dip::sfloat > it( next );
+      do {
+         dip::UnsignedArray const& coords = it.Coordinates();
+         dip::sfloat const* ptr = static_cast< dip::sfloat const* >( current.Pointer( coords ));
+         dip::sfloat delta = 0;
+         for( dip::uint ii = 0; ii < coords.size(); ++ii ) {
+            dip::sfloat below = coords[ ii ] > 0 ? *( ptr - current.Stride( ii )) : 0.0f;
+            dip::sfloat above = coords[ ii ] + 1 < current.Size( ii ) ? *( ptr + current.Stride( ii )) : 0.0f;
+            for( dip::sfloat neighbor : { below, above } ) {
+               dip::sfloat diff = neighbor - *ptr;
+               dip::sfloat v = diff / K;
+               delta += std::exp( -v * v ) * diff;
+            }
+         }
+         *it = *ptr + lambda * delta;
+      } while( ++it );
+      current = next;
+   }
+   return current;
+}
+
+// Coherence enhancing diffusion as it was computed before the diffusion tensor computation was fused into a
+// single line filter: eigen decomposition of the structure tensor into images, computation of the diffusion tensor
+// image, and separate multiplication with the gradient or Hessian. For 2D images only.
+dip::Image CoherenceEnhancingDiffusionReference(
+      dip::Image const& in,
+      dip::dfloat derivativeSigma,
+      dip::dfloat regularizationSigma,
+      dip::uint iterations,
+      bool first,
+      bool variable
+) {
+   dip::Image out = dip::Resampling( in, { 2.0 }, { 0.0 }, "linear" );
+   derivativeSigma *= 2;
+   regularizationSigma *= 2;
+   dip::Image S, D, eigenvalues, eigenvectors, gradient, hessian, delta;
+   for( dip::uint ii = 0; ii < iterations; ++ii ) {
+      dip::StructureTensor( out, {}, S, { derivativeSigma }, { regularizationSigma }, "gaussFIR" );
+      dip::EigenDecomposition( S, eigenvalues, eigenvectors );
+      if( first ) {
+         constexpr dip::dfloat alpha = 0.01;
+         dip::dfloat c = dip::Percentile( eigenvalues[ 1 ], {}, 50.0 ).As< dip::dfloat >();
+         c *= c;
+         dip::Image diff = eigenvalues[ 0 ] - eigenvalues[ 1 ];
+         dip::Image anisotropy;
+         dip::SafeDivide( diff, eigenvalues[ 0 ] + eigenvalues[ 1 ], anisotropy, diff.DataType() );
+         dip::Image mask = anisotropy > alpha;
+         dip::Image tmp = diff.At( mask );
+         tmp *= tmp;
+         dip::Divide( -c, tmp, tmp, tmp.DataType() );
+         dip::Exp( tmp, tmp );
+         tmp *= 1.0 - alpha;
+         tmp += alpha;
+         eigenvalues.Fill( alpha );
+         eigenvalues.At( mask )[ 1 ] = tmp;
+      } else {
+         dip::Divide( 1, eigenvalues, eigenvalues, eigenvalues.DataType() );
+         dip::Divide( eigenvalues, dip::Trace( eigenvalues ), eigenvalues, eigenvalues.DataType() );
+      }
+      dip::Multiply( eigenvectors, eigenvalues, D, eigenvalues.DataType() );
+      dip::Multiply( D, dip::Transpose( eigenvectors ), D, D.DataType() );
+      if( variable ) {
+         dip::Gradient( out, gradient, { 1 }, "gaussFIR" );
+         dip::Multiply( D, gradient, gradient, gradient.DataType() );
+         dip::Divergence( gradient, delta, { 1 }, "gaussFIR" );
+      } else {
+         dip::Hessian( out, hessian, { 1 }, "gaussFIR" );
+         dip::MultiplySampleWise( D, hessian, D, D.DataType() );
+         dip::SumTensorElements( D, delta );
+      }
+      out += delta;
+   }
+   return dip::Subsampling( out, { 2 } );
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::PeronaMalikDiffusion") {
+   dip::Random random( 0 );
+   // 2D image large enough to be split into several tiles, and a number of iterations that is not a multiple
+   // of the number of iterations per block
+   dip::Image img( { 300, 260 }, 1, dip::DT_SFLOAT );
+   img.Fill( 100.0 );
+   dip::GaussianNoise( img, img, random, 400.0 );
+   dip::Image out = dip::PeronaMalikDiffusion( img, 20, 10.0, 0.25, "Gauss" );
+   dip::Image ref = PeronaMalikReference( img, 20, 10.0f, 0.25f );
+   DOCTEST_CHECK( out.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( out.Sizes() == img.Sizes() );
+   DOCTEST_CHECK( dip::MaximumAbs( out - ref ).As< dip::dfloat >() < 1e-3 );
+   // 3D image, in-place
+   img = dip::Image( { 45, 40, 38 }, 1, dip::DT_UINT8 );
+   img.Fill( 100 );
+   dip::GaussianNoise( img, img, random, 400.0 );
+   ref = PeronaMalikReference( img, 7, 10.0f, 0.15f );
+   dip::PeronaMalikDiffusion( img, img, 7, 10.0, 0.15, "Gauss" );
+   DOCTEST_CHECK( img.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( dip::MaximumAbs( img - ref ).As< dip::dfloat >() < 1e-3 );
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::CoherenceEnhancingDiffusion") {
+   dip::Random random( 0 );
+   // 3D image with a flat region, which yields zero eigenvalues in the structure tensor
+   dip::Image img( { 40, 18, 16 }, 1, dip::DT_SFLOAT );
+   img.Fill( 100.0 );
+   dip::Image noisy = img.At( dip::RangeArray{ dip::Range{ 0, 9 }, dip::Range{}, dip::Range{} } );
+   dip::GaussianNoise( noisy, noisy, random, 100.0 );
+   for( auto const& flags : { dip::StringSet{}, dip::StringSet{ "const" }, dip::StringSet{ "all" }, dip::StringSet{ "all", "const" }} ) {
+      dip::Image out = dip::CoherenceEnhancingDiffusion( img, 1, 3, 2, flags );
+      DOCTEST_CHECK( out.Sizes() == img.Sizes() );
+      DOCTEST_CHECK( std::isfinite( dip::Sum( out ).As< dip::dfloat >() ));
+      // The flat region remains flat
+      dip::Image flat = out.At( dip::RangeArray{ dip::Range{ 30, -1 }, dip::Range{}, dip::Range{} } );
+      DOCTEST_CHECK( dip::MaximumAbs( flat - 100.0 ).As< dip::dfloat >() < 1e-3 );
+   }
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::CoherenceEnhancingDiffusion against the unfused computation") {
+   dip::Random random( 0 );
+   // 2D image with an oriented texture, so that the structure tensor has no zero eigenvalues
+   dip::Image img = dip::CreateXCoordinate( { 64, 48 }, { "corner" } ) * 0.4 + dip::CreateYCoordinate( { 64, 48 }, { "corner" } ) * 0.2;
+   img = dip::Sin( img ) * 50.0 + 100.0;
+   dip::GaussianNoise( img, img, random, 25.0 );
+   for( bool first : { true, false } ) {
+      for( bool variable : { true, false } ) {
+         dip::StringSet flags{ first ? "first" : "all", variable ? "variable" : "const" };
+         dip::Image out = dip::CoherenceEnhancingDiffusion( img, 1, 3, 3, flags );
+         dip::Image ref = CoherenceEnhancingDiffusionReference( img, 1, 3, 3, first, variable );
+         DOCTEST_CHECK( out.Sizes() == ref.Sizes() );
+         DOCTEST_CHECK( dip::MaximumAbs( out - ref ).As< dip::dfloat >() < 1e-3 );
+      }
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -18,8 +18,14 @@
  * limitations under the License.
  */
 
+#include <cmath>
+
 #include "diplib.h"
 #include "diplib/nonlinear.h"
+#include "diplib/statistics.h"
+#include "diplib/math.h"
+#include "diplib/mapping.h"
+#include "diplib/boundary.h"
 #include "diplib/framework.h"
 #include "diplib/pixel_table.h"
 #include "diplib/overload.h"
@@ -63,6 +69,139 @@ class VarianceLineFilter : public Framework::FullLineFilter {
       }
 };
 
+// Computes the integral image of `in`, with an additional row of zeros at the start of each dimension, such that
+// box sums for boxes at the image edge don't need special treatment.
+Image PaddedIntegralImage( Image const& in, bool square ) {
+   UnsignedArray sizes = in.Sizes();
+   for( auto& sz : sizes ) {
+      ++sz;
+   }
+   Image out( sizes, 1, DT_DFLOAT );
+   out.Fill( 0 );
+   RangeArray window( in.Dimensionality(), Range{ 1, -1 } );
+   Image inner = out.At( window );
+   inner.Protect();
+   if( square ) {
+      IntegralSquareImage( in, inner );
+   } else {
+      IntegralImage( in, inner );
+   }
+   return out;
+}
+
+// Computes the sum over a box of size `sizes` for each pixel of an image of size `outSizes`, given the padded
+// integral image of that image extended by `border`. `origin` is the position of the top-left corner of the box
+// relative to the pixel. This requires adding 2^nDims shifted views of the integral image.
+Image BoxSums(
+      Image const& integral,
+      UnsignedArray const& outSizes,
+      UnsignedArray const& border,
+      IntegerArray const& origin,
+      UnsignedArray const& sizes
+) {
+   dip::uint nDims = outSizes.size();
+   Image out( outSizes, 1, DT_DFLOAT );
+   out.Fill( 0 );
+   RangeArray window( nDims );
+   for( dip::uint corner = 0; corner < ( dip::uint( 1 ) << nDims ); ++corner ) {
+      bool negative = false;
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         dip::sint start = static_cast< dip::sint >( border[ ii ] ) + origin[ ii ];
+         if( corner & ( dip::uint( 1 ) << ii )) {
+            start += static_cast< dip::sint >( sizes[ ii ] );
+         } else {
+            negative = !negative;
+         }
+         window[ ii ] = Range{ start, start + static_cast< dip::sint >( outSizes[ ii ] ) - 1 };
+      }
+      if( negative ) {
+         Subtract( out, integral.At( window ), out, DT_DFLOAT );
+      } else {
+         Add( out, integral.At( window ), out, DT_DFLOAT );
+      }
+   }
+   return out;
+}
+
+// The variance filter for a rectangular kernel, computed in constant time per pixel from the integral image and the
+// integral square image of the boundary-extended input.
+//
+// The variance doesn't change when subtracting a constant. The image is processed in tiles of about 2^16 pixels,
+// and the mean of each tile (including its border) is subtracted before computing its integral images. This keeps
+// the values in the integral images small, so that the cancellation in `n * sumSquare - sum^2` depends only on the
+// data near the tile, not on the whole image. For integer input, the tile is centered on the rounded mean, so that
+// all sums are integers, and are computed exactly as long as they stay below 2^53 (for 16-bit input, with kernels
+// of up to about 1400 pixels). The result is then exact up to the final division, and a region where the input is
+// constant yields exactly 0. Besides the output, the only full-size temporary is the boundary-extended input, in
+// the input data type. The five double-precision temporaries are tile-sized.
+void RectangularVarianceFilter(
+      Image const& in,
+      Image& out,
+      PixelTable const& pixelTable,
+      BoundaryConditionArray const& bc,
+      DataType dtype
+) {
+   UnsignedArray const& sizes = pixelTable.Sizes();
+   IntegerArray const& origin = pixelTable.Origin();
+   UnsignedArray border = pixelTable.Boundary();
+   UnsignedArray imageSizes = in.Sizes();
+   dip::uint nDims = imageSizes.size();
+   PixelSize pixelSize = in.PixelSize();
+   Image extended;
+   ExtendImage( in, extended, border, bc );
+   out.ReForge( imageSizes, 1, dtype, Option::AcceptDataTypeChange::DO_ALLOW );
+   out.SetPixelSize( pixelSize );
+   // Tiles are at least twice the kernel size, to limit the overhead of the tile borders
+   dip::uint tileEdge = static_cast< dip::uint >( std::pow( 65536.0, 1.0 / static_cast< dfloat >( nDims )));
+   UnsignedArray tileSizes( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      tileSizes[ ii ] = std::min( std::max( tileEdge, 2 * sizes[ ii ] ), imageSizes[ ii ] );
+   }
+   dfloat n = static_cast< dfloat >( pixelTable.NumberOfPixels() );
+   bool isFloat = in.DataType().IsFloat();
+   UnsignedArray tileStart( nDims, 0 );
+   UnsignedArray outSizes( nDims );
+   RangeArray outWindow( nDims );
+   RangeArray inWindow( nDims );
+   while( true ) {
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         outSizes[ ii ] = std::min( tileSizes[ ii ], imageSizes[ ii ] - tileStart[ ii ] );
+         dip::sint start = static_cast< dip::sint >( tileStart[ ii ] );
+         outWindow[ ii ] = Range{ start, start + static_cast< dip::sint >( outSizes[ ii ] ) - 1 };
+         inWindow[ ii ] = Range{ start, start + static_cast< dip::sint >( outSizes[ ii ] + 2 * border[ ii ] ) - 1 };
+      }
+      Image tile = extended.At( inWindow );
+      dfloat mean = Mean( tile ).As< dfloat >();
+      if( !isFloat ) {
+         mean = std::round( mean );
+      }
+      Image centered = Subtract( tile, mean, DT_DFLOAT );
+      Image sum = BoxSums( PaddedIntegralImage( centered, false ), outSizes, border, origin, sizes );
+      Image sumSquare = BoxSums( PaddedIntegralImage( centered, true ), outSizes, border, origin, sizes );
+      centered.Strip();
+      // variance = ( n * sumSquare - sum^2 ) / ( n * ( n - 1 ))
+      MultiplySampleWise( sum, sum, sum, DT_DFLOAT );
+      LinearCombination( sumSquare, sum, sumSquare, n, -1.0 );
+      sumSquare /= n * ( n - 1.0 );
+      // For floating-point input, rounding errors can still make the result slightly negative
+      Clip( sumSquare, sumSquare, 0.0, 0.0, S::LOW );
+      Image outTile = out.At( outWindow );
+      outTile.Copy( sumSquare );
+      // Next tile
+      dip::uint ii = 0;
+      for( ; ii < nDims; ++ii ) {
+         tileStart[ ii ] += tileSizes[ ii ];
+         if( tileStart[ ii ] < imageSizes[ ii ] ) {
+            break;
+         }
+         tileStart[ ii ] = 0;
+      }
+      if( ii == nDims ) {
+         break;
+      }
+   }
+}
+
 } // namespace
 
 void VarianceFilter(
@@ -76,6 +215,15 @@ void VarianceFilter(
    DIP_START_STACK_TRACE
       BoundaryConditionArray bc = StringArrayToBoundaryConditionArray( boundaryCondition );
       DataType dtype = DataType::SuggestFlex( in.DataType() );
+      if( kernel.IsRectangular() && in.IsScalar() && !in.DataType().IsComplex() && ( in.Dimensionality() > 0 )) {
+         // With integral images, the cost per pixel is independent of the kernel size. Worthwhile if the pixel
+         // table has more runs than the number of box corners.
+         PixelTable pixelTable = kernel.PixelTable( in.Dimensionality(), 0 );
+         if(( pixelTable.NumberOfPixels() > 1 ) && ( pixelTable.Runs().size() > ( dip::uint( 1 ) << in.Dimensionality() ))) {
+            RectangularVarianceFilter( in, out, pixelTable, bc, dtype );
+            return;
+         }
+      }
       std::unique_ptr< Framework::FullLineFilter > lineFilter;
       DIP_OVL_NEW_FLOAT( lineFilter, VarianceLineFilter, (), dtype );
       Framework::Full( in, out, dtype, dtype, dtype, 1, bc, kernel, *lineFilter, Framework::FullOption::AsScalarImage );
@@ -83,3 +231,49 @@ void VarianceFilter(
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing integral images and the variance filter") {
+   dip::Image img{ dip::UnsignedArray{ 45, 38 }, 1, dip::DT_UINT16 };
+   img.Fill( 1000 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random, -500.0, 500.0 );
+   // Box sums from the integral image
+   dip::Image integral = dip::IntegralImage( img );
+   DOCTEST_CHECK( integral.DataType() == dip::DT_DFLOAT );
+   dip::dfloat expected = dip::Sum( img.At( dip::Range{ 3, 12 }, dip::Range{ 0, 6 } )).As< dip::dfloat >();
+   DOCTEST_CHECK( dip::BoxSum( integral, { 3, 0 }, { 10, 7 } ) == expected );
+   expected = dip::Sum( img ).As< dip::dfloat >();
+   DOCTEST_CHECK( dip::BoxSum( integral, { 0, 0 }, img.Sizes() ) == expected );
+   dip::Image integralSquare = dip::IntegralSquareImage( img );
+   expected = dip::SumSquare( img.At( dip::Range{ 20, 44 }, dip::Range{ 9, 30 } )).As< dip::dfloat >();
+   DOCTEST_CHECK( dip::BoxSum( integralSquare, { 20, 9 }, { 25, 22 } ) == doctest::Approx( expected ));
+   // Variance filter with a rectangular kernel (integral images) compared to the same kernel given as an image
+   // (pixel table runs), with an odd and an even size
+   for( dip::uint size : { dip::uint( 7 ), dip::uint( 8 ) } ) {
+      dip::Image mask{ dip::UnsignedArray{ size, size }, 1, dip::DT_BIN };
+      mask.Fill( 1 );
+      dip::Image out1 = dip::VarianceFilter( img, dip::Kernel{ dip::FloatArray{ static_cast< dip::dfloat >( size ) }, "rectangular" } );
+      dip::Image out2 = dip::VarianceFilter( img, dip::Kernel{ mask } );
+      DOCTEST_CHECK( out1.DataType() == out2.DataType() );
+      DOCTEST_CHECK( dip::MaximumAbs( out1 - out2 ).As< dip::dfloat >() < 1.0 ); // variance is about 8e4
+   }
+   // Wide-range input that is constant in one half, spanning several tiles: the flat half must be exactly 0
+   img = dip::Image{ dip::UnsignedArray{ 700, 500 }, 1, dip::DT_UINT16 };
+   img.Fill( 30000 );
+   dip::Image noisy = img.At( dip::Range{ 0, 349 }, dip::Range{} );
+   dip::UniformNoise( noisy, noisy, random, -30000.0, 30000.0 );
+   dip::Image mask{ dip::UnsignedArray{ 15, 15 }, 1, dip::DT_BIN };
+   mask.Fill( 1 );
+   dip::Image out1 = dip::VarianceFilter( img, dip::Kernel{ dip::FloatArray{ 15 }, "rectangular" } );
+   dip::Image out2 = dip::VarianceFilter( img, dip::Kernel{ mask } );
+   DOCTEST_CHECK( dip::Maximum( out1.At( dip::Range{ 357, -1 }, dip::Range{} )).As< dip::dfloat >() == 0.0 );
+   DOCTEST_CHECK( dip::Minimum( out1 ).As< dip::dfloat >() >= 0.0 );
+   DOCTEST_CHECK( dip::MaximumAbs( out1 - out2 ).As< dip::dfloat >() < 100.0 ); // variance is about 3e8, in sfloat
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -18,6 +18,8 @@
  * limitations under the License.
  */
 
+#include <numeric>
+
 #include "diplib.h"
 #include "diplib/segmentation.h"
 #include "diplib/framework.h"
@@ -38,8 +40,91 @@ struct Cluster {
 
 using ClusterArray = std::vector< Cluster >;
 
+// Along an image line, the squared distance of pixel `x` to cluster `i` is `( m_i - x )^2 + c_i`, with `m_i` the
+// cluster center coordinate along the line, and `c_i` the squared distance along the other dimensions. All these
+// parabolas have the same shape, so the nearest cluster is constant over long segments of the line, and changes
+// only where two of them intersect. We find these intersections rather than computing the distance to all clusters
+// for every pixel.
+class NearestClusterAlongLine {
+   public:
+      NearestClusterAlongLine( ClusterArray const& clusters, UnsignedArray const& pos, dip::uint scanDim ) :
+            clusters_( clusters ), scanDim_( scanDim ), offset_( clusters.size(), 0.0 ) {
+         for( dip::uint ii = 0; ii < clusters_.size(); ++ii ) {
+            for( dip::uint jj = 0; jj < pos.size(); ++jj ) {
+               if( jj != scanDim_ ) {
+                  dfloat dist = clusters_[ ii ].mean[ jj ] - static_cast< dfloat >( pos[ jj ] );
+                  offset_[ ii ] += dist * dist;
+               }
+            }
+         }
+      }
+
+      // Returns the cluster nearest to `x`
+      dip::uint Nearest( dip::uint x ) const {
+         dip::uint nearest = 0;
+         dfloat nearestDist = std::numeric_limits< dfloat >::max();
+         for( dip::uint ii = 0; ii < clusters_.size(); ++ii ) {
+            dfloat dist = clusters_[ ii ].mean[ scanDim_ ] - static_cast< dfloat >( x );
+            dist = dist * dist + offset_[ ii ];
+            if( dist < nearestDist ) {
+               nearest = ii;
+               nearestDist = dist;
+            }
+         }
+         return nearest;
+      }
+
+      // Returns the first pixel after `x` that might no longer be nearest to `cluster` (at least `x + 1`)
+      dip::uint SegmentEnd( dip::uint cluster, dip::uint x, dip::uint end ) const {
+         // Only clusters further along the line can take over
+         dfloat mi = clusters_[ cluster ].mean[ scanDim_ ];
+         dfloat fi = mi * mi + offset_[ cluster ];
+         dfloat crossing = static_cast< dfloat >( end );
+         for( dip::uint jj = 0; jj < clusters_.size(); ++jj ) {
+            dfloat mj = clusters_[ jj ].mean[ scanDim_ ];
+            if( mj > mi ) {
+               crossing = std::min( crossing, ( mj * mj + offset_[ jj ] - fi ) / ( 2.0 * ( mj - mi )));
+            }
+         }
+         if( crossing >= static_cast< dfloat >( end )) {
+            return end;
+         }
+         return std::max( x + 1, static_cast< dip::uint >( std::max( crossing, 0.0 )) + 1 );
+      }
+
+   private:
+      ClusterArray const& clusters_;
+      dip::uint scanDim_;
+      FloatArray offset_;
+};
+
+class dip__ClusteringBase : public Framework::ScanLineFilter {
+   public:
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         // Each thread accumulates the moments for each cluster: `nDims` first order moments and the sum of weights
+         accumulators_.assign( threads, std::vector< dfloat >( clusters_.size() * ( clusters_[ 0 ].mean.size() + 1 ), 0.0 ));
+      }
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override { return 4; }
+      // Adds the moments accumulated in all threads to the `newMean` and `norm` members of the clusters
+      void Reduce() {
+         dip::uint nDims = clusters_[ 0 ].mean.size();
+         for( auto const& accumulator : accumulators_ ) {
+            for( dip::uint ii = 0; ii < clusters_.size(); ++ii ) {
+               for( dip::uint jj = 0; jj < nDims; ++jj ) {
+                  clusters_[ ii ].newMean[ jj ] += accumulator[ ii * ( nDims + 1 ) + jj ];
+               }
+               clusters_[ ii ].norm += accumulator[ ii * ( nDims + 1 ) + nDims ];
+            }
+         }
+      }
+      dip__ClusteringBase( ClusterArray& clusters ) : clusters_( clusters ) {}
+   protected:
+      ClusterArray& clusters_;
+      std::vector< std::vector< dfloat >> accumulators_;
+};
+
 template< typename TPI >
-class dip__Clustering : public Framework::ScanLineFilter {
+class dip__Clustering : public dip__ClusteringBase {
    public:
       virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
          // Either we have one input image, or one output image.
@@ -59,49 +144,69 @@ class dip__Clustering : public Framework::ScanLineFilter {
          dip::uint scanDim = params.dimension;
          auto& pos = params.position;
          dip::uint nDims = pos.size();
-         // Initialise the cluster array
-         std::vector< dfloat > distCache( clusters_.size(), 0.0 );
-         for( dip::uint ii = 0; ii < clusters_.size(); ++ii ) {
-            for( dip::uint jj = 0; jj < nDims; ++jj ) {
-               if( jj != scanDim ) {
-                  dfloat dist = clusters_[ ii ].mean[ jj ] - static_cast< dfloat >( pos[ jj ] );
-                  distCache[ ii ] += dist * dist;
-               }
-            }
-         }
-         // Process the scan line
-         for( dip::uint xx = pos[ scanDim ]; xx < pos[ scanDim ] + bufferLength; ++xx ) {
-            // Find the nearest cluster center
-            dip::uint nearest = 0;
-            dfloat nearestDist = std::numeric_limits< dfloat >::max();
-            for( dip::uint ii = 0; ii < clusters_.size(); ++ii ) {
-               dfloat dist = clusters_[ ii ].mean[ scanDim ] - static_cast< dfloat >( xx );
-               dist = dist * dist + distCache[ ii ];
-               if( dist < nearestDist ) {
-                  nearest = ii;
-                  nearestDist = dist;
-               }
-            }
+         NearestClusterAlongLine nearestCluster( clusters_, pos, scanDim );
+         // Process the scan line, one segment of pixels with the same nearest cluster at the time
+         dip::uint end = pos[ scanDim ] + bufferLength;
+         dip::uint xx = pos[ scanDim ];
+         while( xx < end ) {
+            dip::uint nearest = nearestCluster.Nearest( xx );
+            dip::uint segmentEnd = nearestCluster.SegmentEnd( nearest, xx, end );
             if( out ) {
                // Write cluster label to output image
-               *out = clusters_[ nearest ].label;
-               out += outStride;
+               LabelType label = clusters_[ nearest ].label;
+               for( ; xx < segmentEnd; ++xx ) {
+                  *out = label;
+                  out += outStride;
+               }
             } else {
                // Update the new mean of nearest mean
+               dfloat sum = 0.0;
+               dfloat moment = 0.0;
+               for( ; xx < segmentEnd; ++xx ) {
+                  dfloat value = static_cast< dfloat >( *in );
+                  sum += value;
+                  moment += value * static_cast< dfloat >( xx );
+                  in += inStride;
+               }
+               dfloat* accumulator = &accumulators_[ params.thread ][ nearest * ( nDims + 1 ) ];
                for( dip::uint ii = 0; ii < nDims; ++ii ) {
-                  clusters_[ nearest ].newMean[ ii ] += *in * static_cast< dfloat >( pos[ ii ] );
+                  if( ii != scanDim ) {
+                     accumulator[ ii ] += sum * static_cast< dfloat >( pos[ ii ] );
+                  }
                }
-               clusters_[ nearest ].newMean[ scanDim ] += static_cast< dfloat >( *in ) * static_cast< dfloat >( xx );
-               clusters_[ nearest ].norm += *in;
-               in += inStride;
+               accumulator[ scanDim ] += moment;
+               accumulator[ nDims ] += sum;
             }
          }
       }
-      dip__Clustering( ClusterArray& clusters ) : clusters_( clusters ) {}
-   private:
-      ClusterArray& clusters_;
+      dip__Clustering( ClusterArray& clusters ) : dip__ClusteringBase( clusters ) {}
 };
 
+// Updates the cluster means with the values accumulated in `newMean` and `norm`, and returns the (squared) change
+dfloat UpdateClusters( ClusterArray& clusters ) {
+   dfloat change = 0;
+   dfloat maxval = 0;
+   //std::cout << "Cluster means: ";
+   for( auto& c : clusters ) {
+      if( c.norm != 0.0 ) {
+         for( dip::uint jj = 0; jj < c.mean.size(); jj++ ) {
+            dfloat val = c.newMean[ jj ] / c.norm;
+            maxval = std::max( std::abs( val ), maxval );
+            dfloat dist = val - c.mean[ jj ];
+            change += dist * dist;
+            c.mean[ jj ] = val;
+            c.newMean[ jj ] = 0.0;
+         }
+      } else {
+         std::fill( c.newMean.begin(), c.newMean.end(), 0.0 );
+      }
+      c.norm = 0.0;
+      //std::cout << c.mean << " ; ";
+   }
+   //std::cout << "change = " << change << '\n';
+   return change <= 1e-10 * maxval ? 0.0 : change;
+}
+
 dfloat Clustering(
       Image const& in,
       Image& out,
@@ -112,7 +217,7 @@ dfloat Clustering(
    if( ovlDataType.IsBinary() ) {
       ovlDataType = DT_UINT8; // Reading binary images as if they were uint8.
    }
-   std::unique_ptr< Framework::ScanLineFilter > lineFilter;
+   std::unique_ptr< dip__ClusteringBase > lineFilter;
    DIP_OVL_NEW_REAL( lineFilter, dip__Clustering, ( clusters ), ovlDataType );
    ImageConstRefArray inImages;
    ImageRefArray outImages;
@@ -134,32 +239,13 @@ dfloat Clustering(
       inBufferTypes.push_back( ovlDataType );
    }
    DIP_STACK_TRACE_THIS( Framework::Scan( inImages, outImages, inBufferTypes, outBufferTypes, outImageTypes, nTensorElements, *lineFilter,
-                                          Framework::ScanOption::NeedCoordinates + Framework::ScanOption::NoMultiThreading ));
-
-   // Process cluster information
-   dfloat change = 0;
-   dfloat maxval = 0;
-   if( !write ) {
-      //std::cout << "Cluster means: ";
-      for( auto& c : clusters ) {
-         if( c.norm != 0.0 ) {
-            for( dip::uint jj = 0; jj < c.mean.size(); jj++ ) {
-               dfloat val = c.newMean[ jj ] / c.norm;
-               maxval = std::max( std::abs( val ), maxval );
-               dfloat dist = val - c.mean[ jj ];
-               change += dist * dist;
-               c.mean[ jj ] = val;
-               c.newMean[ jj ] = 0.0;
-            }
-         } else {
-            std::fill( c.newMean.begin(), c.newMean.end(), 0.0 );
-         }
-         c.norm = 0.0;
-         //std::cout << c.mean << " ; ";
-      }
-      //std::cout << "change = " << change << '\n';
+                                          Framework::ScanOption::NeedCoordinates ));
+   if( write ) {
+      return 0.0;
    }
-   return change <= 1e-10 * maxval ? 0.0 : change;
+   // Process cluster information
+   lineFilter->Reduce();
+   return UpdateClusters( clusters );
 }
 
 void LabelClusters(
@@ -183,12 +269,129 @@ void LabelClusters(
    }
 }
 
+struct Sample {
+   FloatArray coords;
+   dfloat weight;
+};
+
+// Picks `n` pixels at random; their value is used as weight
+std::vector< Sample > SamplePixels( Image const& in, dip::uint n, UniformRandomGenerator& generator ) {
+   dip::uint nDims = in.Dimensionality();
+   std::vector< Sample > samples( n );
+   UnsignedArray coords( nDims );
+   for( auto& sample : samples ) {
+      sample.coords.resize( nDims );
+      for( dip::uint jj = 0; jj < nDims; ++jj ) {
+         coords[ jj ] = std::min( static_cast< dip::uint >( generator( 0, static_cast< dfloat >( in.Size( jj )))), in.Size( jj ) - 1 );
+         sample.coords[ jj ] = static_cast< dfloat >( coords[ jj ] );
+      }
+      sample.weight = std::max( in.At( coords ).As< dfloat >(), 0.0 );
+   }
+   return samples;
+}
+
+dfloat SquareDistance( FloatArray const& a, FloatArray const& b ) {
+   dfloat dist = 0.0;
+   for( dip::uint ii = 0; ii < a.size(); ++ii ) {
+      dfloat diff = a[ ii ] - b[ ii ];
+      dist += diff * diff;
+   }
+   return dist;
+}
+
+dip::uint NearestCluster( ClusterArray const& clusters, FloatArray const& coords ) {
+   dip::uint nearest = 0;
+   dfloat nearestDist = std::numeric_limits< dfloat >::max();
+   for( dip::uint ii = 0; ii < clusters.size(); ++ii ) {
+      dfloat dist = SquareDistance( clusters[ ii ].mean, coords );
+      if( dist < nearestDist ) {
+         nearest = ii;
+         nearestDist = dist;
+      }
+   }
+   return nearest;
+}
+
+// Returns the index of a random element of `weights`, with probability proportional to its weight
+dip::uint PickWeighted( FloatArray const& weights, UniformRandomGenerator& generator ) {
+   dfloat total = std::accumulate( weights.begin(), weights.end(), 0.0 );
+   if( total <= 0.0 ) {
+      return std::min( static_cast< dip::uint >( generator( 0, static_cast< dfloat >( weights.size() ))), weights.size() - 1 );
+   }
+   dfloat target = generator( 0, total );
+   for( dip::uint ii = 0; ii < weights.size(); ++ii ) {
+      target -= weights[ ii ];
+      if( target < 0.0 ) {
+         return ii;
+      }
+   }
+   return weights.size() - 1;
+}
+
+// k-means++ initialization: each new cluster center is a pixel picked with a probability proportional to its
+// weight times the square distance to the nearest already chosen center. To keep the cost of this independent of
+// the image size, the pixels are picked from a random subset of the image.
+void InitializeClusters( Image const& in, ClusterArray& clusters, UniformRandomGenerator& generator ) {
+   constexpr dip::uint maxSamples = 10000;
+   std::vector< Sample > samples = SamplePixels( in, std::min( in.NumberOfPixels(), maxSamples ), generator );
+   dip::uint nSamples = samples.size();
+   FloatArray weights( nSamples );
+   for( dip::uint ii = 0; ii < nSamples; ++ii ) {
+      weights[ ii ] = samples[ ii ].weight;
+   }
+   FloatArray distances( nSamples, std::numeric_limits< dfloat >::max() );
+   for( auto& cluster : clusters ) {
+      cluster.mean = samples[ PickWeighted( weights, generator ) ].coords;
+      for( dip::uint ii = 0; ii < nSamples; ++ii ) {
+         distances[ ii ] = std::min( distances[ ii ], SquareDistance( cluster.mean, samples[ ii ].coords ));
+         weights[ ii ] = samples[ ii ].weight * distances[ ii ];
+      }
+   }
+}
+
+// Mini-batch k-means: each iteration picks a random batch of pixels, and moves each cluster center towards the
+// pixels in the batch that are nearest to it. The learning rate decreases as more pixels are assigned to the cluster.
+void MiniBatchClustering( Image const& in, ClusterArray& clusters, dip::uint batchSize, UniformRandomGenerator& generator ) {
+   constexpr dip::uint maxIterations = 200;
+   constexpr dfloat minChange = 1e-4; // in square pixels
+   FloatArray counts( clusters.size(), 0.0 );
+   std::vector< dip::uint > nearest( batchSize );
+   for( dip::uint iter = 0; iter < maxIterations; ++iter ) {
+      std::vector< Sample > samples = SamplePixels( in, batchSize, generator );
+      for( dip::uint ii = 0; ii < batchSize; ++ii ) {
+         nearest[ ii ] = NearestCluster( clusters, samples[ ii ].coords );
+      }
+      for( auto& cluster : clusters ) {
+         cluster.newMean = cluster.mean;
+      }
+      for( dip::uint ii = 0; ii < batchSize; ++ii ) {
+         if( samples[ ii ].weight > 0.0 ) {
+            Cluster& cluster = clusters[ nearest[ ii ]];
+            counts[ nearest[ ii ]] += samples[ ii ].weight;
+            dfloat rate = samples[ ii ].weight / counts[ nearest[ ii ]];
+            for( dip::uint jj = 0; jj < cluster.mean.size(); ++jj ) {
+               cluster.mean[ jj ] += rate * ( samples[ ii ].coords[ jj ] - cluster.mean[ jj ] );
+            }
+         }
+      }
+      dfloat change = 0.0;
+      for( auto& cluster : clusters ) {
+         change = std::max( change, SquareDistance( cluster.mean, cluster.newMean ));
+         std::fill( cluster.newMean.begin(), cluster.newMean.end(), 0.0 );
+      }
+      if( change < minChange ) {
+         break;
+      }
+   }
+}
+
 } // namespace
 
 CoordinateArray KMeansClustering(
       Image const& in,
       Image& out,
-      dip::uint nClusters
+      dip::uint nClusters,
+      dip::uint batchSize
 ) {
    // Check the image
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
@@ -201,17 +404,17 @@ CoordinateArray KMeansClustering(
    dip::uint nDims = in.Dimensionality();
    ClusterArray clusters( nClusters, Cluster( nDims ));
 
-   // Randomly initialise the clusters
+   // Initialise the clusters
    Random random;
    UniformRandomGenerator generator( random );
-   for( dip::uint ii = 0; ii < nClusters; ++ii ) {
-      for( dip::uint jj = 0; jj < nDims; ++jj ) {
-         clusters[ ii ].mean[ jj ] = generator( 0, static_cast< dfloat >( in.Size( jj )));
-      }
-   }
+   InitializeClusters( in, clusters, generator );
 
    // Do cluster iterations
-   while( Clustering( in, out, clusters, false ) > 0.0 ) {};
+   if( batchSize > 0 ) {
+      MiniBatchClustering( in, clusters, batchSize, generator );
+   } else {
+      while( Clustering( in, out, clusters, false ) > 0.0 ) {};
+   }
    LabelClusters( clusters );
    Clustering( in, out, clusters, true );
 
@@ -225,3 +428,69 @@ CoordinateArray KMeansClustering(
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE( "[DIPlib] testing dip::KMeansClustering" ) {
+   // Three blobs, the cluster centers should be found at their centers
+   dip::Image img( { 200, 150 }, 1, dip::DT_SFLOAT );
+   img.Fill( 0 );
+   dip::DrawBandlimitedPoint( img, { 40.0, 30.0 }, { 100.0 }, { 4.0 } );
+   dip::DrawBandlimitedPoint( img, { 150.0, 50.0 }, { 100.0 }, { 4.0 } );
+   dip::DrawBandlimitedPoint( img, { 90.0, 120.0 }, { 100.0 }, { 4.0 } );
+   dip::Image out;
+   dip::CoordinateArray centers = dip::KMeansClustering( img, out, 3 );
+   DOCTEST_REQUIRE( centers.size() == 3 );
+   DOCTEST_CHECK( out.DataType() == dip::DT_LABEL );
+   // The order of the centers is not defined, we look for each of the expected ones
+   auto found = [ & ]( dip::sint x, dip::sint y ) {
+      for( auto const& c : centers ) {
+         if(( std::abs( static_cast< dip::sint >( c[ 0 ] ) - x ) <= 1 ) && ( std::abs( static_cast< dip::sint >( c[ 1 ] ) - y ) <= 1 )) {
+            return true;
+         }
+      }
+      return false;
+   };
+   DOCTEST_CHECK( found( 40, 30 ));
+   DOCTEST_CHECK( found( 90, 120 ));
+   DOCTEST_CHECK( found( 150, 50 ));
+   // Labels are assigned in order of distance to the origin
+   DOCTEST_CHECK( out.At( 40, 30 ) == 1 );
+   DOCTEST_CHECK( out.At( 90, 120 ) == 2 );
+   DOCTEST_CHECK( out.At( 150, 50 ) == 3 );
+   // The labels are the Voronoi tessellation of the centers
+   dip::uint labels[ 3 ];
+   for( dip::uint ii = 0; ii < 3; ++ii ) {
+      labels[ ii ] = out.At( centers[ ii ] ).As< dip::uint >();
+   }
+   dip::uint errors = 0;
+   for( dip::uint y = 0; y < img.Size( 1 ); ++y ) {
+      for( dip::uint x = 0; x < img.Size( 0 ); ++x ) {
+         dip::uint nearest = 0;
+         dip::dfloat nearestDist = 1e9;
+         for( dip::uint ii = 0; ii < 3; ++ii ) {
+            dip::dfloat dx = static_cast< dip::dfloat >( x ) - static_cast< dip::dfloat >( centers[ ii ][ 0 ] );
+            dip::dfloat dy = static_cast< dip::dfloat >( y ) - static_cast< dip::dfloat >( centers[ ii ][ 1 ] );
+            if( dx * dx + dy * dy < nearestDist ) {
+               nearestDist = dx * dx + dy * dy;
+               nearest = ii;
+            }
+         }
+         if( out.At( x, y ).As< dip::uint >() != labels[ nearest ] ) {
+            ++errors;
+         }
+      }
+   }
+   DOCTEST_CHECK( errors < 200 ); // Cluster centers are rounded, so pixels on the boundaries can differ
+   // Mini-batch k-means gives approximately the same centers
+   centers = dip::KMeansClustering( img, out, 3, 1000 );
+   DOCTEST_REQUIRE( centers.size() == 3 );
+   DOCTEST_CHECK( found( 40, 30 ));
+   DOCTEST_CHECK( found( 90, 120 ));
+   DOCTEST_CHECK( found( 150, 50 ));
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -28,6 +28,9 @@
 #include "diplib/framework.h"
 #include "diplib/overload.h"
 #include "diplib/lookup_table.h"
+#include "diplib/neighborlist.h"
+#include "diplib/iterators.h"
+#include "diplib/union_find.h"
 
 namespace dip {
 
@@ -213,18 +216,155 @@ void RangeThreshold(
    }
 }
 
-void HysteresisThreshold(
+namespace {
+
+// The value associated to each region indicates whether it contains a pixel above the high threshold
+bool HysteresisUnionFunction( bool const& value1, bool const& value2 ) { return value1 || value2; }
+
+using HysteresisRegionList = UnionFind< LabelType, bool, decltype( HysteresisUnionFunction ) >;
+
+template< typename TPI >
+void HysteresisProcessPixel(
+      TPI const* inPtr,
+      LabelType* labPtr,
+      HysteresisRegionList& regions,
+      IntegerArray const& neighborOffsets,
+      std::vector< dip::uint > const& neighbors,
+      TPI lowThreshold,
+      TPI highThreshold
+) {
+   if( *inPtr < lowThreshold ) {
+      *labPtr = 0;
+      return;
+   }
+   bool isHigh = *inPtr >= highThreshold;
+   LabelType lab = 0;
+   for( dip::uint ii : neighbors ) {
+      LabelType nlab = *( labPtr + neighborOffsets[ ii ] );
+      if( nlab != 0 ) {
+         lab = lab == 0 ? regions.FindRoot( nlab ) : regions.Union( lab, nlab );
+      }
+   }
+   if( lab == 0 ) {
+      lab = regions.Create( isHigh );
+   } else if( isHigh ) {
+      regions.Value( lab ) = true;
+   }
+   *labPtr = lab;
+}
+
+// Finds the backward neighbors that are within the image for a pixel at `coords`
+void HysteresisInImageNeighbors(
+      NeighborList const& neighborList,
+      UnsignedArray const& coords,
+      UnsignedArray const& sizes,
+      std::vector< dip::uint >& neighbors
+) {
+   neighbors.clear();
+   auto nlIt = neighborList.begin();
+   for( dip::uint ii = 0; ii < neighborList.Size(); ++ii, ++nlIt ) {
+      if( nlIt.IsInImage( coords, sizes )) {
+         neighbors.push_back( ii );
+      }
+   }
+}
+
+// Single-pass connected component labeling of `in >= lowThreshold`, where each component records
+// whether it has a pixel `>= highThreshold`. Only backward neighbors need to be examined.
+template< typename TPI >
+void dip__HysteresisThreshold(
       Image const& in,
+      Image& labels,
+      NeighborList const& neighborList,
+      dip::uint procDim,
+      dfloat lowThreshold,
+      dfloat highThreshold
+) {
+   HysteresisRegionList regions( HysteresisUnionFunction );
+   IntegerArray neighborOffsets = neighborList.ComputeOffsets( labels.Strides() );
+   // Thresholds are rounded up for integer types, so that comparisons can be done in the input type
+   TPI low = clamp_cast< TPI >( std::is_integral< TPI >::value ? std::ceil( lowThreshold ) : lowThreshold );
+   TPI high = clamp_cast< TPI >( std::is_integral< TPI >::value ? std::ceil( highThreshold ) : highThreshold );
+   if( highThreshold > static_cast< dfloat >( std::numeric_limits< TPI >::max() )) {
+      // No pixel can reach the high threshold
+      labels.Fill( 0 );
+      return;
+   }
+
+   UnsignedArray const& sizes = in.Sizes();
+   dip::sint inStride = in.Stride( procDim );
+   dip::sint labStride = labels.Stride( procDim );
+   dip::uint lastPixel = sizes[ procDim ] - 1;
+   std::vector< dip::uint > neighbors;
+   std::vector< dip::uint > bodyNeighbors;
+   JointImageIterator< TPI, LabelType > it( { in, labels }, procDim );
+   do {
+      UnsignedArray coords = it.Coordinates();
+      TPI const* inPtr = it.InPointer();
+      LabelType* labPtr = it.OutPointer();
+      // First pixel
+      HysteresisInImageNeighbors( neighborList, coords, sizes, neighbors );
+      HysteresisProcessPixel( inPtr, labPtr, regions, neighborOffsets, neighbors, low, high );
+      if( lastPixel == 0 ) {
+         continue;
+      }
+      // Body of image line
+      if( lastPixel > 1 ) {
+         coords[ procDim ] = 1;
+         HysteresisInImageNeighbors( neighborList, coords, sizes, bodyNeighbors );
+         for( dip::uint ii = 1; ii < lastPixel; ++ii ) {
+            inPtr += inStride;
+            labPtr += labStride;
+            HysteresisProcessPixel( inPtr, labPtr, regions, neighborOffsets, bodyNeighbors, low, high );
+         }
+      }
+      // Last pixel
+      inPtr += inStride;
+      labPtr += labStride;
+      coords[ procDim ] = lastPixel;
+      HysteresisInImageNeighbors( neighborList, coords, sizes, neighbors );
+      HysteresisProcessPixel( inPtr, labPtr, regions, neighborOffsets, neighbors, low, high );
+   } while( ++it );
+
+   // Keep only those regions that contain a pixel above the high threshold
+   regions.Relabel( []( bool value ) { return value; } );
+   ImageIterator< LabelType > lit( labels );
+   lit.OptimizeAndFlatten();
+   do {
+      *lit = regions.Label( *lit );
+   } while( ++lit );
+}
+
+} // namespace
+
+void HysteresisThreshold(
+      Image const& c_in,
       Image& out,
       dfloat lowThreshold,
       dfloat highThreshold
 ) {
-   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
-   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !c_in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !c_in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !c_in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   dip::uint nDims = c_in.Dimensionality();
+   if(( nDims == 0 ) || ( highThreshold < lowThreshold )) {
+      // Trivial cases: the high threshold determines which pixels are selected
+      DIP_STACK_TRACE_THIS( NotLesser( c_in, highThreshold < lowThreshold ? lowThreshold : highThreshold, out ));
+      return;
+   }
+   Image in = c_in.QuickCopy();
+   PixelSize pixelSize = c_in.PixelSize();
+   if( in.DataType().IsBinary() ) {
+      in.Convert( DT_UINT8 ); // Binary images are treated as 0/1 valued
+   }
    DIP_START_STACK_TRACE
-      Image low = in >= lowThreshold;
-      Image high = in >= highThreshold;
-      BinaryPropagation( high, low, out, 0, 0, S::BACKGROUND );
+      Image labels;
+      labels.ReForge( in, DT_LABEL );
+      dip::uint procDim = Framework::OptimalProcessingDim( labels );
+      NeighborList neighborList = NeighborList( { Metric::TypeCode::CONNECTED, nDims }, nDims ).SelectBackward( procDim );
+      DIP_OVL_CALL_REAL( dip__HysteresisThreshold, ( in, labels, neighborList, procDim, lowThreshold, highThreshold ), in.DataType() );
+      labels.SetPixelSize( pixelSize );
+      NotEqual( labels, 0, out );
    DIP_END_STACK_TRACE
 }
 
@@ -251,3 +391,40 @@ void MultipleThresholds(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing dip::HysteresisThreshold") {
+   dip::Image img{ dip::UnsignedArray{ 64, 47 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::GaussianNoise( img, img, random, 1.0 );
+   dip::Image low = img >= 0.5;
+   dip::Image high = img >= 1.8;
+   dip::Image reference = dip::BinaryPropagation( high, low, 0, 0, dip::S::BACKGROUND );
+   dip::Image out = dip::HysteresisThreshold( img, 0.5, 1.8 );
+   DOCTEST_CHECK( dip::Count( reference ) > 0 );
+   DOCTEST_CHECK( dip::Count( out != reference ) == 0 );
+   // Integer input with fractional thresholds, and in-place operation
+   dip::Image intImg = dip::Convert( img * 10, dip::DT_SINT16 );
+   low = intImg >= 4.5;
+   high = intImg >= 17.2;
+   reference = dip::BinaryPropagation( high, low, 0, 0, dip::S::BACKGROUND );
+   dip::HysteresisThreshold( intImg, intImg, 4.5, 17.2 );
+   DOCTEST_CHECK( intImg.DataType() == dip::DT_BIN );
+   DOCTEST_CHECK( dip::Count( intImg != reference ) == 0 );
+   // A single image line
+   img = dip::Image{ dip::UnsignedArray{ 7 }, 1, dip::DT_UINT8 };
+   img.Fill( 0 );
+   img.At( 1 ) = 1;
+   img.At( 2 ) = 3;
+   img.At( 4 ) = 1;
+   img.At( 5 ) = 1;
+   out = dip::HysteresisThreshold( img, 1, 2 );
+   DOCTEST_CHECK( dip::Count( out ) == 2 );
+   DOCTEST_CHECK( out.At( 1 ) == 1 );
+   DOCTEST_CHECK( out.At( 2 ) == 1 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -18,6 +18,8 @@
  * limitations under the License.
  */
 
+#include <array>
+
 #include "diplib/library/numeric.h"
 
 #if defined(__GNUG__) || defined(__clang__)
@@ -109,6 +111,242 @@ void EigenDecomposition(
    }
 }
 
+namespace {
+
+// Closed-form eigen decomposition of a 2x2 symmetric matrix. `l0 >= l1`, ( v0, v1 ) is the eigenvector for
+// `l0`, the one for `l1` is ( -v1, v0 ).
+void SymmetricEigenDecomposition2x2(
+      dfloat xx, dfloat yy, dfloat xy,
+      dfloat& l0, dfloat& l1,
+      dfloat& v0, dfloat& v1
+) {
+   dfloat mean = ( xx + yy ) / 2.0;
+   dfloat halfDiff = ( xx - yy ) / 2.0;
+   dfloat radius = std::hypot( halfDiff, xy );
+   l0 = mean + radius;
+   l1 = mean - radius;
+   v0 = 1.0;
+   v1 = 0.0;
+   if( radius > 0.0 ) {
+      // The vector orthogonal to one of the rows of ( A - l0 I ); we pick the row that gives the
+      // largest norm for numerical stability.
+      if( halfDiff >= 0.0 ) {
+         v0 = halfDiff + radius;
+         v1 = xy;
+      } else {
+         v0 = xy;
+         v1 = radius - halfDiff;
+      }
+      dfloat norm = std::hypot( v0, v1 );
+      v0 /= norm;
+      v1 /= norm;
+   }
+}
+
+template< typename T >
+void SymmetricEigenDecomposition2Internal(
+      ConstSampleIterator< T > input,
+      SampleIterator< T > lambdas,
+      SampleIterator< T > vectors
+) {
+   dfloat l0, l1, v0, v1;
+   SymmetricEigenDecomposition2x2( static_cast< dfloat >( input[ 0 ] ), static_cast< dfloat >( input[ 1 ] ),
+                                   static_cast< dfloat >( input[ 2 ] ), l0, l1, v0, v1 );
+   lambdas[ 0 ] = static_cast< T >( l0 );
+   lambdas[ 1 ] = static_cast< T >( l1 );
+   if( vectors ) {
+      vectors[ 0 ] = static_cast< T >( v0 );
+      vectors[ 1 ] = static_cast< T >( v1 );
+      vectors[ 2 ] = static_cast< T >( -v1 );
+      vectors[ 3 ] = static_cast< T >( v0 );
+   }
+}
+
+using Vector3 = std::array< dfloat, 3 >;
+using SymmetricMatrix3 = std::array< dfloat, 6 >; // xx, yy, zz, xy, xz, yz
+
+inline Vector3 Cross( Vector3 const& a, Vector3 const& b ) {
+   return {{ a[ 1 ] * b[ 2 ] - a[ 2 ] * b[ 1 ], a[ 2 ] * b[ 0 ] - a[ 0 ] * b[ 2 ], a[ 0 ] * b[ 1 ] - a[ 1 ] * b[ 0 ] }};
+}
+
+inline dfloat Dot( Vector3 const& a, Vector3 const& b ) {
+   return a[ 0 ] * b[ 0 ] + a[ 1 ] * b[ 1 ] + a[ 2 ] * b[ 2 ];
+}
+
+inline Vector3 Multiply( SymmetricMatrix3 const& A, Vector3 const& v ) {
+   return {{ A[ 0 ] * v[ 0 ] + A[ 3 ] * v[ 1 ] + A[ 4 ] * v[ 2 ],
+             A[ 3 ] * v[ 0 ] + A[ 1 ] * v[ 1 ] + A[ 5 ] * v[ 2 ],
+             A[ 4 ] * v[ 0 ] + A[ 5 ] * v[ 1 ] + A[ 2 ] * v[ 2 ] }};
+}
+
+// Computes the eigenvector for eigenvalue `lambda`, which must be a simple eigenvalue, as the largest
+// cross product of two rows of ( A - lambda I ).
+Vector3 Eigenvector3( SymmetricMatrix3 const& A, dfloat lambda ) {
+   Vector3 r0{{ A[ 0 ] - lambda, A[ 3 ], A[ 4 ] }};
+   Vector3 r1{{ A[ 3 ], A[ 1 ] - lambda, A[ 5 ] }};
+   Vector3 r2{{ A[ 4 ], A[ 5 ], A[ 2 ] - lambda }};
+   std::array< Vector3, 3 > candidates{{ Cross( r0, r1 ), Cross( r0, r2 ), Cross( r1, r2 ) }};
+   dip::uint best = 0;
+   dfloat dmax = Dot( candidates[ 0 ], candidates[ 0 ] );
+   for( dip::uint ii = 1; ii < 3; ++ii ) {
+      dfloat d = Dot( candidates[ ii ], candidates[ ii ] );
+      if( d > dmax ) {
+         best = ii;
+         dmax = d;
+      }
+   }
+   if( dmax == 0.0 ) {
+      return {{ 1.0, 0.0, 0.0 }};
+   }
+   dfloat norm = std::sqrt( dmax );
+   return {{ candidates[ best ][ 0 ] / norm, candidates[ best ][ 1 ] / norm, candidates[ best ][ 2 ] / norm }};
+}
+
+// Closed-form eigen decomposition of a 3x3 symmetric matrix { xx, yy, zz, xy, xz, yz }.
+//  1. The eigenvalues are the roots of the characteristic polynomial, found with the trigonometric method.
+//     These are not precise when two eigenvalues are (nearly) equal, but the one that is best separated from
+//     the other two is.
+//  2. The eigenvector for the best separated eigenvalue is computed from cross products of the rows of
+//     ( A - lambda I ), and the eigenvalue is refined as the Rayleigh quotient.
+//  3. The remaining two eigenpairs are found by solving the 2x2 problem in the plane orthogonal to that
+//     eigenvector.
+template< typename T >
+void SymmetricEigenDecomposition3Internal(
+      ConstSampleIterator< T > input,
+      SampleIterator< T > lambdas,
+      SampleIterator< T > vectors
+) {
+   SymmetricMatrix3 A;
+   for( dip::uint ii = 0; ii < 6; ++ii ) {
+      A[ ii ] = static_cast< dfloat >( input[ ii ] );
+   }
+   // Scale the matrix to avoid overflow and underflow in the computations below
+   dfloat scale = 0.0;
+   for( auto a : A ) {
+      scale = std::max( scale, std::abs( a ));
+   }
+   if( scale == 0.0 ) {
+      scale = 1.0;
+   }
+   for( auto& a : A ) {
+      a /= scale;
+   }
+   std::array< dfloat, 3 > l;
+   std::array< Vector3, 3 > v;
+   if( A[ 3 ] == 0.0 && A[ 4 ] == 0.0 && A[ 5 ] == 0.0 ) {
+      // Diagonal matrix: the eigenvectors are the axes, sorted by the diagonal values
+      std::array< dip::uint, 3 > order{{ 0, 1, 2 }};
+      std::sort( order.begin(), order.end(), [ & ]( dip::uint a, dip::uint b ) { return A[ a ] > A[ b ]; } );
+      for( dip::uint ii = 0; ii < 3; ++ii ) {
+         l[ ii ] = A[ order[ ii ]];
+         v[ ii ] = {{ 0.0, 0.0, 0.0 }};
+         v[ ii ][ order[ ii ]] = 1.0;
+      }
+   } else {
+      // Eigenvalues using the trigonometric solution of the characteristic polynomial (Smith, 1961)
+      dfloat mean = ( A[ 0 ] + A[ 1 ] + A[ 2 ] ) / 3.0;
+      dfloat b00 = A[ 0 ] - mean;
+      dfloat b11 = A[ 1 ] - mean;
+      dfloat b22 = A[ 2 ] - mean;
+      dfloat p = std::sqrt(( b00 * b00 + b11 * b11 + b22 * b22
+                             + 2.0 * ( A[ 3 ] * A[ 3 ] + A[ 4 ] * A[ 4 ] + A[ 5 ] * A[ 5 ] )) / 6.0 );
+      dfloat halfDet = ( b00 * ( b11 * b22 - A[ 5 ] * A[ 5 ] )
+                       - A[ 3 ] * ( A[ 3 ] * b22 - A[ 5 ] * A[ 4 ] )
+                       + A[ 4 ] * ( A[ 3 ] * A[ 5 ] - b11 * A[ 4 ] )) / ( 2.0 * p * p * p );
+      halfDet = clamp( halfDet, -1.0, 1.0 );
+      dfloat phi = std::acos( halfDet ) / 3.0;
+      dfloat largest = mean + 2.0 * p * std::cos( phi );
+      dfloat smallest = mean + 2.0 * p * std::cos( phi + 2.0 * pi / 3.0 );
+      dfloat middle = 3.0 * mean - largest - smallest;
+      // The best separated eigenvalue
+      bool largestIsSeparated = largest - middle >= middle - smallest;
+      Vector3 vs = Eigenvector3( A, largestIsSeparated ? largest : smallest );
+      dfloat ls = Dot( vs, Multiply( A, vs ));
+      // Orthonormal basis { U, V } for the plane orthogonal to `vs`
+      Vector3 U;
+      if( std::abs( vs[ 0 ] ) > std::abs( vs[ 1 ] )) {
+         dfloat norm = std::hypot( vs[ 0 ], vs[ 2 ] );
+         U = {{ -vs[ 2 ] / norm, 0.0, vs[ 0 ] / norm }};
+      } else {
+         dfloat norm = std::hypot( vs[ 1 ], vs[ 2 ] );
+         U = {{ 0.0, vs[ 2 ] / norm, -vs[ 1 ] / norm }};
+      }
+      Vector3 V = Cross( vs, U );
+      // The 2x2 matrix [U V]^T A [U V]
+      Vector3 AV = Multiply( A, V );
+      dfloat l0, l1, c0, c1;
+      SymmetricEigenDecomposition2x2( Dot( U, Multiply( A, U )), Dot( V, AV ), Dot( U, AV ), l0, l1, c0, c1 );
+      Vector3 w0{{ c0 * U[ 0 ] + c1 * V[ 0 ], c0 * U[ 1 ] + c1 * V[ 1 ], c0 * U[ 2 ] + c1 * V[ 2 ] }};
+      Vector3 w1{{ c0 * V[ 0 ] - c1 * U[ 0 ], c0 * V[ 1 ] - c1 * U[ 1 ], c0 * V[ 2 ] - c1 * U[ 2 ] }};
+      if( largestIsSeparated ) {
+         l = {{ ls, l0, l1 }};
+         v = {{ vs, w0, w1 }};
+      } else {
+         l = {{ l0, l1, ls }};
+         v = {{ w0, w1, vs }};
+      }
+      // Rounding errors could have changed the order
+      if( l[ 1 ] > l[ 0 ] ) {
+         std::swap( l[ 0 ], l[ 1 ] );
+         std::swap( v[ 0 ], v[ 1 ] );
+      }
+      if( l[ 2 ] > l[ 1 ] ) {
+         std::swap( l[ 1 ], l[ 2 ] );
+         std::swap( v[ 1 ], v[ 2 ] );
+         if( l[ 1 ] > l[ 0 ] ) {
+            std::swap( l[ 0 ], l[ 1 ] );
+            std::swap( v[ 0 ], v[ 1 ] );
+         }
+      }
+   }
+   // Make it a right-handed coordinate system
+   v[ 2 ] = Cross( v[ 0 ], v[ 1 ] );
+   for( dip::uint ii = 0; ii < 3; ++ii ) {
+      lambdas[ ii ] = static_cast< T >( l[ ii ] * scale );
+   }
+   if( vectors ) {
+      for( dip::uint ii = 0; ii < 3; ++ii ) {
+         for( dip::uint jj = 0; jj < 3; ++jj ) {
+            vectors[ ii * 3 + jj ] = static_cast< T >( v[ ii ][ jj ] );
+         }
+      }
+   }
+}
+
+} // namespace
+
+void SymmetricEigenDecomposition2(
+      ConstSampleIterator< dfloat > input,
+      SampleIterator< dfloat > lambdas,
+      SampleIterator< dfloat > vectors
+) {
+   SymmetricEigenDecomposition2Internal( input, lambdas, vectors );
+}
+
+void SymmetricEigenDecomposition2(
+      ConstSampleIterator< sfloat > input,
+      SampleIterator< sfloat > lambdas,
+      SampleIterator< sfloat > vectors
+) {
+   SymmetricEigenDecomposition2Internal( input, lambdas, vectors );
+}
+
+void SymmetricEigenDecomposition3(
+      ConstSampleIterator< dfloat > input,
+      SampleIterator< dfloat > lambdas,
+      SampleIterator< dfloat > vectors
+) {
+   SymmetricEigenDecomposition3Internal( input, lambdas, vectors );
+}
+
+void SymmetricEigenDecomposition3(
+      ConstSampleIterator< sfloat > input,
+      SampleIterator< sfloat > lambdas,
+      SampleIterator< sfloat > vectors
+) {
+   SymmetricEigenDecomposition3Internal( input, lambdas, vectors );
+}
+
 dfloat Determinant( dip::uint n, ConstSampleIterator< dfloat > input ) {
    DIP_ASSERT( input.Stride() >= 0 );
    Eigen::Map< Eigen::MatrixXd const, 0, Eigen::InnerStride<> > matrix( input.Pointer(), n, n, Eigen::InnerStride<>( input.Stride() ));
@@ -265,6 +503,7 @@ void Solve(
 
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
+#include <random>
 
 DOCTEST_TEST_CASE("[DIPlib] testing the EigenDecomposition functions") {
    dip::dfloat matrix2[] = { 4, 8, 0 };
@@ -394,4 +633,92 @@ DOCTEST_TEST_CASE("[DIPlib] testing the SingularValueDecomposition and related f
    DOCTEST_CHECK( x[ 1 ] == doctest::Approx( 2.0 ));
 }
 
+namespace {
+
+// Checks the closed-form solution for a packed symmetric matrix against the generic one, and tests that
+// `A v = lambda v` for the eigenvectors, and that these are orthonormal.
+template< dip::uint n, typename F >
+void TestClosedFormEigenDecomposition( dip::dfloat const* packed, F const& function ) {
+   constexpr dip::uint N = n * ( n + 1 ) / 2;
+   dip::dfloat scale = 0;
+   for( dip::uint ii = 0; ii < N; ++ii ) {
+      scale = std::max( scale, std::abs( packed[ ii ] ));
+   }
+   dip::dfloat tolerance = 1e-10 * std::max( scale, 1.0 );
+   std::array< dip::dfloat, n > refLambdas;
+   dip::SymmetricEigenDecompositionPacked( n, packed, refLambdas.data() );
+   std::array< dip::dfloat, n > lambdas;
+   std::array< dip::dfloat, n * n > vectors;
+   function( packed, lambdas.data(), vectors.data() );
+   // Full matrix
+   std::array< dip::dfloat, n * n > A;
+   for( dip::uint ii = 0; ii < n; ++ii ) {
+      A[ ii * n + ii ] = packed[ ii ];
+   }
+   for( dip::uint jj = 1, kk = n; jj < n; ++jj ) {
+      for( dip::uint ii = 0; ii < jj; ++ii, ++kk ) {
+         A[ ii * n + jj ] = A[ jj * n + ii ] = packed[ kk ];
+      }
+   }
+   for( dip::uint ii = 0; ii < n; ++ii ) {
+      DOCTEST_CHECK( std::abs( lambdas[ ii ] - refLambdas[ ii ] ) < tolerance );
+      for( dip::uint jj = 0; jj < n; ++jj ) {
+         dip::dfloat Av = 0;
+         dip::dfloat dot = 0;
+         for( dip::uint kk = 0; kk < n; ++kk ) {
+            Av += A[ jj * n + kk ] * vectors[ ii * n + kk ];
+            dot += vectors[ ii * n + kk ] * vectors[ jj * n + kk ];
+         }
+         DOCTEST_CHECK( std::abs( Av - lambdas[ ii ] * vectors[ ii * n + jj ] ) < tolerance );
+         DOCTEST_CHECK( std::abs( dot - ( ii == jj ? 1.0 : 0.0 )) < 1e-10 );
+      }
+   }
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("[DIPlib] testing the closed-form EigenDecomposition functions") {
+   auto eig2 = []( dip::dfloat const* in, dip::dfloat* lambdas, dip::dfloat* vectors ) { dip::SymmetricEigenDecomposition2( in, lambdas, vectors ); };
+   auto eig3 = []( dip::dfloat const* in, dip::dfloat* lambdas, dip::dfloat* vectors ) { dip::SymmetricEigenDecomposition3( in, lambdas, vectors ); };
+   std::mt19937 random( 0 );
+   std::uniform_real_distribution< dip::dfloat > uniform( -10.0, 10.0 );
+   for( dip::uint ii = 0; ii < 100; ++ii ) {
+      dip::dfloat matrix[ 6 ];
+      for( auto& m : matrix ) {
+         m = uniform( random );
+      }
+      TestClosedFormEigenDecomposition< 2 >( matrix, eig2 );
+      TestClosedFormEigenDecomposition< 3 >( matrix, eig3 );
+      // Double eigenvalues: A = 2 I + 3 u u^T, and rank 1: A = u u^T
+      dip::dfloat u[ 3 ] = { matrix[ 0 ], matrix[ 1 ], matrix[ 2 ] };
+      dip::dfloat norm = std::sqrt( u[ 0 ] * u[ 0 ] + u[ 1 ] * u[ 1 ] + u[ 2 ] * u[ 2 ] );
+      for( auto& v : u ) {
+         v /= norm;
+      }
+      dip::dfloat rank1[ 6 ] = { u[ 0 ] * u[ 0 ], u[ 1 ] * u[ 1 ], u[ 2 ] * u[ 2 ], u[ 0 ] * u[ 1 ], u[ 0 ] * u[ 2 ], u[ 1 ] * u[ 2 ] };
+      TestClosedFormEigenDecomposition< 3 >( rank1, eig3 );
+      dip::dfloat doubleEig[ 6 ];
+      for( dip::uint jj = 0; jj < 6; ++jj ) {
+         doubleEig[ jj ] = 3.0 * rank1[ jj ] + ( jj < 3 ? 2.0 : 0.0 );
+      }
+      TestClosedFormEigenDecomposition< 3 >( doubleEig, eig3 );
+   }
+   dip::dfloat diagonal[ 6 ] = { 1, 3, 2, 0, 0, 0 };
+   TestClosedFormEigenDecomposition< 3 >( diagonal, eig3 );
+   TestClosedFormEigenDecomposition< 2 >( diagonal, eig2 );
+   dip::dfloat identity[ 6 ] = { 4, 4, 4, 0, 0, 0 };
+   TestClosedFormEigenDecomposition< 3 >( identity, eig3 );
+   TestClosedFormEigenDecomposition< 2 >( identity, eig2 );
+   dip::dfloat zero[ 6 ] = { 0, 0, 0, 0, 0, 0 };
+   TestClosedFormEigenDecomposition< 3 >( zero, eig3 );
+   TestClosedFormEigenDecomposition< 2 >( zero, eig2 );
+   // Single-precision version
+   dip::sfloat matrix3f[] = { 3, 1.5, 1.5, 0.0, 0.0, -0.5 };
+   dip::sfloat lambdas[ 3 ];
+   dip::SymmetricEigenDecomposition3( matrix3f, lambdas );
+   DOCTEST_CHECK( lambdas[ 0 ] == doctest::Approx( 3 ));
+   DOCTEST_CHECK( lambdas[ 1 ] == doctest::Approx( 2 ));
+   DOCTEST_CHECK( lambdas[ 2 ] == doctest::Approx( 1 ));
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -21,6 +21,9 @@
 #define DIP_VIEWER_SLICE_H
 
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #include "diplib/color.h"
 
@@ -51,7 +54,7 @@ class DIPVIEWER_CLASS_EXPORT SliceView : public View
   public:
     SliceView(ViewPort *viewport, dip::uint dimx, dip::uint dimy) : View(viewport), dimx_(dimx), dimy_(dimy), texture_(0) { }
 
-    DIPVIEWER_EXPORT void project();
+    DIPVIEWER_EXPORT bool project(bool preview=false);
     DIPVIEWER_EXPORT void map();
     DIPVIEWER_EXPORT void rebuild();
     DIPVIEWER_EXPORT void render();
@@ -100,7 +103,10 @@ class DIPVIEWER_CLASS_EXPORT SliceViewer : public Viewer
   protected:
     ViewingOptions options_;
     std::thread thread_;
-    bool continue_, updated_;
+    std::atomic<bool> continue_, updated_;
+    std::mutex wakeup_mutex_;
+    std::condition_variable wakeup_cv_;
+    bool wakeup_;
     std::vector<ViewPort*> viewports_;
     SliceViewPort *main_, *left_, *top_;
     TensorViewPort *tensor_;
@@ -134,6 +140,7 @@ class DIPVIEWER_CLASS_EXPORT SliceViewer : public Viewer
       if (continue_)
       {
         continue_ = false;
+        notify();
         thread_.join();
       }
       
@@ -155,7 +162,12 @@ class DIPVIEWER_CLASS_EXPORT SliceViewer : public Viewer
     
     ViewingOptions &options() override { return options_; }
     const dip::Image &image() override { return image_; }
-    void setImage(const dip::Image &image) override { original_ = image; refresh_seq_++; }
+    void setImage(const dip::Image &image) override { original_ = image; refresh_seq_++; notify(); }
+    
+    /// \brief Wake up the texture calculation thread.
+    ///
+    /// Call this after changing the options or the image, so that the change is processed immediately.
+    DIPVIEWER_EXPORT void notify();
     
     /// \brief Update linked viewers.
     ///
@@ -174,6 +186,8 @@ class DIPVIEWER_CLASS_EXPORT SliceViewer : public Viewer
     DIPVIEWER_EXPORT void place();
     DIPVIEWER_EXPORT ViewPort *viewport(int x, int y);
     DIPVIEWER_EXPORT void calculateTextures();
+    DIPVIEWER_EXPORT bool waitForDraw();
+    DIPVIEWER_EXPORT bool isStale(const ViewingOptions &options, int seq);
 };
 
 /// \}
@@ -31,12 +31,15 @@
 #define DIM_WIDTH   (CHAR_WIDTH+2)
 #define DIM_HEIGHT  (CHAR_HEIGHT+2)
 
+// Maximum number of samples per projected dimension in preview projections
+#define PREVIEW_SAMPLES 16
+
 /// \file
 /// \brief Defines `dip::viewer::SliceViewer`.
 
 namespace dip { namespace viewer {
 
-void SliceView::project()
+bool SliceView::project(bool preview)
 {
   auto &o = viewport()->viewer()->options();
   Image image = viewport()->viewer()->image();
@@ -45,6 +48,10 @@ void SliceView::project()
   
   if (o.projection_ == ViewingOptions::Projection::None)
   {
+    // Extraction is cheap, no preview necessary
+    if (preview)
+      return false;
+      
     // Extraction
     RangeArray range(image.Dimensionality());
     
@@ -74,7 +81,28 @@ void SliceView::project()
       rs[ (dip::uint)dy ] = image.Size((dip::uint)dy);
     }
   
-    image = DefineROI(image, ro, rs, {});
+    if (preview)
+    {
+      // Subsample the projected dimensions, such that at most PREVIEW_SAMPLES
+      // samples along each of them contribute to the preview projection.
+      dip::UnsignedArray spacing(image.Dimensionality(), 1);
+      dip::uint full = 1, reduced = 1;
+      for (size_t ii=0; ii < spacing.size(); ++ii)
+        if (process[ii])
+        {
+          spacing[ii] = (rs[ii] + PREVIEW_SAMPLES - 1) / PREVIEW_SAMPLES;
+          full *= rs[ii];
+          reduced *= (rs[ii] + spacing[ii] - 1) / spacing[ii];
+        }
+        
+      // Not worth it if the preview is not much cheaper than the full projection
+      if (reduced * 4 > full)
+        return false;
+        
+      image = DefineROI(image, ro, rs, spacing);
+    }
+    else
+      image = DefineROI(image, ro, rs, {});
     
     switch (o.projection_)
     {
@@ -98,6 +126,8 @@ void SliceView::project()
     projected_.PermuteDimensions({(unsigned int)dx, (unsigned int)dy});
     
   map();
+  
+  return true;
 }
 
 void SliceView::map()
@@ -556,7 +586,7 @@ void SliceViewPort::screenToView(int x, int y, double *ix, double *iy)
     *iy = (y-y_)/viewer()->options().zoom_[(dip::uint)dy] + viewer()->options().origin_[(dip::uint)dy];
 }
 
-SliceViewer::SliceViewer(const dip::Image &image, std::string name, size_t width, size_t height) : Viewer(name), options_(image), continue_(false), updated_(false), original_(image), drag_viewport_(NULL), refresh_seq_(0)
+SliceViewer::SliceViewer(const dip::Image &image, std::string name, size_t width, size_t height) : Viewer(name), options_(image), continue_(false), updated_(false), wakeup_(false), original_(image), drag_viewport_(NULL), refresh_seq_(0)
 {
   if (width && height)
     requestSize(width, height);
@@ -597,8 +627,8 @@ void SliceViewer::create()
   thread_ = std::thread(&SliceViewer::calculateTextures, this);
   
   // Wait for first projection
-  while (!updated_)
-     std::this_thread::sleep_for(std::chrono::microseconds(1000));
+  std::unique_lock<std::mutex> lk(wakeup_mutex_);
+  wakeup_cv_.wait(lk, [this]{ return updated_.load(); });
 }
 
 void SliceViewer::place()
@@ -636,6 +666,7 @@ void SliceViewer::draw()
     for (size_t ii=0; ii < viewports_.size(); ++ii)
       viewports_[ii]->rebuild();
     updated_ = false;
+    notify();
   }
   
   for (size_t ii=0; ii < viewports_.size(); ++ii)
@@ -764,6 +795,8 @@ void SliceViewer::key(unsigned char k, int x, int y, int mods)
       manager()->createWindow(sv);
     }
   }
+  
+  notify();
 }
 
 void SliceViewer::click(int button, int state, int x, int y, int mods)
@@ -778,6 +811,8 @@ void SliceViewer::click(int button, int state, int x, int y, int mods)
   
   if (drag_viewport_)
     drag_viewport_->click(button, state, x, y, mods);
+    
+  notify();
 }
 
 void SliceViewer::motion(int x, int y)
@@ -785,6 +820,8 @@ void SliceViewer::motion(int x, int y)
   Guard guard(*this);
   if (drag_viewport_)
     drag_viewport_->motion(drag_button_, x, y);
+    
+  notify();
 }
 
 ViewPort *SliceViewer::viewport(int x, int y)
@@ -801,18 +838,47 @@ ViewPort *SliceViewer::viewport(int x, int y)
   return NULL;
 }
 
+void SliceViewer::notify()
+{
+  {
+    std::lock_guard<std::mutex> lk(wakeup_mutex_);
+    wakeup_ = true;
+  }
+  wakeup_cv_.notify_all();
+}
+
+bool SliceViewer::waitForDraw()
+{
+  // Make sure we don't lose updates
+  std::unique_lock<std::mutex> lk(wakeup_mutex_);
+  wakeup_cv_.wait(lk, [this]{ return !updated_ || !continue_; });
+  return continue_;
+}
+
+bool SliceViewer::isStale(const ViewingOptions &options, int seq)
+{
+  Guard guard(*this);
+  return seq != refresh_seq_ || options.diff(options_) >= ViewingOptions::Diff::Projection;
+}
+
 void SliceViewer::calculateTextures()
 {
   ViewingOptions options, old_options;
   int seq = -1;
+  
+  // Complex-to-real conversions and their ranges, per ViewingOptions::ComplexToReal
+  // mode. Only the first element is used for real-valued images.
+  std::array<dip::Image, 4> image_cache;
+  std::array<FloatRange, 4> range_cache;
+  int cache_seq = -1;
+  
+  // Views that still need to be projected at full resolution
+  SliceView *views[] = {main_->view(), left_->view(), top_->view()};
+  bool dirty[] = {true, true, true};
 
   while (continue_)
   {
-    // Make sure we don't lose updates
-    while (updated_ && continue_)
-       std::this_thread::sleep_for(std::chrono::microseconds(1000));
-       
-    if (!continue_)
+    if (!waitForDraw())
       break;
   
     old_options = options;
@@ -830,38 +896,52 @@ void SliceViewer::calculateTextures()
       lock();
       dip::Image original = original_, image;
       unlock();
-    
-      // Deal with complex numbers
-      if (original.DataType().IsComplex())
+      
+      if (cache_seq != seq)
       {
-        switch (options.complex_)
+        for (auto &cached : image_cache)
+          cached.Strip();
+        cache_seq = seq;
+      }
+      
+      dip::uint mode = original.DataType().IsComplex() ? (dip::uint)options.complex_ : 0;
+      if (!image_cache[mode].IsForged())
+      {
+        // Deal with complex numbers
+        if (original.DataType().IsComplex())
         {
-          case ViewingOptions::ComplexToReal::Real:
-            image = original.Real();
-            break;
-          case ViewingOptions::ComplexToReal::Imaginary:
-            image = original.Imaginary();
-            break;
-          case ViewingOptions::ComplexToReal::Magnitude:
-            image = Abs(original);
-            break;
-          case ViewingOptions::ComplexToReal::Phase:
-            image = Phase(original);
-            break;
-        }      
+          switch (options.complex_)
+          {
+            case ViewingOptions::ComplexToReal::Real:
+              image = original.Real();
+              break;
+            case ViewingOptions::ComplexToReal::Imaginary:
+              image = original.Imaginary();
+              break;
+            case ViewingOptions::ComplexToReal::Magnitude:
+              image = Abs(original);
+              break;
+            case ViewingOptions::ComplexToReal::Phase:
+              image = Phase(original);
+              break;
+          }      
+        }
+        else
+          image = original;
+          
+        // Get range
+        dip::MinMaxAccumulator acc = MaximumAndMinimum( image );
+        
+        image_cache[mode] = image;
+        range_cache[mode] = {acc.Minimum(), acc.Maximum()};
       }
       else
-        image = original;
-        
-      // Get range
-      dip::Image copy = image;
-      copy.TensorToSpatial();
-      dip::MinMaxAccumulator acc = MaximumAndMinimum( image );
+        image = image_cache[mode];
       
       lock();
       image_ = image;
       original_ = original;
-      options_.range_ = {acc.Minimum(), acc.Maximum()};
+      options_.range_ = range_cache[mode];
       if (options.mapping_ == ViewingOptions::Mapping::Linear ||
           options.mapping_ == ViewingOptions::Mapping::Symmetric || 
           options.mapping_ == ViewingOptions::Mapping::Logarithmic)
@@ -883,15 +963,45 @@ void SliceViewer::calculateTextures()
       histogram_->calculate();
     }
     
-    if (diff >= ViewingOptions::Diff::Projection)
+    for (size_t ii=0; ii < 3; ++ii)
+      if (diff >= ViewingOptions::Diff::Complex || (diff >= ViewingOptions::Diff::Projection &&
+          old_options.needsReproject(options, views[ii]->dimx(), views[ii]->dimy())))
+        dirty[ii] = true;
+    
+    if (dirty[0] || dirty[1] || dirty[2])
     {
-      // Need to reproject
-      if (old_options.needsReproject(options, main_->view()->dimx(), main_->view()->dimy()) || diff >= ViewingOptions::Diff::Complex)
-        main_->view()->project();
-      if (old_options.needsReproject(options, left_->view()->dimx(), left_->view()->dimy()) || diff >= ViewingOptions::Diff::Complex)
-        left_->view()->project();
-      if (old_options.needsReproject(options, top_->view()->dimx(), top_->view()->dimy()) || diff >= ViewingOptions::Diff::Complex)
-        top_->view()->project();
+      // Need to reproject. First show a quick preview, computed on a subsampled
+      // image, if that is significantly cheaper than the full projection.
+      bool preview = false;
+      for (size_t ii=0; ii < 3; ++ii)
+        if (dirty[ii])
+          preview |= views[ii]->project(true);
+          
+      if (preview)
+      {
+        updated_ = true;
+        notify();
+        refresh();
+        if (!waitForDraw())
+          break;
+      }
+      
+      // Abandon the remaining work as soon as the user has requested something else
+      bool cancelled = false;
+      for (size_t ii=0; ii < 3 && !cancelled; ++ii)
+        if (dirty[ii])
+        {
+          if (isStale(options, seq))
+            cancelled = true;
+          else
+          {
+            views[ii]->project();
+            dirty[ii] = false;
+          }
+        }
+        
+      if (cancelled)
+        continue;
     }
     
     if (diff == ViewingOptions::Diff::Mapping)
@@ -912,12 +1022,17 @@ void SliceViewer::calculateTextures()
     {
       // Just redraw
       updated_ = true;
+      notify();
     }
     
     if (diff != ViewingOptions::Diff::None)
       refresh();
 
-    std::this_thread::sleep_for(std::chrono::microseconds(1000));
+    // Wait for the next event. Options may also be changed from outside
+    // (e.g. by linked viewers) without notification, so we do poll as well.
+    std::unique_lock<std::mutex> lk(wakeup_mutex_);
+    wakeup_cv_.wait_for(lk, std::chrono::milliseconds(10), [this]{ return wakeup_ || !continue_; });
+    wakeup_ = false;
   }
 }
 